@@ -12,12 +12,26 @@ use ieee.numeric_std.all;
 -- Acquires a signal and plots it
 -- Clock frequency required: 108 MHz
 -- Resetn: active low
+-- triple_buffer: true, the sweeps go to frame_buffers and the trigger re-arms after each one; false, one
+-- memory and one sweep per frame, taken during vsync (the original design, the default until a GHDL
+-- run of acquire_and_plot_tb and a build on the board back triple buffering)
+-- persistence: sweeps overlaid in one picture, see frame_buffers.vhd. Only with triple_buffer
+-- deep_bits: above 0, every sample goes to a record of 2**deep_bits samples in 2**deep_segment_bits
+-- segments, shown min/max decimated with zoom and pan (deep_record.vhd). triple_buffer is then ignored
+-- and hscale only sets the rate of the trigger. A segment holds one screen at least:
+-- 2**(deep_bits - deep_segment_bits) >= 1280, so deep_bits >= 11 + deep_segment_bits
 --
 ------------------------------------------
 ------------------------------------------
 
 
 entity acquire_and_plot is
+generic(
+    triple_buffer: boolean := false; -- capture memory in three banks, swapped at vsync
+    persistence: natural := 1; -- sweeps overlaid in one picture, 1 for none
+    deep_bits: natural := 0; -- deep record of 2**deep_bits samples, 0 for none
+    deep_segment_bits: natural := 0 -- 2**deep_segment_bits segments in the deep record, one per trigger
+);
 port(
 	clk:  	in std_logic; -- 108 MHz
 	resetn: in std_logic; -- active low
@@ -31,6 +45,10 @@ port(
     alarm: in std_logic; -- alarm, 1 if true
     vscale: in std_logic_vector(1 downto 0); -- vertical scale
     hscale: in std_logic_vector(1 downto 0); -- horitzontal scale
+    zoom: in std_logic_vector(2 downto 0) := "000"; -- deep record: 2**zoom samples per column
+    pan_left: in std_logic := '0'; -- deep record: button, view 1/8 screen earlier
+    pan_right: in std_logic := '0'; -- deep record: button, view 1/8 screen later
+    hold: in std_logic := '0'; -- deep record: switch, 1 keeps the record to browse it
     --
 	ncs: out std_logic; -- adc chip select
 	sclk: out std_logic; -- slow clock for the adc
@@ -52,6 +70,8 @@ architecture arch of acquire_and_plot is
     signal trigger_level: std_logic_vector(8 downto 0);
     signal addr_vga_memory: std_logic_vector(10 downto 0);
     signal data_memory_vga: std_logic_vector(11 downto 0);
+    signal data_min_memory_vga: std_logic_vector(11 downto 0); -- lowest of the overlaid sweeps
+    signal trigger_fired: std_logic; -- the trigger controller writes the first sample of a sweep
     signal sdata2: std_logic;
     signal period: std_logic_vector(10 downto 0);
     signal offset: std_logic_vector(7 downto 0);
@@ -70,6 +90,9 @@ architecture arch of acquire_and_plot is
     end component;
     
     component trigger_controller is
+        generic(
+            wait_vsync: boolean := true -- arm the trigger only during vsync
+        );
         port(
             clk:  	in std_logic; -- 108 MHz clock signal
             resetn: in std_logic; -- active low
@@ -102,11 +125,52 @@ architecture arch of acquire_and_plot is
         );
     end component;
     
+    component frame_buffers is
+        generic(
+            persistence: natural := 1 -- sweeps overlaid in one picture, 1 for none
+        );
+        port(
+            clk: in std_logic; -- 108 MHz
+            resetn: in std_logic; -- active low
+            vsync: in std_logic; -- display vsync, the display bank changes when it falls
+            we: in std_logic; -- write enable, from the trigger controller
+            addr_in: in std_logic_vector(10 downto 0); -- address to write data_in
+            data_in: in std_logic_vector(11 downto 0); -- data to write
+            addr_out: in std_logic_vector(10 downto 0); -- address to read, from vga_control
+            data_max: out std_logic_vector(11 downto 0); -- sample at addr_out, highest one with persistence
+            data_min: out std_logic_vector(11 downto 0) -- same as data_max, lowest one with persistence
+        );
+    end component;
+    
+    component deep_record is
+        generic(
+            record_bits: natural := 16; -- 2**record_bits samples of 12 bits
+            segment_bits: natural := 0 -- 2**segment_bits segments, one per trigger
+        );
+        port(
+            clk: in std_logic; -- 108 MHz
+            resetn: in std_logic; -- active low
+            sample_ready: in std_logic; -- 1 clock pulse that denotes new input data
+            data1: in std_logic_vector(11 downto 0); -- input data from the ADC
+            trigger: in std_logic; -- 1 clock pulse, the trigger fired on the sample at data1
+            vsync: in std_logic; -- display vsync, the view is rebuilt when it falls
+            vscale: in std_logic_vector(1 downto 0); -- asynchronous input from switches, vertical scale
+            zoom: in std_logic_vector(2 downto 0); -- asynchronous input, 2**zoom samples per column
+            pan_left: in std_logic; -- asynchronous input from button, view 1/8 screen earlier
+            pan_right: in std_logic; -- asynchronous input from button, view 1/8 screen later
+            hold: in std_logic; -- asynchronous input from switch, 1 keeps the record
+            addr_out: in std_logic_vector(10 downto 0); -- column to read, from vga_control
+            data_max: out std_logic_vector(11 downto 0); -- highest sample of the column
+            data_min: out std_logic_vector(11 downto 0) -- lowest sample of the column
+        );
+    end component;
+    
     component vga_control is
         port(
             clk:      in std_logic; -- 108 MHz
             resetn: in std_logic; -- active low
             data_in: in std_logic_vector(11 downto 0); -- input data from the memory
+            data_min: in std_logic_vector(11 downto 0); -- lowest of the overlaid sweeps, = data_in without persistence
             trigger_level: in std_logic_vector(8 downto 0); -- trigger level to display
 	       --
             t_temperature: in std_logic_vector(10 downto 0); -- threshold temperature, in pixels
@@ -138,7 +202,8 @@ adc: adc_driver port map     (clk => clk,
                               data => data_adc_trigger
 );
 
-trigger: trigger_controller port map (clk => clk,
+trigger: trigger_controller generic map (wait_vsync => not triple_buffer and deep_bits = 0)
+                            port map (clk => clk,
                                       resetn => resetn,
                                       sample_ready => sample_ready,
                                       data1 => data_adc_trigger,
@@ -156,6 +221,7 @@ trigger: trigger_controller port map (clk => clk,
                                       trigger_level => trigger_level
 );
 
+single: if not triple_buffer and deep_bits = 0 generate
 memory: sync_ram_dualport port map (clk_in => clk,
                                     clk_out => clk,
                                     we => we,
@@ -164,10 +230,48 @@ memory: sync_ram_dualport port map (clk_in => clk,
                                     data_in => data_trigger_memory,
                                     data_out => data_memory_vga 
 );
+data_min_memory_vga <= data_memory_vga;
+end generate;
+
+triple: if triple_buffer and deep_bits = 0 generate
+memory: frame_buffers generic map (persistence => persistence)
+                      port map (clk => clk,
+                                resetn => resetn,
+                                vsync => vvsync,
+                                we => we,
+                                addr_in => addr_trigger_memory,
+                                data_in => data_trigger_memory,
+                                addr_out => addr_vga_memory,
+                                data_max => data_memory_vga,
+                                data_min => data_min_memory_vga
+);
+end generate;
+
+deep: if deep_bits > 0 generate
+trigger_fired <= '1' when (we = '1' and addr_trigger_memory = 0) else '0';
+memory: deep_record generic map (record_bits => deep_bits,
+                                 segment_bits => deep_segment_bits)
+                    port map (clk => clk,
+                              resetn => resetn,
+                              sample_ready => sample_ready,
+                              data1 => data_adc_trigger,
+                              trigger => trigger_fired,
+                              vsync => vvsync,
+                              vscale => vscale,
+                              zoom => zoom,
+                              pan_left => pan_left,
+                              pan_right => pan_right,
+                              hold => hold,
+                              addr_out => addr_vga_memory,
+                              data_max => data_memory_vga,
+                              data_min => data_min_memory_vga
+);
+end generate;
 
 vga: vga_control port map (clk => clk,
                            resetn => resetn,
                            data_in => data_memory_vga,
+                           data_min => data_min_memory_vga,
                            trigger_level => trigger_level,
                            t_temperature => t_temperature,
                            temperature => temperature,
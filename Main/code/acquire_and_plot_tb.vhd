@@ -1,19 +1,39 @@
 library ieee;
 use ieee.std_logic_1164.all;
 use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
 
 ------------------------------------------
 ------------------------------------------
 --
 -- Testbench for the acquire_and_plot entity
 -- The acquire_and_plot entity is under acquire_and_plot.vhd
+-- Every 4 frames it reports the sweeps stored per second. Compare the two memories with
+--   ghdl -a --std=08 -fsynopsys *.vhd
+--   ghdl -r --std=08 -fsynopsys acquire_and_plot_tb --stop-time=100ms
+--   ghdl -r --std=08 -fsynopsys acquire_and_plot_tb --stop-time=100ms -gtriple_buffer=true
+-- The sweep_rate and deep_check processes read signals of the instance through external names: the
+-- testbench needs VHDL-2008, --std=08 in GHDL, "VHDL 2008" as the file type in Vivado. The golden model
+-- predicts the rates it should report, apmodel run: 61 sweeps/s without triple buffering, 835 with it
+-- With a deep record, the deep_check process checks every column the reductions write against the min and
+-- max of its samples, and reports each view:
+--   ghdl -r --std=08 -fsynopsys acquire_and_plot_tb --stop-time=100ms -gdeep_bits=13 -gdeep_segment_bits=2 -gdeep_zoom=2
+-- apmodel deep --source tb --record-bits 13 --segment-bits 2 --zoom 2 --ram FILE writes the same columns.
+-- With -gdeep_segment_bits=3, segments of 1024 samples, elaboration must stop on the assertion of
+-- deep_record that a segment holds one screen
 --
 ------------------------------------------
 ------------------------------------------
 
 
 entity acquire_and_plot_tb is
-
+generic(
+    triple_buffer: boolean := false; -- true: three banks, the trigger re-arms after each sweep
+    persistence: natural := 1; -- sweeps overlaid in one picture
+    deep_bits: natural := 0; -- deep record of 2**deep_bits samples, 0 for none
+    deep_segment_bits: natural := 0; -- segments of the deep record
+    deep_zoom: natural := 0 -- zoom input of the deep record
+);
 end acquire_and_plot_tb;
 
 
@@ -41,12 +61,19 @@ signal temperature: std_logic_vector(10 downto 0):= (10 => '1', 9 => '1', others
 signal alarm: std_logic := '0'; -- alarm, 1 if true
 signal vscale: std_logic_vector(1 downto 0) := (others => '0'); -- vertical scale
 signal hscale: std_logic_vector(1 downto 0) := (others => '0'); -- horitzontal scale
+signal zoom: std_logic_vector(2 downto 0) := std_logic_vector(to_unsigned(deep_zoom, 3)); -- deep record zoom
 --
 
 -- Auxiliary signals
 signal dataa: std_logic_vector(11 downto 0):= (others => '0');
 
 component acquire_and_plot
+generic(
+    triple_buffer: boolean := false; -- capture memory in three banks, swapped at vsync
+    persistence: natural := 1; -- sweeps overlaid in one picture, 1 for none
+    deep_bits: natural := 0; -- deep record of 2**deep_bits samples, 0 for none
+    deep_segment_bits: natural := 0 -- 2**deep_segment_bits segments in the deep record, one per trigger
+);
 port(
 	clk:  	in std_logic; -- 108 MHz
     resetn: in std_logic; -- active low
@@ -60,6 +87,7 @@ port(
     alarm: in std_logic; -- alarm, 1 if true
     vscale: in std_logic_vector(1 downto 0); -- vertical scale
     hscale: in std_logic_vector(1 downto 0); -- horitzontal scale
+    zoom: in std_logic_vector(2 downto 0) := "000"; -- deep record: 2**zoom samples per column
     --   
     ncs: out std_logic; -- adc chip select
     sclk: out std_logic; -- slow clock for the adc
@@ -132,12 +160,26 @@ begin
     
         -- wait for 1 ms;
         -- trigger_up <= not trigger_up;
+        
+        -- the stimulus steps 0, 1024, 2048, 3072, which never crosses the reset level (256) strictly:
+        -- press trigger_down once, level 240, before the first possible trigger (apmodel --level 240)
+        wait for 1 us;
+        trigger_down <= '1';
+        wait for 100 ns;
+        trigger_down <= '0';
+        wait;
 
     end process;
 	
 	
 	-- Component instantiation
 	acquire_and_plot_instance: acquire_and_plot
+	generic map(
+	            triple_buffer => triple_buffer,
+	            persistence => persistence,
+	            deep_bits => deep_bits,
+	            deep_segment_bits => deep_segment_bits
+	)
 	port map(
 				clk 	=> clk,
 				resetn 	=> resetn,
@@ -150,6 +192,7 @@ begin
                 alarm => alarm,
                 vscale => vscale,
                 hscale => hscale,
+                zoom => zoom,
                 ncs => ncs,
                 sclk => sclk,
                 vsync => vsync,
@@ -159,4 +202,92 @@ begin
                 blue => blue
 	);
 	
+	-- Sweeps per second: a sweep is stored when the trigger controller writes address 1280. Counted from
+	-- the first vsync, reported every 4 frames with the frames that showed a new sweep
+	sweep_rate: process(clk)
+	    alias we_mem is <<signal .acquire_and_plot_tb.acquire_and_plot_instance.we: std_logic>>;
+	    alias addr_mem is <<signal .acquire_and_plot_tb.acquire_and_plot_instance.addr_trigger_memory: std_logic_vector(10 downto 0)>>;
+	    variable sweeps: natural := 0; -- since the first vsync
+	    variable frames: natural := 0; -- vsync falling edges
+	    variable updates: natural := 0; -- frames after which a new sweep was stored
+	    variable stored: boolean := false; -- a sweep was stored in the current frame
+	    variable t0: time := 0 ns;
+	    variable vsync_prev: std_logic := '1';
+	begin
+	    if (clk'event and clk='1') then
+	        if (we_mem = '1' and addr_mem = 1280) then
+	            sweeps := sweeps + 1;
+	            stored := true;
+	        end if;
+	        if (vsync = '0' and vsync_prev = '1') then
+	            if (frames = 0) then
+	                t0 := now;
+	                sweeps := 0;
+	            elsif (stored) then
+	                updates := updates + 1;
+	            end if;
+	            stored := false;
+	            frames := frames + 1;
+	            if (frames mod 4 = 1 and frames > 1) then
+	                report "frames " & integer'image(frames - 1) & ": " & integer'image(sweeps) & " sweeps in " &
+	                       time'image(now - t0) & ", " &
+	                       integer'image(integer(real(sweeps) * 1.0e9 / real((now - t0) / 1 ns))) & " sweeps/s, " &
+	                       integer'image(updates) & " frames with a new sweep";
+	            end if;
+	        end if;
+	        vsync_prev := vsync;
+	    end if;
+	end process;
+	
+	-- Deep record: the staircase fires the trigger on 2048, so sample i of every segment is
+	-- 1024 * ((2 + i) mod 4), and pan stays at 0: column c holds the min and max of samples c*k .. c*k + k-1
+	deep: if deep_bits > 0 generate
+	deep_check: process(clk)
+	    alias disp_we is <<signal .acquire_and_plot_tb.acquire_and_plot_instance.deep.memory.disp_we: std_logic>>;
+	    alias disp_addr is <<signal .acquire_and_plot_tb.acquire_and_plot_instance.deep.memory.disp_addr: std_logic_vector(10 downto 0)>>;
+	    alias disp_word is <<signal .acquire_and_plot_tb.acquire_and_plot_instance.deep.memory.disp_word: std_logic_vector(23 downto 0)>>;
+	    variable k: natural := 1; -- samples per column: deep_zoom, up to the zoom_limit of deep_record
+	    variable hi, lo, s: natural;
+	    variable columns: natural := 0; -- of the current view
+	    variable views: natural := 0;
+	    variable errors: natural := 0;
+	begin
+	    if (clk'event and clk='1') then
+	        if (disp_we = '1') then
+	            k := 1;
+	            while (k < 2**deep_zoom and k < 32 and 1280 * 2 * k <= 2**deep_bits) loop
+	                k := 2 * k;
+	            end loop;
+	            hi := 0;
+	            lo := 4095;
+	            for j in 0 to k - 1 loop
+	                s := 1024 * ((2 + conv_integer(disp_addr) * k + j) mod 4);
+	                if (s > hi) then
+	                    hi := s;
+	                end if;
+	                if (s < lo) then
+	                    lo := s;
+	                end if;
+	            end loop;
+	            if (conv_integer(disp_word(23 downto 12)) /= hi or conv_integer(disp_word(11 downto 0)) /= lo) then
+	                if (errors = 0) then
+	                    report "deep view " & integer'image(views) & ", column " & integer'image(conv_integer(disp_addr)) &
+	                           ": max " & integer'image(conv_integer(disp_word(23 downto 12))) & " min " &
+	                           integer'image(conv_integer(disp_word(11 downto 0))) & ", expected " &
+	                           integer'image(hi) & " " & integer'image(lo) severity error;
+	                end if;
+	                errors := errors + 1;
+	            end if;
+	            columns := columns + 1;
+	            if (columns = 1280) then
+	                report "deep view " & integer'image(views) & ": 1280 columns of " & integer'image(k) &
+	                       " samples, " & integer'image(errors) & " wrong so far";
+	                columns := 0;
+	                views := views + 1;
+	            end if;
+	        end if;
+	    end if;
+	end process;
+	end generate;
+	
 end behaviour;
@@ -61,11 +61,24 @@
 */
 
 #include  <stdio.h>
+#include  <string.h>
 #include  <Source/os.h>
 #include  <ucos_bsp.h>
+#include  <ucos_int.h>
 
 #include "xadcps.h"
 #include <xgpio.h>
+#include <xil_printf.h>
+
+#include "app_log.h"
+#include "app_mon.h"
+#include "app_prof.h"
+#include "app_rate.h"
+#include "app_spec.h"
+#include "app_state.h"
+#include "app_temp.h"
+#include "app_tlm.h"
+#include "app_wheel.h"
 
 
 /*
@@ -81,9 +94,60 @@
 #define	APP_TASK_START_STK_SIZE	512u
 #define	APP_TASK1_STK_SIZE		512u
 #define APP_TASK2_STK_SIZE		512u
+#define APP_TASK_LOG_STK_SIZE	512u
+#define APP_TASK_SPEC_STK_SIZE	1024u	// snprintf() of floats needs more than the other tasks
+#ifndef APP_WHEEL_EN
+#define APP_WHEEL_EN			DEF_TRUE	// DEF_TRUE: the periodic jobs run in Task Start, on a timer wheel (app_wheel.h)
+#endif										// DEF_FALSE: one task each (Task Start, Task #1)
+#if (APP_WHEEL_EN == DEF_TRUE)
+#define APP_TASK_START_PRIO		2u		// Priority of the temperature job, as Task #1 had
+#else
 #define APP_TASK_START_PRIO		8u
+#endif
 #define APP_TASK1_PRIO			2u
 #define APP_TASK2_PRIO			3u
+#define APP_TASK_LOG_PRIO		10u		// Only prints when nothing else runs
+#define APP_TASK_SPEC_PRIO		11u		// Lowest application priority, the analysis only uses idle time
+#define APP_LOG_BATCH_SIZE		128u	// Bytes sent to the UART per UCOS_Print() call
+#ifndef APP_TLM_BINARY
+#define APP_TLM_BINARY			DEF_FALSE	// DEF_TRUE: telemetry as framed binary records (app_tlm.h), decoded by host/tlm_dec.c
+#endif
+#define APP_TLM_COUNTERS_DOTS	10u		// Binary mode: a COUNTERS record in place of every 10th dot, nothing for the others
+#define APP_BTN_INT_ID			XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR // GPIO interrupt line (check this is consistent with the block diagram)
+#define APP_BTN_Q_SIZE			32u		// Button edges that can wait in the queue of Task #2
+#define APP_BTN_DEBOUNCE_MS		20u		// The buttons must be stable this long before a change is accepted
+#define APP_BTN_REPEAT_DLY_MS	600u	// A held button repeats after this delay...
+#define APP_BTN_REPEAT_MS		200u	// ...and then with this period
+#define APP_XADC_CONTINUOUS		DEF_TRUE	// DEF_TRUE: continuous sequencer over AppMonTbl, DEF_FALSE: safe mode
+#define APP_XADC_AVG			XADCPS_AVG_64_SAMPLES	// On-chip averaging of every monitored channel
+#define APP_MON_ROW_TEMP		0u		// Row of AppMonTbl holding the die temperature
+#define APP_TEMP_HYST			2		// The temperature alarm clears 2 C below the threshold
+#define APP_TEMP_PERIOD_MS		200u	// Fixed sampling period of Task #1
+#ifndef APP_TEMP_ADAPTIVE
+#define APP_TEMP_ADAPTIVE		DEF_TRUE	// DEF_TRUE: period from AppRate_Next(), DEF_FALSE: APP_TEMP_PERIOD_MS
+#endif
+#define APP_TEMP_PERIOD_MIN_MS	20u		// Adaptive period limits, see app_rate.h
+#define APP_TEMP_PERIOD_MAX_MS	1000u
+#define APP_TEMP_LATENCY_MS		100u	// Guaranteed alarm detection latency, plus the release delay of Task #1
+#define APP_TEMP_SLEW_MAX_MC	1000u	// Fastest die temperature change assumed, 1 C/s
+#define APP_TEMP_DEADLINE_MS	10u		// A temperature sample served later than this after it was due is a miss
+#define APP_DOT_PERIOD_MS		100u	// Period of the dot of Task Start
+#define APP_DOT_DEADLINE_MS		50u
+#define APP_BTN_PROF			3u		// BTNL+BTNR: print the task statistics
+#define APP_PROF_START			0u		// Rows of AppProfTbl
+#define APP_PROF_TASK1			1u
+#define APP_PROF_TASK2			2u
+#define APP_PROF_LOG			3u
+#define APP_PROF_SPEC			4u
+#define APP_PROF_N				5u
+#define APP_PROF_DUMP_MAX		((APP_PROF_N + 5u) * (APP_PROF_LINE_SIZE + 2u + 2u * APP_TLM_OVERHEAD))	// Bytes AppProfPrint() queues at once: the header and 9 lines with CRLF, each up to 2 frames in binary mode
+#if (APP_LOG_RING_SIZE < APP_PROF_DUMP_MAX)
+#error "APP_LOG_RING_SIZE cannot hold the statistics AppProfPrint() queues at once"
+#endif
+#ifndef APP_SPEC_EN
+#define APP_SPEC_EN				DEF_FALSE	// DEF_TRUE: spectrum task over the sweeps posted with AppSpec_Post(). The PL does not
+#endif										// export them yet (app_spec.h): only the host simulation builds it, -DAPP_SPEC_EN=DEF_TRUE
+#define APP_SPEC_PRINT_MS		1000u	// At most one spectrum line per period
 
 
 /*
@@ -93,25 +157,86 @@
 */
 
 static  OS_TCB       AppTaskStartTCB;							// Task Control Block (TCB).
+#if (APP_WHEEL_EN != DEF_TRUE)
 static  OS_TCB       AppTask1TCB;
+#endif
 static  OS_TCB       AppTask2TCB;
+static  OS_TCB       AppTaskLogTCB;
+#if (APP_SPEC_EN == DEF_TRUE)
+static  OS_TCB       AppTaskSpecTCB;
+#endif
 
 static  CPU_STK      AppTaskStartStk[APP_TASK_START_STK_SIZE]; 	 // Startup Task Stack
+#if (APP_WHEEL_EN != DEF_TRUE)
 static  CPU_STK      AppTask1Stk[APP_TASK1_STK_SIZE];			 // Task #1      Stack
+#endif
 static  CPU_STK      AppTask2Stk[APP_TASK2_STK_SIZE];			 // Task #2      Stack
-
-static  OS_MUTEX     AppMutexPrint;							     // App Mutex
+static  CPU_STK      AppTaskLogStk[APP_TASK_LOG_STK_SIZE];		 // Log task     Stack
+#if (APP_SPEC_EN == DEF_TRUE)
+static  CPU_STK      AppTaskSpecStk[APP_TASK_SPEC_STK_SIZE];	 // Spectrum task Stack
+#endif
+
+static  APP_LOG_RING AppLogStart;								 // One log ring per printing task, single producer each
+static  APP_LOG_RING AppLog1;
+static  APP_LOG_RING AppLog2;
+static  APP_LOG_RING AppLogSpec;
+static  APP_LOG_RING *const AppLogRings[] = { &AppLog1, &AppLog2, &AppLogStart, &AppLogSpec };
+static  APP_LOG_SIGNAL AppLogSignal;							 // Wakes the log task when a ring gets a message
 
 static XAdcPs XAdcInst;      								     // XADC Driver instance
 XAdcPs *XAdcInstPtr = &XAdcInst;
 static XGpio Gpio; 												// GPIO Driver instance
 
-// Global variable that holds the output
-int output = 0; // 32 bit variable, contains 23 useful bits. threshold(11b)|temperature(11b)|alarm(1b)
+// Publisher of the output word, 23 useful bits: alarm(1b)|temperature(11b)|threshold(11b). See app_state.h
+static APP_STATE AppState;
 int threshold; // temperature threshold
 int temperature; // last read temperature value
 int alarm; // holds 1 if there's an alarm (temperature > threshold)
 
+// Monitored XADC channels, one row per sensor. Limits in degrees Celsius or mV.
+static APP_MON_CH AppMonTbl[] = {
+	{ .NamePtr = "TEMP",    .Channel = XADCPS_CH_TEMP,    .Kind = APP_MON_TEMP,   .Limit =   50, .Above = DEF_TRUE,  .Hyst = APP_TEMP_HYST, .AlarmBit = 0u },	// Limit follows 'threshold'
+	{ .NamePtr = "VCCINT",  .Channel = XADCPS_CH_VCCINT,  .Kind = APP_MON_SUPPLY, .Limit =  950, .Above = DEF_FALSE, .Hyst = 10,            .AlarmBit = 1u },	// 1.0 V - 5%
+	{ .NamePtr = "VCCAUX",  .Channel = XADCPS_CH_VCCAUX,  .Kind = APP_MON_SUPPLY, .Limit = 1710, .Above = DEF_FALSE, .Hyst = 10,            .AlarmBit = 2u },	// 1.8 V - 5%
+	{ .NamePtr = "VCCBRAM", .Channel = XADCPS_CH_VBRAM,   .Kind = APP_MON_SUPPLY, .Limit =  950, .Above = DEF_FALSE, .Hyst = 10,            .AlarmBit = 3u },	// 1.0 V - 5%
+	{ .NamePtr = "VAUX0",   .Channel = XADCPS_CH_AUX_MIN, .Kind = APP_MON_EXT,    .Limit =  900, .Above = DEF_TRUE,  .Hyst = 10,            .AlarmBit = 4u },	// External input, 0 to 1 V
+};
+#define APP_MON_N				(sizeof(AppMonTbl) / sizeof(AppMonTbl[0]))
+
+CPU_INT32U alarms; // alarm word, bit 'AlarmBit' of every AppMonTbl row in alarm
+
+// Sampling period of Task #1, see app_rate.h
+static APP_RATE AppRate;
+
+#if (APP_WHEEL_EN == DEF_TRUE)
+// Periodic jobs, run by Task Start. To sample something else periodically, add a job
+static APP_WHEEL AppWheel;
+static APP_WHEEL_JOB AppJobTemp;
+static APP_WHEEL_JOB AppJobDot;
+#endif
+
+// Button statistics
+CPU_INT32U button_presses; // accepted presses and auto-repeats
+CPU_INT32U button_edges_dropped; // edges lost because the queue of Task #2 was full
+CPU_INT32U button_latency_max_us; // worst time from the first edge of a press to the threshold update
+
+// Spectrum of the acquired sweeps, see app_spec.h. Tones of the Goertzel bank, levels in dBFS
+#if (APP_SPEC_EN == DEF_TRUE)
+static APP_SPEC_BIN AppSpecBins[] = {
+	{ .NamePtr = "1k",   .Hz =   1000.0f },
+	{ .NamePtr = "10k",  .Hz =  10000.0f },
+	{ .NamePtr = "100k", .Hz = 100000.0f },
+};
+#define APP_SPEC_BINS			(sizeof(AppSpecBins) / sizeof(AppSpecBins[0]))
+#endif
+
+CPU_INT32U spec_sweeps; // sweeps analyzed
+APP_SPEC_RESULT spec_last; // figures of the last one, also for a debugger
+
+// Task statistics, see app_prof.h. AppProfSnap holds the last snapshot, also for a debugger
+static APP_PROF_TASK AppProfTbl[APP_PROF_N];
+APP_PROF_SNAP AppProfSnap[APP_PROF_N];
+
 
 /*
 *********************************************************************************************************
@@ -121,10 +246,26 @@ int alarm; // holds 1 if there's an alarm (temperature > threshold)
 
 static  void  AppTaskCreate      (void);
 static  void  AppTaskStart       (void *p_arg);
+#if (APP_WHEEL_EN != DEF_TRUE)
 static  void  AppTask1           (void *p_arg);
+#endif
 static  void  AppTask2           (void *p_arg);
+static  void  AppTaskLog         (void *p_arg);
+static  void  AppLogWake         (void);
+#if (APP_SPEC_EN == DEF_TRUE)
+static  void  AppTaskSpec        (void *p_arg);
+#endif
+static  OS_TICK  AppTempJob      (void *p_arg);
+static  OS_TICK  AppDotJob       (void *p_arg);
+static  void  AppButtonISR       (void *p_arg);
+static  void  AppButtonAction    (u32 button, CPU_TS ts_edge);
+static  void  AppProfPrint       (void);
 static  void  AppPrintWelcomeMsg (void);
 static  void  AppPrint           (char *str);
+#if (APP_TLM_BINARY == DEF_TRUE)
+static  void  AppUartWrite       (const CPU_CHAR *p_buf, CPU_INT32U len);
+static  CPU_INT32U  AppTimeMs    (void);
+#endif
 static  void  AppPrintWelcomeMsg (void);
 static void Peripheral_Init		(void); //initialization of the peripheral unit for the XadcPs
 void  MainTask (void *p_arg);
@@ -163,11 +304,29 @@ int main()
 void  MainTask (void *p_arg)
 {
     OS_ERR       err;
+    unsigned     i;
 
     AppPrintWelcomeMsg();
 
 	OSInit(&err);		/* Initialize uC/OS-III.                                */
 
+	AppLog_Init(&AppLogStart, "App Task Start");
+	AppLog_Init(&AppLog1, "Task 1");
+	AppLog_Init(&AppLog2, "Task 2");
+	AppLog_Init(&AppLogSpec, "Task Spectrum");
+	AppLogSignal.WakeFnct = AppLogWake;
+	for (i = 0u; i < sizeof(AppLogRings) / sizeof(AppLogRings[0]); i++) {
+		AppLogRings[i]->Src = (CPU_INT08U)i; // Source number of its binary records
+		AppLog_Attach(AppLogRings[i], &AppLogSignal);
+	}
+
+	AppState_Init(&AppState, &Gpio, TEMPERATURE_CHANNEL);
+	AppState_SetThreshold(&AppState, threshold);
+	AppProf_Init(AppProfTbl, APP_PROF_N);
+	AppSpec_Init();
+	AppRate_Init(&AppRate, APP_TEMP_PERIOD_MIN_MS, APP_TEMP_PERIOD_MAX_MS, APP_TEMP_LATENCY_MS,
+				 APP_TEMP_SLEW_MAX_MC, APP_TEMP_PERIOD_MS);
+
 	OSTaskCreate	((OS_TCB	*)&AppTaskStartTCB,
 					(CPU_CHAR	*)"App Task Start",
 					(OS_TASK_PTR )AppTaskStart,
@@ -176,16 +335,16 @@ void  MainTask (void *p_arg)
 					(CPU_STK 	*)&AppTaskStartStk[0],
 					(CPU_STK_SIZE)APP_TASK_START_STK_SIZE / 10,
 					(CPU_STK_SIZE)APP_TASK_START_STK_SIZE,
-					(OS_MSG_QTY	 )0,
+					(OS_MSG_QTY	 )APP_WHEEL_Q_SIZE,	/* Kicks of the timer wheel jobs                        */
 					(OS_TICK	 )0,
-					(void 		*)0,
+					(void 		*)&AppLogStart,		/* TCB extension: the task's log ring                   */
 					(OS_OPT )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
 					(OS_ERR *)&err);
+	AppProf_Attach(&AppProfTbl[APP_PROF_START], &AppTaskStartTCB);
 
 	OSStart(&err);			/* Start multitasking (i.e. give control to uC/OS-II).  */
 
-	while (1) {
-		AppPrint(".");
+	while (1) {				/* Not reached: OSStart() does not return.              */
 	        ;
 	    }
 }
@@ -213,13 +372,36 @@ static  void  AppPrintWelcomeMsg (void)
     UCOS_Print("\f\f\r\n");
     UCOS_Print("Micrium\r\n");
     UCOS_Print("uCOS-III\r\n\r\n");
-    UCOS_Print("This application runs three different tasks:\r\n\r\n");
+#if (APP_WHEEL_EN == DEF_TRUE)
+    UCOS_Print("This application runs four different tasks:\r\n\r\n");
+    UCOS_Print("1. Task Start: Initializes the OS and creates tasks and\r\n");
+    UCOS_Print("               other kernel objects such as the mutex.\r\n");
+    UCOS_Print("               It then runs the periodic jobs:\r\n");
+    UCOS_Print("               - prints a dot '.' every 100 milliseconds;\r\n");
+    UCOS_Print("               - reads temperature every 20 ms to 1 s,\r\n");
+    UCOS_Print("                 more often the closer it is to the\r\n");
+    UCOS_Print("                 threshold.\r\n");
+    UCOS_Print("2. Task #2   : Handles the input buttons on interrupt.\r\n");
+    UCOS_Print("               BTNL+BTNR prints the task statistics.\r\n");
+    UCOS_Print("3. Task Log  : Sends the text queued by the other tasks\r\n");
+    UCOS_Print("               to the UART.\r\n");
+    UCOS_Print("4. Task Spec : Frequency, THD and SNR of the acquired\r\n");
+    UCOS_Print("               sweeps, in the idle time.\r\n\r\n");
+#else
+    UCOS_Print("This application runs five different tasks:\r\n\r\n");
     UCOS_Print("1. Task Start: Initializes the OS and creates tasks and\r\n");
     UCOS_Print("               other kernel objects such as the mutex.\r\n");
     UCOS_Print("               This task remains running and printing a\r\n");
     UCOS_Print("               dot '.' every 100 milliseconds.\r\n");
-    UCOS_Print("2. Task #1   : Reads temperature every 200-milliseconds.\r\n");
-    UCOS_Print("3. Task #2   : Reads input buttons every 500-milliseconds.\r\n\r\n");
+    UCOS_Print("2. Task #1   : Reads temperature every 20 ms to 1 s, more\r\n");
+    UCOS_Print("               often the closer it is to the threshold.\r\n");
+    UCOS_Print("3. Task #2   : Handles the input buttons on interrupt.\r\n");
+    UCOS_Print("               BTNL+BTNR prints the task statistics.\r\n");
+    UCOS_Print("4. Task Log  : Sends the text queued by the other tasks\r\n");
+    UCOS_Print("               to the UART.\r\n");
+    UCOS_Print("5. Task Spec : Frequency, THD and SNR of the acquired\r\n");
+    UCOS_Print("               sweeps, in the idle time.\r\n\r\n");
+#endif
 }
 
 /*
@@ -235,6 +417,8 @@ static  void  AppPrintWelcomeMsg (void)
 *
 * Notes       : 1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                  used.  The compiler should not generate any code for this statement.
+*               2) With APP_WHEEL_EN it then dispatches the periodic jobs, one stack for all of them; the
+*                  wheel records their deadline misses (see AppProfPrint()).
 *********************************************************************************************************
 */
 
@@ -245,16 +429,69 @@ static  void  AppTaskStart (void *p_arg)
 	UCOS_Print("Task Start Created\r\n");
 
     AppTaskCreate();                                            /* Create Application tasks                             */
-    OSMutexCreate((OS_MUTEX *)&AppMutexPrint, (CPU_CHAR *)"My App. Mutex", (OS_ERR *)&err);
 
+#if (APP_WHEEL_EN == DEF_TRUE)
+    Peripheral_Init();
+    AppWheel_Init(&AppWheel, &AppTaskStartTCB);
+    AppWheel_Add(&AppWheel, &AppJobTemp, "Temperature", AppTempJob, (void *)0,
+                 1u, APP_TEMP_DEADLINE_MS * OS_CFG_TICK_RATE_HZ / 1000u);
+    AppWheel_Add(&AppWheel, &AppJobDot, "Dot", AppDotJob, (void *)0,
+                 APP_DOT_PERIOD_MS * OS_CFG_TICK_RATE_HZ / 1000u, APP_DOT_DEADLINE_MS * OS_CFG_TICK_RATE_HZ / 1000u);
+    AppWheel_Run(&AppWheel);                                    /* Does not return                                      */
+    (void)err;
+#else
     while (1) {                                            /* Task body, always written as an infinite loop.       */
 
-        OSTimeDlyHMSM(0, 0, 0, 100,
+        OSTimeDlyHMSM(0, 0, 0, APP_DOT_PERIOD_MS,
                       OS_OPT_TIME_HMSM_STRICT,
                      &err);                                     /* Waits 100 milliseconds.                              */
 
-    	AppPrint(".");                                          /* Prints a dot every 100 milliseconds.                 */
+        AppProf_LoopBegin(&AppProfTbl[APP_PROF_START]);
+        (void)AppDotJob((void *)0);
+        AppProf_LoopEnd(&AppProfTbl[APP_PROF_START]);
     }
+#endif
+}
+
+/*
+*********************************************************************************************************
+*                                               DOT JOB
+*
+* Description : Prints a dot, every APP_DOT_PERIOD_MS. In binary mode (APP_TLM_BINARY) it sends the
+*               counters every APP_TLM_COUNTERS_DOTS periods instead.
+*
+* Argument(s) : p_arg   is not used.
+*
+* Return(s)   : Ticks until the next dot.
+*
+* Caller(s)   : AppTaskStart(), directly or through the timer wheel.
+*********************************************************************************************************
+*/
+
+static  OS_TICK  AppDotJob (void *p_arg)
+{
+#if (APP_TLM_BINARY == DEF_TRUE)
+	static CPU_INT32U dots = 0u;
+	CPU_INT32U ctr[APP_TLM_COUNTERS_SIZE / 4u];
+	unsigned   i;
+
+
+	(void)p_arg;
+	if (++dots % APP_TLM_COUNTERS_DOTS == 0u) {                 /* The counters, as the sign of life                    */
+		ctr[0] = button_presses;
+		ctr[1] = button_edges_dropped;
+		ctr[2] = 0u;
+		for (i = 0u; i < sizeof(AppLogRings) / sizeof(AppLogRings[0]); i++) {
+			ctr[2] += atomic_load_explicit(&AppLogRings[i]->Dropped, memory_order_relaxed);
+		}
+		ctr[3] = AppRate.Wakeups;
+		(void)AppTlm_Counters((APP_LOG_RING *)OSTCBCurPtr->ExtPtr, AppTimeMs(), ctr);
+	}
+#else
+	(void)p_arg;
+	AppPrint(".");                                              /* Prints a dot every 100 milliseconds.                 */
+#endif
+	return ((OS_TICK)(APP_DOT_PERIOD_MS * OS_CFG_TICK_RATE_HZ / 1000u));
 }
 
 /*
@@ -278,6 +515,22 @@ static  void  AppTaskCreate (void)
 	OS_ERR  err;
 
 
+    OSTaskCreate((OS_TCB     *)&AppTaskLogTCB,                  /* Create the log task first, so no message waits long. */
+                 (CPU_CHAR   *)"Task Log",
+                 (OS_TASK_PTR ) AppTaskLog,
+                 (void       *) 0,
+                 (OS_PRIO     ) APP_TASK_LOG_PRIO,
+                 (CPU_STK    *)&AppTaskLogStk[0],
+                 (CPU_STK_SIZE) APP_TASK_LOG_STK_SIZE / 10u,
+                 (CPU_STK_SIZE) APP_TASK_LOG_STK_SIZE,
+                 (OS_MSG_QTY  ) 0u,
+                 (OS_TICK     ) 0u,
+                 (void       *) 0,
+                 (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
+                 (OS_ERR     *)&err);
+    AppProf_Attach(&AppProfTbl[APP_PROF_LOG], &AppTaskLogTCB);
+
+#if (APP_WHEEL_EN != DEF_TRUE)                                  /* Else the temperature is a job of Task Start          */
     OSTaskCreate((OS_TCB     *)&AppTask1TCB,                    /* Create the Task #1.                                  */
                  (CPU_CHAR   *)"Task 1",
                  (OS_TASK_PTR ) AppTask1,
@@ -288,9 +541,11 @@ static  void  AppTaskCreate (void)
                  (CPU_STK_SIZE) APP_TASK1_STK_SIZE,
                  (OS_MSG_QTY  ) 0u,
                  (OS_TICK     ) 0u,
-                 (void       *) 0,
+                 (void       *)&AppLog1,                        /* TCB extension: the task's log ring                   */
                  (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
                  (OS_ERR     *)&err);
+    AppProf_Attach(&AppProfTbl[APP_PROF_TASK1], &AppTask1TCB);
+#endif
 
     OSTaskCreate((OS_TCB     *)&AppTask2TCB,                    /* Create the Task #2.                                  */
                  (CPU_CHAR   *)"Task 2",
@@ -300,18 +555,37 @@ static  void  AppTaskCreate (void)
                  (CPU_STK    *)&AppTask2Stk[0],
                  (CPU_STK_SIZE) APP_TASK2_STK_SIZE / 10u,
                  (CPU_STK_SIZE) APP_TASK2_STK_SIZE,
-                 (OS_MSG_QTY  ) 0u,
+                 (OS_MSG_QTY  ) APP_BTN_Q_SIZE,                 /* Button edges are posted to the task queue            */
                  (OS_TICK     ) 0u,
+                 (void       *)&AppLog2,                        /* TCB extension: the task's log ring                   */
+                 (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
+                 (OS_ERR     *)&err);
+    AppProf_Attach(&AppProfTbl[APP_PROF_TASK2], &AppTask2TCB);
+
+#if (APP_SPEC_EN == DEF_TRUE)
+    OSTaskCreate((OS_TCB     *)&AppTaskSpecTCB,                 /* Create the spectrum task.                            */
+                 (CPU_CHAR   *)"Task Spectrum",
+                 (OS_TASK_PTR ) AppTaskSpec,
                  (void       *) 0,
+                 (OS_PRIO     ) APP_TASK_SPEC_PRIO,
+                 (CPU_STK    *)&AppTaskSpecStk[0],
+                 (CPU_STK_SIZE) APP_TASK_SPEC_STK_SIZE / 10u,
+                 (CPU_STK_SIZE) APP_TASK_SPEC_STK_SIZE,
+                 (OS_MSG_QTY  ) APP_SPEC_BUFS,                  /* Sweeps are posted to the task queue                  */
+                 (OS_TICK     ) 0u,
+                 (void       *)&AppLogSpec,                     /* TCB extension: the task's log ring                   */
                  (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
                  (OS_ERR     *)&err);
+    AppProf_Attach(&AppProfTbl[APP_PROF_SPEC], &AppTaskSpecTCB);
+    AppSpec_PortInit(&AppTaskSpecTCB);
+#endif
 }
 
 /*
 *********************************************************************************************************
 *                                              TASK #1
 *
-* Description : This is an example of an application task that prints "1" every second to the UART.
+* Description : Temperature task, when the periodic jobs do not run on the timer wheel (APP_WHEEL_EN).
 *
 *
 * Arguments   : p_arg   is the argument passed to 'AppTaskStart()' by 'OSTaskCreate()'.
@@ -323,32 +597,73 @@ static  void  AppTaskCreate (void)
 *********************************************************************************************************
 */
 
+#if (APP_WHEEL_EN != DEF_TRUE)
 static  void  AppTask1 (void *p_arg) // Temperature task
+{
+	OS_ERR  err;
+	OS_TICK ticks;
+	(void)p_arg;
+
+    AppPrint("Temperature task has started\r\n");
+    Peripheral_Init();
+    while (1) {
+                                           		/* Task body, always written as an infinite loop. */
+    AppProf_LoopBegin(&AppProfTbl[APP_PROF_TASK1]);
+    ticks = AppTempJob((void *)0);
+	AppProf_LoopEnd(&AppProfTbl[APP_PROF_TASK1]);
+
+        OSTimeDly(ticks,
+                  OS_OPT_TIME_DLY,
+                 &err);                                         /* Resumed early by a threshold change                  */
+           // AppPrint("1");
+
+    }
+}
+#endif
+
+/*
+*********************************************************************************************************
+*                                          TEMPERATURE JOB
+*
+* Description : Reads the monitored channels, prints the temperature and the alarms, publishes them to the
+*               display and picks the delay until the next reading.
+*
+* Arguments   : p_arg   is not used.
+*
+* Returns     : Ticks until the next reading.
+*
+* Caller(s)   : AppTaskStart() through the timer wheel, or AppTask1().
+*********************************************************************************************************
+*/
+
+static  OS_TICK  AppTempJob (void *p_arg)
 {
 	OS_ERR  err;
 
-	unsigned int temperature_raw;
+	CPU_INT32U period_ms = APP_TEMP_PERIOD_MS;
 	(void)p_arg;
+#if (APP_TLM_BINARY != DEF_TRUE)
+	static CPU_INT32U alarms_prev = 0u;
+	CPU_INT32U i;
+	char alarms_string[64]; // Holds the names of the channels in alarm, it is later printed
 	char temp_string[20]; // Holds the temperature, it is later printed
 	char temp_string_pixels[20]; // Holds the temperature, it is later printed
 	char t_temp_string[20]; // Holds the temperature threshold, it is later printed
 	char t_temp_string_pixels[20]; // Holds the temperature threshold, it is later printed
 	char alarm_string[20];
+#endif
 
-    AppPrint("Temperature task has started\r\n");
-    Peripheral_Init();
-    while (1) {
-                                           		/* Task body, always written as an infinite loop. */
-
-    temperature_raw = XAdcPs_GetAdcData(XAdcInstPtr, XADCPS_CH_TEMP);
-    temperature = (int) XAdcPs_RawToTemperature(temperature_raw);
+    AppMonTbl[APP_MON_ROW_TEMP].Limit = threshold; // The temperature limit is set with the buttons
+    alarms = AppMon_Sample(XAdcInstPtr, AppMonTbl, APP_MON_N); // Read every monitored channel in one pass
+    temperature = AppMonTbl[APP_MON_ROW_TEMP].Value;
 
+#if (APP_TLM_BINARY != DEF_TRUE)
     // Print read temperature
 	sprintf(temp_string, "%d", temperature);
 	AppPrint("\n Temperature: ");
 	AppPrint(temp_string);
 
-	sprintf(temp_string_pixels, "%u", temperature<<4);
+	sprintf(temp_string_pixels, "%u", (unsigned)AppTemp_Pixels(AppMonTbl[APP_MON_ROW_TEMP].Raw));
 	AppPrint("\n Temperature pixels: ");
 	AppPrint(temp_string_pixels);
 
@@ -358,36 +673,49 @@ static  void  AppTask1 (void *p_arg) // Temperature task
 	AppPrint(t_temp_string);
 
     // Print threshold
-	sprintf(t_temp_string_pixels, "%u", (threshold & 0x7F)<<4);
+	sprintf(t_temp_string_pixels, "%u", (unsigned)AppTemp_DegPixels(threshold));
 	AppPrint("\n Threshold pixels: ");
 	AppPrint(t_temp_string_pixels);
 
-	// Compare temperature against threshold
-	if (temperature > threshold){
-		alarm = 1;
-	}
-	else {
-		alarm = 0;
+#endif
+	// Temperature alarm, the one shown on the display
+	alarm = (alarms >> AppMonTbl[APP_MON_ROW_TEMP].AlarmBit) & 0x1;
+
+#if (APP_TLM_BINARY != DEF_TRUE)
+	// Print the channels in alarm, only when they change
+	if (alarms != alarms_prev) {
+		alarms_string[0] = '\0';
+		for (i = 0u; i < APP_MON_N; i++) {
+			if ((alarms >> AppMonTbl[i].AlarmBit) & 0x1) {
+				strcat(alarms_string, " ");
+				strcat(alarms_string, AppMonTbl[i].NamePtr);
+			}
+		}
+		AppPrint("\n alarms:");
+		AppPrint((alarms != 0u) ? alarms_string : " none");
+		alarms_prev = alarms;
 	}
 
     // Print alarm
 	sprintf(alarm_string, "%d", alarm);
 	AppPrint("\n alarm: ");
 	AppPrint(alarm_string);
-
-
-	output = (alarm & 0x1)<<22|(temperature & 0x7F)<<(4+11)|(threshold & 0x7F)<<(4); // Concatenate the variables to get 23 useful bits to output port
-
-
-        OSTimeDlyHMSM(0, 0, 0, 200,
-                      OS_OPT_TIME_HMSM_STRICT,
-                     &err);
-           // AppPrint("1");
-
-     XGpio_DiscreteWrite(&Gpio,TEMPERATURE_CHANNEL,output);		// Write the output in the gpio output channel
-
-
-    }
+#endif
+
+	AppState_SetTemperature(&AppState, temperature, alarm); // Temperature and alarm fields of the output word
+	AppState_Publish(&AppState); // Written to the gpio output channel only if it changed
+
+	// Next sample: sooner near the alarm point or while the temperature moves fast, see app_rate.h
+	period_ms = AppRate_Next(&AppRate, &AppMonTbl[APP_MON_ROW_TEMP],
+							 (CPU_INT32U)((CPU_INT64U)OSTimeGet(&err) * 1000u / OS_CFG_TICK_RATE_HZ));
+#if (APP_TEMP_ADAPTIVE != DEF_TRUE)
+	period_ms = APP_TEMP_PERIOD_MS;
+#endif
+#if (APP_TLM_BINARY == DEF_TRUE)
+	(void)AppTlm_Sample((APP_LOG_RING *)OSTCBCurPtr->ExtPtr, AppTimeMs(), (CPU_INT16S)temperature,
+						(CPU_INT16S)(threshold & 0x7F), (CPU_INT08U)alarm, alarms, (CPU_INT16U)period_ms);
+#endif
+	return ((OS_TICK)(period_ms * OS_CFG_TICK_RATE_HZ / 1000u));
 }
 
 
@@ -396,7 +724,12 @@ static  void  AppTask1 (void *p_arg) // Temperature task
 *********************************************************************************************************
 *                                               TASK #2
 *
-* Description : This is an example of an application task that prints "2" every 2 seconds to the UART.
+* Description : Handles the buttons. It sleeps on its message queue, where AppButtonISR() posts the level
+*               of the button channel at every edge, so it only runs when a button changes or repeats.
+*
+*               A new level is accepted once no edge has arrived for APP_BTN_DEBOUNCE_MS. BTNL or BTNR held
+*               alone repeats after APP_BTN_REPEAT_DLY_MS and then every APP_BTN_REPEAT_MS; any other level,
+*               APP_BTN_PROF among them, acts once per press.
 *
 * Arguments   : p_arg   is the argument passed to 'AppTaskStart()' by 'OSTaskCreate()'.
 *
@@ -404,96 +737,441 @@ static  void  AppTask1 (void *p_arg) // Temperature task
 *
 * Notes       : 1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                  used.  The compiler should not generate any code for this statement.
+*               2) The time stamp of a message is the time of its post, i.e. of the edge.
 *********************************************************************************************************
 */
 
 static  void  AppTask2 (void *p_arg) // This is the responsible for the buttons
 {
-	OS_ERR  err;
+	OS_ERR       err;
+	OS_MSG_SIZE  msg_size;
+	CPU_TS       ts;
+	CPU_TS       ts_edge = 0u;	// time of the first edge of the change being debounced
+	OS_TICK      timeout = 0u;	// 0: wait for an edge forever
+	CPU_BOOLEAN  settling = DEF_FALSE;
+	u32          button = 0u;	// debounced button level
 
 
 	(void)p_arg;
-	int button=0;
-
 
     AppPrint("Buttons task has started \r\n");
     Peripheral_Init();
-	while (1) {
 
-	button = XGpio_DiscreteRead(&Gpio, BUTTON_CHANNEL);	// Reads the input channel of the gpio to determine if a button has been pressed
+    UCOS_IntVectSet(APP_BTN_INT_ID, 0u, 0u, AppButtonISR, (void *)&Gpio);
+    UCOS_IntSrcEn(APP_BTN_INT_ID);
+    XGpio_InterruptEnable(&Gpio, XGPIO_IR_CH1_MASK);	// Interrupt on any change of the button channel
+    XGpio_InterruptGlobalEnable(&Gpio);
+
+	while (1) {                                                 /* Task body, always written as an infinite loop.       */
+
+		(void)OSTaskQPend(timeout, OS_OPT_PEND_BLOCKING, &msg_size, &ts, &err);
+		AppProf_LoopBegin(&AppProfTbl[APP_PROF_TASK2]);
+
+		if (err == OS_ERR_NONE) { // An edge, wait until the buttons settle
+			if (!settling) {
+				settling = DEF_TRUE;
+				ts_edge = ts;
+			}
+			timeout = APP_BTN_DEBOUNCE_MS * OS_CFG_TICK_RATE_HZ / 1000u;
+			AppProf_LoopEnd(&AppProfTbl[APP_PROF_TASK2]);
+			continue;
+		}
 
-	// // Display read button value (0 if any button is pressed)
-	// char button_string[20];
-	// AppPrint("\n BUT ");
-	// sprintf(button_string, "%d", button);
-	// AppPrint(button_string);
+		if (settling) { // Stable for the debounce time, the hardware holds the settled level
+			u32 level = XGpio_DiscreteRead(&Gpio, BUTTON_CHANNEL);
 
-		if(button == 1) { // BTNL button pressed, decrease threshold by 1C
-			threshold = threshold-1;
-			AppPrint("Threshold - 1 \r\n");
+			settling = DEF_FALSE;
+			if (level != button) {
+				button = level;
+				if (button != 0u) {
+					AppButtonAction(button, ts_edge);
+				}
 			}
-		else if (button == 2){ // BTNR button pressed, increase threshold by 1C
-			threshold = threshold+1;
-			AppPrint("Threshold + 1 \r\n");
+			timeout = APP_BTN_REPEAT_DLY_MS * OS_CFG_TICK_RATE_HZ / 1000u;
+		} else if ((button == 1u) || (button == 2u)) { // Held, auto-repeat
+			AppButtonAction(button, OS_TS_GET());
+			timeout = APP_BTN_REPEAT_MS * OS_CFG_TICK_RATE_HZ / 1000u;
+		}
+
+		if ((button != 1u) && (button != 2u)) { // Released, or a level that does not repeat: sleep until the next edge
+			timeout = 0u;
 		}
+		AppProf_LoopEnd(&AppProfTbl[APP_PROF_TASK2]);
+	}
+}
 
 
-		output = (alarm & 0x1)<<22|(temperature & 0x7F)<<(4+11)|(threshold & 0x7F)<<(4); // Concatenate the variables to get 23 useful bits to output port
 
+/*
+*********************************************************************************************************
+*                                         BUTTON INTERRUPT HANDLER
+*
+* Description : Posts the current level of the button channel to Task #2 and acknowledges the interrupt.
+*
+* Argument(s) : p_arg   is the GPIO instance, as registered with UCOS_IntVectSet().
+*
+* Return(s)   : none
+*
+* Caller(s)   : interrupt.
+*
+* Note(s)     : 1) A full queue means Task #2 fell more than APP_BTN_Q_SIZE edges behind; the edge is
+*                  counted in 'button_edges_dropped'.
+*********************************************************************************************************
+*/
+
+static  void  AppButtonISR (void *p_arg)
+{
+	XGpio   *p_gpio = (XGpio *)p_arg;
+	OS_ERR   err;
+	u32      level;
 
-	XGpio_DiscreteWrite(&Gpio,TEMPERATURE_CHANNEL,output); // write in the gpio output channel
 
+	level = XGpio_DiscreteRead(p_gpio, BUTTON_CHANNEL);
+	XGpio_InterruptClear(p_gpio, XGPIO_IR_CH1_MASK);
 
-                                               		/* Task body, always written as an infinite loop.       */
+	OSTaskQPost(&AppTask2TCB, (void *)(CPU_ADDR)level, (OS_MSG_SIZE)sizeof(level), OS_OPT_POST_FIFO, &err);
+	if (err != OS_ERR_NONE) {
+		button_edges_dropped++;
+	}
+}
 
-        OSTimeDlyHMSM(0, 0, 0, 500,
-                      OS_OPT_TIME_HMSM_STRICT,
-                     &err);                                     /* Waits for 2 seconds.                                 */
 
-    	// AppPrint("2");                                          /* Prints 2 to the UART.                                */
 
+/*
+*********************************************************************************************************
+*                                            BUTTON ACTION
+*
+* Description : Applies a debounced press (or an auto-repeat) to the threshold and records the time from
+*               'ts_edge' to the update of the output port.
+*
+* Argument(s) : button    is the debounced level of the button channel.
+*
+*               ts_edge   is the time stamp of the edge that started the press.
+*
+* Return(s)   : none
+*
+* Caller(s)   : AppTask2().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+static  void  AppButtonAction (u32 button, CPU_TS ts_edge)
+{
+	CPU_ERR     cpu_err;
+	OS_ERR      err;
+	CPU_INT32U  latency_us;
+	char        button_string[48];
+
+
+	if (button == 1) { // BTNL button pressed, decrease threshold by 1C
+		threshold = threshold-1;
+	}
+	else if (button == 2) { // BTNR button pressed, increase threshold by 1C
+		threshold = threshold+1;
+	}
+	else if (button == APP_BTN_PROF) { // Both pressed, print the task statistics
+		AppProfPrint();
+		return;
+	}
+	else {
+		return;
+	}
+
+	AppState_SetThreshold(&AppState, threshold); // Threshold field of the output word
+	AppState_Publish(&AppState); // write in the gpio output channel
+#if (APP_TEMP_ADAPTIVE == DEF_TRUE)
+#if (APP_WHEEL_EN == DEF_TRUE)
+	AppWheel_Kick(&AppWheel, &AppJobTemp, &err); // The temperature job may be far into a long period, compare with the new threshold now
+#else
+	OSTimeDlyResume(&AppTask1TCB, &err); // Task #1 may be far into a long period, compare with the new threshold now
+#endif
+#endif
+
+	latency_us = (CPU_INT32U)((CPU_TS)(OS_TS_GET() - ts_edge) / (CPU_TS_TmrFreqGet(&cpu_err) / 1000000u));
+	if (latency_us > button_latency_max_us) {
+		button_latency_max_us = latency_us;
+	}
+	button_presses++;
+
+#if (APP_TLM_BINARY == DEF_TRUE)
+	(void)button_string;
+	(void)AppTlm_Button((APP_LOG_RING *)OSTCBCurPtr->ExtPtr, AppTimeMs(), (CPU_INT08U)button,
+						(CPU_INT16S)(threshold & 0x7F), latency_us);
+#else
+	sprintf(button_string, "Threshold %s 1 (%u us) \r\n", (button == 1) ? "-" : "+", (unsigned)latency_us);
+	AppPrint(button_string);
+#endif
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                            SPECTRUM TASK
+*
+* Description : Analyzes every sweep posted with AppSpec_Post(): FFT figures of the dominant tone and the
+*               levels of the AppSpecBins tones. Prints the last result at most every APP_SPEC_PRINT_MS,
+*               with the number of sweeps analyzed and dropped since the previous line.
+*
+* Arguments   : p_arg   is the argument passed to 'AppTaskSpec()' by 'OSTaskCreate()'.
+*
+* Returns     : none
+*
+* Notes       : 1) It runs below every other task, so Task #1 and Task #2 preempt it; sweeps that arrive
+*                  while it is behind are dropped by AppSpec_Post() rather than queued.
+*               2) A sweep costs about 55 us on a PC (host/spec_bench.c), well under a millisecond here,
+*                  against the 16.7 ms between two sweeps at most.
+*********************************************************************************************************
+*/
+
+#if (APP_SPEC_EN == DEF_TRUE)
+static  void  AppTaskSpec (void *p_arg)
+{
+	OS_ERR           err;
+	OS_MSG_SIZE      msg_size;
+	CPU_TS           ts;
+	APP_SPEC_FRAME  *p_frame;
+	OS_TICK          printed = OSTimeGet(&err);
+	CPU_INT32U       sweeps_printed = 0u;
+	CPU_INT32U       dropped_printed = 0u;
+	CPU_CHAR         line[APP_SPEC_LINE_SIZE];
+	unsigned         i;
+
+
+	(void)p_arg;
+	while (1) {
+		p_frame = (APP_SPEC_FRAME *)OSTaskQPend(0u, OS_OPT_PEND_BLOCKING, &msg_size, &ts, &err);
+		if (err != OS_ERR_NONE) {
+			continue;
+		}
+		AppProf_LoopBegin(&AppProfTbl[APP_PROF_SPEC]);
+
+		AppSpec_Analyze(p_frame->Samples, p_frame->HScale, p_frame->VScale, &spec_last);
+		AppSpec_Goertzel(p_frame->Samples, p_frame->HScale, p_frame->VScale, AppSpecBins, APP_SPEC_BINS);
+		AppSpec_Release(p_frame);
+		spec_sweeps++;
+
+		if ((OS_TICK)(OSTimeGet(&err) - printed) >= APP_SPEC_PRINT_MS * OS_CFG_TICK_RATE_HZ / 1000u) {
+			printed = OSTimeGet(&err);
+			AppPrint("\r\n[spec]");
+			(void)AppSpec_Format(&spec_last, line, sizeof(line));
+			AppPrint(line);
+			for (i = 0u; i < APP_SPEC_BINS; i++) {
+				sprintf(line, "  %s %.1f", AppSpecBins[i].NamePtr, (double)AppSpecBins[i].LevelDb);
+				AppPrint(line);
+			}
+			sprintf(line, "  (%u sweeps, %u dropped)\r\n",
+					(unsigned)(spec_sweeps - sweeps_printed), (unsigned)(AppSpec_Dropped() - dropped_printed));
+			AppPrint(line);
+			sweeps_printed  = spec_sweeps;
+			dropped_printed = AppSpec_Dropped();
 		}
+		AppProf_LoopEnd(&AppProfTbl[APP_PROF_SPEC]);
 	}
+}
+#endif
 
 
 
 /*
 *********************************************************************************************************
-*                                            PRINT THROUGH UART
+*                                         PRINT TASK STATISTICS
 *
-* Description : Prints a string through the UART. It makes use of a mutex to
-*               access this shared resource.
+* Description : Takes a snapshot of the task statistics into AppProfSnap and prints one line per task.
 *
 * Argument(s) : none
 *
 * Return(s)   : none
 *
+* Caller(s)   : AppButtonAction().
+*
+* Note(s)     : 1) Stack figures are in CPU_STK entries, loop times in microseconds. See app_prof.h.
+*********************************************************************************************************
+*/
+
+static  void  AppProfPrint (void)
+{
+	CPU_CHAR  line[APP_PROF_LINE_SIZE];
+	unsigned  i;
+
+
+	AppProf_Snapshot(AppProfTbl, AppProfSnap, APP_PROF_N);
+	AppPrint("\r\n[prof]\r\n");
+	for (i = 0u; i < APP_PROF_N; i++) {
+		if (AppProfTbl[i].TcbPtr == (OS_TCB *)0) { // Task not created, e.g. Task #1 with APP_WHEEL_EN
+			continue;
+		}
+		(void)AppProf_Format(&AppProfSnap[i], line, sizeof(line));
+		AppPrint(line);
+		AppPrint("\r\n");
+	}
+	(void)AppRate_Format(&AppRate, line, sizeof(line));
+	AppPrint("Temperature ");
+	AppPrint(line);
+	AppPrint("\r\n");
+#if (APP_WHEEL_EN == DEF_TRUE)
+	(void)AppWheel_Format(&AppJobTemp, line, sizeof(line));
+	AppPrint(line);
+	AppPrint("\r\n");
+	(void)AppWheel_Format(&AppJobDot, line, sizeof(line));
+	AppPrint(line);
+	AppPrint("\r\n");
+	snprintf((char *)line, sizeof(line), "wheel: %u jobs, %u wake-ups of Task Start",
+	         (unsigned)AppWheel.Jobs, (unsigned)AppWheel.Wakeups);
+	AppPrint(line);
+	AppPrint("\r\n");
+#endif
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                               LOG TASK
+*
+* Description : Only task that writes to the UART. It empties the log ring of each task, in batches of up
+*               to APP_LOG_BATCH_SIZE bytes, and reports newly dropped messages together with the peak
+*               occupancy of the ring that dropped them. Then it waits on its task semaphore until
+*               AppLog_Put() queues the next message (AppLogWake()).
+*
+* Arguments   : p_arg   is the argument passed to 'AppTaskLog()' by 'OSTaskCreate()'.
+*
+* Returns     : none
+*
+* Notes       : 1) It runs at the lowest application priority, so a slow UART only delays the text, never
+*                  the tasks that produced it.
+*               2) The rings are checked once more after 'AppLogSignal' is marked idle (see app_log.h), so
+*                  a message queued while the task was busy is never left behind.
+*********************************************************************************************************
+*/
+
+static  void  AppTaskLog (void *p_arg)
+{
+	OS_ERR      err;
+	CPU_CHAR    batch[APP_LOG_BATCH_SIZE + 1u];
+	CPU_INT32U  dropped_seen[sizeof(AppLogRings) / sizeof(AppLogRings[0])] = { 0u };
+	CPU_INT32U  len;
+	CPU_INT32U  dropped;
+	unsigned    i;
+
+
+	(void)p_arg;
+#if (APP_TLM_BINARY == DEF_TRUE)
+	outbyte('\0');										// Ends the text printed before, a frame starts next
+#endif
+	while (1) {
+		AppProf_LoopBegin(&AppProfTbl[APP_PROF_LOG]);
+		for (i = 0u; i < sizeof(AppLogRings) / sizeof(AppLogRings[0]); i++) {
+			while ((len = AppLog_Get(AppLogRings[i], batch, APP_LOG_BATCH_SIZE)) > 0u) {
+#if (APP_TLM_BINARY == DEF_TRUE)
+				AppUartWrite(batch, len);				// Frames hold NULs, not for UCOS_Print()
+#else
+				batch[len] = '\0';
+				UCOS_Print(batch);
+#endif
+			}
+
+			dropped = atomic_load_explicit(&AppLogRings[i]->Dropped, memory_order_relaxed);
+			if ((dropped != dropped_seen[i]) && (APP_TLM_BINARY != DEF_TRUE)) {	// Report drops once, when they happen
+				sprintf(batch, "\r\n[log] %s: %u messages dropped, high-water %u/%u bytes\r\n",
+						AppLogRings[i]->NamePtr, (unsigned)dropped,
+						(unsigned)atomic_load_explicit(&AppLogRings[i]->HighWater, memory_order_relaxed),
+						(unsigned)APP_LOG_RING_SIZE);
+				UCOS_Print(batch);
+				dropped_seen[i] = dropped;
+			}
+		}
+		AppProf_LoopEnd(&AppProfTbl[APP_PROF_LOG]);
+
+		if (AppLog_Idle(&AppLogSignal, AppLogRings, sizeof(AppLogRings) / sizeof(AppLogRings[0]))) {
+			(void)OSTaskSemPend(0u, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &err);
+		}
+	}
+}
+
+
+static  void  AppLogWake (void)								// Called by the producer that finds the log task idle
+{
+	OS_ERR  err;
+
+
+	(void)OSTaskSemPost(&AppTaskLogTCB, OS_OPT_POST_NONE, &err);
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                            PRINT THROUGH UART
+*
+* Description : Queues a string for the UART in the log ring of the calling task, which is attached to
+*               its TCB as the extension pointer. AppTaskLog() prints it later.
+*
+* Argument(s) : str     is the string to print.
+*
+* Return(s)   : none
+*
 * Caller(s)   : application functions.
 *
-* Note(s)     : none.
+* Note(s)     : 1) Never blocks. If the ring is full the message is dropped and counted.
+*               2) A caller without a log ring (code running before multitasking starts) prints directly.
 *********************************************************************************************************
 */
 
 static  void  AppPrint (char *str)
 {
-	OS_ERR  err;
-    CPU_TS  ts;
+	APP_LOG_RING  *p_ring = (OSTCBCurPtr != (OS_TCB *)0) ? (APP_LOG_RING *)OSTCBCurPtr->ExtPtr : (APP_LOG_RING *)0;
 
 
-                                                                /* Wait for the shared resource to be released.         */
-    OSMutexPend(	(OS_MUTEX *)&AppMutexPrint,
-    				(OS_TICK )0u,                                            /* No timeout.                                          */
-					(OS_OPT )OS_OPT_PEND_BLOCKING,                          /* Block if not available.                              */
-					(CPU_TS *)&ts,                                            /* Timestamp.                                           */
-					(OS_ERR *)&err);
+	if (p_ring == (APP_LOG_RING *)0) {
+		UCOS_Print(str);
+		return;
+	}
+#if (APP_TLM_BINARY == DEF_TRUE)
+	(void)AppTlm_Text(p_ring, AppTimeMs(), str);
+#else
+	(void)AppLog_Put(p_ring, str);
+#endif
+}
 
-    UCOS_Print(str);                                                 /* Access the shared resource.                          */
+/*
+*********************************************************************************************************
+*                                          UART BYTE OUTPUT
+*
+* Description : Sends 'len' bytes of any value to the UART, for the binary records.
+*
+* Caller(s)   : AppTaskLog().
+*********************************************************************************************************
+*/
 
-                                                                /* Releases the shared resource.                        */
-    OSMutexPost( 	(OS_MUTEX *)&AppMutexPrint,
-    				(OS_OPT )OS_OPT_POST_NONE,                              /* No options.                                          */
-					(OS_ERR *)&err);
+#if (APP_TLM_BINARY == DEF_TRUE)
+static  void  AppUartWrite (const CPU_CHAR *p_buf, CPU_INT32U len)
+{
+	CPU_INT32U  i;
+
+
+	for (i = 0u; i < len; i++) {
+		outbyte(p_buf[i]);
+	}
+}
+
+/*
+*********************************************************************************************************
+*                                            TIME STAMP
+*
+* Description : Milliseconds since OSStart(), the time of the binary records.
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  AppTimeMs (void)
+{
+	OS_ERR  err;
+
+
+	return ((CPU_INT32U)((CPU_INT64U)OSTimeGet(&err) * 1000u / OS_CFG_TICK_RATE_HZ));
 }
+#endif
 
 void Peripheral_Init()
 {
@@ -538,10 +1216,11 @@ void Peripheral_Init()
 
 
     	/*
-    	 * Disable the Channel Sequencer before configuring the Sequence
-    	 * registers.
+    	 * Run the Channel Sequencer continuously over the monitored
+    	 * channels, with averaging (it is disabled while configuring the
+    	 * Sequence registers).
     	 */
-    	XAdcPs_SetSequencerMode(XAdcInstPtr, XADCPS_SEQ_MODE_SAFE);
+    	AppMon_Init(XAdcInstPtr, AppMonTbl, APP_MON_N, APP_XADC_AVG, APP_XADC_CONTINUOUS);
 
 }
 
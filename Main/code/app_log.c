@@ -0,0 +1,128 @@
+/*
+*********************************************************************************************************
+*                                         APPLICATION LOG QUEUE
+*
+* Description : See app_log.h.
+*
+* Note(s)     : The indices run freely and are masked on access, so 'Head - Tail' is always the number of
+*               queued bytes, even across wrap-around. The producer publishes a message by storing 'Head'
+*               with release semantics after copying it; the consumer frees space the same way with 'Tail'.
+*               The wake-up of note 4 of app_log.h needs a full fence on each side, between the store of
+*               one flag ('Head' or 'Idle') and the load of the other.
+*********************************************************************************************************
+*/
+
+#include  <string.h>
+#include  "app_log.h"
+
+
+void  AppLog_Init (APP_LOG_RING   *p_ring,
+                   const CPU_CHAR *p_name)
+{
+    p_ring->NamePtr = p_name;
+    atomic_init(&p_ring->Head,      0u);
+    atomic_init(&p_ring->Tail,      0u);
+    atomic_init(&p_ring->Dropped,   0u);
+    atomic_init(&p_ring->HighWater, 0u);
+    p_ring->Src       = 0u;
+    p_ring->Seq       = 0u;
+    p_ring->SignalPtr = (APP_LOG_SIGNAL *)0;
+}
+
+
+void  AppLog_Attach (APP_LOG_RING    *p_ring,
+                     APP_LOG_SIGNAL  *p_sig)
+{
+    p_ring->SignalPtr = p_sig;
+}
+
+
+CPU_BOOLEAN  AppLog_Put (APP_LOG_RING   *p_ring,
+                         const CPU_CHAR *str)
+{
+    return (AppLog_PutN(p_ring, str, (CPU_INT32U)strlen(str)));
+}
+
+
+CPU_BOOLEAN  AppLog_PutN (APP_LOG_RING  *p_ring,
+                          const void    *p_data,
+                          CPU_INT32U     len)
+{
+    const CPU_CHAR  *str  = (const CPU_CHAR *)p_data;
+    CPU_INT32U       head = atomic_load_explicit(&p_ring->Head, memory_order_relaxed);
+    CPU_INT32U       tail = atomic_load_explicit(&p_ring->Tail, memory_order_acquire);
+    CPU_INT32U       used = head - tail;
+    CPU_INT32U       first;
+
+
+    if (len > APP_LOG_RING_SIZE - used) {                       /* Does not fit: drop the whole message                 */
+        atomic_store_explicit(&p_ring->Dropped,
+                              atomic_load_explicit(&p_ring->Dropped, memory_order_relaxed) + 1u,
+                              memory_order_relaxed);
+        return (DEF_FALSE);
+    }
+
+    first = APP_LOG_RING_SIZE - (head & APP_LOG_RING_MASK);     /* Room before the end of the buffer                    */
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&p_ring->Buf[head & APP_LOG_RING_MASK], str,         first);
+    memcpy(&p_ring->Buf[0],                        str + first, len - first);
+    atomic_store_explicit(&p_ring->Head, head + len, memory_order_release);
+
+    if (used + len > atomic_load_explicit(&p_ring->HighWater, memory_order_relaxed)) {
+        atomic_store_explicit(&p_ring->HighWater, used + len, memory_order_relaxed);
+    }
+    if (p_ring->SignalPtr != (APP_LOG_SIGNAL *)0) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if ((atomic_load_explicit(&p_ring->SignalPtr->Idle, memory_order_relaxed) != 0u) &&
+            (atomic_exchange(&p_ring->SignalPtr->Idle, 0u) != 0u)) {   /* Only one producer wakes it        */
+            p_ring->SignalPtr->WakeFnct();
+        }
+    }
+    return (DEF_TRUE);
+}
+
+
+CPU_INT32U  AppLog_Get (APP_LOG_RING  *p_ring,
+                        CPU_CHAR      *p_buf,
+                        CPU_INT32U     size)
+{
+    CPU_INT32U  tail = atomic_load_explicit(&p_ring->Tail, memory_order_relaxed);
+    CPU_INT32U  head = atomic_load_explicit(&p_ring->Head, memory_order_acquire);
+    CPU_INT32U  len  = head - tail;
+    CPU_INT32U  first;
+
+
+    if (len > size) {
+        len = size;
+    }
+    first = APP_LOG_RING_SIZE - (tail & APP_LOG_RING_MASK);
+    if (first > len) {
+        first = len;
+    }
+    memcpy(p_buf,         &p_ring->Buf[tail & APP_LOG_RING_MASK], first);
+    memcpy(p_buf + first, &p_ring->Buf[0],                        len - first);
+    atomic_store_explicit(&p_ring->Tail, tail + len, memory_order_release);
+    return (len);
+}
+
+
+CPU_BOOLEAN  AppLog_Idle (APP_LOG_SIGNAL      *p_sig,
+                          APP_LOG_RING *const *p_rings,
+                          CPU_INT32U           n)
+{
+    CPU_INT32U  i;
+
+
+    atomic_store_explicit(&p_sig->Idle, 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    for (i = 0u; i < n; i++) {
+        if (atomic_load_explicit(&p_rings[i]->Head, memory_order_acquire) !=
+            atomic_load_explicit(&p_rings[i]->Tail, memory_order_relaxed)) {
+            (void)atomic_exchange(&p_sig->Idle, 0u);            /* A producer may have cleared it and woken us already  */
+            return (DEF_FALSE);
+        }
+    }
+    return (DEF_TRUE);
+}
@@ -0,0 +1,92 @@
+/*
+*********************************************************************************************************
+*                                         APPLICATION LOG QUEUE
+*
+* Description : Fixed-size, allocation-free single-producer/single-consumer byte ring. Each task owns one
+*               ring and is its only writer; the log task (AppTaskLog) is the only reader and sends the
+*               queued text to the UART in batches. Neither side takes a lock, so a task never waits for
+*               the UART to print, and the log task sleeps until there is something to send (note 4).
+*
+* Note(s)     : 1) A message is either queued whole or dropped whole; drops are counted in 'Dropped'.
+*               2) 'HighWater' is the largest number of bytes ever waiting in the ring.
+*               3) AppLog_PutN() queues bytes that may include NULs, e.g. the binary records of app_tlm.h.
+*                  'Src' and 'Seq' number those records; only the producer uses them.
+*               4) Rings attached to an APP_LOG_SIGNAL wake their consumer. Before it waits, the consumer
+*                  sets 'Idle' and checks its rings once more (AppLog_Idle()); a producer that publishes a
+*                  message and then finds 'Idle' set clears it and calls 'WakeFnct', e.g. a task semaphore
+*                  post. Either the consumer sees the message or the producer sees 'Idle': no wake-up is
+*                  lost, and there is at most one per idle period of the consumer.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_LOG_H
+#define  APP_LOG_H
+
+#include  <stdatomic.h>
+#include  <Source/os.h>
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#ifndef  APP_LOG_RING_SIZE                                      /* Bytes per ring, must be a power of 2. Holds the      */
+#define  APP_LOG_RING_SIZE      2048u                           /* largest burst a task queues, see APP_PROF_DUMP_MAX   */
+#endif
+#define  APP_LOG_RING_MASK      (APP_LOG_RING_SIZE - 1u)
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    const CPU_CHAR       *NamePtr;
+    _Atomic CPU_INT32U    Head;                                 /* Free running write index, written by the producer    */
+    _Atomic CPU_INT32U    Tail;                                 /* Free running read index, written by the consumer     */
+    _Atomic CPU_INT32U    Dropped;                              /* Messages that did not fit                            */
+    _Atomic CPU_INT32U    HighWater;                            /* Peak ring occupancy, in bytes                        */
+    CPU_INT08U            Src;                                  /* Source number of the binary records                  */
+    CPU_INT16U            Seq;                                  /* Number of the next binary record                     */
+    struct app_log_signal *SignalPtr;                           /* Consumer to wake, or NULL                            */
+    CPU_CHAR              Buf[APP_LOG_RING_SIZE];
+} APP_LOG_RING;
+
+typedef  struct  app_log_signal {                               /* See note 4                                           */
+    _Atomic CPU_INT32U    Idle;                                 /* Set by the consumer before it waits                  */
+    void                (*WakeFnct)(void);                      /* Called by the producer that clears 'Idle'            */
+} APP_LOG_SIGNAL;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void         AppLog_Init (APP_LOG_RING  *p_ring,
+                          const CPU_CHAR *p_name);
+
+void         AppLog_Attach (APP_LOG_RING   *p_ring,             /* Before the producer runs                             */
+                            APP_LOG_SIGNAL *p_sig);
+
+CPU_BOOLEAN  AppLog_Put  (APP_LOG_RING  *p_ring,                /* Producer side                                        */
+                          const CPU_CHAR *str);
+
+CPU_BOOLEAN  AppLog_PutN (APP_LOG_RING  *p_ring,                /* Producer side, 'len' bytes of any value              */
+                          const void    *p_data,
+                          CPU_INT32U     len);
+
+CPU_INT32U   AppLog_Get  (APP_LOG_RING  *p_ring,                /* Consumer side, returns the number of bytes copied    */
+                          CPU_CHAR      *p_buf,
+                          CPU_INT32U     size);
+
+CPU_BOOLEAN  AppLog_Idle (APP_LOG_SIGNAL      *p_sig,           /* Consumer side, DEF_TRUE: every ring is empty, wait   */
+                          APP_LOG_RING *const *p_rings,
+                          CPU_INT32U           n);
+
+#endif
@@ -0,0 +1,121 @@
+/*
+*********************************************************************************************************
+*                                          XADC SENSOR MONITOR
+*
+* Description : See app_mon.h.
+*********************************************************************************************************
+*/
+
+#include  "app_mon.h"
+#include  "app_temp.h"
+
+
+/*
+*********************************************************************************************************
+*                                      SEQUENCER CHANNEL MASK
+*
+* Description : Returns the bit of 'channel' in the sequencer channel and averaging enable registers.
+*********************************************************************************************************
+*/
+
+static  u32  AppMon_SeqMask (u8 channel)
+{
+    if (channel >= XADCPS_CH_AUX_MIN) {
+        return (XADCPS_SEQ_CH_AUX00 << (channel - XADCPS_CH_AUX_MIN));
+    }
+    return (XADCPS_SEQ_CH_TEMP << channel);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           INITIALIZATION
+*
+* Description : Enables every channel of the table in the sequencer, with averaging 'avg', and starts it
+*               in continuous mode. With 'continuous' set to DEF_FALSE the sequencer is left in safe mode,
+*               as before.
+*
+* Return(s)   : XST_SUCCESS, or XST_FAILURE if the driver rejected the configuration.
+*
+* Note(s)     : The sequencer must be in safe mode while its registers are written.
+*********************************************************************************************************
+*/
+
+int  AppMon_Init (XAdcPs       *p_adc,
+                  APP_MON_CH   *p_tbl,
+                  CPU_INT32U    n,
+                  u8            avg,
+                  CPU_BOOLEAN   continuous)
+{
+    u32         mask = XADCPS_SEQ_CH_CALIB;                     /* Keep the offset/gain calibration in the sequence     */
+    CPU_INT32U  i;
+
+
+    XAdcPs_SetSequencerMode(p_adc, XADCPS_SEQ_MODE_SAFE);
+    if (!continuous) {
+        return (XST_SUCCESS);
+    }
+
+    for (i = 0u; i < n; i++) {
+        mask |= AppMon_SeqMask(p_tbl[i].Channel);
+    }
+    XAdcPs_SetAvg(p_adc, avg);
+    if ((XAdcPs_SetSeqAvgEnables(p_adc, mask & ~XADCPS_SEQ_CH_CALIB) != XST_SUCCESS) ||
+        (XAdcPs_SetSeqChEnables(p_adc, mask) != XST_SUCCESS)) {
+        return (XST_FAILURE);
+    }
+    XAdcPs_SetSequencerMode(p_adc, XADCPS_SEQ_MODE_CONTINPASS);
+    return (XST_SUCCESS);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              SAMPLING
+*
+* Description : Reads, converts and checks every channel of the table.
+*
+* Return(s)   : Alarm word, with the AlarmBit of every channel in alarm set (see Note 3 of app_mon.h).
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppMon_Sample (XAdcPs       *p_adc,
+                           APP_MON_CH   *p_tbl,
+                           CPU_INT32U    n)
+{
+    CPU_INT32U   alarms = 0u;
+    CPU_INT32U   i;
+    APP_MON_CH  *p_ch;
+
+
+    for (i = 0u; i < n; i++) {                                  /* Batched pass: all the register reads back to back    */
+        p_tbl[i].Raw = XAdcPs_GetAdcData(p_adc, p_tbl[i].Channel);
+    }
+
+    for (i = 0u; i < n; i++) {
+        p_ch = &p_tbl[i];
+        switch (p_ch->Kind) {
+            case APP_MON_TEMP:
+                 p_ch->Value = AppTemp_Celsius(p_ch->Raw);      /* Same as (int)XAdcPs_RawToTemperature(), no FPU      */
+                 break;
+
+            case APP_MON_SUPPLY:
+                 p_ch->Value = (int)(((CPU_INT32U)p_ch->Raw * 3000u) >> 16);
+                 break;
+
+            case APP_MON_EXT:
+            default:
+                 p_ch->Value = (int)(((CPU_INT32U)p_ch->Raw * 1000u) >> 16);
+                 break;
+        }
+        if (p_ch->Above) {
+            p_ch->Alarm = p_ch->Alarm ? (p_ch->Value > p_ch->Limit - p_ch->Hyst) : (p_ch->Value > p_ch->Limit);
+        } else {
+            p_ch->Alarm = p_ch->Alarm ? (p_ch->Value < p_ch->Limit + p_ch->Hyst) : (p_ch->Value < p_ch->Limit);
+        }
+        if (p_ch->Alarm) {
+            alarms |= 1u << p_ch->AlarmBit;
+        }
+    }
+    return (alarms);
+}
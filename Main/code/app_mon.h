@@ -0,0 +1,72 @@
+/*
+*********************************************************************************************************
+*                                          XADC SENSOR MONITOR
+*
+* Description : Table-driven monitoring of XADC channels. Each row of the table names a channel, how to
+*               convert its result, a limit and the bit it sets in the alarm word. AppMon_Init() makes the
+*               channel sequencer convert every channel of the table continuously, with on-chip averaging,
+*               and AppMon_Sample() reads all of their results in one pass.
+*
+* Note(s)     : 1) Adding a sensor means adding a row, not a task.
+*               2) In continuous mode the sequencer keeps the data registers up to date, so a sample is
+*                  one register read per channel and never waits for a conversion.
+*               3) An alarm sets when Value goes beyond Limit and clears only when it is back by Hyst or
+*                  more, so a reading that dithers around the limit does not toggle it.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_MON_H
+#define  APP_MON_H
+
+#include  <Source/os.h>
+#include  "xadcps.h"
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_MON_TEMP            0u                             /* On-chip temperature, Value in degrees Celsius        */
+#define  APP_MON_SUPPLY          1u                             /* Supply sensor (3 V full scale), Value in mV          */
+#define  APP_MON_EXT             2u                             /* VP/VN or VAUXn (1 V unipolar), Value in mV           */
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    const CPU_CHAR  *NamePtr;
+    u8               Channel;                                   /* XADCPS_CH_...                                        */
+    u8               Kind;                                      /* APP_MON_...                                          */
+    int              Limit;                                     /* Same unit as Value                                   */
+    CPU_BOOLEAN      Above;                                     /* DEF_TRUE: alarm when Value > Limit, else < Limit     */
+    int              Hyst;                                      /* An alarm clears at Limit -/+ Hyst                    */
+    u8               AlarmBit;                                  /* Bit of the alarm word                                */
+    CPU_BOOLEAN      Alarm;                                     /* Current state, kept by AppMon_Sample()               */
+    u16              Raw;                                       /* Last result, as read from the data register          */
+    int              Value;                                     /* Last result, converted                               */
+} APP_MON_CH;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+int         AppMon_Init   (XAdcPs       *p_adc,
+                           APP_MON_CH   *p_tbl,
+                           CPU_INT32U    n,
+                           u8            avg,                   /* XADCPS_AVG_...                                       */
+                           CPU_BOOLEAN   continuous);
+
+CPU_INT32U  AppMon_Sample (XAdcPs       *p_adc,                 /* Returns the alarm word                               */
+                           APP_MON_CH   *p_tbl,
+                           CPU_INT32U    n);
+
+#endif
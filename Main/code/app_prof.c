@@ -0,0 +1,204 @@
+/*
+*********************************************************************************************************
+*                                        PER-TASK INSTRUMENTATION
+*
+* Description : See app_prof.h.
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  <string.h>
+#include  "app_prof.h"
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  AppProfTsPerUs = 1u;                        /* CPU time stamp counts per microsecond                */
+static  OS_TICK     AppProfStartTick;
+
+
+/*
+*********************************************************************************************************
+*                                            HELPERS
+*********************************************************************************************************
+*/
+
+static  CPU_INT32U  AppProf_Us (CPU_TS from, CPU_TS to)
+{
+    return ((CPU_INT32U)((CPU_TS)(to - from) / AppProfTsPerUs));
+}
+
+static  CPU_INT32U  AppProf_Bucket (CPU_INT32U us)              /* floor(log2(us)), 0 for us < 2, clamped               */
+{
+    CPU_INT32U  k = 31u - (CPU_INT32U)__builtin_clz(us | 1u);
+
+
+    return ((k < APP_PROF_HIST_N) ? k : (APP_PROF_HIST_N - 1u));
+}
+
+
+/*
+*********************************************************************************************************
+*                                           INITIALIZATION
+*
+* Description : Clears the counters of 'n' tasks and starts the time base of the load figures.
+*
+* Note(s)     : Must be called after OSInit() and before the tasks run.
+*********************************************************************************************************
+*/
+
+void  AppProf_Init (APP_PROF_TASK  *p_tbl,
+                    CPU_INT32U      n)
+{
+    CPU_ERR  cpu_err;
+    OS_ERR   err;
+
+
+    memset(p_tbl, 0, n * sizeof(*p_tbl));
+    AppProfTsPerUs = CPU_TS_TmrFreqGet(&cpu_err) / 1000000u;
+    if (AppProfTsPerUs == 0u) {
+        AppProfTsPerUs = 1u;
+    }
+    AppProfStartTick = OSTimeGet(&err);
+}
+
+void  AppProf_Attach (APP_PROF_TASK  *p_prof,
+                      OS_TCB         *p_tcb)
+{
+    p_prof->TcbPtr = p_tcb;
+}
+
+
+/*
+*********************************************************************************************************
+*                                           LOOP BODY TIME
+*
+* Description : AppProf_LoopBegin() is called when the task wakes up, AppProf_LoopEnd() right before it
+*               blocks again. Only the calling task writes 'p_prof'; the 64-bit sum is updated with
+*               interrupts disabled, so that a snapshot that preempts the task never reads half of it.
+*********************************************************************************************************
+*/
+
+void  AppProf_LoopBegin (APP_PROF_TASK  *p_prof)
+{
+    p_prof->LoopStartTs = OS_TS_GET();
+}
+
+void  AppProf_LoopEnd (APP_PROF_TASK  *p_prof)
+{
+    CPU_INT32U  us = AppProf_Us(p_prof->LoopStartTs, OS_TS_GET());
+    CPU_SR_ALLOC();
+
+
+    p_prof->Hist[AppProf_Bucket(us)]++;
+    CPU_CRITICAL_ENTER();                                       /* Two stores on the target, see AppProf_Snapshot()     */
+    p_prof->ExecSumUs += us;
+    CPU_CRITICAL_EXIT();
+    if (us > p_prof->ExecMaxUs) {
+        p_prof->ExecMaxUs = us;
+    }
+    p_prof->Loops++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                              SNAPSHOT
+*
+* Description : Copies the counters of 'n' tasks into 'p_snap', together with the stack usage and the
+*               context switch count the kernel keeps in their TCBs.
+*
+* Note(s)     : OSTaskStkChk() scans the unused part of the stack, so the cost of a snapshot grows with the
+*               free stack. Take it on demand, not in a fast loop.
+*********************************************************************************************************
+*/
+
+void  AppProf_Snapshot (const APP_PROF_TASK  *p_tbl,
+                        APP_PROF_SNAP        *p_snap,
+                        CPU_INT32U            n)
+{
+    OS_ERR        err;
+    CPU_INT64U    ms;
+    CPU_INT64U    sum_us;
+    CPU_STK_SIZE  stk_free;
+    CPU_STK_SIZE  stk_used;
+    CPU_INT32U    i;
+    CPU_SR_ALLOC();
+
+
+    ms = (CPU_INT64U)(OS_TICK)(OSTimeGet(&err) - AppProfStartTick) * 1000u / OS_CFG_TICK_RATE_HZ;
+    for (i = 0u; i < n; i++) {
+        const APP_PROF_TASK  *p_prof = &p_tbl[i];
+        APP_PROF_SNAP        *p_row  = &p_snap[i];
+
+
+        CPU_CRITICAL_ENTER();                                   /* Two words on the target: do not read half a write    */
+        sum_us = p_prof->ExecSumUs;
+        CPU_CRITICAL_EXIT();
+
+        memset(p_row, 0, sizeof(*p_row));
+        memcpy(p_row->Hist, p_prof->Hist, sizeof(p_row->Hist));
+        p_row->Loops        = p_prof->Loops;
+        p_row->ExecMaxUs    = p_prof->ExecMaxUs;
+        p_row->LoadPermille = (ms > 0u) ? (CPU_INT32U)(sum_us / ms) : 0u;
+        if (p_prof->TcbPtr == (OS_TCB *)0) {
+            continue;
+        }
+
+        p_row->NamePtr = p_prof->TcbPtr->NamePtr;
+        p_row->CtxSw   = p_prof->TcbPtr->CtxSwCtr;
+        p_row->StkSize = p_prof->TcbPtr->StkSize;
+        OSTaskStkChk(p_prof->TcbPtr, &stk_free, &stk_used, &err);
+        if (err == OS_ERR_NONE) {
+            p_row->StkUsed = stk_used;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             FORMATTING
+*
+* Description : One line per task, e.g.
+*
+*                   Task 1: n 50 max 310us load 1.2% stk 188/512 ctx 101 h 6:3 7:45 8:2
+*
+*               'h' lists the non-empty histogram buckets as <k>:<count>, bucket k holding the loop bodies
+*               of 2^k to 2^(k+1) microseconds. The line is cut short rather than overflow 'p_buf'.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppProf_Format (const APP_PROF_SNAP  *p_snap,
+                            CPU_CHAR             *p_buf,
+                            CPU_INT32U            size)
+{
+    CPU_INT32U  len;
+    CPU_INT32U  k;
+    int         r;
+
+
+    if (size == 0u) {
+        return (0u);
+    }
+    r = snprintf(p_buf, size, "%s: n %u max %uus load %u.%u%% stk %u/%u ctx %u h",
+                 (p_snap->NamePtr != (CPU_CHAR *)0) ? p_snap->NamePtr : "?",
+                 (unsigned)p_snap->Loops, (unsigned)p_snap->ExecMaxUs,
+                 (unsigned)(p_snap->LoadPermille / 10u), (unsigned)(p_snap->LoadPermille % 10u),
+                 (unsigned)p_snap->StkUsed, (unsigned)p_snap->StkSize,
+                 (unsigned)p_snap->CtxSw);
+    len = (r < 0) ? 0u : (CPU_INT32U)r;
+
+    for (k = 0u; (k < APP_PROF_HIST_N) && (len < size); k++) {
+        if (p_snap->Hist[k] == 0u) {
+            continue;
+        }
+        r = snprintf(&p_buf[len], size - len, " %u:%u", (unsigned)k, (unsigned)p_snap->Hist[k]);
+        len += (r < 0) ? 0u : (CPU_INT32U)r;
+    }
+    return ((len < size) ? len : (size - 1u));
+}
@@ -0,0 +1,92 @@
+/*
+*********************************************************************************************************
+*                                        PER-TASK INSTRUMENTATION
+*
+* Description : Low overhead run-time figures of the application tasks:
+*
+*               - Loop body time: each task marks the start and the end of its loop body, and the time in
+*                 between goes into a histogram with power-of-two buckets of microseconds, a maximum and
+*                 a sum (from which the share of the time spent in the body follows).
+*               - Stack usage and context switches, read from the kernel when a snapshot is taken.
+*
+*               AppProf_Snapshot() copies all of it into a compact table, that a debugger can also read,
+*               and AppProf_Format() turns one row into a line of text.
+*
+* Note(s)     : 1) A loop body time is measured with the CPU time stamp, so it includes the time the task
+*                  was preempted by higher priority tasks and interrupts.
+*               2) Stack usage needs the task to be created with OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR
+*                  and OS_CFG_STAT_TASK_STK_CHK_EN; context switch counts need OS_CFG_TASK_PROFILE_EN.
+*               3) The counters of a task are only written by that task. A snapshot taken by another task
+*                  may mix two consecutive loops, never corrupt a counter: the 64-bit sum, two words on the
+*                  target, is both updated and copied with interrupts disabled.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_PROF_H
+#define  APP_PROF_H
+
+#include  <Source/os.h>
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_PROF_HIST_N        16u                             /* Bucket k: [2^k, 2^(k+1)) us, 0: < 2 us, last: above  */
+#define  APP_PROF_LINE_SIZE    128u                             /* Enough for one AppProf_Format() line                 */
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    OS_TCB      *TcbPtr;
+    CPU_TS       LoopStartTs;
+    CPU_INT32U   Loops;
+    CPU_INT32U   ExecMaxUs;
+    CPU_INT64U   ExecSumUs;
+    CPU_INT32U   Hist[APP_PROF_HIST_N];
+} APP_PROF_TASK;
+
+typedef  struct {                                               /* One row of a snapshot                                */
+    const CPU_CHAR  *NamePtr;
+    CPU_INT32U       Loops;
+    CPU_INT32U       ExecMaxUs;
+    CPU_INT32U       LoadPermille;                              /* Share of the time since AppProf_Init() in the body   */
+    CPU_INT32U       StkUsed;                                   /* CPU_STK entries                                      */
+    CPU_INT32U       StkSize;
+    CPU_INT32U       CtxSw;
+    CPU_INT32U       Hist[APP_PROF_HIST_N];
+} APP_PROF_SNAP;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void        AppProf_Init      (APP_PROF_TASK        *p_tbl,     /* Once, before the tasks start                         */
+                               CPU_INT32U            n);
+
+void        AppProf_Attach    (APP_PROF_TASK        *p_prof,    /* After OSTaskCreate()                                 */
+                               OS_TCB               *p_tcb);
+
+void        AppProf_LoopBegin (APP_PROF_TASK        *p_prof);
+
+void        AppProf_LoopEnd   (APP_PROF_TASK        *p_prof);
+
+void        AppProf_Snapshot  (const APP_PROF_TASK  *p_tbl,
+                               APP_PROF_SNAP        *p_snap,
+                               CPU_INT32U            n);
+
+CPU_INT32U  AppProf_Format    (const APP_PROF_SNAP  *p_snap,    /* Returns the length of the line                       */
+                               CPU_CHAR             *p_buf,
+                               CPU_INT32U            size);
+
+#endif
@@ -0,0 +1,179 @@
+/*
+*********************************************************************************************************
+*                                     ADAPTIVE TEMPERATURE SAMPLING
+*
+* Description : See app_rate.h.
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+
+#include  "app_rate.h"
+
+
+/*
+*********************************************************************************************************
+*                                           INITIALIZATION
+*
+* Description : Sets the limits of the sampling period and clears the history and the statistics.
+*
+* Argument(s) : p_rate          the scheduler.
+*
+*               period_min_ms   shortest period, used at the alarm point.
+*
+*               period_max_ms   longest period, used far from it.
+*
+*               latency_ms      detection latency to guarantee; raised to 'period_min_ms' if below.
+*
+*               slew_max_mc     fastest temperature change assumed, in milli-degrees per second.
+*
+*               base_ms         fixed period this replaces, only used to report the wake-ups saved.
+*
+* Return(s)   : none
+*********************************************************************************************************
+*/
+
+void  AppRate_Init (APP_RATE    *p_rate,
+                    CPU_INT32U   period_min_ms,
+                    CPU_INT32U   period_max_ms,
+                    CPU_INT32U   latency_ms,
+                    CPU_INT32U   slew_max_mc,
+                    CPU_INT32U   base_ms)
+{
+    p_rate->PeriodMinMs = (period_min_ms > 0u) ? period_min_ms : 1u;
+    p_rate->PeriodMaxMs = (period_max_ms > p_rate->PeriodMinMs) ? period_max_ms : p_rate->PeriodMinMs;
+    p_rate->LatencyMs   = (latency_ms > p_rate->PeriodMinMs) ? latency_ms : p_rate->PeriodMinMs;
+    p_rate->SlewMaxMc   = (slew_max_mc > 0u) ? slew_max_mc : 1u;
+    p_rate->BaseMs      = base_ms;
+    p_rate->RefValue    = 0;
+    p_rate->RefMs       = 0u;
+    p_rate->SlewObsMc   = 0u;
+    p_rate->Started     = DEF_FALSE;
+    p_rate->StartMs     = 0u;
+    p_rate->LastMs      = 0u;
+    p_rate->Wakeups     = 0u;
+    p_rate->PeriodMs    = 0u;
+    p_rate->PeriodLoMs  = 0xFFFFFFFFu;
+    p_rate->PeriodHiMs  = 0u;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            NEXT PERIOD
+*
+* Description : Updates the observed slew with the reading just taken and returns the delay until the
+*               next sample.
+*
+* Argument(s) : p_rate      the scheduler.
+*
+*               p_ch        monitor row of the temperature, right after AppMon_Sample(): Value, Limit,
+*                           Hyst, Above and the Alarm state are used.
+*
+*               now_ms      time of the sample.
+*
+* Return(s)   : Delay in milliseconds, within [PeriodMinMs, PeriodMaxMs].
+*
+* Caller(s)   : the sampling task, once per sample.
+*
+* Note(s)     : 1) Observed slew: a change of n degrees since the last change, dt ms ago, gives n / dt. A
+*                  reading that stayed put for dt ms moved less than one degree, so the estimate is
+*                  lowered to 1 / dt; it decays as the temperature settles.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppRate_Next (APP_RATE          *p_rate,
+                          const APP_MON_CH  *p_ch,
+                          CPU_INT32U         now_ms)
+{
+    CPU_INT32U  dt;
+    CPU_INT32U  slew;
+    CPU_INT32U  period;
+    int         dist;
+
+
+    if (!p_rate->Started) {
+        p_rate->Started  = DEF_TRUE;
+        p_rate->StartMs  = now_ms;
+        p_rate->RefValue = p_ch->Value;
+        p_rate->RefMs    = now_ms;
+    }
+    p_rate->Wakeups++;
+    p_rate->LastMs = now_ms;
+
+    dt = now_ms - p_rate->RefMs;
+    if (p_ch->Value != p_rate->RefValue) {
+        CPU_INT32U  n = (CPU_INT32U)((p_ch->Value > p_rate->RefValue) ? p_ch->Value - p_rate->RefValue
+                                                                      : p_rate->RefValue - p_ch->Value);
+
+
+        p_rate->SlewObsMc = (CPU_INT32U)(((CPU_INT64U)n * 1000000u) / ((dt > 0u) ? dt : 1u));
+        p_rate->RefValue  = p_ch->Value;
+        p_rate->RefMs     = now_ms;
+    } else if ((dt > 0u) && (1000000u / dt < p_rate->SlewObsMc)) {
+        p_rate->SlewObsMc = 1000000u / dt;
+    }
+
+    if (p_ch->Above) {                                          /* Degrees to go before the alarm state can change      */
+        dist = p_ch->Alarm ? p_ch->Value - (p_ch->Limit - p_ch->Hyst) - 1 : p_ch->Limit - p_ch->Value;
+    } else {
+        dist = p_ch->Alarm ? (p_ch->Limit + p_ch->Hyst) - p_ch->Value - 1 : p_ch->Value - p_ch->Limit;
+    }
+    slew = (p_rate->SlewObsMc > p_rate->SlewMaxMc / 2u) ? p_rate->SlewObsMc * 2u : p_rate->SlewMaxMc;
+
+    if (dist <= 0) {
+        period = p_rate->LatencyMs;
+    } else {
+        CPU_INT64U  reach = ((CPU_INT64U)dist * 1000000u) / slew;   /* ms before it can get there                       */
+
+
+        period = (reach + p_rate->LatencyMs < p_rate->PeriodMaxMs) ? (CPU_INT32U)reach + p_rate->LatencyMs
+                                                                   : p_rate->PeriodMaxMs;
+    }
+    if (period < p_rate->PeriodMinMs) {
+        period = p_rate->PeriodMinMs;
+    }
+    if (period > p_rate->PeriodMaxMs) {
+        period = p_rate->PeriodMaxMs;
+    }
+
+    p_rate->PeriodMs = period;
+    if (period < p_rate->PeriodLoMs) {
+        p_rate->PeriodLoMs = period;
+    }
+    if (period > p_rate->PeriodHiMs) {
+        p_rate->PeriodHiMs = period;
+    }
+    return (period);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FORMAT STATISTICS
+*
+* Description : One line: wake-ups since the first sample, against the fixed BaseMs period, the range of
+*               periods used and the latency bound.
+*
+* Return(s)   : Length of the line.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppRate_Format (const APP_RATE *p_rate,
+                            CPU_CHAR       *p_buf,
+                            CPU_INT32U      size)
+{
+    CPU_INT32U  span = p_rate->LastMs - p_rate->StartMs;
+    CPU_INT32U  base = (p_rate->BaseMs > 0u) ? span / p_rate->BaseMs + 1u : 0u;
+    int         len;
+
+
+    len = snprintf((char *)p_buf, size,
+                   "sampling: %u wake-ups in %u.%01u s, %u at %u ms (%d%% saved), period %u..%u ms, bound %u ms",
+                   (unsigned)p_rate->Wakeups, (unsigned)(span / 1000u), (unsigned)(span % 1000u / 100u),
+                   (unsigned)base, (unsigned)p_rate->BaseMs,
+                   (base > 0u) ? (int)(100 - (int)((CPU_INT64U)p_rate->Wakeups * 100u / base)) : 0,
+                   (unsigned)((p_rate->Wakeups > 0u) ? p_rate->PeriodLoMs : 0u), (unsigned)p_rate->PeriodHiMs,
+                   (unsigned)p_rate->LatencyMs);
+    return ((len < 0) ? 0u : ((CPU_INT32U)len < size) ? (CPU_INT32U)len : size - 1u);
+}
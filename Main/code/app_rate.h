@@ -0,0 +1,92 @@
+/*
+*********************************************************************************************************
+*                                     ADAPTIVE TEMPERATURE SAMPLING
+*
+* Description : Chooses the delay until the next temperature sample from how far the reading is from the
+*               point where the alarm changes state, and how fast it moves:
+*
+*                   period = distance / slew + LatencyMs,   clamped to [PeriodMinMs, PeriodMaxMs]
+*
+*               'distance' is how far the temperature has to go, at least, before the reading sets the
+*               alarm (or clears it, from 'Limit - Hyst', while in alarm). 'slew' is the larger of
+*               SlewMaxMc, the fastest change the die temperature is assumed to make, and twice the
+*               change observed lately. Far from the threshold the task wakes up rarely; near it, or
+*               while the temperature moves fast, it samples every few ticks.
+*
+* Note(s)     : 1) Latency bound: if the temperature never changes faster than SlewMaxMc, it cannot reach
+*                  the alarm point before 'distance / slew' after a sample, so the next sample comes at
+*                  most LatencyMs after it does. An alarm set or clear is therefore seen at most
+*                  max(LatencyMs, PeriodMinMs) plus the release delay of the sampling task after the
+*                  temperature crosses, and at once after a threshold change if the task that changes it
+*                  calls OSTimeDlyResume() on the sampling task.
+*               2) Distances come from whole-degree readings, truncated (see app_temp.h): a reading 'v'
+*                  means v <= T < v + 1, and the bound uses the unfavourable end.
+*               3) Temperatures in degrees Celsius, slews in milli-degrees per second, times in ms.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_RATE_H
+#define  APP_RATE_H
+
+#include  <Source/os.h>
+#include  "app_mon.h"
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_RATE_LINE_SIZE     128u
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    CPU_INT32U   PeriodMinMs;                                   /* Configuration, see AppRate_Init()                    */
+    CPU_INT32U   PeriodMaxMs;
+    CPU_INT32U   LatencyMs;
+    CPU_INT32U   SlewMaxMc;
+    CPU_INT32U   BaseMs;                                        /* Fixed period it replaces, for the statistics         */
+
+    int          RefValue;                                      /* Reading at the last change, and its time             */
+    CPU_INT32U   RefMs;
+    CPU_INT32U   SlewObsMc;                                     /* Recent change, upper estimate                        */
+    CPU_BOOLEAN  Started;
+
+    CPU_INT32U   StartMs;                                       /* Statistics                                           */
+    CPU_INT32U   LastMs;
+    CPU_INT32U   Wakeups;
+    CPU_INT32U   PeriodMs;                                      /* Last period chosen                                   */
+    CPU_INT32U   PeriodLoMs;
+    CPU_INT32U   PeriodHiMs;
+} APP_RATE;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void        AppRate_Init   (APP_RATE           *p_rate,
+                            CPU_INT32U          period_min_ms,
+                            CPU_INT32U          period_max_ms,
+                            CPU_INT32U          latency_ms,
+                            CPU_INT32U          slew_max_mc,    /* Milli-degrees per second                             */
+                            CPU_INT32U          base_ms);
+
+CPU_INT32U  AppRate_Next   (APP_RATE           *p_rate,         /* After every sample; returns the delay in ms          */
+                            const APP_MON_CH   *p_ch,
+                            CPU_INT32U          now_ms);
+
+CPU_INT32U  AppRate_Format (const APP_RATE     *p_rate,         /* Returns the length of the line                       */
+                            CPU_CHAR           *p_buf,
+                            CPU_INT32U          size);
+
+#endif
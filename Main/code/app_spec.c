@@ -0,0 +1,512 @@
+/*
+*********************************************************************************************************
+*                                          SPECTRUM ANALYSIS
+*
+* Description : See app_spec.h.
+*
+* Note(s)     : 1) AppSpec_Analyze() and AppSpec_Goertzel() work in static buffers (16 KB), so only one
+*                  task may call them.
+*               2) Scaling: the windowed input is (x * w) << 2 with |x| <= 4096 and w in Q15, at most
+*                  2^29. Each butterfly adds in 64 bits and halves the result, so no stage can grow past
+*                  2^29 and the output is the DFT divided by APP_SPEC_FFT_N.
+*********************************************************************************************************
+*/
+
+#include  <math.h>
+#include  <stdio.h>
+
+#include  "app_spec.h"
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_SPEC_PI             3.14159265358979323846
+#define  APP_SPEC_IN_SHIFT          2u                          /* Windowed input, (x * w) << 2                         */
+#define  APP_SPEC_GOE_SHIFT        14u                          /* Goertzel input, windowed input >> 14, about 2^15     */
+#define  APP_SPEC_FS_AMPL        2048.0                         /* Amplitude of a full-scale sine, in codes             */
+#define  APP_SPEC_HALF          (APP_SPEC_FFT_N / 2u)
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  CPU_INT32S       AppSpecRe[APP_SPEC_FFT_N];
+static  CPU_INT32S       AppSpecIm[APP_SPEC_FFT_N];
+static  float            AppSpecPow[APP_SPEC_HALF];
+static  CPU_INT08U       AppSpecUsed[APP_SPEC_HALF];            /* Bins taken by the tone or a harmonic                 */
+static  CPU_INT32S       AppSpecCos[APP_SPEC_HALF];             /* exp(-j 2 pi k / N) in Q30                            */
+static  CPU_INT32S       AppSpecSin[APP_SPEC_HALF];
+static  CPU_INT16U       AppSpecWin[APP_SPEC_SAMPLES];          /* Blackman-Harris, Q15                                 */
+static  double           AppSpecPowScale;                       /* Tone power to (amplitude / full scale)^2             */
+static  double           AppSpecWinSum;                         /* Sum of the Goertzel input window                     */
+
+static  OS_TCB          *AppSpecTcbPtr;
+static  APP_SPEC_FRAME   AppSpecFrames[APP_SPEC_BUFS];
+static  _Atomic CPU_INT32U  AppSpecDropped;
+
+
+/*
+*********************************************************************************************************
+*                                           INITIALIZATION
+*
+* Description : Builds the twiddle and window tables and the scale factors that go with them.
+*
+* Note(s)     : 1) Lobe power P of a sine of amplitude A: P = A^2 / 4 * sum((4 w)^2) / N, w in Q15.
+*********************************************************************************************************
+*/
+
+void  AppSpec_Init (void)
+{
+    double      sum_sq = 0.0;
+    double      sum    = 0.0;
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < APP_SPEC_HALF; i++) {
+        double  a = 2.0 * APP_SPEC_PI * (double)i / (double)APP_SPEC_FFT_N;
+
+
+        AppSpecCos[i] = (CPU_INT32S)lround( cos(a) * 1073741824.0);
+        AppSpecSin[i] = (CPU_INT32S)lround(-sin(a) * 1073741824.0);
+    }
+
+    for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+        double  a = 2.0 * APP_SPEC_PI * (double)i / (double)APP_SPEC_SAMPLES;
+        double  w = 0.35875 - 0.48829 * cos(a) + 0.14128 * cos(2.0 * a) - 0.01168 * cos(3.0 * a);
+
+
+        AppSpecWin[i] = (CPU_INT16U)lround(w * 32767.0);
+        sum_sq       += (double)AppSpecWin[i] * AppSpecWin[i];
+        sum          += (double)AppSpecWin[i];
+    }
+
+    AppSpecPowScale = 4.0 * APP_SPEC_FFT_N /
+                      ((double)(1u << (2u * APP_SPEC_IN_SHIFT)) * sum_sq * APP_SPEC_FS_AMPL * APP_SPEC_FS_AMPL);
+    AppSpecWinSum   = sum * (double)(1u << APP_SPEC_IN_SHIFT) / (double)(1u << APP_SPEC_GOE_SHIFT);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         LOAD A SWEEP
+*
+* Description : Undoes the vscale shift, removes the mean and writes the windowed sweep into AppSpecRe[],
+*               zero padded to APP_SPEC_FFT_N, with AppSpecIm[] cleared.
+*********************************************************************************************************
+*/
+
+static  void  AppSpec_Load (const CPU_INT16U  *samples,
+                            CPU_INT08U         vscale)
+{
+    CPU_INT32S  sum = 0;
+    CPU_INT32S  mean;
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+        sum += (CPU_INT32S)(samples[i] & 0xFFFu);
+    }
+    mean = (CPU_INT32S)(((sum << vscale) + (CPU_INT32S)(APP_SPEC_SAMPLES / 2u)) / (CPU_INT32S)APP_SPEC_SAMPLES);
+
+    for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+        CPU_INT32S  x = ((CPU_INT32S)(samples[i] & 0xFFFu) << vscale) - mean;
+
+
+        AppSpecRe[i] = (x * (CPU_INT32S)AppSpecWin[i]) * (1 << APP_SPEC_IN_SHIFT);
+        AppSpecIm[i] = 0;
+    }
+    for (; i < APP_SPEC_FFT_N; i++) {
+        AppSpecRe[i] = 0;
+        AppSpecIm[i] = 0;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         RADIX-2 FFT
+*
+* Description : In place, decimation in time, on AppSpecRe[] / AppSpecIm[]. Halves the data at each stage.
+*********************************************************************************************************
+*/
+
+static  void  AppSpec_Fft (void)
+{
+    CPU_INT32U  i;
+    CPU_INT32U  j;
+    CPU_INT32U  k;
+    CPU_INT32U  len;
+
+
+    for (i = 1u, j = 0u; i < APP_SPEC_FFT_N; i++) {             /* Bit reversed order                                   */
+        CPU_INT32U  bit = APP_SPEC_FFT_N >> 1;
+
+
+        for (; (j & bit) != 0u; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            CPU_INT32S  t = AppSpecRe[i];
+
+
+            AppSpecRe[i] = AppSpecRe[j];
+            AppSpecRe[j] = t;
+        }
+    }
+
+    for (i = 0u; i < APP_SPEC_FFT_N; i += 2u) {                 /* First stage, twiddle 1, imaginary part still 0       */
+        CPU_INT32S  a = AppSpecRe[i];
+        CPU_INT32S  b = AppSpecRe[i + 1u];
+
+
+        AppSpecRe[i]      = (CPU_INT32S)(((CPU_INT64S)a + b) >> 1);
+        AppSpecRe[i + 1u] = (CPU_INT32S)(((CPU_INT64S)a - b) >> 1);
+    }
+
+    for (len = 4u; len <= APP_SPEC_FFT_N; len <<= 1) {
+        CPU_INT32U  half = len >> 1;
+        CPU_INT32U  step = APP_SPEC_FFT_N / len;
+
+
+        for (i = 0u; i < APP_SPEC_FFT_N; i += len) {
+            for (k = 0u; k < half; k++) {
+                CPU_INT32U  a  = i + k;
+                CPU_INT32U  b  = a + half;
+                CPU_INT64S  wr = AppSpecCos[k * step];
+                CPU_INT64S  wi = AppSpecSin[k * step];
+                CPU_INT64S  tr = ((CPU_INT64S)AppSpecRe[b] * wr - (CPU_INT64S)AppSpecIm[b] * wi) >> 30;
+                CPU_INT64S  ti = ((CPU_INT64S)AppSpecRe[b] * wi + (CPU_INT64S)AppSpecIm[b] * wr) >> 30;
+                CPU_INT64S  ar = AppSpecRe[a];
+                CPU_INT64S  ai = AppSpecIm[a];
+
+
+                AppSpecRe[a] = (CPU_INT32S)((ar + tr) >> 1);
+                AppSpecIm[a] = (CPU_INT32S)((ai + ti) >> 1);
+                AppSpecRe[b] = (CPU_INT32S)((ar - tr) >> 1);
+                AppSpecIm[b] = (CPU_INT32S)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          TONE POWER
+*
+* Description : Sums the power of the bins within APP_SPEC_LOBE of 'bin' that no other tone took, and
+*               marks them as taken.
+*
+* Return(s)   : The power, and in 'p_bins' the number of bins summed.
+*********************************************************************************************************
+*/
+
+static  double  AppSpec_Lobe (CPU_INT32U   bin,
+                              CPU_INT32U  *p_bins)
+{
+    CPU_INT32U  lo = (bin > APP_SPEC_LOBE) ? bin - APP_SPEC_LOBE : 0u;
+    CPU_INT32U  hi = (bin + APP_SPEC_LOBE < APP_SPEC_HALF) ? bin + APP_SPEC_LOBE : APP_SPEC_HALF - 1u;
+    double      p  = 0.0;
+    CPU_INT32U  k;
+
+
+    *p_bins = 0u;
+    for (k = lo; k <= hi; k++) {
+        if (AppSpecUsed[k] == 0u) {
+            AppSpecUsed[k] = 1u;
+            p             += AppSpecPow[k];
+            (*p_bins)++;
+        }
+    }
+    return (p);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         SPECTRUM OF A SWEEP
+*
+* Description : FFT of one sweep and the figures of its dominant tone.
+*
+* Argument(s) : samples     the 1280 words of the sweep.
+*
+*               hscale      'hscale' of the sweep, which sets the sample rate.
+*
+*               vscale      'vscale' of the sweep, undone before the analysis.
+*
+*               p_res       receives the figures.
+*
+* Return(s)   : none
+*
+* Caller(s)   : the spectrum task.
+*
+* Note(s)     : 1) The bins around DC are ignored: the window leaks the mean removal residue into them.
+*               2) The noise is the power of the bins outside DC, the tone and the harmonics, scaled up to
+*                  the whole band; the same noise density is taken out of the tone and harmonic sums.
+*                  Harmonics buried in the noise count as one bin of noise, so THD bottoms out there.
+*               3) Harmonics above Nyquist are folded back to where they alias.
+*********************************************************************************************************
+*/
+
+void  AppSpec_Analyze (const CPU_INT16U  *samples,
+                       CPU_INT08U         hscale,
+                       CPU_INT08U         vscale,
+                       APP_SPEC_RESULT   *p_res)
+{
+    float       fs = APP_SPEC_ADC_HZ / (float)(hscale + 1u);
+    CPU_INT32U  peak = APP_SPEC_LOBE + 1u;
+    CPU_INT32U  bins_tone;
+    CPU_INT32U  bins_harm = 0u;
+    CPU_INT32U  bins_dc;
+    CPU_INT32U  bins_noise;
+    CPU_INT32U  n;
+    CPU_INT32U  k;
+    CPU_INT32U  h;
+    double      p_tone;
+    double      p_harm = 0.0;
+    double      p_noise = 0.0;
+    double      density;
+    double      delta = 0.0;
+    double      freq;
+
+
+    AppSpec_Load(samples, vscale);
+    AppSpec_Fft();
+
+    for (k = 0u; k < APP_SPEC_HALF; k++) {
+        float  re = (float)AppSpecRe[k];
+        float  im = (float)AppSpecIm[k];
+
+
+        AppSpecPow[k]  = re * re + im * im;
+        AppSpecUsed[k] = 0u;
+        if ((k > APP_SPEC_LOBE) && (AppSpecPow[k] > AppSpecPow[peak])) {
+            peak = k;
+        }
+    }
+
+    if (peak < APP_SPEC_HALF - 1u) {                            /* Parabola through the log power of the 3 top bins     */
+        double  l = log((double)AppSpecPow[peak - 1u] + 1e-3);
+        double  c = log((double)AppSpecPow[peak]      + 1e-3);
+        double  r = log((double)AppSpecPow[peak + 1u] + 1e-3);
+        double  d = l - 2.0 * c + r;
+
+
+        if (d < 0.0) {
+            delta = 0.5 * (l - r) / d;
+        }
+    }
+    freq = ((double)peak + delta) * fs / APP_SPEC_FFT_N;
+
+    (void)AppSpec_Lobe(0u, &bins_dc);
+    p_tone = AppSpec_Lobe(peak, &bins_tone);
+    for (h = 2u; h <= APP_SPEC_HARM_MAX; h++) {
+        double  fh = fmod(freq * h, fs);
+
+
+        if (fh > 0.5 * fs) {
+            fh = fs - fh;
+        }
+        k       = (CPU_INT32U)lround(fh * APP_SPEC_FFT_N / fs);
+        p_harm += AppSpec_Lobe((k < APP_SPEC_HALF) ? k : APP_SPEC_HALF - 1u, &n);
+        bins_harm += n;
+    }
+
+    bins_noise = 0u;
+    for (k = 0u; k < APP_SPEC_HALF; k++) {
+        if (AppSpecUsed[k] == 0u) {
+            p_noise += AppSpecPow[k];
+            bins_noise++;
+        }
+    }
+    density  = (bins_noise > 0u) ? p_noise / bins_noise : 0.0;
+    p_noise  = density * (APP_SPEC_HALF - bins_dc);
+    p_noise  = fmax(p_noise, 1e-9);
+    p_tone   = fmax(p_tone - density * bins_tone, 1e-9);
+    p_harm   = fmax(p_harm - density * bins_harm, fmax(density, 1e-9));
+
+    p_res->FreqHz   = (float)freq;
+    p_res->LevelDb  = (float)(10.0 * log10(p_tone * AppSpecPowScale));
+    p_res->ThdDb    = (float)(10.0 * log10(p_harm / p_tone));
+    p_res->SnrDb    = (float)(10.0 * log10(p_tone / p_noise));
+    p_res->SinadDb  = (float)(10.0 * log10(p_tone / (p_noise + p_harm)));
+    p_res->Enob     = (p_res->SinadDb - 1.76f) / 6.02f;
+    p_res->SampleHz = fs;
+    p_res->Bin      = peak;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            GOERTZEL BANK
+*
+* Description : Level of every tone of the table, from one Goertzel filter each over the windowed sweep.
+*
+* Argument(s) : samples     the 1280 words of the sweep.
+*
+*               hscale      'hscale' of the sweep.
+*
+*               vscale      'vscale' of the sweep.
+*
+*               p_tbl       tones; LevelDb is written, in dB relative to a full-scale sine.
+*
+*               n           number of rows of 'p_tbl'.
+*
+* Return(s)   : none
+*
+* Caller(s)   : the spectrum task.
+*
+* Note(s)     : 1) The state is 64-bit with the coefficient 2 cos(w) in Q30, the input about 2^15, so the
+*                  resonance over 1280 samples cannot overflow it.
+*               2) The resolution is the width of the window's main lobe, about 2 fs / 1280.
+*********************************************************************************************************
+*/
+
+void  AppSpec_Goertzel (const CPU_INT16U  *samples,
+                        CPU_INT08U         hscale,
+                        CPU_INT08U         vscale,
+                        APP_SPEC_BIN      *p_tbl,
+                        CPU_INT32U         n)
+{
+    double      fs = (double)APP_SPEC_ADC_HZ / (double)(hscale + 1u);
+    CPU_INT32U  t;
+    CPU_INT32U  i;
+
+
+    AppSpec_Load(samples, vscale);
+    for (t = 0u; t < n; t++) {
+        double      w     = 2.0 * APP_SPEC_PI * (double)p_tbl[t].Hz / fs;
+        double      c     = 2.0 * cos(w);
+        CPU_INT64S  coeff = (CPU_INT64S)llround(c * 1073741824.0);
+        CPU_INT64S  s1    = 0;
+        CPU_INT64S  s2    = 0;
+        double      re;
+        double      im;
+        double      ampl;
+
+
+        for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+            CPU_INT64S  s = (CPU_INT64S)(AppSpecRe[i] >> APP_SPEC_GOE_SHIFT) + ((coeff * s1) >> 30) - s2;
+
+
+            s2 = s1;
+            s1 = s;
+        }
+        re   = (double)s1 - 0.5 * c * (double)s2;
+        im   = sin(w) * (double)s2;
+        ampl = 2.0 * sqrt(re * re + im * im) / AppSpecWinSum;   /* Amplitude of the tone, in codes                      */
+        p_tbl[t].LevelDb = (float)(20.0 * log10(ampl / APP_SPEC_FS_AMPL + 1e-9));
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FORMAT A RESULT
+*
+* Description : Writes one line of text for 'p_res' into 'p_buf', without line terminator.
+*
+* Return(s)   : Length of the line.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppSpec_Format (const APP_SPEC_RESULT *p_res,
+                            CPU_CHAR              *p_buf,
+                            CPU_INT32U             size)
+{
+    int  len;
+
+
+    len = snprintf((char *)p_buf, size,
+                   "%10.1f Hz %6.1f dBFS  THD %6.1f dB  SNR %5.1f dB  SINAD %5.1f dB  ENOB %4.1f",
+                   (double)p_res->FreqHz, (double)p_res->LevelDb, (double)p_res->ThdDb,
+                   (double)p_res->SnrDb, (double)p_res->SinadDb, (double)p_res->Enob);
+    return ((len < 0) ? 0u : ((CPU_INT32U)len < size) ? (CPU_INT32U)len : size - 1u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            FRAME PORT
+*
+* Description : AppSpec_PortInit() names the task that receives the frames. AppSpec_Post() copies a
+*               sweep into a free buffer of the pool and posts it to that task; the task gets a pointer to
+*               the APP_SPEC_FRAME and returns the buffer with AppSpec_Release() once analyzed.
+*
+* Note(s)     : 1) The task queue must hold at least APP_SPEC_BUFS messages.
+*               2) Frames posted before AppSpec_PortInit() are neither delivered nor counted as dropped.
+*********************************************************************************************************
+*/
+
+void  AppSpec_PortInit (OS_TCB *p_tcb)
+{
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < APP_SPEC_BUFS; i++) {
+        atomic_init(&AppSpecFrames[i].Busy, 0u);
+    }
+    atomic_init(&AppSpecDropped, 0u);
+    AppSpecTcbPtr = p_tcb;
+}
+
+CPU_BOOLEAN  AppSpec_Post (const CPU_INT16U  *samples,
+                           CPU_INT08U         hscale,
+                           CPU_INT08U         vscale)
+{
+    APP_SPEC_FRAME  *p_frame = (APP_SPEC_FRAME *)0;
+    OS_ERR           err;
+    CPU_INT32U       i;
+
+
+    if (AppSpecTcbPtr == (OS_TCB *)0) {
+        return (DEF_FALSE);
+    }
+    for (i = 0u; i < APP_SPEC_BUFS; i++) {
+        if (atomic_load_explicit(&AppSpecFrames[i].Busy, memory_order_acquire) == 0u) {
+            p_frame = &AppSpecFrames[i];
+            break;
+        }
+    }
+    if (p_frame == (APP_SPEC_FRAME *)0) {                       /* The task is still busy with every buffer             */
+        atomic_store_explicit(&AppSpecDropped,
+                              atomic_load_explicit(&AppSpecDropped, memory_order_relaxed) + 1u,
+                              memory_order_relaxed);
+        return (DEF_FALSE);
+    }
+
+    for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+        p_frame->Samples[i] = samples[i];
+    }
+    p_frame->HScale = hscale;
+    p_frame->VScale = vscale;
+    atomic_store_explicit(&p_frame->Busy, 1u, memory_order_relaxed);
+
+    OSTaskQPost(AppSpecTcbPtr, (void *)p_frame, (OS_MSG_SIZE)sizeof(*p_frame), OS_OPT_POST_FIFO, &err);
+    if (err != OS_ERR_NONE) {
+        AppSpec_Release(p_frame);
+        atomic_store_explicit(&AppSpecDropped,
+                              atomic_load_explicit(&AppSpecDropped, memory_order_relaxed) + 1u,
+                              memory_order_relaxed);
+        return (DEF_FALSE);
+    }
+    return (DEF_TRUE);
+}
+
+void  AppSpec_Release (APP_SPEC_FRAME *p_frame)
+{
+    atomic_store_explicit(&p_frame->Busy, 0u, memory_order_release);
+}
+
+CPU_INT32U  AppSpec_Dropped (void)
+{
+    return (atomic_load_explicit(&AppSpecDropped, memory_order_relaxed));
+}
@@ -0,0 +1,115 @@
+/*
+*********************************************************************************************************
+*                                          SPECTRUM ANALYSIS
+*
+* Description : Frequency analysis of the sweeps written by trigger_controller, 1280 12-bit words each.
+*
+*               AppSpec_Analyze() removes the mean, applies a 4-term Blackman-Harris window (sidelobes at
+*               -92 dB, below the noise of a 12-bit ADC), zero pads to 2048 points and runs a radix-2 FFT
+*               in fixed point (32-bit data, Q30 twiddles, one bit of scaling per stage, so it cannot
+*               overflow). From the power spectrum it takes the dominant tone, its frequency (interpolated
+*               between bins), THD over harmonics 2 to APP_SPEC_HARM_MAX, SNR and SINAD.
+*
+*               AppSpec_Goertzel() measures only the tones of a table, one Goertzel filter each, which is
+*               cheaper than the FFT for a few frequencies that need not fall on a bin.
+*
+*               Frames reach the spectrum task through a small pool: AppSpec_Post() copies a sweep into
+*               a free buffer and posts it to the task queue, the task analyzes it and hands it back with
+*               AppSpec_Release(). With no free buffer the sweep is dropped and counted.
+*
+* Note(s)     : 1) The sample rate of a sweep is 108 MHz / 101 / (hscale + 1). Levels are in dB relative
+*                  to a full-scale sine of the ADC (amplitude 2048 codes), after undoing the vscale shift.
+*               2) AppSpec_Post() is meant for the interrupt that signals a completed sweep. The PL of this
+*                  design does not export the sweeps to the PS yet; the host simulation posts the frames
+*                  of a capture file (SIM_FRAMES) instead.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_SPEC_H
+#define  APP_SPEC_H
+
+#include  <stdatomic.h>
+#include  <Source/os.h>
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_SPEC_SAMPLES        1280u                          /* Words of a sweep                                     */
+#define  APP_SPEC_FFT_LOG2         11u
+#define  APP_SPEC_FFT_N          (1u << APP_SPEC_FFT_LOG2)      /* Zero padded FFT length                               */
+#define  APP_SPEC_LOBE             10u                          /* Half width, in bins, of a windowed tone              */
+#define  APP_SPEC_HARM_MAX          6u                          /* Highest harmonic counted in THD                      */
+#define  APP_SPEC_BUFS              2u                          /* Frames in the pool                                   */
+#define  APP_SPEC_ADC_HZ         (108000000.0f / 101.0f)        /* One conversion every 101 clocks                      */
+#define  APP_SPEC_LINE_SIZE       128u
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    CPU_INT16U            Samples[APP_SPEC_SAMPLES];
+    CPU_INT08U            HScale;
+    CPU_INT08U            VScale;
+    _Atomic CPU_INT08U    Busy;                                 /* Set by AppSpec_Post(), cleared by AppSpec_Release()  */
+} APP_SPEC_FRAME;
+
+typedef  struct {
+    float       FreqHz;                                         /* Dominant tone                                        */
+    float       LevelDb;                                        /* ... its level                                        */
+    float       ThdDb;                                          /* Harmonics 2 .. APP_SPEC_HARM_MAX over the tone       */
+    float       SnrDb;                                          /* Tone over everything but DC and the harmonics        */
+    float       SinadDb;
+    float       Enob;                                           /* (SINAD - 1.76) / 6.02                                */
+    float       SampleHz;
+    CPU_INT32U  Bin;                                            /* FFT bin of the peak                                  */
+} APP_SPEC_RESULT;
+
+typedef  struct {                                               /* One row of the Goertzel bank                         */
+    const CPU_CHAR  *NamePtr;
+    float            Hz;
+    float            LevelDb;                                   /* Result                                               */
+} APP_SPEC_BIN;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void            AppSpec_Init     (void);                        /* Twiddle and window tables, once before the others    */
+
+void            AppSpec_Analyze  (const CPU_INT16U  *samples,
+                                  CPU_INT08U         hscale,
+                                  CPU_INT08U         vscale,
+                                  APP_SPEC_RESULT   *p_res);
+
+void            AppSpec_Goertzel (const CPU_INT16U  *samples,
+                                  CPU_INT08U         hscale,
+                                  CPU_INT08U         vscale,
+                                  APP_SPEC_BIN      *p_tbl,
+                                  CPU_INT32U         n);
+
+CPU_INT32U      AppSpec_Format   (const APP_SPEC_RESULT *p_res,  /* Returns the length of the line                    */
+                                  CPU_CHAR              *p_buf,
+                                  CPU_INT32U             size);
+
+void            AppSpec_PortInit (OS_TCB            *p_tcb);    /* Task that receives the frames, on its task queue     */
+
+CPU_BOOLEAN     AppSpec_Post     (const CPU_INT16U  *samples,   /* Interrupt side; DEF_FALSE if the frame was dropped   */
+                                  CPU_INT08U         hscale,
+                                  CPU_INT08U         vscale);
+
+void            AppSpec_Release  (APP_SPEC_FRAME    *p_frame);
+
+CPU_INT32U      AppSpec_Dropped  (void);
+
+#endif
@@ -0,0 +1,89 @@
+/*
+*********************************************************************************************************
+*                                        OUTPUT STATE PUBLISHER
+*
+* Description : See app_state.h.
+*********************************************************************************************************
+*/
+
+#include  "app_state.h"
+
+
+#define  APP_STATE_THRESHOLD_FIELD    (APP_STATE_PIXELS_MASK << APP_STATE_THRESHOLD_SHIFT)
+#define  APP_STATE_TEMP_ALARM_FIELD  ((APP_STATE_PIXELS_MASK << APP_STATE_TEMPERATURE_SHIFT) | (1u << APP_STATE_ALARM_SHIFT))
+
+
+void  AppState_Init (APP_STATE  *p_state,
+                     XGpio      *p_gpio,
+                     unsigned    channel)
+{
+    atomic_init(&p_state->Word,    0u);
+    atomic_init(&p_state->Busy,    0u);
+    atomic_init(&p_state->Pending, 0u);
+    atomic_init(&p_state->Writes,  0u);
+    atomic_init(&p_state->Avoided, 0u);
+    p_state->Published = ~0u;                                   /* Not a valid word: the first publish always writes    */
+    p_state->GpioPtr   = p_gpio;
+    p_state->Channel   = channel;
+}
+
+
+CPU_INT32U  AppState_Pack (int  threshold,
+                           int  temperature,
+                           int  alarm)
+{
+    return (((CPU_INT32U)(alarm & 0x1) << APP_STATE_ALARM_SHIFT) |
+            ((CPU_INT32U)((temperature & 0x7F) << 4) << APP_STATE_TEMPERATURE_SHIFT) |
+            ((CPU_INT32U)((threshold & 0x7F) << 4) << APP_STATE_THRESHOLD_SHIFT));
+}
+
+
+static  void  AppState_Update (APP_STATE   *p_state,            /* Replace the bits of 'field' with those of 'bits'      */
+                               CPU_INT32U   field,
+                               CPU_INT32U   bits)
+{
+    CPU_INT32U  old = atomic_load_explicit(&p_state->Word, memory_order_relaxed);
+
+
+    while (!atomic_compare_exchange_weak_explicit(&p_state->Word, &old, (old & ~field) | (bits & field),
+                                                  memory_order_release, memory_order_relaxed)) {
+        ;
+    }
+}
+
+
+void  AppState_SetThreshold (APP_STATE  *p_state,
+                             int         threshold)
+{
+    AppState_Update(p_state, APP_STATE_THRESHOLD_FIELD, AppState_Pack(threshold, 0, 0));
+}
+
+
+void  AppState_SetTemperature (APP_STATE  *p_state,
+                               int         temperature,
+                               int         alarm)
+{
+    AppState_Update(p_state, APP_STATE_TEMP_ALARM_FIELD, AppState_Pack(0, temperature, alarm));
+}
+
+
+void  AppState_Publish (APP_STATE *p_state)
+{
+    CPU_INT32U  word;
+
+
+    atomic_store_explicit(&p_state->Pending, 1u, memory_order_seq_cst);
+    while (atomic_load_explicit(&p_state->Pending, memory_order_seq_cst) &&
+           !atomic_exchange_explicit(&p_state->Busy, 1u, memory_order_acquire)) {
+        atomic_store_explicit(&p_state->Pending, 0u, memory_order_seq_cst);
+        word = atomic_load_explicit(&p_state->Word, memory_order_acquire);
+        if (word != p_state->Published) {
+            XGpio_DiscreteWrite(p_state->GpioPtr, p_state->Channel, word);
+            p_state->Published = word;
+            atomic_fetch_add_explicit(&p_state->Writes, 1u, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&p_state->Avoided, 1u, memory_order_relaxed);
+        }
+        atomic_store_explicit(&p_state->Busy, 0u, memory_order_release);
+    }                                                           /* Busy elsewhere: that publisher will see 'Pending'    */
+}
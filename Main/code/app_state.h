@@ -0,0 +1,84 @@
+/*
+*********************************************************************************************************
+*                                        OUTPUT STATE PUBLISHER
+*
+* Description : Owns the 23-bit word written to the GPIO output channel for acquire_and_plot:
+*
+*                   bit 22      alarm
+*                   bits 21..11 temperature, in pixels (degrees << 4)
+*                   bits 10..0  threshold,   in pixels (degrees << 4)
+*
+*               Each task updates only its own fields, with a compare-and-swap on the whole word, so the
+*               word always holds a combination the tasks really produced. AppState_Publish() writes it
+*               to the GPIO only when it differs from the value already there, and only one caller at a
+*               time ever touches the GPIO: a caller that finds a publish in progress leaves a note and
+*               returns, and the publisher in progress writes its change too before it leaves.
+*
+* Note(s)     : 1) No call blocks or waits, so a low priority task in the middle of a publish cannot hold
+*                  up a higher priority one.
+*               2) 'Writes' counts GPIO writes, 'Avoided' counts publishes that found nothing new.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_STATE_H
+#define  APP_STATE_H
+
+#include  <stdatomic.h>
+#include  <Source/os.h>
+#include  <xgpio.h>
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_STATE_THRESHOLD_SHIFT     0u
+#define  APP_STATE_TEMPERATURE_SHIFT  11u
+#define  APP_STATE_ALARM_SHIFT        22u
+#define  APP_STATE_PIXELS_MASK        0x7FFu                    /* 11-bit pixel fields                                  */
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    _Atomic CPU_INT32U  Word;                                   /* Latest packed state                                  */
+    CPU_INT32U          Published;                              /* Last value written, only used by the publisher       */
+    _Atomic CPU_INT32U  Busy;                                   /* A publish is in progress                             */
+    _Atomic CPU_INT32U  Pending;                                /* The word changed during a publish                    */
+    _Atomic CPU_INT32U  Writes;
+    _Atomic CPU_INT32U  Avoided;
+    XGpio              *GpioPtr;
+    unsigned            Channel;
+} APP_STATE;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void        AppState_Init           (APP_STATE  *p_state,
+                                     XGpio      *p_gpio,
+                                     unsigned    channel);
+
+CPU_INT32U  AppState_Pack           (int         threshold,     /* Encoding of the output word, in degrees Celsius      */
+                                     int         temperature,
+                                     int         alarm);
+
+void        AppState_SetThreshold   (APP_STATE  *p_state,
+                                     int         threshold);
+
+void        AppState_SetTemperature (APP_STATE  *p_state,       /* Temperature and alarm change together                */
+                                     int         temperature,
+                                     int         alarm);
+
+void        AppState_Publish        (APP_STATE  *p_state);
+
+#endif
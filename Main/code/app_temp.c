@@ -0,0 +1,30 @@
+/*
+*********************************************************************************************************
+*                                     INTEGER TEMPERATURE CONVERSION
+*
+* Description : Lookup table of app_temp.h. Every entry is a constant expression of the float conversion
+*               macro, so the compiler evaluates it once and the target never runs it.
+*********************************************************************************************************
+*/
+
+#include  "app_temp.h"
+
+
+#define  APP_TEMP_T(r)        ((int16_t)XAdcPs_RawToTemperature(r))
+#define  APP_TEMP_EQ(c, j)    (APP_TEMP_T((c) * 16 + (j)) == APP_TEMP_T((c) * 16))
+#define  APP_TEMP_STEP(c)     (APP_TEMP_EQ(c,  0) + APP_TEMP_EQ(c,  1) + APP_TEMP_EQ(c,  2) + APP_TEMP_EQ(c,  3) + \
+                               APP_TEMP_EQ(c,  4) + APP_TEMP_EQ(c,  5) + APP_TEMP_EQ(c,  6) + APP_TEMP_EQ(c,  7) + \
+                               APP_TEMP_EQ(c,  8) + APP_TEMP_EQ(c,  9) + APP_TEMP_EQ(c, 10) + APP_TEMP_EQ(c, 11) + \
+                               APP_TEMP_EQ(c, 12) + APP_TEMP_EQ(c, 13) + APP_TEMP_EQ(c, 14) + APP_TEMP_EQ(c, 15))
+#define  APP_TEMP_E(c)        (int16_t)(APP_TEMP_T((c) * 16) * 32 + APP_TEMP_STEP(c))
+
+#define  APP_TEMP_E4(c)       APP_TEMP_E(c),         APP_TEMP_E((c) + 1),      APP_TEMP_E((c) + 2),      APP_TEMP_E((c) + 3)
+#define  APP_TEMP_E16(c)      APP_TEMP_E4(c),        APP_TEMP_E4((c) + 4),     APP_TEMP_E4((c) + 8),     APP_TEMP_E4((c) + 12)
+#define  APP_TEMP_E64(c)      APP_TEMP_E16(c),       APP_TEMP_E16((c) + 16),   APP_TEMP_E16((c) + 32),   APP_TEMP_E16((c) + 48)
+#define  APP_TEMP_E256(c)     APP_TEMP_E64(c),       APP_TEMP_E64((c) + 64),   APP_TEMP_E64((c) + 128),  APP_TEMP_E64((c) + 192)
+#define  APP_TEMP_E1024(c)    APP_TEMP_E256(c),      APP_TEMP_E256((c) + 256), APP_TEMP_E256((c) + 512), APP_TEMP_E256((c) + 768)
+
+
+const  int16_t  AppTempLut[4096] = {
+    APP_TEMP_E1024(0), APP_TEMP_E1024(1024), APP_TEMP_E1024(2048), APP_TEMP_E1024(3072)
+};
@@ -0,0 +1,50 @@
+/*
+*********************************************************************************************************
+*                                     INTEGER TEMPERATURE CONVERSION
+*
+* Description : Converts an XADC temperature result to whole degrees Celsius, and to the 11-bit pixel
+*               value of the 'temperature'/'t_temperature' ports of acquire_and_plot, without floating
+*               point. The result is exactly (int)XAdcPs_RawToTemperature(raw) for every 16-bit 'raw',
+*               including the fractional bits 3..0 that the averaging filter adds.
+*
+* Note(s)     : 1) AppTempLut has one entry per 12-bit code 'c' (bits 15..4 of 'raw'), built by the
+*                  compiler from the driver's own conversion macro:
+*
+*                      bits 15..5  (int)XAdcPs_RawToTemperature(c << 4)
+*                      bits  4..0  how many of the 16 sub-codes c<<4 .. (c<<4)+15 convert to that value
+*
+*                  A 12-bit code spans 0.12 degrees, so the truncated value steps at most once within it,
+*                  and the sub-code count tells where.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_TEMP_H
+#define  APP_TEMP_H
+
+#include  <stdint.h>
+#include  "xadcps.h"
+
+extern  const  int16_t  AppTempLut[4096];
+
+
+static  inline  int  AppTemp_Celsius (u16 raw)
+{
+    int16_t  e = AppTempLut[raw >> 4];
+
+
+    return ((e - (e & 0x1F)) / 32 + (int)((raw & 0xFu) >= (unsigned)(e & 0x1F)));
+}
+
+
+static  inline  u16  AppTemp_DegPixels (int deg)                /* Same field as the output word: degrees << 4          */
+{
+    return ((u16)((deg & 0x7F) << 4));
+}
+
+
+static  inline  u16  AppTemp_Pixels (u16 raw)
+{
+    return (AppTemp_DegPixels(AppTemp_Celsius(raw)));
+}
+
+#endif
@@ -0,0 +1,294 @@
+/*
+*********************************************************************************************************
+*                                          BINARY TELEMETRY
+*
+* Description : See app_tlm.h.
+*********************************************************************************************************
+*/
+
+#include  <string.h>
+#include  "app_tlm.h"
+
+
+#define  APP_TLM_RAW_MAX         (APP_TLM_HDR_SIZE + APP_TLM_PAYLOAD_MAX + APP_TLM_CRC_SIZE)
+
+
+/*
+*********************************************************************************************************
+*                                            HELPERS
+*********************************************************************************************************
+*/
+
+static  const  CPU_INT16U  AppTlm_CrcTbl[16] = {                /* CRC-16/CCITT, polynomial 0x1021, one nibble a step   */
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+static  CPU_INT16U  AppTlm_Crc (const CPU_INT08U  *p,
+                                CPU_INT32U         len)
+{
+    CPU_INT16U  crc = 0xFFFFu;
+
+
+    while (len-- > 0u) {
+        crc = (CPU_INT16U)((crc << 4) ^ AppTlm_CrcTbl[(crc >> 12) ^ (*p >> 4)]);
+        crc = (CPU_INT16U)((crc << 4) ^ AppTlm_CrcTbl[(crc >> 12) ^ (*p & 0x0Fu)]);
+        p++;
+    }
+    return (crc);
+}
+
+static  void  AppTlm_Put16 (CPU_INT08U *p, CPU_INT16U v)
+{
+    p[0] = (CPU_INT08U)v;
+    p[1] = (CPU_INT08U)(v >> 8);
+}
+
+static  void  AppTlm_Put32 (CPU_INT08U *p, CPU_INT32U v)
+{
+    p[0] = (CPU_INT08U)v;
+    p[1] = (CPU_INT08U)(v >>  8);
+    p[2] = (CPU_INT08U)(v >> 16);
+    p[3] = (CPU_INT08U)(v >> 24);
+}
+
+CPU_INT16U  AppTlm_Get16 (const CPU_INT08U *p)
+{
+    return ((CPU_INT16U)(p[0] | ((CPU_INT16U)p[1] << 8)));
+}
+
+CPU_INT32U  AppTlm_Get32 (const CPU_INT08U *p)
+{
+    return ((CPU_INT32U)p[0] | ((CPU_INT32U)p[1] << 8) | ((CPU_INT32U)p[2] << 16) | ((CPU_INT32U)p[3] << 24));
+}
+
+
+/*
+*********************************************************************************************************
+*                                            ENCODE A RECORD
+*
+* Description : Builds the record and writes it COBS-encoded to 'p_frame', followed by the zero byte.
+*
+* Argument(s) : type, src, seq, ms   header fields.
+*
+*               p_payload            payload of 'len' bytes, at most APP_TLM_PAYLOAD_MAX.
+*
+*               p_frame              at least APP_TLM_FRAME_MAX bytes.
+*
+* Return(s)   : Bytes written to 'p_frame', 0 if the payload is too long.
+*
+* Note(s)     : 1) COBS: each run of non-zero bytes is preceded by its length plus one, which stands for the
+*                  zero that follows it; a code of 0xFF is a run of 254 bytes not followed by a zero.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppTlm_Encode (CPU_INT08U   type,
+                           CPU_INT08U   src,
+                           CPU_INT16U   seq,
+                           CPU_INT32U   ms,
+                           const void  *p_payload,
+                           CPU_INT32U   len,
+                           CPU_INT08U  *p_frame)
+{
+    CPU_INT08U  raw[APP_TLM_RAW_MAX];
+    CPU_INT32U  n;
+    CPU_INT32U  i;
+    CPU_INT32U  code_at;
+    CPU_INT32U  out;
+    CPU_INT08U  code;
+
+
+    if (len > APP_TLM_PAYLOAD_MAX) {
+        return (0u);
+    }
+    raw[0] = type;
+    raw[1] = src;
+    AppTlm_Put16(&raw[2], seq);
+    AppTlm_Put32(&raw[4], ms);
+    memcpy(&raw[APP_TLM_HDR_SIZE], p_payload, len);
+    n = APP_TLM_HDR_SIZE + len;
+    AppTlm_Put16(&raw[n], AppTlm_Crc(raw, n));
+    n += APP_TLM_CRC_SIZE;
+
+    code_at = 0u;                                               /* COBS                                                 */
+    out     = 1u;
+    code    = 1u;
+    for (i = 0u; i < n; i++) {
+        if (raw[i] == 0u) {
+            p_frame[code_at] = code;
+            code_at = out++;
+            code    = 1u;
+        } else {
+            p_frame[out++] = raw[i];
+            if (++code == 0xFFu) {
+                p_frame[code_at] = code;
+                code_at = out++;
+                code    = 1u;
+            }
+        }
+    }
+    p_frame[code_at] = code;
+    p_frame[out++]   = 0u;                                      /* End of frame                                         */
+    return (out);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            DECODE A RECORD
+*
+* Description : Undoes AppTlm_Encode() for one frame, the bytes between two zeros.
+*
+* Return(s)   : APP_TLM_ERR_NONE with the record in 'p_rec', or the reason the frame was rejected.
+*********************************************************************************************************
+*/
+
+CPU_INT08U  AppTlm_Decode (const CPU_INT08U  *p_frame,
+                           CPU_INT32U         len,
+                           APP_TLM_REC       *p_rec)
+{
+    CPU_INT08U  raw[APP_TLM_RAW_MAX + 1u];
+    CPU_INT32U  in = 0u;
+    CPU_INT32U  n  = 0u;
+    CPU_INT32U  code;
+    CPU_INT32U  k;
+
+
+    while (in < len) {
+        code = p_frame[in++];
+        if ((code == 0u) || (in + code - 1u > len)) {
+            return (APP_TLM_ERR_COBS);
+        }
+        if (n + code > sizeof(raw)) {
+            return (APP_TLM_ERR_SIZE);
+        }
+        for (k = 1u; k < code; k++) {
+            raw[n++] = p_frame[in++];
+        }
+        if ((code != 0xFFu) && (in < len)) {                    /* A zero, unless this was the last run                 */
+            raw[n++] = 0u;
+        }
+    }
+
+    if ((n < APP_TLM_HDR_SIZE + APP_TLM_CRC_SIZE) || (n > APP_TLM_RAW_MAX)) {
+        return (APP_TLM_ERR_SIZE);
+    }
+    n -= APP_TLM_CRC_SIZE;
+    if (AppTlm_Crc(raw, n) != AppTlm_Get16(&raw[n])) {
+        return (APP_TLM_ERR_CRC);
+    }
+    p_rec->Type = raw[0];
+    p_rec->Src  = raw[1];
+    p_rec->Seq  = AppTlm_Get16(&raw[2]);
+    p_rec->Ms   = AppTlm_Get32(&raw[4]);
+    p_rec->Len  = n - APP_TLM_HDR_SIZE;
+    memcpy(p_rec->Payload, &raw[APP_TLM_HDR_SIZE], p_rec->Len);
+    return (APP_TLM_ERR_NONE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           QUEUE A RECORD
+*
+* Description : Encodes a record of the ring's source, with its next sequence number, and queues the
+*               frame whole in 'p_ring'.
+*
+* Return(s)   : DEF_FALSE if the ring had no room for it (counted in its 'Dropped').
+*
+* Caller(s)   : The task that owns 'p_ring', directly or through the record functions below.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppTlm_Put (APP_LOG_RING  *p_ring,
+                         CPU_INT08U     type,
+                         CPU_INT32U     ms,
+                         const void    *p_payload,
+                         CPU_INT32U     len)
+{
+    CPU_INT08U  frame[APP_TLM_FRAME_MAX];
+    CPU_INT32U  n;
+
+
+    n = AppTlm_Encode(type, p_ring->Src, p_ring->Seq, ms, p_payload, len, frame);
+    if (n == 0u) {
+        return (DEF_FALSE);
+    }
+    p_ring->Seq++;                                              /* Used even if dropped: the receiver sees a gap        */
+    return (AppLog_PutN(p_ring, frame, n));
+}
+
+
+/*
+*********************************************************************************************************
+*                                              RECORDS
+*
+* Description : Pack the payload of each record type, see app_tlm.h, and queue it with AppTlm_Put().
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  AppTlm_Sample (APP_LOG_RING  *p_ring,
+                            CPU_INT32U     ms,
+                            CPU_INT16S     temperature,
+                            CPU_INT16S     threshold,
+                            CPU_INT08U     alarm,
+                            CPU_INT32U     alarms,
+                            CPU_INT16U     period_ms)
+{
+    CPU_INT08U  p[APP_TLM_SAMPLE_SIZE];
+
+
+    AppTlm_Put16(&p[0], (CPU_INT16U)temperature);
+    AppTlm_Put16(&p[2], (CPU_INT16U)threshold);
+    p[4] = alarm;
+    AppTlm_Put32(&p[5], alarms);
+    AppTlm_Put16(&p[9], period_ms);
+    return (AppTlm_Put(p_ring, APP_TLM_TYPE_SAMPLE, ms, p, sizeof(p)));
+}
+
+CPU_BOOLEAN  AppTlm_Button (APP_LOG_RING  *p_ring,
+                            CPU_INT32U     ms,
+                            CPU_INT08U     button,
+                            CPU_INT16S     threshold,
+                            CPU_INT32U     latency_us)
+{
+    CPU_INT08U  p[APP_TLM_BUTTON_SIZE];
+
+
+    p[0] = button;
+    AppTlm_Put16(&p[1], (CPU_INT16U)threshold);
+    AppTlm_Put32(&p[3], latency_us);
+    return (AppTlm_Put(p_ring, APP_TLM_TYPE_BUTTON, ms, p, sizeof(p)));
+}
+
+CPU_BOOLEAN  AppTlm_Counters (APP_LOG_RING      *p_ring,
+                              CPU_INT32U         ms,
+                              const CPU_INT32U  *p_ctr)
+{
+    CPU_INT08U  p[APP_TLM_COUNTERS_SIZE];
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < APP_TLM_COUNTERS_SIZE / 4u; i++) {
+        AppTlm_Put32(&p[i * 4u], p_ctr[i]);
+    }
+    return (AppTlm_Put(p_ring, APP_TLM_TYPE_COUNTERS, ms, p, sizeof(p)));
+}
+
+CPU_BOOLEAN  AppTlm_Text (APP_LOG_RING    *p_ring,
+                          CPU_INT32U       ms,
+                          const CPU_CHAR  *str)
+{
+    CPU_INT32U   len = (CPU_INT32U)strlen(str);
+    CPU_INT32U   n;
+    CPU_BOOLEAN  ok  = DEF_TRUE;
+
+
+    while (len > 0u) {
+        n    = (len < APP_TLM_PAYLOAD_MAX) ? len : APP_TLM_PAYLOAD_MAX;
+        ok   = (CPU_BOOLEAN)(AppTlm_Put(p_ring, APP_TLM_TYPE_TEXT, ms, str, n) && ok);
+        str += n;
+        len -= n;
+    }
+    return (ok);
+}
@@ -0,0 +1,136 @@
+/*
+*********************************************************************************************************
+*                                          BINARY TELEMETRY
+*
+* Description : Framed binary records, sent on the UART in place of the text telemetry when the
+*               application is built with APP_TLM_BINARY. A record is
+*
+*                   offset  size
+*                        0     1    type, APP_TLM_TYPE_...
+*                        1     1    source: the log ring of the task that produced it
+*                        2     2    sequence number, per source
+*                        4     4    time, milliseconds since OSStart()
+*                        8     n    payload, see below
+*                    8 + n     2    CRC-16/CCITT-FALSE of bytes 0 .. 8 + n - 1
+*
+*               all fields little-endian. It is COBS-encoded, so it holds no zero byte, and followed by
+*               one zero byte that ends the frame. A receiver that starts in the middle of a frame, or
+*               loses bytes, resynchronizes on the next zero.
+*
+*               Payloads:
+*
+*                   SAMPLE     i16 temperature (C), i16 threshold (C), u8 alarm, u32 alarm word (app_mon.h),
+*                              u16 period until the next sample (ms)                             11 bytes
+*                   BUTTON     u8 button, i16 threshold after it (C), u32 latency of the action (us)   7 bytes
+*                   COUNTERS   u32 button presses, u32 button edges dropped, u32 log messages dropped,
+*                              u32 temperature samples                                           16 bytes
+*                   TEXT       the text of an AppPrint(), up to APP_TLM_PAYLOAD_MAX bytes per record
+*
+* Note(s)     : 1) A record costs APP_TLM_OVERHEAD bytes plus its payload on the wire: a SAMPLE is 23
+*                  bytes where the text of the same reading is about 90 (host/tlm_bench.c).
+*               2) The sequence number is taken even when the log ring has no room for the record, so
+*                  the receiver sees every record the application dropped as a gap.
+*               3) host/tlm_dec.c turns a capture of the UART into CSV files.
+*********************************************************************************************************
+*/
+
+#ifndef  APP_TLM_H
+#define  APP_TLM_H
+
+#include  <Source/os.h>
+#include  "app_log.h"
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_TLM_TYPE_SAMPLE       1u
+#define  APP_TLM_TYPE_BUTTON       2u
+#define  APP_TLM_TYPE_COUNTERS     3u
+#define  APP_TLM_TYPE_TEXT         4u
+
+#define  APP_TLM_HDR_SIZE          8u
+#define  APP_TLM_CRC_SIZE          2u
+#define  APP_TLM_PAYLOAD_MAX     120u                           /* Record below 254 bytes: one COBS code byte           */
+#define  APP_TLM_OVERHEAD        (APP_TLM_HDR_SIZE + APP_TLM_CRC_SIZE + 2u)   /* + COBS code byte + frame end           */
+#define  APP_TLM_FRAME_MAX       (APP_TLM_OVERHEAD + APP_TLM_PAYLOAD_MAX)
+
+#define  APP_TLM_SAMPLE_SIZE      11u
+#define  APP_TLM_BUTTON_SIZE       7u
+#define  APP_TLM_COUNTERS_SIZE    16u
+
+#define  APP_TLM_ERR_NONE          0u                           /* AppTlm_Decode() results                              */
+#define  APP_TLM_ERR_COBS          1u
+#define  APP_TLM_ERR_SIZE          2u
+#define  APP_TLM_ERR_CRC           3u
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {                                               /* A decoded record                                     */
+    CPU_INT08U   Type;
+    CPU_INT08U   Src;
+    CPU_INT16U   Seq;
+    CPU_INT32U   Ms;
+    CPU_INT32U   Len;                                           /* Payload bytes                                        */
+    CPU_INT08U   Payload[APP_TLM_PAYLOAD_MAX];
+} APP_TLM_REC;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+CPU_INT32U   AppTlm_Encode   (CPU_INT08U         type,          /* Returns the frame length, 0 if 'len' is too long     */
+                              CPU_INT08U         src,
+                              CPU_INT16U         seq,
+                              CPU_INT32U         ms,
+                              const void        *p_payload,
+                              CPU_INT32U         len,
+                              CPU_INT08U        *p_frame);      /* APP_TLM_FRAME_MAX bytes                              */
+
+CPU_INT08U   AppTlm_Decode   (const CPU_INT08U  *p_frame,       /* One frame, without its zero byte                     */
+                              CPU_INT32U         len,
+                              APP_TLM_REC       *p_rec);
+
+CPU_BOOLEAN  AppTlm_Put      (APP_LOG_RING      *p_ring,        /* Producer side of 'p_ring'                            */
+                              CPU_INT08U         type,
+                              CPU_INT32U         ms,
+                              const void        *p_payload,
+                              CPU_INT32U         len);
+
+CPU_BOOLEAN  AppTlm_Sample   (APP_LOG_RING      *p_ring,
+                              CPU_INT32U         ms,
+                              CPU_INT16S         temperature,
+                              CPU_INT16S         threshold,
+                              CPU_INT08U         alarm,
+                              CPU_INT32U         alarms,
+                              CPU_INT16U         period_ms);
+
+CPU_BOOLEAN  AppTlm_Button   (APP_LOG_RING      *p_ring,
+                              CPU_INT32U         ms,
+                              CPU_INT08U         button,
+                              CPU_INT16S         threshold,
+                              CPU_INT32U         latency_us);
+
+CPU_BOOLEAN  AppTlm_Counters (APP_LOG_RING      *p_ring,
+                              CPU_INT32U         ms,
+                              const CPU_INT32U  *p_ctr);        /* APP_TLM_COUNTERS_SIZE / 4 counters, in order         */
+
+CPU_BOOLEAN  AppTlm_Text     (APP_LOG_RING      *p_ring,        /* Split into records of APP_TLM_PAYLOAD_MAX bytes      */
+                              CPU_INT32U         ms,
+                              const CPU_CHAR    *str);
+
+CPU_INT16U   AppTlm_Get16    (const CPU_INT08U  *p);            /* Little-endian payload fields                         */
+CPU_INT32U   AppTlm_Get32    (const CPU_INT08U  *p);
+
+#endif
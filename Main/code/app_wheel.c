@@ -0,0 +1,290 @@
+/*
+*********************************************************************************************************
+*                                         PERIODIC JOB DISPATCHER
+*
+* Description : See app_wheel.h.
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  "app_wheel.h"
+
+
+/*
+*********************************************************************************************************
+*                                            HELPERS
+*********************************************************************************************************
+*/
+
+static  CPU_BOOLEAN  AppWheel_IsDue (OS_TICK due, OS_TICK now)  /* due <= now, across the wrap of the tick counter      */
+{
+    return ((CPU_BOOLEAN)((OS_TICK)(now - due) < ((OS_TICK)1u << (sizeof(OS_TICK) * 8u - 1u))));
+}
+
+static  void  AppWheel_Link (APP_WHEEL      *p_wheel,
+                             APP_WHEEL_JOB  *p_job)
+{
+    APP_WHEEL_JOB  **pp_head = &p_wheel->Slot[p_job->Due & APP_WHEEL_MASK];
+
+
+    p_job->NextPtr = *pp_head;
+    *pp_head       = p_job;
+}
+
+static  void  AppWheel_Unlink (APP_WHEEL      *p_wheel,
+                               APP_WHEEL_JOB  *p_job)
+{
+    APP_WHEEL_JOB  **pp = &p_wheel->Slot[p_job->Due & APP_WHEEL_MASK];
+
+
+    while ((*pp != (APP_WHEEL_JOB *)0) && (*pp != p_job)) {
+        pp = &(*pp)->NextPtr;
+    }
+    if (*pp == p_job) {
+        *pp = p_job->NextPtr;
+    }
+    p_job->NextPtr = (APP_WHEEL_JOB *)0;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            RUN ONE JOB
+*
+* Description : Runs a job that is due and links it again at its next release.
+*
+* Note(s)     : 1) The job is unlinked while it runs, so it may add other jobs to the wheel.
+*********************************************************************************************************
+*/
+
+static  void  AppWheel_Serve (APP_WHEEL      *p_wheel,
+                              APP_WHEEL_JOB  *p_job,
+                              OS_TICK         now)
+{
+    OS_ERR   err;
+    CPU_TS   ts;
+    OS_TICK  next;
+    OS_TICK  end;
+
+
+    AppWheel_Unlink(p_wheel, p_job);
+    if ((OS_TICK)(now - p_job->Due) > p_job->LateMax) {
+        p_job->LateMax = (OS_TICK)(now - p_job->Due);
+    }
+
+    ts   = OS_TS_GET();
+    next = p_job->FnctPtr(p_job->ArgPtr);
+    ts   = (CPU_TS)(OS_TS_GET() - ts);
+    end  = OSTimeGet(&err);
+
+    p_job->Runs++;
+    if (ts / p_wheel->TsPerUs > p_job->ExecMaxUs) {
+        p_job->ExecMaxUs = (CPU_INT32U)(ts / p_wheel->TsPerUs);
+    }
+    if ((p_job->DeadlineTicks != 0u) && ((OS_TICK)(end - p_job->Due) > p_job->DeadlineTicks)) {
+        p_job->Misses++;
+    }
+
+    next       = (next > 0u) ? next : 1u;
+    p_job->Due = p_job->Due + next;                             /* Fixed rate...                                        */
+    if (AppWheel_IsDue(p_job->Due, end)) {
+        p_job->Due = end + next;                                /* ... unless it overran: skip the missed releases      */
+    }
+    AppWheel_Link(p_wheel, p_job);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           INITIALIZATION
+*
+* Description : Empties the wheel. 'p_tcb' is the task that will call AppWheel_Run(); it must have been
+*               created with a task queue of at least APP_WHEEL_Q_SIZE messages.
+*********************************************************************************************************
+*/
+
+void  AppWheel_Init (APP_WHEEL  *p_wheel,
+                     OS_TCB     *p_tcb)
+{
+    CPU_ERR     cpu_err;
+    OS_ERR      err;
+    CPU_INT32U  i;
+
+
+    for (i = 0u; i < APP_WHEEL_SLOTS; i++) {
+        p_wheel->Slot[i] = (APP_WHEEL_JOB *)0;
+    }
+    p_wheel->TcbPtr  = p_tcb;
+    p_wheel->Last    = OSTimeGet(&err);
+    p_wheel->Jobs    = 0u;
+    p_wheel->Wakeups = 0u;
+    p_wheel->TsPerUs = CPU_TS_TmrFreqGet(&cpu_err) / 1000000u;
+    if (p_wheel->TsPerUs == 0u) {
+        p_wheel->TsPerUs = 1u;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             ADD A JOB
+*
+* Description : Registers a job, first released 'first_ticks' after the last tick the wheel served.
+*
+* Argument(s) : p_wheel          the wheel.
+*
+*               p_job            storage of the job, owned by the caller for as long as the wheel runs.
+*
+*               p_name           name, for AppWheel_Format().
+*
+*               p_fnct           work of one release; returns the ticks until the next one.
+*
+*               p_arg            argument of 'p_fnct'.
+*
+*               first_ticks      delay of the first release, at least 1 tick.
+*
+*               deadline_ticks   a run that ends later than this after its release is a miss; 0: none.
+*
+* Return(s)   : none
+*********************************************************************************************************
+*/
+
+void  AppWheel_Add (APP_WHEEL       *p_wheel,
+                    APP_WHEEL_JOB   *p_job,
+                    const CPU_CHAR  *p_name,
+                    APP_WHEEL_FNCT   p_fnct,
+                    void            *p_arg,
+                    OS_TICK          first_ticks,
+                    OS_TICK          deadline_ticks)
+{
+    p_job->NamePtr       = p_name;
+    p_job->FnctPtr       = p_fnct;
+    p_job->ArgPtr        = p_arg;
+    p_job->DeadlineTicks = deadline_ticks;
+    p_job->Due           = p_wheel->Last + ((first_ticks > 0u) ? first_ticks : 1u);
+    p_job->Runs          = 0u;
+    p_job->Misses        = 0u;
+    p_job->Kicks         = 0u;
+    p_job->LateMax       = 0u;
+    p_job->ExecMaxUs     = 0u;
+    AppWheel_Link(p_wheel, p_job);
+    p_wheel->Jobs++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            DISPATCHER
+*
+* Description : Body of the dispatching task. Each round:
+*
+*               - serves the slots of the ticks since the last round, running the jobs of each slot that
+*                 are due (a slot also holds jobs due in later turns of the wheel);
+*               - finds the nearest due tick and pends on the task queue until then, or until a kick.
+*
+* Note(s)     : 1) A round that comes a whole turn or more after the previous one serves every slot once.
+*               2) The nearest due tick comes from one pass over the slots, so finding it does not depend
+*                  on how far away it is.
+*********************************************************************************************************
+*/
+
+void  AppWheel_Run (APP_WHEEL  *p_wheel)
+{
+    OS_ERR          err;
+    OS_MSG_SIZE     msg_size;
+    CPU_TS          ts;
+    OS_TICK         now;
+    OS_TICK         t;
+    OS_TICK         dly;
+    APP_WHEEL_JOB  *p_job;
+    CPU_INT32U      i;
+
+
+    while (1) {
+        now = OSTimeGet(&err);
+        if ((OS_TICK)(now - p_wheel->Last) >= APP_WHEEL_SLOTS) {
+            p_wheel->Last = now - APP_WHEEL_SLOTS;
+        }
+        for (t = p_wheel->Last + 1u; AppWheel_IsDue(t, now); t++) {
+            p_job = p_wheel->Slot[t & APP_WHEEL_MASK];
+            while (p_job != (APP_WHEEL_JOB *)0) {
+                if (AppWheel_IsDue(p_job->Due, now)) {
+                    AppWheel_Serve(p_wheel, p_job, now);
+                    p_job = p_wheel->Slot[t & APP_WHEEL_MASK];  /* The list changed, start over                         */
+                } else {
+                    p_job = p_job->NextPtr;
+                }
+            }
+        }
+        p_wheel->Last = now;
+
+        dly = 0u;                                               /* Nearest due tick; 0 = none, wait for a kick          */
+        for (i = 0u; i < APP_WHEEL_SLOTS; i++) {
+            for (p_job = p_wheel->Slot[i]; p_job != (APP_WHEEL_JOB *)0; p_job = p_job->NextPtr) {
+                t = AppWheel_IsDue(p_job->Due, now) ? 1u : (OS_TICK)(p_job->Due - now);
+                if ((dly == 0u) || (t < dly)) {
+                    dly = t;
+                }
+            }
+        }
+
+        p_job = (APP_WHEEL_JOB *)OSTaskQPend(dly, OS_OPT_PEND_BLOCKING, &msg_size, &ts, &err);
+        p_wheel->Wakeups++;
+        if ((err == OS_ERR_NONE) && (p_job != (APP_WHEEL_JOB *)0)) {
+            now = OSTimeGet(&err);                              /* Kicked: due now, served in this round                */
+            AppWheel_Unlink(p_wheel, p_job);
+            p_job->Due = now;
+            p_job->Kicks++;
+            AppWheel_Link(p_wheel, p_job);
+            if (p_wheel->Last == now) {
+                p_wheel->Last = now - 1u;
+            }
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             KICK A JOB
+*
+* Description : Asks the dispatcher to release 'p_job' now, e.g. because its input changed. Safe from any
+*               task or interrupt; the job still runs in the dispatching task.
+*
+* Note(s)     : 1) With the queue full (APP_WHEEL_Q_SIZE kicks pending) 'p_err' is OS_ERR_Q_MAX and the
+*                  kick is lost; the job still runs at its next release.
+*********************************************************************************************************
+*/
+
+void  AppWheel_Kick (APP_WHEEL      *p_wheel,
+                     APP_WHEEL_JOB  *p_job,
+                     OS_ERR         *p_err)
+{
+    OSTaskQPost(p_wheel->TcbPtr, (void *)p_job, (OS_MSG_SIZE)sizeof(*p_job), OS_OPT_POST_FIFO, p_err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FORMAT STATISTICS
+*
+* Description : One line per job: runs, deadline misses, worst release delay and run time, kicks.
+*
+* Return(s)   : Length of the line.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  AppWheel_Format (const APP_WHEEL_JOB  *p_job,
+                             CPU_CHAR             *p_buf,
+                             CPU_INT32U            size)
+{
+    int  len;
+
+
+    len = snprintf((char *)p_buf, size,
+                   "job %-12s runs %7u  missed %5u (deadline %u t)  late max %4u t  exec max %6u us  kicks %u",
+                   (const char *)p_job->NamePtr, (unsigned)p_job->Runs, (unsigned)p_job->Misses,
+                   (unsigned)p_job->DeadlineTicks, (unsigned)p_job->LateMax, (unsigned)p_job->ExecMaxUs,
+                   (unsigned)p_job->Kicks);
+    return ((len < 0) ? 0u : ((CPU_INT32U)len < size) ? (CPU_INT32U)len : size - 1u);
+}
@@ -0,0 +1,106 @@
+/*
+*********************************************************************************************************
+*                                         PERIODIC JOB DISPATCHER
+*
+* Description : Runs the periodic work of the application as jobs of one task, on a hashed timer wheel,
+*               instead of one task (and one stack) per period.
+*
+*               A job is a function that does one round of its work and returns the number of ticks until
+*               its next release. Every job sits in the slot of the wheel given by the low bits of its
+*               due tick; AppWheel_Run() releases the jobs of the slots of the ticks that passed, then
+*               pends on its task queue until the next due tick, so the task only wakes up when a job is
+*               due. AppWheel_Kick() posts a job to that queue to release it at once.
+*
+*               Per job it counts the runs, the deadline misses (a run that ends more than DeadlineTicks
+*               after the job was due), the worst release delay and the worst run time.
+*
+* Note(s)     : 1) Jobs run one after the other at the priority of the dispatching task, which must have a
+*                  task queue (APP_WHEEL_Q_SIZE messages). A long job delays the ones due after it; that
+*                  shows as release delay and deadline misses.
+*               2) A job that returns 0 is released again one tick later.
+*               3) Releases are fixed-rate: the next due tick is counted from the one just served, not from
+*                  the end of the run. After an overrun the missed releases are skipped.
+*               4) Only the dispatching task touches the wheel; AppWheel_Add() is called before
+*                  AppWheel_Run(), or from a job. Other tasks and interrupts only call AppWheel_Kick().
+*********************************************************************************************************
+*/
+
+#ifndef  APP_WHEEL_H
+#define  APP_WHEEL_H
+
+#include  <Source/os.h>
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  APP_WHEEL_SLOTS          64u                           /* Ticks per turn of the wheel, must be a power of 2    */
+#define  APP_WHEEL_MASK          (APP_WHEEL_SLOTS - 1u)
+#define  APP_WHEEL_Q_SIZE          4u                           /* Kicks that can wait in the dispatcher's task queue   */
+#define  APP_WHEEL_LINE_SIZE     128u
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  OS_TICK  (*APP_WHEEL_FNCT)(void *p_arg);               /* Returns the ticks until the next release             */
+
+typedef  struct  app_wheel_job {
+    const CPU_CHAR          *NamePtr;
+    APP_WHEEL_FNCT           FnctPtr;
+    void                    *ArgPtr;
+    OS_TICK                  DeadlineTicks;                     /* 0: no deadline                                       */
+    OS_TICK                  Due;
+    struct  app_wheel_job   *NextPtr;                           /* In its slot                                          */
+
+    CPU_INT32U               Runs;                              /* Statistics                                           */
+    CPU_INT32U               Misses;
+    CPU_INT32U               Kicks;
+    OS_TICK                  LateMax;                           /* Release delay, in ticks                              */
+    CPU_INT32U               ExecMaxUs;
+} APP_WHEEL_JOB;
+
+typedef  struct {
+    APP_WHEEL_JOB           *Slot[APP_WHEEL_SLOTS];
+    OS_TCB                  *TcbPtr;                            /* Dispatching task                                     */
+    OS_TICK                  Last;                              /* Last tick whose slot was served                      */
+    CPU_INT32U               Jobs;
+    CPU_INT32U               Wakeups;
+    CPU_INT32U               TsPerUs;
+} APP_WHEEL;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void        AppWheel_Init   (APP_WHEEL            *p_wheel,     /* After OSInit()                                       */
+                             OS_TCB               *p_tcb);
+
+void        AppWheel_Add    (APP_WHEEL            *p_wheel,
+                             APP_WHEEL_JOB        *p_job,
+                             const CPU_CHAR       *p_name,
+                             APP_WHEEL_FNCT        p_fnct,
+                             void                 *p_arg,
+                             OS_TICK               first_ticks, /* First release, from now                              */
+                             OS_TICK               deadline_ticks);
+
+void        AppWheel_Run    (APP_WHEEL            *p_wheel);    /* From the dispatching task, does not return           */
+
+void        AppWheel_Kick   (APP_WHEEL            *p_wheel,     /* Releases 'p_job' now, from any task                  */
+                             APP_WHEEL_JOB        *p_job,
+                             OS_ERR               *p_err);
+
+CPU_INT32U  AppWheel_Format (const APP_WHEEL_JOB  *p_job,       /* Returns the length of the line                       */
+                             CPU_CHAR             *p_buf,
+                             CPU_INT32U            size);
+
+#endif
@@ -0,0 +1,335 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+------------------------------------------
+------------------------------------------
+--
+-- deep_record.vhd
+-- Deep capture memory: every ADC sample, not 1 out of hscale + 1, in a record of 2**record_bits samples
+-- The record is split in 2**segment_bits segments. Each trigger fills the next segment, from the sample
+-- that fired it; when the last one is full the record is complete and capture stops.
+-- At each vsync falling edge of a complete record, the view (1280 columns of 2**zoom samples from
+-- pan_pos) is reduced to the min and max of each column (peak detect) and written to the display memory,
+-- so a glitch narrower than a column still shows. This takes 1280 * 2**zoom clocks, at most 40960,
+-- which fits in the 41 blank lines before the first active one: the picture never tears.
+-- With hold = '0' capture re-arms after that; with hold = '1' the record is kept, and zoom and the pan
+-- buttons browse it, the view being rebuilt at every frame.
+-- data_max / data_min have the frame_buffers interface, for vga_control.
+-- Clock frequency required: 108 MHz
+-- Resetn: active low
+--
+------------------------------------------
+------------------------------------------
+
+
+entity deep_record is
+generic(
+    record_bits: natural := 16; -- 2**record_bits samples of 12 bits
+    segment_bits: natural := 0 -- 2**segment_bits segments, one per trigger, of 1280 samples or more
+);
+port(
+    clk: in std_logic; -- 108 MHz
+    resetn: in std_logic; -- active low
+    sample_ready: in std_logic; -- 1 clock pulse that denotes new input data
+    data1: in std_logic_vector(11 downto 0); -- input data from the ADC
+    trigger: in std_logic; -- 1 clock pulse, the trigger fired on the sample at data1
+    vsync: in std_logic; -- display vsync, the view is rebuilt when it falls
+    vscale: in std_logic_vector(1 downto 0); -- asynchronous input from switches, vertical scale
+    zoom: in std_logic_vector(2 downto 0); -- asynchronous input, 2**zoom samples per column
+    pan_left: in std_logic; -- asynchronous input from button, view 1/8 screen earlier
+    pan_right: in std_logic; -- asynchronous input from button, view 1/8 screen later
+    hold: in std_logic; -- asynchronous input from switch, 1 keeps the record
+    addr_out: in std_logic_vector(10 downto 0); -- column to read, from vga_control
+    data_max: out std_logic_vector(11 downto 0); -- highest sample of the column
+    data_min: out std_logic_vector(11 downto 0) -- lowest sample of the column
+);
+end deep_record;
+
+architecture arch of deep_record is
+    constant depth: natural := 2**record_bits;
+    constant segments: natural := 2**segment_bits;
+    constant seg_len: natural := 2**(record_bits - segment_bits);
+
+    -- largest zoom whose view fits in the record and whose reduction fits in the vertical blank
+    function zoom_limit return natural is
+        variable z: natural := 0;
+    begin
+        while (z < 5 and 1280 * 2**(z + 1) <= depth) loop
+            z := z + 1;
+        end loop;
+        return z;
+    end function;
+    constant zoom_max: natural := zoom_limit;
+
+    -- samples per column at zoom z, as a table: z is not a constant
+    function per_col(z: natural) return natural is
+    begin
+        case z is
+            when 0 => return 1;
+            when 1 => return 2;
+            when 2 => return 4;
+            when 3 => return 8;
+            when 4 => return 16;
+            when others => return 32;
+        end case;
+    end function;
+
+    type capture_states is (armed, capturing, full);
+    signal state: capture_states;
+    signal seg: natural range 0 to segments - 1; -- segment being filled
+    signal count: natural range 0 to seg_len - 1; -- next sample of the segment
+    signal rec_we: std_logic;
+    signal rec_addr: std_logic_vector(record_bits - 1 downto 0);
+    signal rec_data: std_logic_vector(11 downto 0);
+
+    signal reducing: std_logic; -- 1 while the view is reduced
+    signal rearm: std_logic; -- 1 clock pulse, the view of a complete record was reduced
+    signal vsync_prev: std_logic;
+    signal rd_addr: std_logic_vector(record_bits - 1 downto 0);
+    signal rd_data: std_logic_vector(11 downto 0);
+    signal issued: natural range 0 to 1280; -- columns whose reads are all issued
+    signal n: natural range 0 to 31; -- next sample of the column to read
+    signal n_last: natural range 0 to 31; -- samples per column - 1
+    signal valid, first, last: std_logic; -- about rd_data: a sample, first / last of its column
+    signal col: std_logic_vector(10 downto 0); -- column being reduced
+    signal lo, hi: std_logic_vector(11 downto 0);
+    signal shift: natural range 0 to 3; -- vscale of this view
+    signal step: natural range 0 to 160 * 32; -- pan step, 1/8 of the view
+    signal view: natural range 0 to 1280 * 32; -- samples in the view
+    signal pan_pos: natural range 0 to depth - 1; -- first sample of the view
+
+    type disp_type is array (2047 downto 0) of std_logic_vector(23 downto 0);
+    signal disp: disp_type := (others => (others => '0'));
+    signal disp_we: std_logic;
+    signal disp_addr: std_logic_vector(10 downto 0);
+    signal disp_word: std_logic_vector(23 downto 0);
+
+    -- inputs process signals
+    signal vscale_r, vscale_rr: std_logic_vector(1 downto 0);
+    signal zoom_r, zoom_rr: std_logic_vector(2 downto 0);
+    signal hold_r, hold_rr: std_logic;
+    signal left, leftt, lefttt: std_logic;
+    signal right, rightt, righttt: std_logic;
+
+    component sync_ram_dualport is
+        generic (
+            data_width : natural := 12;
+            addr_width : natural := 11);
+        port(
+            clk_in : in std_logic;
+            clk_out : in std_logic;
+            we : in std_logic ;
+            addr_in : in std_logic_vector(addr_width - 1 downto 0) ;
+            addr_out : in std_logic_vector(addr_width - 1 downto 0) ;
+            data_in : in std_logic_vector(data_width - 1 downto 0) ;
+            data_out : out std_logic_vector(data_width - 1 downto 0)
+        );
+    end component;
+begin
+
+-- the view at zoom 0 is one segment wide at most: pan_pos goes below 0 otherwise
+assert seg_len >= 1280
+    report "deep_record: 2**(record_bits - segment_bits) must be at least 1280 samples"
+    severity failure;
+
+
+capture: process(clk)
+begin
+    if (clk'event and clk='1') then
+        if (resetn = '0') then -- sync reset
+            state <= armed;
+            seg <= 0;
+            count <= 0;
+            rec_we <= '0';
+        else
+            rec_we <= '0';
+            case (state) is
+                when armed =>     if (trigger = '1') then -- the sample that fired is the first one
+                                      rec_we <= '1';
+                                      rec_addr <= std_logic_vector(to_unsigned(seg * seg_len, record_bits));
+                                      rec_data <= data1;
+                                      count <= 1;
+                                      state <= capturing;
+                                  end if;
+                when capturing => if (sample_ready = '1') then
+                                      rec_we <= '1';
+                                      rec_addr <= std_logic_vector(to_unsigned(seg * seg_len + count, record_bits));
+                                      rec_data <= data1;
+                                      if (count = seg_len - 1) then -- segment full
+                                          count <= 0;
+                                          if (seg = segments - 1) then
+                                              seg <= 0;
+                                              state <= full;
+                                          else
+                                              seg <= seg + 1;
+                                              state <= armed;
+                                          end if;
+                                      else
+                                          count <= count + 1;
+                                      end if;
+                                  end if;
+                when full =>      if (rearm = '1') then
+                                      state <= armed;
+                                  end if;
+            end case;
+        end if;
+    end if;
+end process;
+
+record_memory: sync_ram_dualport generic map (data_width => 12,
+                                              addr_width => record_bits)
+                                 port map (clk_in => clk,
+                                           clk_out => clk,
+                                           we => rec_we,
+                                           addr_in => rec_addr,
+                                           addr_out => rd_addr,
+                                           data_in => rec_data,
+                                           data_out => rd_data
+);
+
+
+-- reads the view from the record, one sample a clock; rd_data comes one clock after rd_addr
+reduce: process(clk)
+    variable zz: natural range 0 to 7;
+begin
+    if (clk'event and clk='1') then
+        if (resetn = '0') then -- sync reset
+            reducing <= '0';
+            rearm <= '0';
+            vsync_prev <= '1';
+            valid <= '0';
+            disp_we <= '0';
+            pan_pos <= 0;
+            step <= 160;
+            view <= 1280;
+        else
+            rearm <= '0';
+            disp_we <= '0';
+            vsync_prev <= vsync;
+
+            -- pan buttons, kept inside the record, used by the next view
+            if (lefttt = '0' and leftt = '1') then
+                if (pan_pos >= step) then
+                    pan_pos <= pan_pos - step;
+                else
+                    pan_pos <= 0;
+                end if;
+            elsif (righttt = '0' and rightt = '1') then
+                if (pan_pos + step <= depth - view) then
+                    pan_pos <= pan_pos + step;
+                else
+                    pan_pos <= depth - view;
+                end if;
+            end if;
+
+            if (reducing = '0') then
+                if (vsync = '0' and vsync_prev = '1' and state = full) then -- start of the vertical blank
+                    zz := conv_integer(zoom_rr);
+                    if (zz > zoom_max) then
+                        zz := zoom_max;
+                    end if;
+                    n_last <= per_col(zz) - 1;
+                    step <= 160 * per_col(zz);
+                    view <= 1280 * per_col(zz);
+                    shift <= conv_integer(vscale_rr);
+                    if (pan_pos > depth - 1280 * per_col(zz)) then -- after a zoom out
+                        pan_pos <= depth - 1280 * per_col(zz);
+                        rd_addr <= std_logic_vector(to_unsigned(depth - 1280 * per_col(zz), record_bits));
+                    else
+                        rd_addr <= std_logic_vector(to_unsigned(pan_pos, record_bits));
+                    end if;
+                    issued <= 0;
+                    n <= 0;
+                    col <= (others => '0');
+                    reducing <= '1';
+                end if;
+                valid <= '0';
+            elsif (issued = 1280) then -- all read, the last sample arrives now
+                valid <= '0';
+                if (valid = '0') then
+                    reducing <= '0';
+                    if (hold_rr = '0') then
+                        rearm <= '1';
+                    end if;
+                end if;
+            else
+                rd_addr <= rd_addr + 1;
+                valid <= '1';
+                if (n = 0) then
+                    first <= '1';
+                else
+                    first <= '0';
+                end if;
+                if (n = n_last) then
+                    last <= '1';
+                    n <= 0;
+                    issued <= issued + 1;
+                else
+                    last <= '0';
+                    n <= n + 1;
+                end if;
+            end if;
+
+            -- min and max of the column
+            if (valid = '1') then
+                if (first = '1' or rd_data > hi) then
+                    hi <= rd_data;
+                end if;
+                if (first = '1' or rd_data < lo) then
+                    lo <= rd_data;
+                end if;
+            end if;
+            if (valid = '1' and last = '1') then
+                disp_we <= '1';
+                disp_addr <= col;
+                col <= col + 1;
+            end if;
+        end if;
+    end if;
+end process;
+
+-- lo and hi are complete one clock after the last sample of the column, when disp_we is set
+disp_word <= std_logic_vector(shift_right(unsigned(hi), shift)) & std_logic_vector(shift_right(unsigned(lo), shift));
+
+display_write: process(clk)
+begin
+    if (clk'event and clk='1') then
+        if (disp_we = '1') then
+            disp(conv_integer(disp_addr)) <= disp_word;
+        end if;
+    end if;
+end process;
+
+display_read: process(clk)
+    variable word: std_logic_vector(23 downto 0);
+begin
+    if (clk'event and clk='1') then
+        word := disp(conv_integer(addr_out));
+        data_max <= word(23 downto 12);
+        data_min <= word(11 downto 0);
+    end if;
+end process;
+
+
+inputs: process(clk) -- synchronizers, as in trigger_controller
+begin
+    if (clk'event and clk='1') then
+        vscale_r <= vscale;
+        vscale_rr <= vscale_r;
+        zoom_r <= zoom;
+        zoom_rr <= zoom_r;
+        hold_r <= hold;
+        hold_rr <= hold_r;
+        left <= pan_left;
+        leftt <= left;
+        lefttt <= leftt;
+        right <= pan_right;
+        rightt <= right;
+        righttt <= rightt;
+    end if;
+end process;
+
+
+end arch;
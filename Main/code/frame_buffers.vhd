@@ -0,0 +1,193 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+
+------------------------------------------
+------------------------------------------
+--
+-- frame_buffers.vhd
+-- Capture memory in three banks of 2048 words, so the sweep being written is never the one on screen
+-- The trigger controller writes the write bank. When it stores the last sample of a sweep (address 1280)
+-- that bank becomes the ready bank and the previous ready bank is written next. When vsync falls, the
+-- display takes the ready bank if it holds a newer sweep, and gives its own bank back.
+-- The swap happens in the vertical retrace, so a picture always shows one whole sweep.
+-- persistence: with a value above 1, a bank keeps the lowest and highest sample of each column over
+-- that many sweeps before it is handed to the display (overlay). The write is then a read-modify-write,
+-- which needs the trigger controller writes to be at least 2 clocks apart (they are).
+-- Clock frequency required: 108 MHz
+-- Resetn: active low
+--
+------------------------------------------
+------------------------------------------
+
+
+entity frame_buffers is
+generic(
+    persistence: natural := 1 -- sweeps overlaid in one picture, 1 for none
+);
+port(
+    clk: in std_logic; -- 108 MHz
+    resetn: in std_logic; -- active low
+    vsync: in std_logic; -- display vsync, the display bank changes when it falls
+    we: in std_logic; -- write enable, from the trigger controller
+    addr_in: in std_logic_vector(10 downto 0); -- address to write data_in
+    data_in: in std_logic_vector(11 downto 0); -- data to write
+    addr_out: in std_logic_vector(10 downto 0); -- address to read, from vga_control
+    data_max: out std_logic_vector(11 downto 0); -- sample at addr_out, highest one with persistence
+    data_min: out std_logic_vector(11 downto 0) -- same as data_max, lowest one with persistence
+);
+end frame_buffers;
+
+architecture arch of frame_buffers is
+    signal wr_bank: std_logic_vector(1 downto 0); -- bank being written
+    signal rdy_bank: std_logic_vector(1 downto 0); -- last complete bank
+    signal rd_bank: std_logic_vector(1 downto 0); -- bank on screen
+    signal rdy_new: std_logic; -- 1 if rdy_bank holds a sweep that has not been shown
+    signal vsync_prev: std_logic; -- to detect the falling edge of vsync
+    signal merged: natural range 0 to persistence - 1; -- sweeps already stored in wr_bank
+
+    signal addr_wr: std_logic_vector(12 downto 0); -- bank & address, write side
+    signal addr_rd: std_logic_vector(12 downto 0); -- bank & address, display side
+
+    component sync_ram_dualport is
+        generic (
+            data_width : natural := 12;
+            addr_width : natural := 11);
+        port(
+            clk_in : in std_logic;
+            clk_out : in std_logic;
+            we : in std_logic ;
+            addr_in : in std_logic_vector(addr_width - 1 downto 0) ;
+            addr_out : in std_logic_vector(addr_width - 1 downto 0) ;
+            data_in : in std_logic_vector(data_width - 1 downto 0) ;
+            data_out : out std_logic_vector(data_width - 1 downto 0)
+        );
+    end component;
+begin
+
+
+banks: process(clk)
+    variable wr, rdy, rd: std_logic_vector(1 downto 0);
+    variable fresh: std_logic;
+begin
+    if (clk'event and clk='1') then
+        if (resetn = '0') then -- sync reset
+            wr_bank <= "00";
+            rdy_bank <= "01";
+            rd_bank <= "10";
+            rdy_new <= '0';
+            vsync_prev <= '1';
+            merged <= 0;
+        else
+            wr := wr_bank;
+            rdy := rdy_bank;
+            rd := rd_bank;
+            fresh := rdy_new;
+            if (we = '1' and addr_in = 1280) then -- last sample of a sweep, written to wr_bank at this edge
+                if (merged = persistence - 1) then -- the bank is complete, it becomes the ready one
+                    wr := rdy_bank;
+                    rdy := wr_bank;
+                    fresh := '1';
+                    merged <= 0;
+                else
+                    merged <= merged + 1;
+                end if;
+            end if;
+            if (vsync = '0' and vsync_prev = '1' and fresh = '1') then -- frame boundary, show the newest sweep
+                rd := rdy; -- rdy, not rdy_bank: a sweep may have completed at this same edge
+                rdy := rd_bank;
+                fresh := '0';
+            end if;
+            vsync_prev <= vsync;
+            wr_bank <= wr;
+            rdy_bank <= rdy;
+            rd_bank <= rd;
+            rdy_new <= fresh;
+        end if;
+    end if;
+end process;
+
+addr_wr <= wr_bank & addr_in;
+addr_rd <= rd_bank & addr_out;
+
+
+-- one sweep per picture: the memory of the single-buffered design, four times deeper
+plain: if persistence = 1 generate
+    signal data_out: std_logic_vector(11 downto 0);
+begin
+    memory: sync_ram_dualport generic map (data_width => 12,
+                                           addr_width => 13)
+                              port map (clk_in => clk,
+                                        clk_out => clk,
+                                        we => we,
+                                        addr_in => addr_wr,
+                                        addr_out => addr_rd,
+                                        data_in => data_in,
+                                        data_out => data_out
+    );
+    data_max <= data_out;
+    data_min <= data_out;
+end generate;
+
+
+-- overlay: each word holds max & min, port A reads the word at the edge that sees we and writes it back
+-- merged at the next one, port B is the display
+overlay: if persistence > 1 generate
+    type mem_type is array (2**13 - 1 downto 0) of std_logic_vector(23 downto 0);
+    signal mem: mem_type := (others => (others => '0'));
+    signal pending: std_logic; -- a merged word is written at the next edge
+    signal first: std_logic; -- the sweep is the first one in its bank, it overwrites the word
+    signal addr_a: std_logic_vector(12 downto 0);
+    signal addr_p: std_logic_vector(12 downto 0); -- address of the pending word
+    signal data_p: std_logic_vector(11 downto 0); -- sample of the pending word
+    signal word_a: std_logic_vector(23 downto 0); -- word read by port A
+    signal word_b: std_logic_vector(23 downto 0); -- word read by port B
+    signal hi, lo: std_logic_vector(11 downto 0);
+begin
+    addr_a <= addr_p when pending = '1' else addr_wr;
+    hi <= data_p when (first = '1' or data_p > word_a(23 downto 12)) else word_a(23 downto 12);
+    lo <= data_p when (first = '1' or data_p < word_a(11 downto 0)) else word_a(11 downto 0);
+
+    port_a: process(clk)
+    begin
+        if (clk'event and clk='1') then
+            if (pending = '1') then
+                mem(conv_integer(addr_a)) <= hi & lo;
+            end if;
+            word_a <= mem(conv_integer(addr_a));
+        end if;
+    end process;
+
+    merge: process(clk)
+    begin
+        if (clk'event and clk='1') then
+            if (resetn = '0') then -- sync reset
+                pending <= '0';
+            else
+                pending <= we;
+                if (we = '1') then
+                    addr_p <= addr_wr;
+                    data_p <= data_in;
+                    if (merged = 0) then
+                        first <= '1';
+                    else
+                        first <= '0';
+                    end if;
+                end if;
+            end if;
+        end if;
+    end process;
+
+    port_b: process(clk)
+    begin
+        if (clk'event and clk='1') then
+            word_b <= mem(conv_integer(addr_rd));
+        end if;
+    end process;
+
+    data_max <= word_b(23 downto 12);
+    data_min <= word_b(11 downto 0);
+end generate;
+
+
+end arch;
@@ -0,0 +1,254 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                 uC/OS-III kernel interface (subset)
+*
+* Description : Stand-in for <Source/os.h> so that app.c builds and runs on a Linux host. Only the
+*               services used by the application are provided. Every task is backed by a POSIX thread,
+*               but exactly one of them holds the (virtual) CPU at any time and the scheduler hands it
+*               to the highest priority ready task, as the real kernel does. Time is virtual: whenever
+*               every task is blocked the clock jumps to the next wake-up, so the application runs
+*               much faster than real time. See host/sim.c.
+*********************************************************************************************************
+*/
+
+#ifndef  OS_H
+#define  OS_H
+
+#include  <pthread.h>
+#include  <stdint.h>
+
+
+/*
+*********************************************************************************************************
+*                                              DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  char            CPU_CHAR;
+typedef  uint8_t         CPU_BOOLEAN;
+typedef  uint8_t         CPU_INT08U;
+typedef  uint16_t        CPU_INT16U;
+typedef  int16_t         CPU_INT16S;
+typedef  uint32_t        CPU_INT32U;
+typedef  int32_t         CPU_INT32S;
+typedef  uint64_t        CPU_INT64U;
+typedef  int64_t         CPU_INT64S;
+typedef  uint32_t        CPU_TS;
+typedef  uint32_t        CPU_STK;
+typedef  uint32_t        CPU_STK_SIZE;
+typedef  uint32_t        CPU_TS32;
+typedef  uint32_t        CPU_TS_TMR_FREQ;
+typedef  uint16_t        CPU_ERR;
+typedef  uintptr_t       CPU_ADDR;
+typedef  uint32_t        CPU_SR;
+
+typedef  uint8_t         OS_PRIO;
+typedef  uint16_t        OS_OPT;
+typedef  uint16_t        OS_MSG_QTY;
+typedef  uint16_t        OS_MSG_SIZE;
+typedef  uint32_t        OS_TICK;
+typedef  uint32_t        OS_ERR;
+typedef  uint32_t        OS_CTR;
+typedef  uint32_t        OS_SEM_CTR;
+
+typedef  void          (*OS_TASK_PTR)(void *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                              CONSTANTS
+*********************************************************************************************************
+*/
+
+#define  DEF_FALSE                           0u
+#define  DEF_TRUE                            1u
+
+#define  OS_TS_GET()                     ((CPU_TS)CPU_TS_Get32())
+
+#define  CPU_SR_ALLOC()                   CPU_SR  cpu_sr = (CPU_SR)0
+#define  CPU_CRITICAL_ENTER()             do { (void)cpu_sr; } while (0)    /* A task only loses the CPU in a kernel */
+#define  CPU_CRITICAL_EXIT()              do { (void)cpu_sr; } while (0)    /* call, so there is nothing to mask     */
+
+#define  OS_CFG_TICK_RATE_HZ             1000u
+#define  OS_CFG_PRIO_MAX                   64u
+
+#define  OS_OPT_NONE                   0x0000u
+#define  OS_OPT_TASK_STK_CHK           0x0001u
+#define  OS_OPT_TASK_STK_CLR           0x0002u
+
+#define  OS_OPT_TIME_DLY               0x0000u
+#define  OS_OPT_TIME_PERIODIC          0x0008u
+#define  OS_OPT_TIME_HMSM_STRICT       0x0000u
+#define  OS_OPT_TIME_HMSM_NON_STRICT   0x0010u
+
+#define  OS_OPT_PEND_BLOCKING          0x0000u
+#define  OS_OPT_PEND_NON_BLOCKING      0x8000u
+#define  OS_OPT_POST_NONE              0x0000u
+#define  OS_OPT_POST_FIFO              0x0000u
+
+#define  OS_ERR_NONE                       0u
+#define  OS_ERR_MUTEX_NOT_OWNER        22002u
+#define  OS_ERR_OBJ_TYPE               24004u
+#define  OS_ERR_PEND_WOULD_BLOCK       25008u
+#define  OS_ERR_Q_MAX                  26201u
+#define  OS_ERR_TASK_OPT               28001u
+#define  OS_ERR_TASK_NOT_DLY           28009u
+#define  OS_ERR_TIMEOUT                29401u
+
+
+/*
+*********************************************************************************************************
+*                                          KERNEL OBJECTS
+*
+* Note(s) : The 'Sim...' members belong to the host backend and must not be touched by the application.
+*********************************************************************************************************
+*/
+
+typedef  struct  os_tcb    OS_TCB;
+typedef  struct  os_mutex  OS_MUTEX;
+
+struct  os_tcb {
+    CPU_CHAR        *NamePtr;
+    OS_PRIO          Prio;                                      /* Base priority                                        */
+    OS_PRIO          SimPrioEff;                                /* Effective priority (raised by mutex inheritance)     */
+    OS_TASK_PTR      SimTaskPtr;
+    void            *SimArg;
+    CPU_STK         *StkBasePtr;
+    CPU_STK_SIZE     StkSize;
+    OS_OPT           Opt;
+    void            *ExtPtr;                                    /* TCB extension, 'p_ext' of OSTaskCreate()             */
+    OS_CTR           CtxSwCtr;                                  /* Times the task was switched in                       */
+    OS_SEM_CTR       SemCtr;                                    /* Task semaphore                                       */
+
+    int              SimState;
+    OS_TICK          SimWakeTick;                               /* Virtual tick at which a delayed task becomes ready   */
+    OS_TICK          SimNominalTick;                            /* Requested release, to measure release jitter          */
+    OS_MUTEX        *SimPendOn;
+    struct os_msg   *SimQ;                                      /* Task message queue, 'q_size' entries                 */
+    OS_MSG_QTY       SimQSize;
+    OS_MSG_QTY       SimQIn;
+    OS_MSG_QTY       SimQLen;
+    pthread_t        SimThread;
+    CPU_INT08U      *SimStkMem;                                 /* Host stack of the thread, cleared before it starts   */
+    CPU_INT08U      *SimStkTop;                                 /* Frame of the task function                           */
+    pthread_cond_t   SimCond;
+    OS_TCB          *SimNext;
+
+    CPU_INT64U       SimRunNs;                                  /* Host CPU time accumulated in the current loop body   */
+    CPU_INT64U       SimSliceStartNs;
+    CPU_INT64U       SimLoops;                                  /* Loop statistics, one sample per OSTimeDly...() call  */
+    CPU_INT64U       SimLoopMinNs;
+    CPU_INT64U       SimLoopMaxNs;
+    double           SimLoopSumNs;
+    double           SimLoopSumSqNs;
+    OS_TICK          SimLateMaxTicks;
+};
+
+struct  os_msg {
+    void            *MsgPtr;
+    OS_MSG_SIZE      MsgSize;
+    CPU_TS           MsgTS;                                     /* Time stamp of the post                               */
+};
+
+struct  os_mutex {
+    CPU_CHAR        *NamePtr;
+    int              SimCreated;
+    OS_TCB          *SimOwner;
+    OS_CTR           SimNesting;
+};
+
+
+/*
+*********************************************************************************************************
+*                                          GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+extern  OS_TCB  *OSTCBCurPtr;                                   /* Task currently holding the CPU                       */
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void     OSInit          (OS_ERR       *p_err);
+void     OSStart         (OS_ERR       *p_err);
+
+void     OSTaskCreate    (OS_TCB       *p_tcb,
+                          CPU_CHAR     *p_name,
+                          OS_TASK_PTR   p_task,
+                          void         *p_arg,
+                          OS_PRIO       prio,
+                          CPU_STK      *p_stk_base,
+                          CPU_STK_SIZE  stk_limit,
+                          CPU_STK_SIZE  stk_size,
+                          OS_MSG_QTY    q_size,
+                          OS_TICK       time_quanta,
+                          void         *p_ext,
+                          OS_OPT        opt,
+                          OS_ERR       *p_err);
+
+void     OSTaskStkChk    (OS_TCB       *p_tcb,
+                          CPU_STK_SIZE *p_free,
+                          CPU_STK_SIZE *p_used,
+                          OS_ERR       *p_err);
+
+void     OSTimeDly       (OS_TICK       dly,
+                          OS_OPT        opt,
+                          OS_ERR       *p_err);
+
+void     OSTimeDlyHMSM   (CPU_INT16U    hours,
+                          CPU_INT16U    minutes,
+                          CPU_INT16U    seconds,
+                          CPU_INT32U    milli,
+                          OS_OPT        opt,
+                          OS_ERR       *p_err);
+
+void     OSTimeDlyResume (OS_TCB       *p_tcb,
+                          OS_ERR       *p_err);
+
+OS_TICK  OSTimeGet       (OS_ERR       *p_err);
+
+void    *OSTaskQPend     (OS_TICK       timeout,
+                          OS_OPT        opt,
+                          OS_MSG_SIZE  *p_msg_size,
+                          CPU_TS       *p_ts,
+                          OS_ERR       *p_err);
+
+void     OSTaskQPost     (OS_TCB       *p_tcb,
+                          void         *p_void,
+                          OS_MSG_SIZE   msg_size,
+                          OS_OPT        opt,
+                          OS_ERR       *p_err);
+
+OS_SEM_CTR  OSTaskSemPend (OS_TICK     timeout,
+                           OS_OPT      opt,
+                           CPU_TS     *p_ts,
+                           OS_ERR     *p_err);
+
+OS_SEM_CTR  OSTaskSemPost (OS_TCB     *p_tcb,
+                           OS_OPT      opt,
+                           OS_ERR     *p_err);
+
+void     OSMutexCreate   (OS_MUTEX     *p_mutex,
+                          CPU_CHAR     *p_name,
+                          OS_ERR       *p_err);
+
+void     OSMutexPend     (OS_MUTEX     *p_mutex,
+                          OS_TICK       timeout,
+                          OS_OPT        opt,
+                          CPU_TS       *p_ts,
+                          OS_ERR       *p_err);
+
+void     OSMutexPost     (OS_MUTEX     *p_mutex,
+                          OS_OPT        opt,
+                          OS_ERR       *p_err);
+
+CPU_TS32         CPU_TS_Get32      (void);                      /* Virtual time stamp, 1 ns resolution                  */
+CPU_TS_TMR_FREQ  CPU_TS_TmrFreqGet (CPU_ERR      *p_err);
+
+#endif
@@ -0,0 +1,393 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                   Benchmark suite, monitor task paths
+*
+* Description : The hot paths of the monitor, with the harness of bench.h:
+*
+*                   mon_sample          AppMon_Sample() over the channel table of app.c
+*                   state_publish       AppState_SetTemperature() and AppState_Publish(), the word changing
+*                                       at every call, so every call writes the GPIO
+*                   temp_job            the body of AppTempJob() in text mode: the sample, the five lines
+*                                       formatted and queued with AppPrint() (the alarm line when the
+*                                       alarm word changes), the output word published and the next
+*                                       period picked; the log ring is emptied after each, as
+*                                       AppTaskLog() does
+*                   print_ring_<t>      AppPrint() today: <t> threads queue the same 17-byte message,
+*                                       each in its own log ring, while one thread drains every ring
+*                                       to the UART
+*                   print_mutex_<t>     AppPrint() before the log rings: <t> threads send the message to
+*                                       the UART under one mutex
+*
+*               ns/op of the print benchmarks is wall time over the messages of all the threads. A
+*               message that finds its ring full is retried, so both designs deliver every message and
+*               both are bound by the line: the figure is the same for both, what differs is that the
+*               mutex makes the printing task itself wait for the UART.
+*
+* Build       : gcc -O2 -I . -I host host/app_bench.c host/bench.c app_mon.c app_temp.c app_state.c app_rate.c \
+*                   app_log.c -lpthread -o app_bench
+*
+* Usage       : app_bench [options of bench.h]
+*
+* Note(s)     : 1) The XADC and GPIO are replaced by the stubs below, not by host/sim.c: the kernel
+*                  simulation would put its scheduling in every figure.
+*               2) The UART is a memcpy() to a buffer followed by a wait of 10 bit times a byte at
+*                  BENCH_UART_BAUD, as the polled UCOS_Print() of the board takes. With -DBENCH_UART_BAUD=0
+*                  there is no wait and the two designs only differ by their locking: the mutex rows then
+*                  look faster, but do not compare with the board.
+*********************************************************************************************************
+*/
+
+#define  _GNU_SOURCE
+
+#include  <pthread.h>
+#include  <sched.h>
+#include  <stdatomic.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <time.h>
+
+#include  "app_log.h"
+#include  "app_mon.h"
+#include  "app_rate.h"
+#include  "app_state.h"
+#include  "bench.h"
+
+
+#define  BENCH_THREADS_MAX        4u
+#define  BENCH_MSG          "\n Temperature: 42"
+#define  BENCH_SINK_SIZE       4096u                            /* Stand-in for the UART, see Note 2                    */
+#ifndef  BENCH_UART_BAUD
+#define  BENCH_UART_BAUD      115200u                           /* 8N1, 0: no wait                                      */
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                          DEVICE STUBS
+*
+* Description : A temperature that walks between 40 and 60 C, the supplies at their nominal values.
+*********************************************************************************************************
+*/
+
+static  unsigned           BenchAdcStep;
+static  volatile u32       BenchGpioWord;
+
+u16  XAdcPs_GetAdcData (XAdcPs *InstancePtr, u8 Channel)
+{
+    unsigned  k = BenchAdcStep++ % 64u;
+
+
+    (void)InstancePtr;
+    switch (Channel) {
+        case XADCPS_CH_TEMP:   return ((u16)(0x9D00u + ((k < 32u) ? k : 63u - k) * 0x30u));   /* 40 .. 60 C     */
+        case XADCPS_CH_VCCINT:
+        case XADCPS_CH_VBRAM:  return (0x5555u);                                               /* 1.0 V          */
+        case XADCPS_CH_VCCAUX: return (0x9999u);                                               /* 1.8 V          */
+        default:               return ((u16)(k * 1024u));
+    }
+}
+
+void  XAdcPs_SetSequencerMode (XAdcPs *InstancePtr, u8 SequencerMode)    { (void)InstancePtr; (void)SequencerMode; }
+void  XAdcPs_SetAvg           (XAdcPs *InstancePtr, u8 Average)          { (void)InstancePtr; (void)Average; }
+
+int  XAdcPs_SetSeqAvgEnables (XAdcPs *InstancePtr, u32 AvgEnableChMask)
+{
+    (void)InstancePtr;
+    (void)AvgEnableChMask;
+    return (XST_SUCCESS);
+}
+
+int  XAdcPs_SetSeqChEnables (XAdcPs *InstancePtr, u32 ChEnableMask)
+{
+    (void)InstancePtr;
+    (void)ChEnableMask;
+    return (XST_SUCCESS);
+}
+
+void  XGpio_DiscreteWrite (XGpio *InstancePtr, unsigned Channel, u32 Data)
+{
+    (void)InstancePtr;
+    (void)Channel;
+    BenchGpioWord = Data;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        MONITOR TASK PATHS
+*********************************************************************************************************
+*/
+
+static  APP_MON_CH  BenchMonTbl[] = {                           /* As AppMonTbl in app.c                                */
+    { "TEMP",    XADCPS_CH_TEMP,    APP_MON_TEMP,     50, DEF_TRUE,   2, 0u, DEF_FALSE, 0u, 0 },
+    { "VCCINT",  XADCPS_CH_VCCINT,  APP_MON_SUPPLY,  950, DEF_FALSE, 10, 1u, DEF_FALSE, 0u, 0 },
+    { "VCCAUX",  XADCPS_CH_VCCAUX,  APP_MON_SUPPLY, 1710, DEF_FALSE, 10, 2u, DEF_FALSE, 0u, 0 },
+    { "VCCBRAM", XADCPS_CH_VBRAM,   APP_MON_SUPPLY,  950, DEF_FALSE, 10, 3u, DEF_FALSE, 0u, 0 },
+    { "VAUX0",   XADCPS_CH_AUX_MIN, APP_MON_EXT,     900, DEF_TRUE,  10, 4u, DEF_FALSE, 0u, 0 },
+};
+#define  BENCH_MON_N   (sizeof(BenchMonTbl) / sizeof(BenchMonTbl[0]))
+
+static  XAdcPs        BenchAdc;
+static  XGpio         BenchGpio;
+static  APP_STATE     BenchState;
+static  APP_RATE      BenchRate;
+static  APP_LOG_RING  BenchLog;
+
+
+static  void  BenchMonSample (void *p_arg, unsigned long n)
+{
+    unsigned long  i;
+    CPU_INT32U     acc = 0u;
+
+
+    (void)p_arg;
+    for (i = 0u; i < n; i++) {
+        acc += AppMon_Sample(&BenchAdc, BenchMonTbl, BENCH_MON_N);
+    }
+    Bench_Sink(acc);
+}
+
+static  void  BenchStatePublish (void *p_arg, unsigned long n)
+{
+    unsigned long  i;
+
+
+    (void)p_arg;
+    for (i = 0u; i < n; i++) {
+        AppState_SetTemperature(&BenchState, 40 + (int)(i & 15u), (int)(i & 1u));
+        AppState_Publish(&BenchState);
+    }
+}
+
+static  void  BenchPrint (const char *str)                      /* AppPrint() of a task with a log ring                 */
+{
+    (void)AppLog_Put(&BenchLog, str);
+}
+
+static  void  BenchTempJob (void *p_arg, unsigned long n)       /* AppTempJob(), APP_TLM_BINARY off                     */
+{
+    static  CPU_INT32U  alarms_prev;
+    CPU_CHAR            drain[APP_LOG_RING_SIZE];
+    CPU_INT32U          alarms;
+    CPU_INT32U          period_ms = 0u;
+    CPU_INT32U          k;
+    unsigned long       i;
+    char                alarms_string[64];
+    char                str[20];
+    int                 temperature;
+    int                 threshold = 50;
+    int                 alarm;
+
+
+    (void)p_arg;
+    for (i = 0u; i < n; i++) {
+        BenchMonTbl[0].Limit = threshold;
+        alarms      = AppMon_Sample(&BenchAdc, BenchMonTbl, BENCH_MON_N);
+        temperature = BenchMonTbl[0].Value;
+
+        sprintf(str, "%d", temperature);
+        BenchPrint("\n Temperature: ");
+        BenchPrint(str);
+        sprintf(str, "%u", temperature << 4);
+        BenchPrint("\n Temperature pixels: ");
+        BenchPrint(str);
+        sprintf(str, "%d", threshold & 0x7F);
+        BenchPrint("\n Threshold: ");
+        BenchPrint(str);
+        sprintf(str, "%u", (threshold & 0x7F) << 4);
+        BenchPrint("\n Threshold pixels: ");
+        BenchPrint(str);
+
+        alarm = (int)((alarms >> BenchMonTbl[0].AlarmBit) & 0x1u);
+        if (alarms != alarms_prev) {
+            alarms_string[0] = '\0';
+            for (k = 0u; k < BENCH_MON_N; k++) {
+                if ((alarms >> BenchMonTbl[k].AlarmBit) & 0x1u) {
+                    strcat(alarms_string, " ");
+                    strcat(alarms_string, BenchMonTbl[k].NamePtr);
+                }
+            }
+            BenchPrint("\n alarms:");
+            BenchPrint((alarms != 0u) ? alarms_string : " none");
+            alarms_prev = alarms;
+        }
+        sprintf(str, "%d", alarm);
+        BenchPrint("\n alarm: ");
+        BenchPrint(str);
+
+        AppState_SetTemperature(&BenchState, temperature, alarm);
+        AppState_Publish(&BenchState);
+        period_ms += AppRate_Next(&BenchRate, &BenchMonTbl[0], (CPU_INT32U)(i * 200u));
+
+        while (AppLog_Get(&BenchLog, drain, sizeof(drain)) > 0u) {
+        }
+    }
+    Bench_Sink(period_ms + (unsigned long)atomic_load(&BenchLog.Dropped));
+}
+
+
+/*
+*********************************************************************************************************
+*                                         PRINT CONTENTION
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    unsigned               Threads;
+    int                    Mutex;                               /* 1: the design before the log rings                   */
+    unsigned long          PerThread;
+    APP_LOG_RING           Rings[BENCH_THREADS_MAX];
+    pthread_mutex_t        Lock;
+    _Atomic unsigned       Running;                             /* Producers still running                              */
+    char                   Sink[BENCH_SINK_SIZE];
+    size_t                 SinkPos;
+} BENCH_PRINT;
+
+typedef  struct {
+    BENCH_PRINT  *PrintPtr;
+    unsigned      Ix;
+} BENCH_PRODUCER;
+
+static  unsigned long long  BenchNowNs (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec);
+}
+
+static  void  BenchSinkWrite (BENCH_PRINT *p_print, const char *p_buf, size_t len)   /* The "UART"             */
+{
+    unsigned long long  end;
+
+
+    if (p_print->SinkPos + len > sizeof(p_print->Sink)) {
+        p_print->SinkPos = 0u;
+    }
+    memcpy(&p_print->Sink[p_print->SinkPos], p_buf, len);
+    p_print->SinkPos += len;
+#if (BENCH_UART_BAUD > 0u)
+    end = BenchNowNs() + (unsigned long long)len * 10u * 1000000000ull / BENCH_UART_BAUD;
+    while (BenchNowNs() < end) {                                /* Polled, as UCOS_Print(): the CPU is not given up     */
+    }
+#else
+    (void)end;
+#endif
+}
+
+static  void  *BenchProducer (void *p_arg)
+{
+    BENCH_PRODUCER  *p_prod  = (BENCH_PRODUCER *)p_arg;
+    BENCH_PRINT     *p_print = p_prod->PrintPtr;
+    unsigned long    i;
+
+
+    for (i = 0u; i < p_print->PerThread; i++) {
+        if (p_print->Mutex) {
+            pthread_mutex_lock(&p_print->Lock);
+            BenchSinkWrite(p_print, BENCH_MSG, sizeof(BENCH_MSG) - 1u);
+            pthread_mutex_unlock(&p_print->Lock);
+        } else {
+            while (!AppLog_Put(&p_print->Rings[p_prod->Ix], BENCH_MSG)) {
+                sched_yield();                                  /* Full: let the log thread run                         */
+            }
+        }
+    }
+    atomic_fetch_sub(&p_print->Running, 1u);
+    return (NULL);
+}
+
+static  void  *BenchLogTask (void *p_arg)                       /* AppTaskLog(), without the delay between passes      */
+{
+    BENCH_PRINT  *p_print = (BENCH_PRINT *)p_arg;
+    CPU_CHAR      batch[APP_LOG_RING_SIZE];
+    CPU_INT32U    len;
+    CPU_INT32U    got;
+    unsigned      running;
+    unsigned      i;
+
+
+    do {
+        running = atomic_load(&p_print->Running);               /* Read before the pass: nothing is left behind         */
+        got     = 0u;
+        for (i = 0u; i < p_print->Threads; i++) {
+            while ((len = AppLog_Get(&p_print->Rings[i], batch, sizeof(batch))) > 0u) {
+                BenchSinkWrite(p_print, batch, len);
+                got += len;
+            }
+        }
+        if (got == 0u) {
+            sched_yield();                                      /* Idle: AppTaskLog() would sleep                       */
+        }
+    } while (running > 0u);
+    return (NULL);
+}
+
+static  void  BenchPrintRun (void *p_arg, unsigned long n)
+{
+    BENCH_PRINT     *p_print = (BENCH_PRINT *)p_arg;
+    BENCH_PRODUCER   prod[BENCH_THREADS_MAX];
+    pthread_t        th[BENCH_THREADS_MAX];
+    pthread_t        log;
+    unsigned         i;
+
+
+    p_print->PerThread = (n + p_print->Threads - 1u) / p_print->Threads;
+    atomic_store(&p_print->Running, p_print->Threads);
+    if (!p_print->Mutex) {
+        pthread_create(&log, NULL, BenchLogTask, p_print);
+    }
+    for (i = 0u; i < p_print->Threads; i++) {
+        prod[i].PrintPtr = p_print;
+        prod[i].Ix       = i;
+        pthread_create(&th[i], NULL, BenchProducer, &prod[i]);
+    }
+    for (i = 0u; i < p_print->Threads; i++) {
+        pthread_join(th[i], NULL);
+    }
+    if (!p_print->Mutex) {
+        pthread_join(log, NULL);
+    }
+    Bench_Sink(p_print->SinkPos);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    static  BENCH_PRINT  print;
+    static  char         names[2u * BENCH_THREADS_MAX][32];
+    unsigned             t;
+    unsigned             m;
+    unsigned             k = 0u;
+
+
+    Bench_Init(argc, argv, "app");
+    AppMon_Init(&BenchAdc, BenchMonTbl, BENCH_MON_N, XADCPS_AVG_64_SAMPLES, DEF_TRUE);
+    AppState_Init(&BenchState, &BenchGpio, 2u);
+    AppState_SetThreshold(&BenchState, 50);
+    AppRate_Init(&BenchRate, 20u, 1000u, 100u, 1000u, 200u);    /* APP_TEMP_... of app.c                                */
+    AppLog_Init(&BenchLog, "Task1");
+
+    Bench_Run("mon_sample",    BenchMonSample,    NULL);
+    Bench_Run("state_publish", BenchStatePublish, NULL);
+    Bench_Run("temp_job",      BenchTempJob,      NULL);
+
+    pthread_mutex_init(&print.Lock, NULL);
+    for (t = 0u; t < BENCH_THREADS_MAX; t++) {
+        AppLog_Init(&print.Rings[t], "bench");
+    }
+    for (m = 0u; m < 2u; m++) {
+        for (t = 1u; t <= BENCH_THREADS_MAX; t *= 2u) {
+            snprintf(names[k], sizeof(names[k]), "print_%s_%u", m ? "mutex" : "ring", t);
+            print.Threads = t;
+            print.Mutex   = (int)m;
+            Bench_Run(names[k++], BenchPrintRun, &print);
+        }
+    }
+    pthread_mutex_destroy(&print.Lock);
+    return (Bench_Done());
+}
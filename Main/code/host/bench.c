@@ -0,0 +1,401 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                          Benchmark harness
+*
+* Description : See bench.h.
+*
+* Build       : compiled with each suite, see host/app_bench.c and model/apbench.cpp.
+*********************************************************************************************************
+*/
+
+#define  _GNU_SOURCE
+
+#include  <linux/perf_event.h>
+#include  <stdatomic.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <sys/ioctl.h>
+#include  <sys/syscall.h>
+#include  <time.h>
+#include  <unistd.h>
+
+#include  "bench.h"
+
+
+#define  BENCH_MAX               64u                            /* Benchmarks per suite                                 */
+#define  BENCH_LINE_MAX        1024u
+#define  BENCH_PERF_N             4u
+
+
+static  const char           *BenchSuite;
+static  char                  BenchOut[256];
+static  const char           *BenchBaseline;
+static  const char           *BenchTag     = "";
+static  const char           *BenchFilter;
+static  double                BenchTolerance = 10.0;
+static  int                   BenchQuick;
+
+static  BENCH_RESULT          BenchRes[BENCH_MAX];
+static  unsigned              BenchN;
+
+static  int                   BenchPerfFd[BENCH_PERF_N] = { -1, -1, -1, -1 };
+static  const unsigned long   BenchPerfCfg[BENCH_PERF_N] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static  _Atomic unsigned long BenchAllocs;
+static  _Atomic unsigned long BenchBytes;
+static  volatile unsigned long BenchSinkVal;
+
+
+/*
+*********************************************************************************************************
+*                                        ALLOCATION COUNTERS
+*********************************************************************************************************
+*/
+
+extern  void  *__libc_malloc  (size_t size);
+extern  void  *__libc_calloc  (size_t n, size_t size);
+extern  void  *__libc_realloc (void *p, size_t size);
+
+void  *malloc (size_t size)
+{
+    atomic_fetch_add_explicit(&BenchAllocs, 1u,   memory_order_relaxed);
+    atomic_fetch_add_explicit(&BenchBytes,  size, memory_order_relaxed);
+    return (__libc_malloc(size));
+}
+
+void  *calloc (size_t n, size_t size)
+{
+    atomic_fetch_add_explicit(&BenchAllocs, 1u,       memory_order_relaxed);
+    atomic_fetch_add_explicit(&BenchBytes,  n * size, memory_order_relaxed);
+    return (__libc_calloc(n, size));
+}
+
+void  *realloc (void *p, size_t size)
+{
+    atomic_fetch_add_explicit(&BenchAllocs, 1u,   memory_order_relaxed);
+    atomic_fetch_add_explicit(&BenchBytes,  size, memory_order_relaxed);
+    return (__libc_realloc(p, size));
+}
+
+
+/*
+*********************************************************************************************************
+*                                          PERF COUNTERS
+*
+* Description : One counter per event, not a group: a group cannot be inherited by the threads a benchmark
+*               starts. The counts of a thread are added when it exits, so a benchmark joins its threads.
+*********************************************************************************************************
+*/
+
+static  void  BenchPerfOpen (void)
+{
+    struct perf_event_attr  attr;
+    unsigned                i;
+
+
+    for (i = 0u; i < BENCH_PERF_N; i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = BenchPerfCfg[i];
+        attr.disabled       = 1;
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        BenchPerfFd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (BenchPerfFd[i] < 0) {                               /* All four or none                                     */
+            while (i-- > 0u) {
+                close(BenchPerfFd[i]);
+                BenchPerfFd[i] = -1;
+            }
+            return;
+        }
+    }
+}
+
+static  void  BenchPerfCtl (unsigned long req)
+{
+    unsigned  i;
+
+
+    for (i = 0u; (i < BENCH_PERF_N) && (BenchPerfFd[0] >= 0); i++) {
+        ioctl(BenchPerfFd[i], req, 0);
+    }
+}
+
+static  int  BenchPerfRead (double *p_val)
+{
+    unsigned long long  v;
+    unsigned            i;
+
+
+    if (BenchPerfFd[0] < 0) {
+        return (0);
+    }
+    for (i = 0u; i < BENCH_PERF_N; i++) {
+        if (read(BenchPerfFd[i], &v, sizeof(v)) != (ssize_t)sizeof(v)) {
+            return (0);
+        }
+        p_val[i] = (double)v;
+    }
+    return (1);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              RUNNING
+*********************************************************************************************************
+*/
+
+static  double  BenchNow (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+static  void  BenchUsage (void)
+{
+    fprintf(stderr, "options: --out FILE --baseline FILE --tolerance PCT --tag TEXT --filter TEXT --quick\n");
+    exit(2);
+}
+
+void  Bench_Init (int argc, char **argv, const char *suite)
+{
+    int  i;
+
+
+    BenchSuite = suite;
+    snprintf(BenchOut, sizeof(BenchOut), "bench-%s.jsonl", suite);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            BenchQuick = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            BenchUsage();
+        }
+        if      (strcmp(argv[i], "--out")       == 0) { snprintf(BenchOut, sizeof(BenchOut), "%s", argv[i + 1]); }
+        else if (strcmp(argv[i], "--baseline")  == 0) { BenchBaseline  = argv[i + 1]; }
+        else if (strcmp(argv[i], "--tolerance") == 0) { BenchTolerance = strtod(argv[i + 1], NULL); }
+        else if (strcmp(argv[i], "--tag")       == 0) { BenchTag       = argv[i + 1]; }
+        else if (strcmp(argv[i], "--filter")    == 0) { BenchFilter    = argv[i + 1]; }
+        else                                          { BenchUsage(); }
+        i++;
+    }
+    BenchPerfOpen();
+    printf("suite %s, %s, perf counters %s\n\n", suite, BenchQuick ? "quick" : "best of 5",
+           (BenchPerfFd[0] >= 0) ? "on" : "not available");
+    printf("%-26s %12s %9s %10s %10s %7s %10s %10s\n", "benchmark", "ns/op", "allocs/op", "bytes/op", "cycles/op",
+           "IPC", "cmiss/op", "bmiss/op");
+}
+
+const BENCH_RESULT  *Bench_Run (const char *name, BENCH_FNCT fnct, void *p_arg)
+{
+    BENCH_RESULT  *p_res;
+    double         pass_ns = BenchQuick ? BENCH_PASS_NS / 50.0 : BENCH_PASS_NS;
+    double         ctr[BENCH_PERF_N];
+    double         t;
+    double         best = 1e300;
+    unsigned long  n    = 1u;
+    unsigned long  allocs;
+    unsigned long  bytes;
+    unsigned       p;
+
+
+    if (((BenchFilter != NULL) && (strstr(name, BenchFilter) == NULL)) || (BenchN >= BENCH_MAX)) {
+        return (NULL);
+    }
+    p_res = &BenchRes[BenchN++];
+    memset(p_res, 0, sizeof(*p_res));
+    p_res->NamePtr = name;
+
+    for (;;) {                                                  /* Calibration: grow n until a run is long enough       */
+        t = BenchNow();
+        fnct(p_arg, n);
+        t = BenchNow() - t;
+        if ((t >= pass_ns / 8.0) || (n >= (1ul << 40))) {
+            break;
+        }
+        n = (t < pass_ns / 800.0) ? n * 100u : (unsigned long)((double)n * pass_ns / 8.0 / t) + 1u;
+    }
+    n = (unsigned long)((double)n * pass_ns / t) + 1u;
+
+    for (p = 0u; p < (BenchQuick ? 1u : BENCH_PASSES); p++) {
+        atomic_store(&BenchAllocs, 0u);
+        atomic_store(&BenchBytes,  0u);
+        BenchPerfCtl(PERF_EVENT_IOC_RESET);
+        BenchPerfCtl(PERF_EVENT_IOC_ENABLE);
+        t = BenchNow();
+        fnct(p_arg, n);
+        t = BenchNow() - t;
+        BenchPerfCtl(PERF_EVENT_IOC_DISABLE);
+        allocs = atomic_load(&BenchAllocs);
+        bytes  = atomic_load(&BenchBytes);
+        if (t < best) {
+            best            = t;
+            p_res->Ops      = n;
+            p_res->Ns       = t / (double)n;
+            p_res->Allocs   = (double)allocs / (double)n;
+            p_res->Bytes    = (double)bytes  / (double)n;
+            p_res->Perf     = BenchPerfRead(ctr);
+            if (p_res->Perf) {
+                p_res->Cycles     = ctr[0] / (double)n;
+                p_res->Instr      = ctr[1] / (double)n;
+                p_res->CacheMiss  = ctr[2] / (double)n;
+                p_res->BranchMiss = ctr[3] / (double)n;
+            }
+        }
+    }
+
+    printf("%-26s %12.1f %9.2f %10.1f ", name, p_res->Ns, p_res->Allocs, p_res->Bytes);
+    if (p_res->Perf) {
+        printf("%10.1f %7.2f %10.3f %10.3f\n", p_res->Cycles,
+               (p_res->Cycles > 0.0) ? p_res->Instr / p_res->Cycles : 0.0, p_res->CacheMiss, p_res->BranchMiss);
+    } else {
+        printf("%10s %7s %10s %10s\n", "-", "-", "-", "-");
+    }
+    fflush(stdout);
+    return (p_res);
+}
+
+void  Bench_Sink (unsigned long v)
+{
+    BenchSinkVal += v;
+}
+
+
+/*
+*********************************************************************************************************
+*                                              RESULTS
+*********************************************************************************************************
+*/
+
+static  void  BenchNum (FILE *f, const char *key, double v, int valid)
+{
+    if (valid) {
+        fprintf(f, ",\"%s\":%.6g", key, v);
+    } else {
+        fprintf(f, ",\"%s\":null", key);
+    }
+}
+
+static  int  BenchField (const char *line, const char *key, char *p_val, size_t size)
+{                                                               /* Value of "key": in a line written by Bench_Done()    */
+    char         pat[64];
+    const char  *p;
+    size_t       len = 0u;
+
+
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    p = strstr(line, pat);
+    if (p == NULL) {
+        return (0);
+    }
+    p += strlen(pat);
+    if (*p == '"') {
+        p++;
+    }
+    while ((*p != '\0') && (*p != '"') && (*p != ',') && (*p != '}') && (len + 1u < size)) {
+        p_val[len++] = *p++;
+    }
+    p_val[len] = '\0';
+    return (1);
+}
+
+static  int  BenchCompare (void)
+{
+    FILE      *f = fopen(BenchBaseline, "r");
+    char       line[BENCH_LINE_MAX];
+    char       suite[64];
+    char       name[64];
+    char       ns[64];
+    unsigned   i;
+    unsigned   seen = 0u;
+    int        slow = 0;
+
+
+    if (f == NULL) {
+        perror(BenchBaseline);
+        return (1);
+    }
+    printf("\nagainst %s (tolerance %.1f%%)\n", BenchBaseline, BenchTolerance);
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (!BenchField(line, "suite", suite, sizeof(suite)) || (strcmp(suite, BenchSuite) != 0) ||
+            !BenchField(line, "name", name, sizeof(name)) || !BenchField(line, "ns", ns, sizeof(ns))) {
+            continue;
+        }
+        for (i = 0u; i < BenchN; i++) {
+            double  base = strtod(ns, NULL);
+            double  pct;
+
+
+            if (strcmp(BenchRes[i].NamePtr, name) != 0) {
+                continue;
+            }
+            pct = (base > 0.0) ? (BenchRes[i].Ns / base - 1.0) * 100.0 : 0.0;
+            printf("%-26s %12.1f -> %12.1f ns/op %+7.1f%%%s\n", name, base, BenchRes[i].Ns, pct,
+                   (pct > BenchTolerance) ? "  REGRESSION" : "");
+            slow |= (pct > BenchTolerance);
+            seen++;
+        }
+    }
+    fclose(f);
+    if (seen == 0u) {
+        printf("no benchmark of suite %s in common\n", BenchSuite);
+    }
+    return (slow);
+}
+
+int  Bench_Done (void)
+{
+    FILE      *f;
+    unsigned   i;
+    int        ret = 0;
+
+
+    if (BenchBaseline != NULL) {                                /* First: the baseline may be the --out file            */
+        ret = BenchCompare();
+    }
+    f = fopen(BenchOut, "w");
+    if (f == NULL) {
+        perror(BenchOut);
+        return (1);
+    }
+    for (i = 0u; i < BenchN; i++) {
+        const BENCH_RESULT  *p_res = &BenchRes[i];
+        const char          *p;
+
+
+        fprintf(f, "{\"suite\":\"%s\",\"name\":\"%s\",\"ops\":%lu", BenchSuite, p_res->NamePtr, p_res->Ops);
+        BenchNum(f, "ns",            p_res->Ns,         1);
+        BenchNum(f, "allocs",        p_res->Allocs,     1);
+        BenchNum(f, "bytes",         p_res->Bytes,      1);
+        BenchNum(f, "cycles",        p_res->Cycles,     p_res->Perf);
+        BenchNum(f, "instructions",  p_res->Instr,      p_res->Perf);
+        BenchNum(f, "cache_misses",  p_res->CacheMiss,  p_res->Perf);
+        BenchNum(f, "branch_misses", p_res->BranchMiss, p_res->Perf);
+        fprintf(f, ",\"tag\":\"");
+        for (p = BenchTag; *p != '\0'; p++) {                   /* No escapes: quotes and backslashes become '_'        */
+            fputc(((*p == '"') || (*p == '\\') || ((unsigned char)*p < 0x20u)) ? '_' : *p, f);
+        }
+        fprintf(f, "\"}\n");
+    }
+    if (fclose(f) != 0) {
+        perror(BenchOut);
+        ret = 1;
+    }
+    printf("\n%u results in %s\n", BenchN, BenchOut);
+    return (ret);
+}
@@ -0,0 +1,106 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                          Benchmark harness
+*
+* Description : Shared by the benchmark suites, host/app_bench.c (monitor task paths) and model/apbench.cpp
+*               (scope paths). A benchmark is a function that runs its operation 'n' times; Bench_Run()
+*               calibrates 'n' so that one pass takes about BENCH_PASS_NS, keeps the fastest of
+*               BENCH_PASSES passes and reports, per operation:
+*
+*               - ns          wall time;
+*               - allocs      calls to malloc(), calloc() and realloc(), from any thread;
+*               - bytes       bytes they asked for;
+*               - cycles, instructions, cache misses, branch misses: perf_event hardware counters of the
+*                 process and of the threads it starts, user space only. Absent when perf_event_open()
+*                 is refused (container, perf_event_paranoid above 2, no PMU in the VM).
+*
+*               Bench_Done() prints the table and writes one JSON object per benchmark and per line
+*               (JSON Lines) to the --out file:
+*
+*                   {"suite":"app","name":"temp_job","ops":..,"ns":..,"allocs":..,"bytes":..,
+*                    "cycles":..,"instructions":..,"cache_misses":..,"branch_misses":..,"tag":".."}
+*
+*               the counters being null when absent. With --baseline <file> it compares ns/op with the
+*               benchmark of the same suite and name in that file and fails when one got slower by more
+*               than --tolerance percent (default 10).
+*
+* Options     : --out <file>        Results, JSON Lines.                  Default: bench-<suite>.jsonl
+*               --baseline <file>   Results of an earlier run to compare with
+*               --tolerance <pct>   Slowdown that counts as a regression. Default: 10
+*               --tag <text>        Copied to every record, e.g. the commit
+*               --filter <text>     Runs the benchmarks whose name contains it
+*               --quick             One short pass each, for a smoke test
+*
+* Note(s)     : 1) The allocation counters replace malloc() and friends with wrappers around the glibc
+*                  __libc_ entry points, so they see the allocations of C++ operator new as well.
+*               2) Pin the process (taskset -c 2) and fix the CPU frequency for runs that are compared.
+*********************************************************************************************************
+*/
+
+#ifndef  BENCH_H
+#define  BENCH_H
+
+#include  <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  BENCH_PASSES              5u                           /* Best of                                              */
+#define  BENCH_PASS_NS      50000000.0                          /* Target length of one pass                            */
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  void  (*BENCH_FNCT)(void *p_arg, unsigned long n);    /* Runs the operation 'n' times                         */
+
+typedef  struct {
+    const char     *NamePtr;
+    unsigned long   Ops;                                        /* Operations of the pass kept                          */
+    double          Ns;                                         /* Per operation, from here on                          */
+    double          Allocs;
+    double          Bytes;
+    int             Perf;                                       /* 1 if the four counters below are valid               */
+    double          Cycles;
+    double          Instr;
+    double          CacheMiss;
+    double          BranchMiss;
+} BENCH_RESULT;
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void           Bench_Init (int           argc,                  /* Exits on an unknown option                           */
+                           char        **argv,
+                           const char   *suite);
+
+const BENCH_RESULT  *Bench_Run  (const char  *name,             /* NULL if --filter skipped it                          */
+                                 BENCH_FNCT   fnct,
+                                 void        *p_arg);
+
+int            Bench_Done (void);                               /* Exit code: 1 on a regression or a write error        */
+
+void           Bench_Sink (unsigned long v);                    /* Keeps a result alive                                 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1631 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+* Description : Virtual-time implementation of the uC/OS-III services, the XAdcPs and XGpio drivers and
+*               the ucos_standalone BSP used by app.c. See sim.h for the build line, the environment
+*               variables and the script format.
+*
+* Notes       : 1) Each task runs on its own POSIX thread, but a task only executes while it holds the
+*                  virtual CPU ('SimCur'). The scheduler, which runs on the thread that called OSStart(),
+*                  always hands the CPU to the highest priority ready task and gets it back when that
+*                  task blocks or yields inside a kernel call. Since the application only gives up the
+*                  CPU through kernel calls, this reproduces the preemptive kernel at every point at
+*                  which the application can observe it.
+*
+*               2) When no task is ready the virtual clock jumps to the next delay expiry or script
+*                  event, so idle time costs nothing on the host.
+*********************************************************************************************************
+*/
+
+#define  _GNU_SOURCE
+
+#include  <errno.h>
+#include  <math.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <time.h>
+
+#include  <Source/os.h>
+#include  <ucos_bsp.h>
+#include  <ucos_int.h>
+#include  "app_spec.h"
+#include  "app_state.h"
+#include  "sim.h"
+#include  "xadcps.h"
+#include  "xgpio.h"
+#include  "xil_printf.h"
+
+
+/*
+*********************************************************************************************************
+*                                            DEFINES
+*********************************************************************************************************
+*/
+
+#define  SIM_NS_PER_TICK        (1000000000ull / OS_CFG_TICK_RATE_HZ)
+#define  SIM_NS_PER_MS          1000000ull
+#define  SIM_GPIO_CHANNELS      2u
+#define  SIM_GPIO_OUT_CHANNEL   2u                              /* Channel of the APP_STATE word, see app_state.h       */
+#define  SIM_ADC_CHANNELS       32u
+#define  SIM_HOST_STK_SIZE      (256u * 1024u)                  /* Host stack of every task thread                      */
+
+#define  SIM_TASK_READY         0
+#define  SIM_TASK_DLY           1
+#define  SIM_TASK_PEND          2
+#define  SIM_TASK_DONE          3
+#define  SIM_TASK_PEND_Q        4
+#define  SIM_TASK_PEND_SEM      5
+
+#define  SIM_EVT_BUTTON         0
+#define  SIM_EVT_SWEEP          1                               /* Value: frame of the SIM_FRAMES capture               */
+
+#define  SIM_CAP_HDR_SIZE      64u                              /* Capture file layout, see model/ap_capture.hpp        */
+#define  SIM_CAP_FRM_HDR_SIZE  32u
+#define  SIM_SWEEP_PENDING     16u                              /* Sweeps handed over at one scheduling point, at most  */
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct {
+    CPU_INT64U  Ns;
+    double      Value;                                          /* Celsius for the temperature channel, volts otherwise */
+} SIM_ADC_PT;
+
+typedef  struct {
+    SIM_ADC_PT *Pts;
+    size_t      Len;
+} SIM_ADC_TRACE;
+
+typedef  struct {
+    CPU_INT64U  Ns;
+    size_t      Seq;                                            /* Script order, breaks ties between simultaneous events */
+    int         Type;
+    u32         Value;
+} SIM_EVT;
+
+typedef  struct {
+    CPU_INT64U  Ns;
+    unsigned    Channel;
+    u32         Value;
+} SIM_GPIO_WR;
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  pthread_mutex_t   SimLock      = PTHREAD_MUTEX_INITIALIZER;
+static  pthread_cond_t    SimSchedCond = PTHREAD_COND_INITIALIZER;
+
+static  OS_TCB           *SimTaskList;                          /* Tasks in creation order                              */
+static  OS_TCB           *SimCur;                               /* Task holding the CPU, NULL while the scheduler has it */
+static  OS_TCB           *SimLast;                              /* Last task that held the CPU                          */
+        OS_TCB           *OSTCBCurPtr;
+static  int               SimStarted;
+
+static  CPU_INT64U        SimNow;                               /* Virtual time, ns                                     */
+static  CPU_INT64U        SimEnd;
+static  CPU_INT64U        SimHostStart;
+static  double            SimCpuScale;
+static  CPU_INT64U        SimUartNsPerByte;
+
+static  SIM_ADC_TRACE     SimAdc[SIM_ADC_CHANNELS];
+static  double            SimAdcNoiseLsb;
+static  CPU_INT64U        SimAdcRng = 0x9E3779B97F4A7C15ull;
+static  SIM_EVT          *SimEvt;
+static  size_t            SimEvtLen;
+static  size_t            SimEvtNext;
+static  u32               SimButtonLevel;
+
+static  FILE             *SimUart;
+static  CPU_INT64U        SimUartBytes;
+static  FILE             *SimReportFile;
+static  const char       *SimGpioLogPath;
+
+static  UCOS_INT_FNCT_PTR SimIsrFnct;                           /* The GPIO interrupt is the only one modelled          */
+static  void             *SimIsrArg;
+static  int               SimIsrEn;
+static  u32               SimGpioIsr;                           /* GPIO interrupt status, enable and global enable      */
+static  u32               SimGpioIer;
+static  int               SimGpioGie;
+static  CPU_INT64U        SimBtnEdges;
+static  CPU_INT64U        SimIsrCtr;
+
+static  u32               SimAlarmWord;                         /* Alarm detection, see Sim_AlarmCheck()                */
+static  CPU_INT64U        SimAlarmThNs;
+static  CPU_INT64U        SimAlarmClrNs;
+static  CPU_INT64U        SimAlarmSets;
+static  CPU_INT64U        SimAlarmClears;
+static  CPU_INT64U        SimAlarmLatMaxNs;
+static  double            SimAlarmLatSumNs;
+
+static  CPU_INT08U       *SimCap;                               /* SIM_FRAMES capture, read whole                       */
+static  size_t            SimCapFrameSize;
+static  CPU_INT64U        SimSweepDue;                          /* Sweeps completed by the PL so far                    */
+static  CPU_INT64U        SimSweepDone;                         /* ... of which handed to AppSpec_Post()                */
+static  CPU_INT64U        SimSweepAccepted;
+static  size_t            SimSweepPending[SIM_SWEEP_PENDING];   /* Frames of the sweeps not handed over yet             */
+
+static  SIM_GPIO_WR      *SimGpioLog;
+static  size_t            SimGpioLogLen;
+static  size_t            SimGpioLogCap;
+static  u32               SimGpioOut[SIM_GPIO_CHANNELS + 1u];
+static  CPU_INT64U        SimGpioWrCtr[SIM_GPIO_CHANNELS + 1u];
+
+static  XAdcPs_Config     SimAdcCfg  = { XPAR_XADCPS_0_DEVICE_ID, XPAR_XADCPS_0_BASEADDR };
+
+
+/*
+*********************************************************************************************************
+*                                              CLOCKS
+*********************************************************************************************************
+*/
+
+CPU_INT64U  Sim_HostNs (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((CPU_INT64U)ts.tv_sec * 1000000000ull + (CPU_INT64U)ts.tv_nsec);
+}
+
+CPU_INT64U  Sim_NowNs (void)
+{
+    return (SimNow);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           SCRIPT LOADING
+*********************************************************************************************************
+*/
+
+static  void  Sim_Die (const char *what, const char *detail)
+{
+    fprintf(stderr, "sim: %s: %s\n", what, detail);
+    exit(EXIT_FAILURE);
+}
+
+static  void  Sim_AddEvt (CPU_INT64U ns, int type, u32 value)
+{
+    SimEvt = realloc(SimEvt, (SimEvtLen + 1u) * sizeof(*SimEvt));
+    if (SimEvt == NULL) {
+        Sim_Die("script", "out of memory");
+    }
+    SimEvt[SimEvtLen].Ns    = ns;
+    SimEvt[SimEvtLen].Seq   = SimEvtLen;
+    SimEvt[SimEvtLen].Type  = type;
+    SimEvt[SimEvtLen].Value = value;
+    SimEvtLen++;
+}
+
+static  int  Sim_EvtCmp (const void *a, const void *b)
+{
+    const SIM_EVT  *ea = a;
+    const SIM_EVT  *eb = b;
+
+
+    if (ea->Ns != eb->Ns) {
+        return ((ea->Ns < eb->Ns) ? -1 : 1);
+    }
+    return ((ea->Seq < eb->Seq) ? -1 : 1);
+}
+
+static  int  Sim_AdcPtCmp (const void *a, const void *b)
+{
+    const SIM_ADC_PT  *pa = a;
+    const SIM_ADC_PT  *pb = b;
+
+
+    return ((pa->Ns > pb->Ns) - (pa->Ns < pb->Ns));
+}
+
+static  void  Sim_AddAdcPt (unsigned ch, CPU_INT64U ns, double value)
+{
+    SIM_ADC_TRACE  *tr = &SimAdc[ch];
+
+
+    tr->Pts = realloc(tr->Pts, (tr->Len + 1u) * sizeof(*tr->Pts));
+    if (tr->Pts == NULL) {
+        Sim_Die("script", "out of memory");
+    }
+    tr->Pts[tr->Len].Ns    = ns;
+    tr->Pts[tr->Len].Value = value;
+    tr->Len++;
+}
+
+static  void  Sim_LoadScript (const char *path)
+{
+    FILE    *f;
+    char     line[256];
+    unsigned lineno = 0u;
+    int      n;
+
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        Sim_Die(path, strerror(errno));
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        double    ms;
+        char      kind[16];
+        double    a;
+        double    b;
+        char     *hash;
+
+
+        lineno++;
+        hash = strchr(line, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        n = sscanf(line, "%lf %15s %lf %lf", &ms, kind, &a, &b);
+        if (n <= 0) {
+            continue;                                           /* Blank or comment line                                */
+        }
+        if (ms < 0.0) {
+            n = 0;
+        }
+
+        if ((n == 3) && (strcmp(kind, "temp") == 0)) {
+            Sim_AddAdcPt(XADCPS_CH_TEMP, (CPU_INT64U)(ms * SIM_NS_PER_MS), a);
+        } else if ((n == 4) && (strcmp(kind, "adc") == 0) && (a >= 0.0) && (a < SIM_ADC_CHANNELS)) {
+            Sim_AddAdcPt((unsigned)a, (CPU_INT64U)(ms * SIM_NS_PER_MS), b);
+        } else if ((n == 3) && (strcmp(kind, "button") == 0)) {
+            Sim_AddEvt((CPU_INT64U)(ms * SIM_NS_PER_MS), SIM_EVT_BUTTON, (u32)a);
+        } else if ((n == 4) && (strcmp(kind, "press") == 0)) {
+            Sim_AddEvt((CPU_INT64U)(ms * SIM_NS_PER_MS), SIM_EVT_BUTTON, (u32)a);
+            Sim_AddEvt((CPU_INT64U)((ms + b) * SIM_NS_PER_MS), SIM_EVT_BUTTON, 0u);
+        } else if ((n >= 3) && (strcmp(kind, "burst") == 0)) {
+            double    hold;                                     /* <ms> burst <value> <count> <hold_ms> <gap_ms>        */
+            double    gap;
+            unsigned  count;
+            unsigned  i;
+
+
+            if (sscanf(line, "%*f %*s %lf %u %lf %lf", &a, &count, &hold, &gap) != 4) {
+                fprintf(stderr, "sim: %s:%u: burst needs <value> <count> <hold_ms> <gap_ms>\n", path, lineno);
+                exit(EXIT_FAILURE);
+            }
+            for (i = 0u; i < count; i++) {
+                Sim_AddEvt((CPU_INT64U)(ms * SIM_NS_PER_MS), SIM_EVT_BUTTON, (u32)a);
+                Sim_AddEvt((CPU_INT64U)((ms + hold) * SIM_NS_PER_MS), SIM_EVT_BUTTON, 0u);
+                ms += hold + gap;
+            }
+        } else {
+            fprintf(stderr, "sim: %s:%u: cannot parse '%s'\n", path, lineno, line);
+            exit(EXIT_FAILURE);
+        }
+    }
+    fclose(f);
+
+    for (n = 0; n < (int)SIM_ADC_CHANNELS; n++) {
+        qsort(SimAdc[n].Pts, SimAdc[n].Len, sizeof(*SimAdc[n].Pts), Sim_AdcPtCmp);
+    }
+}
+
+static  u32  Sim_CapU32 (const CPU_INT08U *p)                    /* Little-endian fields of the capture                  */
+{
+    return ((u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24));
+}
+
+static  void  Sim_LoadSweeps (const char *path)                 /* One sweep event per frame, when its last sample lands */
+{
+    FILE        *f;
+    long         len;
+    u32          frame_size;
+    u32          samples;
+    double       clk_hz;
+    u32          conv;
+    size_t       frames;
+    size_t       k;
+
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        Sim_Die(path, strerror(errno));
+    }
+    if ((fseek(f, 0, SEEK_END) != 0) || ((len = ftell(f)) < (long)SIM_CAP_HDR_SIZE) || (fseek(f, 0, SEEK_SET) != 0)) {
+        Sim_Die(path, "not a capture file");
+    }
+    SimCap = malloc((size_t)len);
+    if ((SimCap == NULL) || (fread(SimCap, 1u, (size_t)len, f) != (size_t)len)) {
+        Sim_Die(path, "cannot read");
+    }
+    fclose(f);
+
+    frame_size = Sim_CapU32(&SimCap[16]);
+    samples    = Sim_CapU32(&SimCap[20]);
+    clk_hz     = (double)Sim_CapU32(&SimCap[24]);
+    conv       = Sim_CapU32(&SimCap[28]);
+    if ((memcmp(SimCap, "APCAP\r\n\x1A", 8u) != 0) || (Sim_CapU32(&SimCap[8]) != 1u) ||
+        (Sim_CapU32(&SimCap[12]) != SIM_CAP_HDR_SIZE) || (samples != APP_SPEC_SAMPLES) ||
+        (frame_size != SIM_CAP_FRM_HDR_SIZE + 2u * samples) || (clk_hz <= 0.0)) {
+        Sim_Die(path, "not a version 1 capture of 1280-sample sweeps");
+    }
+    SimCapFrameSize = frame_size;
+    frames          = ((size_t)len - SIM_CAP_HDR_SIZE) / frame_size;
+
+    for (k = 0u; k < frames; k++) {
+        const CPU_INT08U  *h      = &SimCap[SIM_CAP_HDR_SIZE + k * frame_size];
+        CPU_INT64U         edge   = (CPU_INT64U)Sim_CapU32(&h[8]) | ((CPU_INT64U)Sim_CapU32(&h[12]) << 32);
+        unsigned           hscale = (h[19] >> 2) & 3u;
+
+
+        edge += (CPU_INT64U)samples * conv * (hscale + 1u);     /* Trigger edge plus the length of the sweep            */
+        Sim_AddEvt((CPU_INT64U)((double)edge * 1e9 / clk_hz), SIM_EVT_SWEEP, (u32)k);
+    }
+}
+
+static  FILE  *Sim_OpenOut (const char *path, FILE *dflt)
+{
+    FILE  *f;
+
+
+    if ((path == NULL) || (strcmp(path, "-") == 0)) {
+        return (dflt);
+    }
+    if (strcmp(path, "none") == 0) {
+        return (NULL);
+    }
+    f = fopen(path, "w");
+    if (f == NULL) {
+        Sim_Die(path, strerror(errno));
+    }
+    return (f);
+}
+
+static  void  Sim_Init (void)
+{
+    const char  *env;
+    double       baud;
+
+
+    env    = getenv("SIM_DURATION_MS");
+    SimEnd = ((env != NULL) ? (CPU_INT64U)(atof(env) * SIM_NS_PER_MS) : 10000ull * SIM_NS_PER_MS);
+
+    env         = getenv("SIM_CPU_SCALE");
+    SimCpuScale = ((env != NULL) ? atof(env) : 0.0);
+
+    env            = getenv("SIM_ADC_NOISE_LSB");
+    SimAdcNoiseLsb = ((env != NULL) ? atof(env) : 0.0);
+
+    env  = getenv("SIM_UART_BAUD");
+    baud = ((env != NULL) ? atof(env) : 0.0);
+    SimUartNsPerByte = ((baud > 0.0) ? (CPU_INT64U)(10.0 * 1e9 / baud) : 0u);
+
+    SimUart        = Sim_OpenOut(getenv("SIM_UART"),   stdout);
+    SimReportFile  = Sim_OpenOut(getenv("SIM_REPORT"), stderr);
+    SimGpioLogPath = getenv("SIM_GPIO_LOG");
+
+    env = getenv("SIM_SCRIPT");
+    if (env != NULL) {
+        Sim_LoadScript(env);
+    }
+    env = getenv("SIM_FRAMES");
+    if (env != NULL) {
+        Sim_LoadSweeps(env);
+    }
+    qsort(SimEvt, SimEvtLen, sizeof(*SimEvt), Sim_EvtCmp);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          SCRIPTED INPUTS
+*********************************************************************************************************
+*/
+
+double  Sim_AdcValue (unsigned ch)
+{
+    static  const  double   dflt[8] = { 25.0, 1.0, 1.8, 0.0, 1.25, 0.0, 1.0, 0.0 };
+    const   SIM_ADC_TRACE  *tr      = &SimAdc[ch];
+    size_t                  i;
+
+
+    if (tr->Len == 0u) {
+        return ((ch < 8u) ? dflt[ch] : 0.0);                    /* Nominal die temperature and supplies                 */
+    }
+    if (SimNow <= tr->Pts[0].Ns) {
+        return (tr->Pts[0].Value);
+    }
+    for (i = 1u; i < tr->Len; i++) {
+        if (SimNow < tr->Pts[i].Ns) {
+            double  frac = (double)(SimNow - tr->Pts[i - 1u].Ns) /
+                           (double)(tr->Pts[i].Ns - tr->Pts[i - 1u].Ns);
+
+            return (tr->Pts[i - 1u].Value + frac * (tr->Pts[i].Value - tr->Pts[i - 1u].Value));
+        }
+    }
+    return (tr->Pts[tr->Len - 1u].Value);
+}
+
+double  Sim_Temperature (void)
+{
+    return (Sim_AdcValue(XADCPS_CH_TEMP));
+}
+
+u32  Sim_Buttons (void)
+{
+    return (SimButtonLevel);
+}
+
+static  void  Sim_ApplyEvents (void)
+{
+    while ((SimEvtNext < SimEvtLen) && (SimEvt[SimEvtNext].Ns <= SimNow)) {
+        SIM_EVT  *e = &SimEvt[SimEvtNext++];
+
+
+        if ((e->Type == SIM_EVT_BUTTON) && (e->Value != SimButtonLevel)) {
+            SimButtonLevel = e->Value;
+            SimBtnEdges++;
+            SimGpioIsr    |= XGPIO_IR_CH1_MASK;                 /* Any change of the input channel latches its status   */
+        } else if (e->Type == SIM_EVT_SWEEP) {
+            SimSweepPending[SimSweepDue % SIM_SWEEP_PENDING] = e->Value;
+            SimSweepDue++;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             SCHEDULER
+*
+* Note(s) : All the functions below are called with 'SimLock' held.
+*********************************************************************************************************
+*/
+
+static  int  Sim_GpioIrqPending (void)
+{
+    return ((SimIsrFnct != NULL) && SimIsrEn && SimGpioGie && ((SimGpioIsr & SimGpioIer) != 0u));
+}
+
+static  int  Sim_IrqPending (void)
+{
+    return (Sim_GpioIrqPending() || (SimSweepDone < SimSweepDue));
+}
+
+static  void  Sim_ServiceIrq (void)                             /* Called by the scheduler, no task holds the CPU       */
+{
+    if (Sim_GpioIrqPending()) {                                 /* One handler run per scheduling point, as the line is */
+        SimIsrCtr++;                                            /* ... level sensitive until the handler clears it      */
+        pthread_mutex_unlock(&SimLock);
+        SimIsrFnct(SimIsrArg);
+        pthread_mutex_lock(&SimLock);
+    }
+    if (SimSweepDue - SimSweepDone > SIM_SWEEP_PENDING) {        /* Older sweeps were overwritten in the PL RAM          */
+        SimSweepDone = SimSweepDue - SIM_SWEEP_PENDING;
+    }
+    while (SimSweepDone < SimSweepDue) {                        /* End of sweep interrupt: the PL has no such line yet, */
+        const CPU_INT08U  *h = &SimCap[SIM_CAP_HDR_SIZE +       /* ... so the handler is AppSpec_Post() itself          */
+                                       SimSweepPending[SimSweepDone % SIM_SWEEP_PENDING] * SimCapFrameSize];
+        CPU_INT16U         samples[APP_SPEC_SAMPLES];
+        CPU_BOOLEAN        ok;
+
+
+        SimSweepDone++;
+        memcpy(samples, h + SIM_CAP_FRM_HDR_SIZE, sizeof(samples));
+        pthread_mutex_unlock(&SimLock);
+        ok = AppSpec_Post(samples, (CPU_INT08U)((h[19] >> 2) & 3u), (CPU_INT08U)(h[19] & 3u));
+        pthread_mutex_lock(&SimLock);
+        SimSweepAccepted += (ok ? 1u : 0u);
+    }
+}
+
+static  void  Sim_ChargeSlice (OS_TCB *p_tcb)
+{
+    CPU_INT64U  slice = Sim_HostNs() - p_tcb->SimSliceStartNs;
+
+
+    p_tcb->SimRunNs += slice;
+    if (SimCpuScale > 0.0) {
+        SimNow += (CPU_INT64U)((double)slice * SimCpuScale);
+    }
+}
+
+static  void  Sim_Block (OS_TCB *p_tcb)                        /* Give the CPU back and wait until it is handed back   */
+{
+    Sim_ChargeSlice(p_tcb);
+    SimCur = NULL;
+    pthread_cond_signal(&SimSchedCond);
+    while (SimCur != p_tcb) {
+        pthread_cond_wait(&p_tcb->SimCond, &SimLock);
+    }
+    p_tcb->SimSliceStartNs = Sim_HostNs();
+}
+
+static  void  Sim_YieldIfPreempted (OS_TCB *p_woken)            /* Yield if 'p_woken' outranks the running task         */
+{
+    OS_TCB  *cur = SimCur;
+
+
+    if ((cur != NULL) && (p_woken != NULL) && (p_woken->SimPrioEff < cur->SimPrioEff)) {
+        cur->SimState = SIM_TASK_READY;
+        Sim_Block(cur);
+    }
+}
+
+static  void  Sim_ReleaseDue (void)                             /* Ready every task whose delay or timeout expired       */
+{
+    OS_TCB  *p_tcb;
+
+
+    Sim_ApplyEvents();
+    for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+        if ((p_tcb->SimWakeTick != 0u) && ((CPU_INT64U)p_tcb->SimWakeTick * SIM_NS_PER_TICK <= SimNow)) {
+            if ((p_tcb->SimState == SIM_TASK_DLY)    || (p_tcb->SimState == SIM_TASK_PEND) ||
+                (p_tcb->SimState == SIM_TASK_PEND_Q) || (p_tcb->SimState == SIM_TASK_PEND_SEM)) {
+                p_tcb->SimState    = SIM_TASK_READY;            /* A pending task keeps 'SimPendOn' to flag the timeout */
+                p_tcb->SimWakeTick = 0u;
+            }
+        }
+    }
+}
+
+static  OS_TCB  *Sim_HighestReady (void)
+{
+    OS_TCB  *p_tcb;
+    OS_TCB  *best = NULL;
+
+
+    for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+        if ((p_tcb->SimState == SIM_TASK_READY) &&
+            ((best == NULL) || (p_tcb->SimPrioEff < best->SimPrioEff))) {
+            best = p_tcb;
+        }
+    }
+    return (best);
+}
+
+static  CPU_INT64U  Sim_NextWakeNs (void)
+{
+    OS_TCB      *p_tcb;
+    CPU_INT64U   next = SimEnd;
+
+
+    for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+        if (((p_tcb->SimState == SIM_TASK_DLY)    || (p_tcb->SimState == SIM_TASK_PEND) ||
+             (p_tcb->SimState == SIM_TASK_PEND_Q) || (p_tcb->SimState == SIM_TASK_PEND_SEM)) &&
+            (p_tcb->SimWakeTick != 0u)) {
+            CPU_INT64U  wake = (CPU_INT64U)p_tcb->SimWakeTick * SIM_NS_PER_TICK;
+
+
+            if (wake < next) {
+                next = wake;
+            }
+        }
+    }
+    if ((SimEvtNext < SimEvtLen) && (SimEvt[SimEvtNext].Ns < next)) {
+        next = SimEvt[SimEvtNext].Ns;
+    }
+    return (next);
+}
+
+static  OS_TICK  Sim_NowTick (void)
+{
+    return ((OS_TICK)(SimNow / SIM_NS_PER_TICK));
+}
+
+static  void  *Sim_TaskEntry (void *p_arg)
+{
+    OS_TCB  *p_tcb = p_arg;
+
+
+    pthread_mutex_lock(&SimLock);
+    while (SimCur != p_tcb) {
+        pthread_cond_wait(&p_tcb->SimCond, &SimLock);
+    }
+    p_tcb->SimSliceStartNs = Sim_HostNs();
+    p_tcb->SimStkTop       = __builtin_frame_address(0);
+    pthread_mutex_unlock(&SimLock);
+
+    p_tcb->SimTaskPtr(p_tcb->SimArg);                           /* uC/OS-III tasks never return, but be tolerant        */
+
+    pthread_mutex_lock(&SimLock);
+    p_tcb->SimState = SIM_TASK_DONE;
+    Sim_ChargeSlice(p_tcb);
+    SimCur = NULL;
+    pthread_cond_signal(&SimSchedCond);
+    pthread_mutex_unlock(&SimLock);
+    return (NULL);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          END OF RUN REPORT
+*********************************************************************************************************
+*/
+
+static  void  Sim_Report (void)
+{
+    FILE        *f = SimReportFile;
+    OS_TCB      *p_tcb;
+    CPU_INT64U   host = Sim_HostNs() - SimHostStart;
+    CPU_INT64U   ctx_sw = 0u;
+    CPU_INT64U   stk    = 0u;
+    unsigned     tasks  = 0u;
+    unsigned     ch;
+
+
+    if (SimGpioLogPath != NULL) {
+        FILE   *log = fopen(SimGpioLogPath, "w");
+        size_t  i;
+
+
+        if (log == NULL) {
+            Sim_Die(SimGpioLogPath, strerror(errno));
+        }
+        for (i = 0u; i < SimGpioLogLen; i++) {
+            fprintf(log, "%.3f %u 0x%08x\n",
+                    (double)SimGpioLog[i].Ns / SIM_NS_PER_MS, SimGpioLog[i].Channel, (unsigned)SimGpioLog[i].Value);
+        }
+        fclose(log);
+    }
+
+    if (SimUart != NULL) {
+        fflush(SimUart);
+    }
+    if (f == NULL) {
+        return;
+    }
+
+    fprintf(f, "\n---- simulation report ----\n");
+    fprintf(f, "Simulated time : %.1f ms in %.3f ms of host time (%.0fx real time)\n",
+            (double)SimNow / SIM_NS_PER_MS, (double)host / SIM_NS_PER_MS,
+            (host > 0u) ? (double)SimNow / (double)host : 0.0);
+    fprintf(f, "UART output    : %llu bytes\n", (unsigned long long)SimUartBytes);
+    for (ch = 1u; ch <= SIM_GPIO_CHANNELS; ch++) {
+        fprintf(f, "GPIO ch%u writes: %llu\n", ch, (unsigned long long)SimGpioWrCtr[ch]);
+    }
+    fprintf(f, "Button edges   : %llu, GPIO interrupts serviced: %llu\n",
+            (unsigned long long)SimBtnEdges, (unsigned long long)SimIsrCtr);
+    fprintf(f, "Alarm          : %llu set, worst %.1f ms, mean %.1f ms after the cause; %llu cleared\n",
+            (unsigned long long)SimAlarmSets, (double)SimAlarmLatMaxNs / SIM_NS_PER_MS,
+            (SimAlarmSets > 0u) ? SimAlarmLatSumNs / (double)SimAlarmSets / SIM_NS_PER_MS : 0.0,
+            (unsigned long long)SimAlarmClears);
+    if (SimCap != NULL) {
+        fprintf(f, "Sweeps         : %llu completed, %llu accepted by AppSpec_Post()\n",
+                (unsigned long long)SimSweepDue, (unsigned long long)SimSweepAccepted);
+    }
+    fprintf(f, "\n%-16s %4s %8s %10s %10s %10s %10s %9s %8s\n",
+            "Task", "Prio", "Loops", "min [ns]", "mean [ns]", "max [ns]", "jitter", "late [t]", "ctx sw");
+    for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+        double  n    = (double)p_tcb->SimLoops;
+        double  mean = (n > 0.0) ? p_tcb->SimLoopSumNs / n : 0.0;
+        double  var  = (n > 0.0) ? p_tcb->SimLoopSumSqNs / n - mean * mean : 0.0;
+
+
+        fprintf(f, "%-16s %4u %8llu %10llu %10.0f %10llu %10.0f %9u %8u\n",
+                p_tcb->NamePtr, (unsigned)p_tcb->Prio, (unsigned long long)p_tcb->SimLoops,
+                (unsigned long long)((p_tcb->SimLoops > 0u) ? p_tcb->SimLoopMinNs : 0u), mean,
+                (unsigned long long)p_tcb->SimLoopMaxNs, (var > 0.0) ? sqrt(var) : 0.0,
+                (unsigned)p_tcb->SimLateMaxTicks, (unsigned)p_tcb->CtxSwCtr);
+        ctx_sw += p_tcb->CtxSwCtr;
+        stk    += p_tcb->StkSize;
+        tasks++;
+    }
+    fprintf(f, "%-16s %4u %8s %10s %10s %10s %10s %9s %8llu\n",
+            "Total", tasks, "", "", "", "", "", "", (unsigned long long)ctx_sw);
+    fprintf(f, "Stacks         : %llu CPU_STK entries reserved by %u tasks\n", (unsigned long long)stk, tasks);
+    fprintf(f, "\nLoops: one per OSTimeDly...() or timed OSTask...Pend() call. min/mean/max: host CPU time\n"
+               "of the loop body; jitter: its standard deviation; late: worst release delay in virtual\n"
+               "ticks; ctx sw: times the task was switched in.\n");
+    fflush(f);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            END OF A LOOP
+*
+* Description : Closes the loop body of 'cur', which is about to block, and records its cost. Called with
+*               SimLock held.
+*********************************************************************************************************
+*/
+
+static  void  Sim_LoopEnd (OS_TCB *cur)
+{
+    CPU_INT64U  body;
+
+
+    Sim_ChargeSlice(cur);
+    cur->SimSliceStartNs = Sim_HostNs();
+    body = cur->SimRunNs;
+    cur->SimRunNs = 0u;
+    cur->SimLoops++;
+    cur->SimLoopSumNs   += (double)body;
+    cur->SimLoopSumSqNs += (double)body * (double)body;
+    if (body < cur->SimLoopMinNs) {
+        cur->SimLoopMinNs = body;
+    }
+    if (body > cur->SimLoopMaxNs) {
+        cur->SimLoopMaxNs = body;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         uC/OS-III SERVICES
+*********************************************************************************************************
+*/
+
+void  OSInit (OS_ERR *p_err)
+{
+    *p_err = OS_ERR_NONE;
+}
+
+void  OSStart (OS_ERR *p_err)
+{
+    OS_TCB  *next;
+
+
+    *p_err = OS_ERR_NONE;
+    pthread_mutex_lock(&SimLock);
+    SimStarted   = 1;
+    SimHostStart = Sim_HostNs();
+
+    for (;;) {
+        Sim_ReleaseDue();
+        Sim_ServiceIrq();
+        next = Sim_HighestReady();
+        if (next != NULL) {
+            if (next != SimLast) {
+                next->CtxSwCtr++;
+                SimLast = next;
+            }
+            SimCur      = next;                                 /* Context switch to 'next'                             */
+            OSTCBCurPtr = next;
+            pthread_cond_signal(&next->SimCond);
+            while (SimCur != NULL) {
+                pthread_cond_wait(&SimSchedCond, &SimLock);
+            }
+            if (SimNow >= SimEnd) {
+                break;
+            }
+            continue;
+        }
+        SimLast = NULL;                                         /* The idle task runs                                   */
+        SimNow = Sim_NextWakeNs();                              /* Idle: jump to the next thing that can happen         */
+        if (SimNow >= SimEnd) {
+            break;
+        }
+    }
+
+    SimNow = SimEnd;
+    Sim_Report();
+    exit(EXIT_SUCCESS);                                         /* Like the real OSStart(), never returns               */
+}
+
+void  OSTaskCreate (OS_TCB        *p_tcb,
+                    CPU_CHAR      *p_name,
+                    OS_TASK_PTR    p_task,
+                    void          *p_arg,
+                    OS_PRIO        prio,
+                    CPU_STK       *p_stk_base,
+                    CPU_STK_SIZE   stk_limit,
+                    CPU_STK_SIZE   stk_size,
+                    OS_MSG_QTY     q_size,
+                    OS_TICK        time_quanta,
+                    void          *p_ext,
+                    OS_OPT         opt,
+                    OS_ERR        *p_err)
+{
+    OS_TCB          **pp_tail;
+    pthread_attr_t    attr;
+
+
+    (void)stk_limit;
+    (void)time_quanta;
+
+    pthread_mutex_lock(&SimLock);
+    memset(p_tcb, 0, sizeof(*p_tcb));
+    p_tcb->NamePtr      = p_name;
+    p_tcb->Prio         = prio;
+    p_tcb->SimPrioEff   = prio;
+    p_tcb->SimTaskPtr   = p_task;
+    p_tcb->SimArg       = p_arg;
+    p_tcb->StkBasePtr   = p_stk_base;
+    p_tcb->StkSize      = stk_size;
+    p_tcb->Opt          = opt;
+    p_tcb->ExtPtr       = p_ext;
+    p_tcb->SimState     = SIM_TASK_READY;
+    p_tcb->SimLoopMinNs = ~0ull;
+    pthread_cond_init(&p_tcb->SimCond, NULL);
+    if (q_size > 0u) {
+        p_tcb->SimQ     = calloc(q_size, sizeof(*p_tcb->SimQ));
+        p_tcb->SimQSize = q_size;
+        if (p_tcb->SimQ == NULL) {
+            Sim_Die("OSTaskCreate", "out of memory");
+        }
+    }
+
+    if ((opt & OS_OPT_TASK_STK_CLR) != 0u) {
+        memset(p_stk_base, 0, stk_size * sizeof(CPU_STK));
+    }
+
+    for (pp_tail = &SimTaskList; *pp_tail != NULL; pp_tail = &(*pp_tail)->SimNext) {
+        ;
+    }
+    *pp_tail = p_tcb;
+
+    if (posix_memalign((void **)&p_tcb->SimStkMem, 4096u, SIM_HOST_STK_SIZE) != 0) {
+        Sim_Die("OSTaskCreate", "out of memory");
+    }
+    memset(p_tcb->SimStkMem, 0, SIM_HOST_STK_SIZE);             /* So that OSTaskStkChk() can find the deepest use      */
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, p_tcb->SimStkMem, SIM_HOST_STK_SIZE);
+    if (pthread_create(&p_tcb->SimThread, &attr, Sim_TaskEntry, p_tcb) != 0) {
+        Sim_Die("OSTaskCreate", "cannot create thread");
+    }
+    pthread_attr_destroy(&attr);
+    *p_err = OS_ERR_NONE;
+
+    if (SimStarted) {
+        Sim_YieldIfPreempted(p_tcb);
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  OSTaskStkChk (OS_TCB        *p_tcb,
+                    CPU_STK_SIZE  *p_free,
+                    CPU_STK_SIZE  *p_used,
+                    OS_ERR        *p_err)
+{
+    CPU_INT08U    *p;
+    CPU_STK_SIZE   used = 0u;
+
+
+    if (p_tcb == NULL) {
+        p_tcb = SimCur;
+    }
+    if ((p_tcb->Opt & (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR)) != (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR)) {
+        *p_free = 0u;
+        *p_used = 0u;
+        *p_err  = OS_ERR_TASK_OPT;
+        return;
+    }
+    if (p_tcb->SimStkTop != NULL) {                             /* Host stack, from the task function to the deepest    */
+                                                                /* byte written. Host frames are bigger than on the     */
+                                                                /* Cortex-A9, so this is an upper bound of the target.  */
+        for (p = p_tcb->SimStkMem; (p < p_tcb->SimStkTop) && (*p == 0u); p++) {
+            ;
+        }
+        used = (CPU_STK_SIZE)((p_tcb->SimStkTop - p + sizeof(CPU_STK) - 1u) / sizeof(CPU_STK));
+    }
+    *p_used = used;
+    *p_free = (used < p_tcb->StkSize) ? (p_tcb->StkSize - used) : 0u;
+    *p_err  = OS_ERR_NONE;
+}
+
+void  OSTimeDly (OS_TICK   dly,
+                 OS_OPT    opt,
+                 OS_ERR   *p_err)
+{
+    OS_TCB      *cur;
+    OS_TICK      now;
+
+
+    *p_err = OS_ERR_NONE;
+    pthread_mutex_lock(&SimLock);
+    cur = SimCur;
+    if ((cur == NULL) || (dly == 0u)) {
+        pthread_mutex_unlock(&SimLock);
+        return;
+    }
+
+    Sim_LoopEnd(cur);
+
+    now = Sim_NowTick();
+    if (((opt & OS_OPT_TIME_PERIODIC) != 0u) && (cur->SimNominalTick != 0u)) {
+        cur->SimNominalTick += dly;                             /* Periodic: relative to the previous release           */
+    } else {
+        cur->SimNominalTick  = now + dly;
+    }
+    cur->SimWakeTick = cur->SimNominalTick;
+    cur->SimState    = SIM_TASK_DLY;
+    Sim_Block(cur);
+
+    now = Sim_NowTick();
+    if (now - cur->SimNominalTick > cur->SimLateMaxTicks) {
+        cur->SimLateMaxTicks = now - cur->SimNominalTick;
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  OSTimeDlyHMSM (CPU_INT16U   hours,
+                     CPU_INT16U   minutes,
+                     CPU_INT16U   seconds,
+                     CPU_INT32U   milli,
+                     OS_OPT       opt,
+                     OS_ERR      *p_err)
+{
+    CPU_INT64U  ms = (((CPU_INT64U)hours * 60u + minutes) * 60u + seconds) * 1000u + milli;
+
+
+    OSTimeDly((OS_TICK)(ms * OS_CFG_TICK_RATE_HZ / 1000u), opt & OS_OPT_TIME_PERIODIC, p_err);
+}
+
+void  OSTimeDlyResume (OS_TCB  *p_tcb,
+                       OS_ERR  *p_err)
+{
+    pthread_mutex_lock(&SimLock);
+    if (p_tcb->SimState != SIM_TASK_DLY) {
+        *p_err = OS_ERR_TASK_NOT_DLY;
+        pthread_mutex_unlock(&SimLock);
+        return;
+    }
+    p_tcb->SimState       = SIM_TASK_READY;
+    p_tcb->SimWakeTick    = 0u;
+    p_tcb->SimNominalTick = Sim_NowTick();                      /* Released now, on purpose: not late                   */
+    *p_err = OS_ERR_NONE;
+    Sim_YieldIfPreempted(p_tcb);
+    pthread_mutex_unlock(&SimLock);
+}
+
+OS_TICK  OSTimeGet (OS_ERR *p_err)
+{
+    *p_err = OS_ERR_NONE;
+    return (Sim_NowTick());
+}
+
+void  *OSTaskQPend (OS_TICK       timeout,
+                   OS_OPT        opt,
+                   OS_MSG_SIZE  *p_msg_size,
+                   CPU_TS       *p_ts,
+                   OS_ERR       *p_err)
+{
+    OS_TCB      *cur;
+    OS_MSG_QTY   out;
+    OS_TICK      timed;
+    void        *p_msg = NULL;
+
+
+    pthread_mutex_lock(&SimLock);
+    cur = SimCur;
+    if ((cur == NULL) || (cur->SimQSize == 0u)) {
+        *p_err = OS_ERR_OBJ_TYPE;
+        pthread_mutex_unlock(&SimLock);
+        return (NULL);
+    }
+    if ((cur->SimQLen == 0u) && ((opt & OS_OPT_PEND_NON_BLOCKING) == 0u)) {
+        if (timeout != 0u) {                                    /* A timed pend ends a loop, as OSTimeDly() does        */
+            Sim_LoopEnd(cur);
+        }
+        cur->SimWakeTick = (timeout != 0u) ? Sim_NowTick() + timeout : 0u;
+        cur->SimState    = SIM_TASK_PEND_Q;
+        timed            = cur->SimWakeTick;
+        Sim_Block(cur);
+        if ((timed != 0u) && (cur->SimQLen == 0u) && (Sim_NowTick() - timed > cur->SimLateMaxTicks)) {
+            cur->SimLateMaxTicks = Sim_NowTick() - timed;
+        }
+    }
+    if (cur->SimQLen == 0u) {
+        *p_err = ((opt & OS_OPT_PEND_NON_BLOCKING) != 0u) ? OS_ERR_PEND_WOULD_BLOCK : OS_ERR_TIMEOUT;
+        if (p_ts != NULL) {
+            *p_ts = 0u;
+        }
+    } else {
+        out    = (OS_MSG_QTY)((cur->SimQIn + cur->SimQSize - cur->SimQLen) % cur->SimQSize);
+        p_msg  = cur->SimQ[out].MsgPtr;
+        cur->SimQLen--;
+        *p_msg_size = cur->SimQ[out].MsgSize;
+        if (p_ts != NULL) {
+            *p_ts = cur->SimQ[out].MsgTS;
+        }
+        *p_err = OS_ERR_NONE;
+    }
+    pthread_mutex_unlock(&SimLock);
+    return (p_msg);
+}
+
+void  OSTaskQPost (OS_TCB       *p_tcb,
+                   void         *p_void,
+                   OS_MSG_SIZE   msg_size,
+                   OS_OPT        opt,
+                   OS_ERR       *p_err)
+{
+    (void)opt;
+    pthread_mutex_lock(&SimLock);
+    if (p_tcb->SimQLen >= p_tcb->SimQSize) {
+        *p_err = OS_ERR_Q_MAX;
+    } else {
+        p_tcb->SimQ[p_tcb->SimQIn].MsgPtr  = p_void;
+        p_tcb->SimQ[p_tcb->SimQIn].MsgSize = msg_size;
+        p_tcb->SimQ[p_tcb->SimQIn].MsgTS   = (CPU_TS)SimNow;
+        p_tcb->SimQIn = (OS_MSG_QTY)((p_tcb->SimQIn + 1u) % p_tcb->SimQSize);
+        p_tcb->SimQLen++;
+        if (p_tcb->SimState == SIM_TASK_PEND_Q) {
+            p_tcb->SimState    = SIM_TASK_READY;
+            p_tcb->SimWakeTick = 0u;
+        }
+        *p_err = OS_ERR_NONE;
+        Sim_YieldIfPreempted(p_tcb);                            /* No effect from an interrupt handler                  */
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+OS_SEM_CTR  OSTaskSemPend (OS_TICK   timeout,
+                           OS_OPT    opt,
+                           CPU_TS   *p_ts,
+                           OS_ERR   *p_err)
+{
+    OS_TCB      *cur;
+    OS_SEM_CTR   ctr;
+
+
+    pthread_mutex_lock(&SimLock);
+    cur = SimCur;
+    if ((cur->SemCtr == 0u) && ((opt & OS_OPT_PEND_NON_BLOCKING) == 0u)) {
+        if (timeout != 0u) {                                    /* A timed pend ends a loop, as OSTimeDly() does        */
+            Sim_LoopEnd(cur);
+        }
+        cur->SimWakeTick = (timeout != 0u) ? Sim_NowTick() + timeout : 0u;
+        cur->SimState    = SIM_TASK_PEND_SEM;
+        Sim_Block(cur);
+    }
+    if (cur->SemCtr == 0u) {
+        *p_err = ((opt & OS_OPT_PEND_NON_BLOCKING) != 0u) ? OS_ERR_PEND_WOULD_BLOCK : OS_ERR_TIMEOUT;
+    } else {
+        cur->SemCtr--;
+        *p_err = OS_ERR_NONE;
+    }
+    if (p_ts != NULL) {
+        *p_ts = (CPU_TS)SimNow;
+    }
+    ctr = cur->SemCtr;
+    pthread_mutex_unlock(&SimLock);
+    return (ctr);
+}
+
+OS_SEM_CTR  OSTaskSemPost (OS_TCB   *p_tcb,
+                           OS_OPT    opt,
+                           OS_ERR   *p_err)
+{
+    OS_SEM_CTR  ctr;
+
+
+    (void)opt;
+    pthread_mutex_lock(&SimLock);
+    ctr = ++p_tcb->SemCtr;
+    if (p_tcb->SimState == SIM_TASK_PEND_SEM) {
+        p_tcb->SimState    = SIM_TASK_READY;
+        p_tcb->SimWakeTick = 0u;
+    }
+    *p_err = OS_ERR_NONE;
+    Sim_YieldIfPreempted(p_tcb);                                /* No effect from an interrupt handler                  */
+    pthread_mutex_unlock(&SimLock);
+    return (ctr);
+}
+
+void  OSMutexCreate (OS_MUTEX   *p_mutex,
+                     CPU_CHAR   *p_name,
+                     OS_ERR     *p_err)
+{
+    pthread_mutex_lock(&SimLock);
+    p_mutex->NamePtr    = p_name;
+    p_mutex->SimOwner   = NULL;
+    p_mutex->SimNesting = 0u;
+    p_mutex->SimCreated = 1;
+    pthread_mutex_unlock(&SimLock);
+    *p_err = OS_ERR_NONE;
+}
+
+void  OSMutexPend (OS_MUTEX   *p_mutex,
+                   OS_TICK     timeout,
+                   OS_OPT      opt,
+                   CPU_TS     *p_ts,
+                   OS_ERR     *p_err)
+{
+    OS_TCB  *cur;
+
+
+    pthread_mutex_lock(&SimLock);
+    cur = SimCur;
+    if (p_ts != NULL) {
+        *p_ts = (CPU_TS)SimNow;
+    }
+    if (!p_mutex->SimCreated) {                                 /* Same outcome as the kernel's argument checking       */
+        *p_err = OS_ERR_OBJ_TYPE;
+    } else if ((cur == NULL) || (p_mutex->SimOwner == NULL) || (p_mutex->SimOwner == cur)) {
+        p_mutex->SimOwner = cur;
+        p_mutex->SimNesting++;
+        *p_err = OS_ERR_NONE;
+    } else if ((opt & OS_OPT_PEND_NON_BLOCKING) != 0u) {
+        *p_err = OS_ERR_PEND_WOULD_BLOCK;
+    } else {
+        OS_TCB  *owner = p_mutex->SimOwner;
+
+
+        if (owner->SimPrioEff > cur->SimPrioEff) {              /* Priority inheritance                                 */
+            owner->SimPrioEff = cur->SimPrioEff;
+        }
+        cur->SimPendOn   = p_mutex;
+        cur->SimWakeTick = (timeout != 0u) ? Sim_NowTick() + timeout : 0u;
+        cur->SimState    = SIM_TASK_PEND;
+        Sim_Block(cur);
+        if (cur->SimPendOn != NULL) {                           /* Woken by the timeout, not by OSMutexPost()           */
+            cur->SimPendOn = NULL;
+            *p_err = OS_ERR_TIMEOUT;
+        } else {
+            *p_err = OS_ERR_NONE;
+        }
+        if (p_ts != NULL) {
+            *p_ts = (CPU_TS)SimNow;
+        }
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  OSMutexPost (OS_MUTEX   *p_mutex,
+                   OS_OPT      opt,
+                   OS_ERR     *p_err)
+{
+    OS_TCB  *cur;
+    OS_TCB  *p_tcb;
+    OS_TCB  *next = NULL;
+
+
+    (void)opt;
+    pthread_mutex_lock(&SimLock);
+    cur = SimCur;
+    if (!p_mutex->SimCreated) {
+        *p_err = OS_ERR_OBJ_TYPE;
+    } else if (p_mutex->SimOwner != cur) {
+        *p_err = OS_ERR_MUTEX_NOT_OWNER;
+    } else if (--p_mutex->SimNesting > 0u) {
+        *p_err = OS_ERR_NONE;
+    } else {
+        if (cur != NULL) {
+            cur->SimPrioEff = cur->Prio;                        /* Drop any inherited priority                          */
+        }
+        for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+            if ((p_tcb->SimState == SIM_TASK_PEND) && (p_tcb->SimPendOn == p_mutex) &&
+                ((next == NULL) || (p_tcb->SimPrioEff < next->SimPrioEff))) {
+                next = p_tcb;
+            }
+        }
+        p_mutex->SimOwner = next;
+        if (next != NULL) {
+            p_mutex->SimNesting = 1u;
+            next->SimPendOn     = NULL;
+            next->SimWakeTick   = 0u;
+            next->SimState      = SIM_TASK_READY;
+            for (p_tcb = SimTaskList; p_tcb != NULL; p_tcb = p_tcb->SimNext) {
+                if ((p_tcb->SimState == SIM_TASK_PEND) && (p_tcb->SimPendOn == p_mutex) &&
+                    (p_tcb->SimPrioEff < next->SimPrioEff)) {
+                    next->SimPrioEff = p_tcb->SimPrioEff;
+                }
+            }
+        }
+        *p_err = OS_ERR_NONE;
+        Sim_YieldIfPreempted(next);
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+
+CPU_TS32  CPU_TS_Get32 (void)
+{
+    OS_TCB      *cur = SimCur;
+    CPU_INT64U   now = SimNow;
+
+
+    if ((SimCpuScale > 0.0) && (cur != NULL)) {                 /* Include the CPU time of the slice in progress        */
+        now += (CPU_INT64U)((double)(Sim_HostNs() - cur->SimSliceStartNs) * SimCpuScale);
+    }
+    return ((CPU_TS32)now);
+}
+
+CPU_TS_TMR_FREQ  CPU_TS_TmrFreqGet (CPU_ERR *p_err)
+{
+    *p_err = 0u;
+    return (1000000000u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          ucos_standalone BSP
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  UCOS_IntVectSet (CPU_INT32U          int_id,
+                              CPU_INT08U          int_prio,
+                              CPU_INT08U          int_target_list,
+                              UCOS_INT_FNCT_PTR   int_fnct,
+                              void               *p_int_arg)
+{
+    (void)int_prio;
+    (void)int_target_list;
+    if (int_id != XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR) {
+        return (DEF_FALSE);
+    }
+    pthread_mutex_lock(&SimLock);
+    SimIsrFnct = int_fnct;
+    SimIsrArg  = p_int_arg;
+    pthread_mutex_unlock(&SimLock);
+    return (DEF_TRUE);
+}
+
+CPU_BOOLEAN  UCOS_IntSrcEn (CPU_INT32U int_id)
+{
+    if (int_id != XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR) {
+        return (DEF_FALSE);
+    }
+    pthread_mutex_lock(&SimLock);
+    SimIsrEn = 1;
+    pthread_mutex_unlock(&SimLock);
+    return (DEF_TRUE);
+}
+
+CPU_BOOLEAN  UCOS_IntSrcDis (CPU_INT32U int_id)
+{
+    if (int_id != XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR) {
+        return (DEF_FALSE);
+    }
+    pthread_mutex_lock(&SimLock);
+    SimIsrEn = 0;
+    pthread_mutex_unlock(&SimLock);
+    return (DEF_TRUE);
+}
+
+void  UCOSStartup (void (*main_task)(void *p_arg))
+{
+    Sim_Init();
+    main_task((void *)0);
+}
+
+static  void  Sim_UartWrite (const char *p_buf, size_t len)
+{
+    size_t   i;
+    OS_TCB  *cur;
+    OS_TCB  *next;
+
+
+    if (SimUart != NULL) {
+        fwrite(p_buf, 1u, len, SimUart);
+    }
+    pthread_mutex_lock(&SimLock);
+    SimUartBytes += len;
+    cur = SimCur;
+    if ((cur != NULL) && (SimUartNsPerByte != 0u)) {
+        for (i = 0u; i < len; i++) {                            /* Polled UART: the caller spins until each byte leaves, */
+            SimNow += SimUartNsPerByte;                         /* ... but the tick can preempt it in between           */
+            Sim_ReleaseDue();
+            next = Sim_HighestReady();
+            if (Sim_IrqPending() || ((next != NULL) && (next->SimPrioEff < cur->SimPrioEff))) {
+                cur->SimState = SIM_TASK_READY;
+                Sim_Block(cur);
+            }
+        }
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  UCOS_Print (const char *str)
+{
+    Sim_UartWrite(str, strlen(str));
+}
+
+void  outbyte (char c)
+{
+    Sim_UartWrite(&c, 1u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             XGPIO DRIVER
+*********************************************************************************************************
+*/
+
+int  XGpio_Initialize (XGpio *InstancePtr, u16 DeviceId)
+{
+    (void)DeviceId;
+    InstancePtr->BaseAddress = XPAR_AXI_GPIO_0_BASEADDR;
+    InstancePtr->IsReady     = 1u;
+    return (XST_SUCCESS);
+}
+
+int  XGpio_SelfTest (XGpio *InstancePtr)
+{
+    return (InstancePtr->IsReady ? XST_SUCCESS : XST_FAILURE);
+}
+
+void  XGpio_SetDataDirection (XGpio *InstancePtr, unsigned Channel, u32 DirectionMask)
+{
+    if ((Channel >= 1u) && (Channel <= SIM_GPIO_CHANNELS)) {
+        InstancePtr->Direction[Channel - 1u] = DirectionMask;
+    }
+}
+
+u32  XGpio_DiscreteRead (XGpio *InstancePtr, unsigned Channel)
+{
+    u32  value;
+
+
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    value = (Channel == 1u) ? SimButtonLevel : SimGpioOut[(Channel <= SIM_GPIO_CHANNELS) ? Channel : 0u];
+    pthread_mutex_unlock(&SimLock);
+    return (value);
+}
+
+static  CPU_INT64U  Sim_TraceRise (unsigned ch, double level)  /* Last time <= now the trace of 'ch' rose to 'level'    */
+{
+    const SIM_ADC_TRACE  *tr   = &SimAdc[ch];
+    CPU_INT64U            last;
+    size_t                i;
+
+
+    if (tr->Len == 0u) {
+        return ((Sim_AdcValue(ch) >= level) ? 0u : SimNow);
+    }
+    last = (tr->Pts[0].Value >= level) ? 0u : SimNow;           /* Never: the reading was early (noise)                 */
+    for (i = 1u; (i < tr->Len) && (tr->Pts[i - 1u].Ns <= SimNow); i++) {
+        const SIM_ADC_PT  *a = &tr->Pts[i - 1u];
+        const SIM_ADC_PT  *b = &tr->Pts[i];
+
+
+        if ((a->Value < level) && (b->Value >= level)) {
+            CPU_INT64U  t = a->Ns + (CPU_INT64U)((level - a->Value) / (b->Value - a->Value) * (double)(b->Ns - a->Ns));
+
+
+            if (t <= SimNow) {
+                last = t;
+            }
+        }
+    }
+    return (last);
+}
+
+static  void  Sim_AlarmCheck (u32 word)                         /* Time from cause to alarm bit, on every output write  */
+{
+    u32         th      = ((word         >> APP_STATE_THRESHOLD_SHIFT) & APP_STATE_PIXELS_MASK) >> 4;
+    u32         th_prev = ((SimAlarmWord >> APP_STATE_THRESHOLD_SHIFT) & APP_STATE_PIXELS_MASK) >> 4;
+    u32         alarm   = (word         >> APP_STATE_ALARM_SHIFT) & 1u;
+    u32         prev    = (SimAlarmWord >> APP_STATE_ALARM_SHIFT) & 1u;
+    CPU_INT64U  cause;
+
+
+    if (th != th_prev) {
+        SimAlarmThNs = SimNow;
+    }
+    if ((alarm != 0u) && (prev == 0u)) {                        /* Cause: the die reaching threshold + 1 C, the first   */
+        cause = Sim_TraceRise(XADCPS_CH_TEMP, (double)th + 1.0);/* ... reading above it, or the threshold change        */
+        cause = (SimAlarmThNs > cause) ? SimAlarmThNs : cause;
+        cause = (SimAlarmClrNs > cause) ? SimNow       : cause; /* Rose before the last clear: an early reading again   */
+        cause = SimNow - cause;
+        SimAlarmSets++;
+        SimAlarmLatSumNs += (double)cause;
+        if (cause > SimAlarmLatMaxNs) {
+            SimAlarmLatMaxNs = cause;
+        }
+    } else if ((alarm == 0u) && (prev != 0u)) {
+        SimAlarmClears++;
+        SimAlarmClrNs = SimNow;
+    }
+    SimAlarmWord = word;
+}
+
+void  XGpio_DiscreteWrite (XGpio *InstancePtr, unsigned Channel, u32 Data)
+{
+    (void)InstancePtr;
+    if (Channel > SIM_GPIO_CHANNELS) {
+        return;
+    }
+    pthread_mutex_lock(&SimLock);
+    if (Channel == SIM_GPIO_OUT_CHANNEL) {
+        Sim_AlarmCheck(Data);
+    }
+    SimGpioOut[Channel] = Data;
+    SimGpioWrCtr[Channel]++;
+    if (SimGpioLogPath != NULL) {
+        if (SimGpioLogLen == SimGpioLogCap) {
+            SimGpioLogCap = (SimGpioLogCap != 0u) ? SimGpioLogCap * 2u : 1024u;
+            SimGpioLog    = realloc(SimGpioLog, SimGpioLogCap * sizeof(*SimGpioLog));
+            if (SimGpioLog == NULL) {
+                Sim_Die("GPIO log", "out of memory");
+            }
+        }
+        SimGpioLog[SimGpioLogLen].Ns      = SimNow;
+        SimGpioLog[SimGpioLogLen].Channel = Channel;
+        SimGpioLog[SimGpioLogLen].Value   = Data;
+        SimGpioLogLen++;
+    }
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  XGpio_InterruptGlobalEnable (XGpio *InstancePtr)
+{
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    SimGpioGie = 1;
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  XGpio_InterruptGlobalDisable (XGpio *InstancePtr)
+{
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    SimGpioGie = 0;
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  XGpio_InterruptEnable (XGpio *InstancePtr, u32 Mask)
+{
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    SimGpioIer |= Mask;
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  XGpio_InterruptDisable (XGpio *InstancePtr, u32 Mask)
+{
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    SimGpioIer &= ~Mask;
+    pthread_mutex_unlock(&SimLock);
+}
+
+void  XGpio_InterruptClear (XGpio *InstancePtr, u32 Mask)
+{
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    SimGpioIsr &= ~Mask;
+    pthread_mutex_unlock(&SimLock);
+}
+
+u32  XGpio_InterruptGetStatus (XGpio *InstancePtr)
+{
+    u32  status;
+
+
+    (void)InstancePtr;
+    pthread_mutex_lock(&SimLock);
+    status = SimGpioIsr;
+    pthread_mutex_unlock(&SimLock);
+    return (status);
+}
+
+CPU_INT64U  Sim_GpioWrites (unsigned channel)
+{
+    return ((channel <= SIM_GPIO_CHANNELS) ? SimGpioWrCtr[channel] : 0u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            XADCPS DRIVER
+*********************************************************************************************************
+*/
+
+XAdcPs_Config  *XAdcPs_LookupConfig (u16 DeviceId)
+{
+    return ((DeviceId == SimAdcCfg.DeviceId) ? &SimAdcCfg : NULL);
+}
+
+int  XAdcPs_CfgInitialize (XAdcPs *InstancePtr, XAdcPs_Config *ConfigPtr, u32 EffectiveAddr)
+{
+    InstancePtr->Config             = *ConfigPtr;
+    InstancePtr->Config.BaseAddress = EffectiveAddr;
+    InstancePtr->IsReady            = 1u;
+    InstancePtr->SequencerMode      = XADCPS_SEQ_MODE_SAFE;
+    InstancePtr->SeqChEnables       = 0u;
+    InstancePtr->SeqAvgEnables      = 0u;
+    InstancePtr->Average            = XADCPS_AVG_0_SAMPLES;
+    return (XST_SUCCESS);
+}
+
+int  XAdcPs_SelfTest (XAdcPs *InstancePtr)
+{
+    return (InstancePtr->IsReady ? XST_SUCCESS : XST_FAILURE);
+}
+
+void  XAdcPs_SetSequencerMode (XAdcPs *InstancePtr, u8 SequencerMode)
+{
+    InstancePtr->SequencerMode = SequencerMode;
+}
+
+u8  XAdcPs_GetSequencerMode (XAdcPs *InstancePtr)
+{
+    return (InstancePtr->SequencerMode);
+}
+
+int  XAdcPs_SetSeqChEnables (XAdcPs *InstancePtr, u32 ChEnableMask)
+{
+    if (InstancePtr->SequencerMode != XADCPS_SEQ_MODE_SAFE) {  /* The driver refuses while the sequencer runs          */
+        return (XST_FAILURE);
+    }
+    InstancePtr->SeqChEnables = ChEnableMask;
+    return (XST_SUCCESS);
+}
+
+int  XAdcPs_SetSeqAvgEnables (XAdcPs *InstancePtr, u32 AvgEnableChMask)
+{
+    if (InstancePtr->SequencerMode != XADCPS_SEQ_MODE_SAFE) {
+        return (XST_FAILURE);
+    }
+    InstancePtr->SeqAvgEnables = AvgEnableChMask;
+    return (XST_SUCCESS);
+}
+
+void  XAdcPs_SetAvg (XAdcPs *InstancePtr, u8 Average)
+{
+    InstancePtr->Average = Average;
+}
+
+static  double  Sim_AdcNoise (void)                             /* Standard normal deviate (Box-Muller on xorshift64)   */
+{
+    double  u1;
+    double  u2;
+
+
+    SimAdcRng ^= SimAdcRng << 13;
+    SimAdcRng ^= SimAdcRng >> 7;
+    SimAdcRng ^= SimAdcRng << 17;
+    u1 = ((double)(SimAdcRng >> 11) + 1.0) / 9007199254740993.0;
+    SimAdcRng ^= SimAdcRng << 13;
+    SimAdcRng ^= SimAdcRng >> 7;
+    SimAdcRng ^= SimAdcRng << 17;
+    u2 = (double)(SimAdcRng >> 11) / 9007199254740992.0;
+    return (sqrt(-2.0 * log(u1)) * cos(2.0 * 3.14159265358979323846 * u2));
+}
+
+static  u32  Sim_AdcSeqMask (u8 Channel)                         /* Sequencer register bit of a channel                  */
+{
+    if (Channel >= XADCPS_CH_AUX_MIN) {
+        return (XADCPS_SEQ_CH_AUX00 << (Channel - XADCPS_CH_AUX_MIN));
+    }
+    return (XADCPS_SEQ_CH_TEMP << Channel);
+}
+
+u16  XAdcPs_GetAdcData (XAdcPs *InstancePtr, u8 Channel)
+{
+    static  const  double  avg_n[4] = { 1.0, 16.0, 64.0, 256.0 };
+    double  value;
+    double  code;
+    double  sigma;
+
+
+    if (Channel >= SIM_ADC_CHANNELS) {
+        return (0u);
+    }
+    pthread_mutex_lock(&SimLock);
+    value = Sim_AdcValue(Channel);
+    if (Channel == XADCPS_CH_TEMP) {
+        code = (value + 273.15) * 0.00198421639 * 4096.0;       /* Inverse of XAdcPs_RawToTemperature()                 */
+    } else if ((Channel == XADCPS_CH_VPVN) || (Channel >= XADCPS_CH_AUX_MIN)) {
+        code = value * 4096.0;                                  /* External inputs: 1 V full scale, unipolar            */
+    } else {
+        code = value / 3.0 * 4096.0;                            /* Supply sensors: 3 V full scale                       */
+    }
+    if (SimAdcNoiseLsb > 0.0) {                                 /* Averaging divides the noise by sqrt(samples)         */
+        sigma = SimAdcNoiseLsb;
+        if ((InstancePtr->SeqAvgEnables & Sim_AdcSeqMask(Channel)) != 0u) {
+            sigma /= sqrt(avg_n[InstancePtr->Average & 3u]);
+        }
+        code += sigma * Sim_AdcNoise();
+    }
+    pthread_mutex_unlock(&SimLock);
+    if (code < 0.0) {
+        code = 0.0;
+    } else if (code > 4095.0) {
+        code = 4095.0;
+    }
+    return ((u16)((u16)lround(code) << 4));                     /* 12-bit result, MSB justified                         */
+}
@@ -0,0 +1,64 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+* Description : Runs app.c on a Linux host in place of the Zynq PS. The Xilinx drivers (XAdcPs, XGpio)
+*               and the uC/OS-III services used by the application are replaced by the stand-ins in this
+*               directory, which are driven by a virtual clock and a script of input events.
+*
+* Build       : gcc -O2 -I . -I host -DAPP_SPEC_EN=DEF_TRUE
+*                   app.c app_log.c app_mon.c app_state.c app_temp.c app_prof.c app_spec.c app_rate.c
+*                   app_wheel.c app_tlm.c
+*                   host/sim.c -lpthread -lm -o app_sim
+*
+* Environment : SIM_SCRIPT       Script of input events (see below). Default: 25 C, no buttons.
+*               SIM_DURATION_MS  Simulated time to run, in milliseconds.       Default: 10000.
+*               SIM_UART         File that receives UCOS_Print() output, '-' for stdout, 'none'
+*                                to discard it.                                 Default: '-'.
+*               SIM_UART_BAUD    When set, every byte printed keeps the CPU busy for 10 bit times,
+*                                as the polled PS UART does.                    Default: 0 (free).
+*               SIM_CPU_SCALE    When set, virtual time also advances by the host CPU time used by
+*                                the tasks, multiplied by this factor.          Default: 0 (free).
+*               SIM_ADC_NOISE_LSB  Gaussian noise added to every XADC conversion, in LSB rms, divided
+*                                by sqrt(N) on channels with N-sample averaging. Default: 0.
+*               SIM_GPIO_LOG     File that receives every GPIO write as 'ms channel value'.
+*               SIM_REPORT       File that receives the end of run report.      Default: stderr.
+*               SIM_FRAMES       Capture file (model/ap_capture.hpp) whose sweeps are posted to
+*                                AppSpec_Post() at the time the PL completes them, as an end of
+*                                sweep interrupt would. Needs the spectrum task, which only
+*                                this build enables (APP_SPEC_EN).              Default: none.
+*
+* Script      : One event per line, '#' starts a comment. Times are in milliseconds.
+*
+*                   <ms>  temp    <celsius>              Temperature trace point, linearly interpolated
+*                   <ms>  adc     <channel> <volts>      Same for any other XADC channel (XADCPS_CH_...)
+*                   <ms>  button  <value>                Level of the button GPIO channel from <ms> on
+*                   <ms>  press   <value>  <hold_ms>     Button <value> held for <hold_ms>, then released
+*                   <ms>  burst   <value>  <count> <hold_ms> <gap_ms>
+*                                                        <count> presses of <hold_ms>, <gap_ms> apart
+*********************************************************************************************************
+*/
+
+#ifndef  SIM_H
+#define  SIM_H
+
+#include  <Source/os.h>
+#include  "xil_types.h"
+
+
+/*
+*********************************************************************************************************
+*                                          FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+CPU_INT64U  Sim_NowNs          (void);                          /* Virtual time since OSStart(), in nanoseconds          */
+CPU_INT64U  Sim_HostNs         (void);                          /* Host monotonic clock, in nanoseconds                  */
+
+double      Sim_Temperature    (void);                          /* Scripted temperature at the current virtual time      */
+double      Sim_AdcValue       (unsigned ch);                   /* Scripted input of XADC channel 'ch' (C or volts)     */
+u32         Sim_Buttons        (void);                          /* Scripted button level at the current virtual time     */
+
+CPU_INT64U  Sim_GpioWrites     (unsigned channel);              /* Number of XGpio_DiscreteWrite() calls on 'channel'    */
+
+#endif
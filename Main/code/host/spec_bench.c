@@ -0,0 +1,230 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                     Spectrum analysis benchmark
+*
+* Description : Feeds AppSpec_Analyze() and AppSpec_Goertzel() synthetic sweeps with known content (a
+*               tone, two harmonics and gaussian noise, quantized to 12 bits), compares the figures with
+*               the expected ones, then measures how many sweeps per second each of them handles.
+*
+* Build       : gcc -O2 -I . -I host host/spec_bench.c app_spec.c -lm -o spec_bench
+*
+* Usage       : spec_bench [sweeps per pass]
+*********************************************************************************************************
+*/
+
+#include  <math.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <time.h>
+
+#include  "app_spec.h"
+
+
+#define  BENCH_SWEEPS      64u                                  /* Distinct sweeps cycled through when timing           */
+#define  BENCH_PASSES       5u                                  /* Best of                                              */
+
+
+typedef  struct {
+    const char  *NamePtr;
+    double       Hz;
+    double       Ampl;                                          /* Codes                                                */
+    double       H2Dbc;                                         /* 2nd and 3rd harmonic, dB below the tone              */
+    double       H3Dbc;
+    double       NoiseLsb;                                      /* rms                                                  */
+    unsigned     HScale;
+    unsigned     VScale;
+} BENCH_CASE;
+
+static  const  BENCH_CASE  BenchCases[] = {
+/*    Name              Hz        Ampl   H2     H3     Noise  hs  vs */
+    { "clean 12 kHz",   12345.0,  1800.0, -200.0, -200.0, 0.0,  0u, 0u },
+    { "distorted",      12345.0,  1800.0,  -50.0,  -60.0, 0.5,  0u, 0u },
+    { "noisy",          48000.0,  1000.0,  -40.0, -200.0, 4.0,  0u, 0u },
+    { "aliased H3",    310000.0,  1500.0, -200.0,  -45.0, 0.5,  0u, 0u },
+    { "hscale 3",        5000.0,  1900.0,  -55.0,  -65.0, 1.0,  3u, 0u },
+    { "vscale 1",       20000.0,  1900.0,  -45.0, -200.0, 1.0,  0u, 1u },
+};
+#define  BENCH_CASES  (sizeof(BenchCases) / sizeof(BenchCases[0]))
+
+static  CPU_INT16U       BenchBuf[BENCH_SWEEPS][APP_SPEC_SAMPLES];
+static  unsigned long    BenchRng = 0x2545F4914F6CDD1Dul;
+static  volatile float   BenchSink;
+static  void            *BenchPosted[APP_SPEC_BUFS + 1u];       /* Messages seen by the OSTaskQPost() stand-in          */
+static  unsigned         BenchPostedN;
+
+
+void  OSTaskQPost (OS_TCB *p_tcb, void *p_void, OS_MSG_SIZE msg_size, OS_OPT opt, OS_ERR *p_err)
+{
+    (void)p_tcb;
+    (void)msg_size;
+    (void)opt;
+    if (BenchPostedN >= sizeof(BenchPosted) / sizeof(BenchPosted[0])) {
+        *p_err = OS_ERR_Q_MAX;
+        return;
+    }
+    BenchPosted[BenchPostedN++] = p_void;
+    *p_err = OS_ERR_NONE;
+}
+
+
+static  double  BenchNow (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+
+static  double  BenchGauss (void)                               /* Standard normal deviate (Box-Muller on xorshift64)   */
+{
+    double  u1;
+    double  u2;
+
+
+    BenchRng ^= BenchRng << 13; BenchRng ^= BenchRng >> 7; BenchRng ^= BenchRng << 17;
+    u1 = ((double)(BenchRng >> 11) + 1.0) / 9007199254740993.0;
+    BenchRng ^= BenchRng << 13; BenchRng ^= BenchRng >> 7; BenchRng ^= BenchRng << 17;
+    u2 = (double)(BenchRng >> 11) / 9007199254740992.0;
+    return (sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2));
+}
+
+
+static  void  BenchSweep (const BENCH_CASE *c, double phase, CPU_INT16U *out)
+{
+    double    fs = (108e6 / 101.0) / (c->HScale + 1u);
+    double    a2 = c->Ampl * pow(10.0, c->H2Dbc / 20.0);
+    double    a3 = c->Ampl * pow(10.0, c->H3Dbc / 20.0);
+    unsigned  i;
+
+
+    for (i = 0u; i < APP_SPEC_SAMPLES; i++) {
+        double  w = 2.0 * M_PI * c->Hz * i / fs + phase;
+        double  v = 2048.0 + c->Ampl * cos(w) + a2 * cos(2.0 * w) + a3 * cos(3.0 * w) + c->NoiseLsb * BenchGauss();
+        long    q = lround(v);
+
+
+        q      = (q < 0) ? 0 : (q > 4095) ? 4095 : q;
+        out[i] = (CPU_INT16U)(q >> c->VScale);
+    }
+}
+
+
+static  int  BenchCheck (void)
+{
+    APP_SPEC_RESULT  res;
+    APP_SPEC_BIN     bin;
+    CPU_CHAR         line[APP_SPEC_LINE_SIZE];
+    unsigned         i;
+    int              fail = 0;
+
+
+    printf("%-14s %-12s %9s %8s %8s %8s %9s\n", "case", "", "Hz", "dBFS", "THD", "SNR", "Goertzel");
+    for (i = 0u; i < BENCH_CASES; i++) {
+        const BENCH_CASE  *c     = &BenchCases[i];
+        double             q     = (c->VScale == 0u) ? 1.0 : (double)(1u << c->VScale);
+        double             noise = c->NoiseLsb * c->NoiseLsb + q * q / 12.0;
+        double             thd   = 10.0 * log10(pow(10.0, c->H2Dbc / 10.0) + pow(10.0, c->H3Dbc / 10.0));
+        double             snr   = 10.0 * log10(c->Ampl * c->Ampl / 2.0 / noise);
+        double             lvl   = 20.0 * log10(c->Ampl / 2048.0);
+
+
+        BenchSweep(c, 0.3, BenchBuf[0]);
+        AppSpec_Analyze(BenchBuf[0], (CPU_INT08U)c->HScale, (CPU_INT08U)c->VScale, &res);
+        bin.NamePtr = "tone";
+        bin.Hz      = (float)c->Hz;
+        AppSpec_Goertzel(BenchBuf[0], (CPU_INT08U)c->HScale, (CPU_INT08U)c->VScale, &bin, 1u);
+
+        printf("%-14s %-12s %9.1f %8.2f %8.2f %8.2f %9.2f\n", c->NamePtr, "expected", c->Hz, lvl,
+               (thd < -150.0) ? -INFINITY : thd, snr, lvl);
+        printf("%-14s %-12s %9.1f %8.2f %8.2f %8.2f %9.2f\n", "", "measured", res.FreqHz, res.LevelDb,
+               res.ThdDb, res.SnrDb, bin.LevelDb);
+        (void)AppSpec_Format(&res, line, sizeof(line));
+        printf("%-14s %s\n", "", line);
+
+        if ((fabs(res.FreqHz - c->Hz) > 0.05 * res.SampleHz / APP_SPEC_FFT_N) ||
+            (fabs(res.LevelDb - lvl) > 0.1) || (fabs(bin.LevelDb - lvl) > 0.1) ||
+            ((thd > -100.0) && (fabs(res.ThdDb - thd) > 1.0)) ||
+            (fabs(res.SnrDb - snr) > 1.5)) {
+            printf("%-14s ** out of tolerance\n", "");
+            fail = 1;
+        }
+    }
+    return (fail);
+}
+
+
+static  int  BenchPort (void)                                  /* Pool: one frame per buffer, then drops, then reuse   */
+{
+    OS_TCB           tcb;
+    APP_SPEC_FRAME  *p_frame;
+    unsigned         i;
+    int              fail = 0;
+
+
+    AppSpec_PortInit(&tcb);
+    for (i = 0u; i < APP_SPEC_BUFS; i++) {
+        fail |= (AppSpec_Post(BenchBuf[i], 1u, 0u) != DEF_TRUE);
+    }
+    fail |= (AppSpec_Post(BenchBuf[0], 1u, 0u) != DEF_FALSE) || (AppSpec_Dropped() != 1u);
+    p_frame = (APP_SPEC_FRAME *)BenchPosted[0];
+    fail |= (p_frame->HScale != 1u) || (p_frame->Samples[7] != BenchBuf[0][7]);
+    AppSpec_Release(p_frame);
+    fail |= (AppSpec_Post(BenchBuf[1], 2u, 0u) != DEF_TRUE) || (BenchPosted[APP_SPEC_BUFS] != p_frame);
+    printf("\nFrame pool     : %s\n", fail ? "** FAILED" : "ok");
+    return (fail);
+}
+
+
+int  main (int argc, char **argv)
+{
+    unsigned long    n = (argc > 1) ? strtoul(argv[1], NULL, 0) : 2000ul;
+    APP_SPEC_RESULT  res;
+    APP_SPEC_BIN     bank[] = { { "1k", 1000.0f, 0.0f }, { "10k", 10000.0f, 0.0f },
+                                { "50k", 50000.0f, 0.0f }, { "100k", 100000.0f, 0.0f } };
+    double           best_fft = 1e30;
+    double           best_goe = 1e30;
+    unsigned long    i;
+    unsigned         p;
+    int              fail;
+
+
+    AppSpec_Init();
+    fail  = BenchCheck();
+    fail |= BenchPort();
+
+    for (i = 0u; i < BENCH_SWEEPS; i++) {
+        BenchSweep(&BenchCases[1], 0.1 * i, BenchBuf[i]);
+    }
+    for (p = 0u; p < BENCH_PASSES; p++) {
+        double  t0 = BenchNow();
+        double  t;
+
+
+        for (i = 0u; i < n; i++) {
+            AppSpec_Analyze(BenchBuf[i % BENCH_SWEEPS], 0u, 0u, &res);
+            BenchSink = res.FreqHz;
+        }
+        t        = (BenchNow() - t0) / (double)n;
+        best_fft = (t < best_fft) ? t : best_fft;
+
+        t0 = BenchNow();
+        for (i = 0u; i < n; i++) {
+            AppSpec_Goertzel(BenchBuf[i % BENCH_SWEEPS], 0u, 0u, bank, sizeof(bank) / sizeof(bank[0]));
+            BenchSink = bank[0].LevelDb;
+        }
+        t        = (BenchNow() - t0) / (double)n;
+        best_goe = (t < best_goe) ? t : best_goe;
+    }
+
+    printf("\n%lu sweeps per pass, best of %u\n", n, BENCH_PASSES);
+    printf("AppSpec_Analyze  (%u-point FFT)  : %8.1f us/sweep  %8.0f sweeps/s\n",
+           APP_SPEC_FFT_N, best_fft / 1e3, 1e9 / best_fft);
+    printf("AppSpec_Goertzel (%u tones)        : %8.1f us/sweep  %8.0f sweeps/s\n",
+           (unsigned)(sizeof(bank) / sizeof(bank[0])), best_goe / 1e3, 1e9 / best_goe);
+    printf("VGA frame rate                    : %8.1f sweeps/s at most (one per vsync)\n", 108e6 / (1688.0 * 1066.0));
+    return (fail ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,146 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                  Stress run of the output state publisher
+*
+* Description : Hammers AppState_SetThreshold(), AppState_SetTemperature() and AppState_Publish() from
+*               several free-running threads (truly parallel, unlike the simulated kernel) and checks
+*               every word that reaches the GPIO:
+*
+*               - Never torn: the temperature writers always set 'alarm' to the parity of the temperature,
+*                 so a word mixing two updates of that pair is detected.
+*               - Single writer: two threads are never inside XGpio_DiscreteWrite() at the same time, so
+*                 the GPIO sees the words in the order they were read from the state.
+*               - Up to date: after the threads stop, the GPIO holds the latest word.
+*
+* Build       : gcc -O2 -I . -I host host/state_stress.c app_state.c -lpthread -o state_stress
+*
+* Usage       : state_stress [iterations per thread]
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <pthread.h>
+
+#include  "app_state.h"
+
+
+#define  STRESS_THREADS_TEMP       2u
+#define  STRESS_THREADS_THRESHOLD  1u
+#define  STRESS_THREADS_PUBLISH    1u                           /* Publish without changing anything                    */
+#define  STRESS_THREADS           (STRESS_THREADS_TEMP + STRESS_THREADS_THRESHOLD + STRESS_THREADS_PUBLISH)
+
+
+static  APP_STATE           StressState;
+static  XGpio               StressGpio;
+static  unsigned long       StressIters = 1000000ul;
+
+static  _Atomic CPU_INT32U  StressInside;                       /* Threads inside XGpio_DiscreteWrite()                 */
+static  _Atomic CPU_INT32U  StressTemp;
+static  CPU_INT32U          StressGpioWord;
+static  unsigned long       StressTorn;
+static  _Atomic CPU_INT32U  StressOverlap;
+
+
+void  XGpio_DiscreteWrite (XGpio *InstancePtr, unsigned Channel, u32 Data)
+{
+    CPU_INT32U  temp  = (Data >> APP_STATE_TEMPERATURE_SHIFT) & APP_STATE_PIXELS_MASK;
+    CPU_INT32U  alarm = (Data >> APP_STATE_ALARM_SHIFT) & 1u;
+
+
+    (void)InstancePtr;
+    (void)Channel;
+    if (atomic_fetch_add(&StressInside, 1u) != 0u) {
+        atomic_fetch_add(&StressOverlap, 1u);
+    }
+    if (alarm != ((temp >> 4) & 1u)) {
+        StressTorn++;
+    }
+    StressGpioWord = Data;
+    atomic_fetch_sub(&StressInside, 1u);
+}
+
+
+static  void  *StressTempTask (void *p_arg)
+{
+    unsigned long  i;
+
+
+    (void)p_arg;
+    for (i = 0u; i < StressIters; i++) {
+        CPU_INT32U  t = atomic_fetch_add(&StressTemp, 1u) + 1u;
+
+
+        AppState_SetTemperature(&StressState, (int)t, (int)(t & 1u));
+        AppState_Publish(&StressState);
+    }
+    return (NULL);
+}
+
+
+static  void  *StressThresholdTask (void *p_arg)
+{
+    unsigned long  i;
+
+
+    (void)p_arg;
+    for (i = 0u; i < StressIters; i++) {
+        AppState_SetThreshold(&StressState, (int)(i % 100u));
+        AppState_Publish(&StressState);
+    }
+    return (NULL);
+}
+
+
+static  void  *StressPublishTask (void *p_arg)
+{
+    unsigned long  i;
+
+
+    (void)p_arg;
+    for (i = 0u; i < StressIters; i++) {
+        AppState_Publish(&StressState);
+    }
+    return (NULL);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    pthread_t      th[STRESS_THREADS];
+    unsigned       i;
+    unsigned long  calls;
+    int            ok;
+
+
+    if (argc > 1) {
+        StressIters = strtoul(argv[1], NULL, 0);
+    }
+    AppState_Init(&StressState, &StressGpio, 2u);
+
+    for (i = 0u; i < STRESS_THREADS; i++) {
+        pthread_create(&th[i], NULL,
+                       (i < STRESS_THREADS_TEMP)                            ? StressTempTask      :
+                       (i < STRESS_THREADS_TEMP + STRESS_THREADS_THRESHOLD) ? StressThresholdTask :
+                                                                              StressPublishTask,   NULL);
+    }
+    for (i = 0u; i < STRESS_THREADS; i++) {
+        pthread_join(th[i], NULL);
+    }
+
+    calls = StressIters * STRESS_THREADS;
+    ok    = (StressTorn == 0u) && (atomic_load(&StressOverlap) == 0u) &&
+            (StressGpioWord == atomic_load(&StressState.Word));
+
+    printf("publish calls   : %lu\n", calls);
+    printf("GPIO writes     : %u\n", (unsigned)atomic_load(&StressState.Writes));
+    printf("writes avoided  : %u\n", (unsigned)atomic_load(&StressState.Avoided));
+    printf("torn words      : %lu\n", StressTorn);
+    printf("overlapping     : %u\n", (unsigned)atomic_load(&StressOverlap));
+    printf("final GPIO word : 0x%06x (state 0x%06x)\n",
+           (unsigned)StressGpioWord, (unsigned)atomic_load(&StressState.Word));
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
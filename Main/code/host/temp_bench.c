@@ -0,0 +1,120 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                 Temperature conversion micro-benchmark
+*
+* Description : Checks AppTemp_Celsius() and AppTemp_Pixels() against the float conversion of the driver
+*               for all 65536 raw results, then times both over a buffer of raw values around room
+*               temperature, as AppTask1 sees them with 64-sample averaging.
+*
+* Build       : gcc -O2 -I . -I host host/temp_bench.c app_temp.c -o temp_bench
+*
+* Usage       : temp_bench [conversions per pass]
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <time.h>
+
+#include  "app_temp.h"
+
+
+#define  BENCH_BUF_SIZE   4096u                                 /* Raw values per pass, fits in L1                      */
+#define  BENCH_PASSES        5u                                 /* Best of                                              */
+
+
+static  u16           BenchRaw[BENCH_BUF_SIZE];
+static  volatile int  BenchSink;                                /* Keeps the loops from being optimized away             */
+
+
+static  double  BenchNow (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+
+static  double  BenchFloat (unsigned long n)
+{
+    unsigned long  i;
+    int            acc = 0;
+    double         t0  = BenchNow();
+
+
+    for (i = 0u; i < n; i++) {
+        acc += (int)XAdcPs_RawToTemperature(BenchRaw[i % BENCH_BUF_SIZE]);
+    }
+    BenchSink = acc;
+    return ((BenchNow() - t0) / (double)n);
+}
+
+
+static  double  BenchLut (unsigned long n)
+{
+    unsigned long  i;
+    int            acc = 0;
+    double         t0  = BenchNow();
+
+
+    for (i = 0u; i < n; i++) {
+        acc += AppTemp_Celsius(BenchRaw[i % BENCH_BUF_SIZE]);
+    }
+    BenchSink = acc;
+    return ((BenchNow() - t0) / (double)n);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    unsigned long  n = 50000000ul;
+    unsigned long  mismatch = 0u;
+    unsigned       raw;
+    unsigned       i;
+    double         ns_float = 1e9;
+    double         ns_lut   = 1e9;
+    double         ns;
+
+
+    if (argc > 1) {
+        n = strtoul(argv[1], NULL, 0);
+    }
+
+    for (raw = 0u; raw <= 0xFFFFu; raw++) {                     /* Exhaustive check against the float path              */
+        int  ref = (int)XAdcPs_RawToTemperature(raw);
+
+
+        if ((AppTemp_Celsius((u16)raw) != ref) ||
+            (AppTemp_Pixels((u16)raw)  != (u16)((ref & 0x7F) << 4))) {
+            if (mismatch < 10u) {
+                printf("mismatch raw 0x%04x: float %d, table %d\n", raw, ref, AppTemp_Celsius((u16)raw));
+            }
+            mismatch++;
+        }
+    }
+
+    srand(1u);
+    for (i = 0u; i < BENCH_BUF_SIZE; i++) {                     /* 32..71 C with random fractional bits                 */
+        BenchRaw[i] = (u16)(0x9B00u + (unsigned)rand() % 0x1400u);
+    }
+    for (i = 0u; i < BENCH_PASSES; i++) {
+        ns = BenchFloat(n);
+        if (ns < ns_float) {
+            ns_float = ns;
+        }
+        ns = BenchLut(n);
+        if (ns < ns_lut) {
+            ns_lut = ns;
+        }
+    }
+
+    printf("raw values checked : 65536, %lu mismatches\n", mismatch);
+    printf("float conversion   : %.2f ns\n", ns_float);
+    printf("table conversion   : %.2f ns (%.1fx)\n", ns_lut, ns_float / ns_lut);
+    printf("%s\n", (mismatch == 0u) ? "PASS" : "FAIL");
+    return ((mismatch == 0u) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
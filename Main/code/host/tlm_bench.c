@@ -0,0 +1,419 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                Text against binary telemetry, over a pty
+*
+* Description : Sends the same series of temperature samples through a local pseudo-terminal twice: as the
+*               text the temperature job prints, and as the SAMPLE records of app_tlm.h. A reader thread
+*               on the other side parses the text back, or decodes the frames, and checks every sample.
+*               For each mode it reports:
+*
+*               - bytes per sample on the line;
+*               - CPU time to format or encode one sample, and to parse or decode it;
+*               - samples per second through the pty, end to end;
+*               - the samples per second the line allows at 115200 baud (8N1, 10 bits a byte), which is
+*                 what limits the board.
+*
+* Build       : gcc -O2 -I . -I host host/tlm_bench.c app_tlm.c app_log.c -lpthread -o tlm_bench
+*
+* Usage       : tlm_bench [samples]
+*
+* Note(s)     : 1) The pty is in raw mode and has no baud rate of its own: it runs at memory speed, so its
+*                  figure compares the cost of each format on the host, not on the line.
+*               2) The text is the one of the temperature job: five lines per sample, plus the alarm line
+*                  when the alarm word changes. The parser only takes back what the text holds.
+*********************************************************************************************************
+*/
+
+#define  _XOPEN_SOURCE  600
+#define  _DEFAULT_SOURCE
+
+#include  <fcntl.h>
+#include  <pthread.h>
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <termios.h>
+#include  <time.h>
+#include  <unistd.h>
+
+#include  "app_tlm.h"
+
+
+#define  BENCH_BAUD          115200.0
+#define  BENCH_CHUNK           4096u                            /* Bytes per read()                                     */
+#define  BENCH_SAMPLE_MAX       160u                            /* Bytes of one sample, either format                   */
+#define  BENCH_PASSES             5u                            /* Best of, for the CPU times                           */
+
+
+typedef  struct {
+    int         Temperature;
+    int         Threshold;
+    unsigned    Alarm;
+    CPU_INT32U  Alarms;
+} BENCH_SAMPLE;
+
+typedef  struct {                                               /* Receiver state, either format                        */
+    CPU_INT08U    Buf[BENCH_SAMPLE_MAX];                        /* Current line, or frame                               */
+    size_t        Len;
+    BENCH_SAMPLE  Cur;
+    size_t        Got;                                          /* Samples taken back                                   */
+    size_t        Bad;                                          /* ... that differ from what was sent                   */
+    size_t        Rejected;                                     /* Lines or frames that did not parse                   */
+} BENCH_RX;
+
+typedef  struct {
+    const char   *NamePtr;
+    size_t      (*Encode)(size_t i, CPU_INT08U *p_out);
+    void        (*Decode)(BENCH_RX *p_rx, const CPU_INT08U *p_in, size_t len);
+} BENCH_MODE;
+
+typedef  struct {                                               /* One run through the pty                              */
+    const BENCH_MODE  *ModePtr;
+    int                Fd;
+    BENCH_RX           Rx;
+} BENCH_RUN;
+
+
+static  BENCH_SAMPLE   *BenchIn;
+static  size_t          BenchN = 200000u;
+static  volatile size_t BenchSink;
+
+
+static  double  BenchNow (void)
+{
+    struct timespec  ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9 + (double)ts.tv_nsec);
+}
+
+
+static  void  BenchCheck (BENCH_RX *p_rx, CPU_BOOLEAN alarms)   /* A sample was taken back                              */
+{
+    const BENCH_SAMPLE  *p_s = &BenchIn[p_rx->Got];
+
+
+    if ((p_rx->Got >= BenchN) ||
+        (p_rx->Cur.Temperature != p_s->Temperature) || (p_rx->Cur.Threshold != p_s->Threshold) ||
+        (p_rx->Cur.Alarm != p_s->Alarm) || ((alarms) && (p_rx->Cur.Alarms != p_s->Alarms))) {
+        p_rx->Bad++;
+    }
+    p_rx->Got++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                              TEXT MODE
+*********************************************************************************************************
+*/
+
+static  size_t  BenchTextEncode (size_t i, CPU_INT08U *p_out)
+{
+    const BENCH_SAMPLE  *p_s = &BenchIn[i];
+    char                *p   = (char *)p_out;
+    int                  n;
+
+
+    n  = sprintf(p,     "\n Temperature: %d", p_s->Temperature);
+    n += sprintf(p + n, "\n Temperature pixels: %u", (unsigned)p_s->Temperature << 4);
+    n += sprintf(p + n, "\n Threshold: %d", p_s->Threshold & 0x7F);
+    n += sprintf(p + n, "\n Threshold pixels: %u", (unsigned)(p_s->Threshold & 0x7F) << 4);
+    if ((i == 0u) || (p_s->Alarms != p_s[-1].Alarms)) {
+        n += sprintf(p + n, "\n alarms:%s", (p_s->Alarms != 0u) ? " temp" : " none");
+    }
+    n += sprintf(p + n, "\n alarm: %u", p_s->Alarm);
+    return ((size_t)n);
+}
+
+static  void  BenchTextLine (BENCH_RX *p_rx)
+{
+    const char  *line = (const char *)p_rx->Buf;
+    int          v;
+
+
+    p_rx->Buf[p_rx->Len] = '\0';
+    if (p_rx->Len == 0u) {
+        return;
+    }
+    if (sscanf(line, " Temperature pixels: %d", &v) == 1) {
+        return;                                                 /* Same information as the line before                  */
+    } else if (sscanf(line, " Temperature: %d", &v) == 1) {
+        p_rx->Cur.Temperature = v;
+    } else if (sscanf(line, " Threshold pixels: %d", &v) == 1) {
+        return;
+    } else if (sscanf(line, " Threshold: %d", &v) == 1) {
+        p_rx->Cur.Threshold = v;
+    } else if (strncmp(line, " alarms:", 8u) == 0) {
+        return;
+    } else if (sscanf(line, " alarm: %d", &v) == 1) {
+        p_rx->Cur.Alarm = (unsigned)v;
+        BenchCheck(p_rx, DEF_FALSE);                            /* Last line of a sample                                */
+    } else {
+        p_rx->Rejected++;
+    }
+}
+
+static  void  BenchTextDecode (BENCH_RX *p_rx, const CPU_INT08U *p_in, size_t len)
+{
+    size_t  i;
+
+
+    for (i = 0u; i < len; i++) {
+        if (p_in[i] == '\n') {                                  /* A line is complete when the next one starts          */
+            BenchTextLine(p_rx);
+            p_rx->Len = 0u;
+        } else if (p_rx->Len < BENCH_SAMPLE_MAX - 1u) {
+            p_rx->Buf[p_rx->Len++] = p_in[i];
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             BINARY MODE
+*********************************************************************************************************
+*/
+
+static  size_t  BenchBinEncode (size_t i, CPU_INT08U *p_out)
+{
+    const BENCH_SAMPLE  *p_s = &BenchIn[i];
+    CPU_INT08U           p[APP_TLM_SAMPLE_SIZE];
+
+
+    p[0] = (CPU_INT08U)p_s->Temperature;                        /* Same packing as AppTlm_Sample()                      */
+    p[1] = (CPU_INT08U)((CPU_INT16U)p_s->Temperature >> 8);
+    p[2] = (CPU_INT08U)p_s->Threshold;
+    p[3] = (CPU_INT08U)((CPU_INT16U)p_s->Threshold >> 8);
+    p[4] = (CPU_INT08U)p_s->Alarm;
+    p[5] = (CPU_INT08U)p_s->Alarms;
+    p[6] = (CPU_INT08U)(p_s->Alarms >>  8);
+    p[7] = (CPU_INT08U)(p_s->Alarms >> 16);
+    p[8] = (CPU_INT08U)(p_s->Alarms >> 24);
+    p[9] = 200u;
+    p[10] = 0u;
+    return (AppTlm_Encode(APP_TLM_TYPE_SAMPLE, 0u, (CPU_INT16U)i, (CPU_INT32U)(i * 200u), p, sizeof(p), p_out));
+}
+
+static  void  BenchBinDecode (BENCH_RX *p_rx, const CPU_INT08U *p_in, size_t len)
+{
+    APP_TLM_REC  rec;
+    size_t       i;
+
+
+    for (i = 0u; i < len; i++) {
+        if (p_in[i] != 0u) {
+            if (p_rx->Len < BENCH_SAMPLE_MAX) {
+                p_rx->Buf[p_rx->Len++] = p_in[i];
+            }
+            continue;
+        }
+        if ((AppTlm_Decode(p_rx->Buf, (CPU_INT32U)p_rx->Len, &rec) != APP_TLM_ERR_NONE) ||
+            (rec.Type != APP_TLM_TYPE_SAMPLE) || (rec.Seq != (CPU_INT16U)p_rx->Got)) {
+            p_rx->Rejected++;
+        } else {
+            p_rx->Cur.Temperature = (CPU_INT16S)AppTlm_Get16(&rec.Payload[0]);
+            p_rx->Cur.Threshold   = (CPU_INT16S)AppTlm_Get16(&rec.Payload[2]);
+            p_rx->Cur.Alarm       = rec.Payload[4];
+            p_rx->Cur.Alarms      = AppTlm_Get32(&rec.Payload[5]);
+            BenchCheck(p_rx, DEF_TRUE);
+        }
+        p_rx->Len = 0u;
+    }
+}
+
+
+static  const  BENCH_MODE  BenchModes[] = {
+    { "text",   BenchTextEncode, BenchTextDecode },
+    { "binary", BenchBinEncode,  BenchBinDecode  }
+};
+
+
+/*
+*********************************************************************************************************
+*                                          RUN THROUGH A PTY
+*
+* Description : The calling thread encodes every sample and writes it to the master side as soon as it is
+*               formatted, as the board would; BenchReader() reads the slave side in raw mode.
+*********************************************************************************************************
+*/
+
+static  void  *BenchReader (void *p_arg)
+{
+    BENCH_RUN   *p_run = (BENCH_RUN *)p_arg;
+    CPU_INT08U   buf[BENCH_CHUNK];
+    ssize_t      n;
+
+
+    while ((n = read(p_run->Fd, buf, sizeof(buf))) > 0) {
+        p_run->ModePtr->Decode(&p_run->Rx, buf, (size_t)n);
+        if ((p_run->Rx.Got >= BenchN) && (p_run->Rx.Len == 0u)) {
+            break;
+        }
+    }
+    return (NULL);
+}
+
+static  double  BenchPty (const BENCH_MODE *p_mode, BENCH_RUN *p_run, size_t *p_bytes)
+{
+    struct termios  tio;
+    pthread_t       th;
+    CPU_INT08U      buf[BENCH_CHUNK + BENCH_SAMPLE_MAX];
+    size_t          len   = 0u;
+    size_t          bytes = 0u;
+    size_t          i;
+    int             master;
+    int             slave;
+    double          t0;
+    double          t;
+
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0) ||
+        ((slave = open(ptsname(master), O_RDWR | O_NOCTTY)) < 0)) {
+        perror("pty");
+        exit(EXIT_FAILURE);
+    }
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    memset(p_run, 0, sizeof(*p_run));
+    p_run->ModePtr = p_mode;
+    p_run->Fd      = slave;
+    pthread_create(&th, NULL, BenchReader, p_run);
+
+    t0 = BenchNow();
+    for (i = 0u; i <= BenchN; i++) {                            /* Samples go out in writes of up to BENCH_CHUNK bytes  */
+        if (i < BenchN) {
+            len += p_mode->Encode(i, &buf[len]);
+        } else if (p_mode->Decode == BenchTextDecode) {
+            buf[len++] = '\n';                                  /* Ends the last line                                   */
+        }
+        if ((len >= BENCH_CHUNK) || ((i == BenchN) && (len > 0u))) {
+            size_t  off = 0u;
+
+
+            while (off < len) {
+                ssize_t  n = write(master, &buf[off], len - off);
+
+
+                if (n <= 0) {
+                    perror("write");
+                    exit(EXIT_FAILURE);
+                }
+                off += (size_t)n;
+            }
+            bytes += len;
+            len    = 0u;
+        }
+    }
+    pthread_join(th, NULL);
+    t = BenchNow() - t0;
+
+    close(slave);
+    close(master);
+    *p_bytes = bytes;
+    return (t);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          CPU TIME PER SAMPLE
+*********************************************************************************************************
+*/
+
+static  void  BenchCpu (const BENCH_MODE *p_mode, double *p_enc_ns, double *p_dec_ns)
+{
+    static  CPU_INT08U  stream[64u * 1024u * 1024u];
+    BENCH_RX            rx;
+    size_t              len;
+    size_t              n;
+    size_t              i;
+    unsigned            p;
+    double              t0;
+    double              t;
+
+
+    *p_enc_ns = 1e30;
+    *p_dec_ns = 1e30;
+    for (p = 0u; p < BENCH_PASSES; p++) {
+        len = 0u;
+        n   = 0u;
+        t0  = BenchNow();
+        for (i = 0u; (i < BenchN) && (len + BENCH_SAMPLE_MAX < sizeof(stream)); i++) {
+            len += p_mode->Encode(i, &stream[len]);
+            n++;
+        }
+        t         = (BenchNow() - t0) / (double)n;
+        *p_enc_ns = (t < *p_enc_ns) ? t : *p_enc_ns;
+        stream[len++] = (p_mode->Decode == BenchTextDecode) ? '\n' : 0u;
+
+        memset(&rx, 0, sizeof(rx));
+        t0 = BenchNow();
+        p_mode->Decode(&rx, stream, len);
+        t         = (BenchNow() - t0) / (double)n;
+        *p_dec_ns = (t < *p_dec_ns) ? t : *p_dec_ns;
+        BenchSink = rx.Got;
+    }
+}
+
+
+int  main (int argc, char **argv)
+{
+    BENCH_RUN   run;
+    size_t      bytes;
+    unsigned    m;
+    double      t;
+    double      enc;
+    double      dec;
+    double      per;
+    double      temp = 38.0;
+    int         fail = 0;
+    size_t      i;
+
+
+    if (argc > 1) {
+        BenchN = strtoul(argv[1], NULL, 0);
+    }
+    BenchIn = calloc(BenchN, sizeof(BENCH_SAMPLE));
+    if (BenchIn == NULL) {
+        return (EXIT_FAILURE);
+    }
+    srand(1u);
+    for (i = 0u; i < BenchN; i++) {                             /* A slow random walk around the threshold              */
+        temp += (double)(rand() % 201 - 100) / 400.0;
+        temp  = (temp < 20.0) ? 20.0 : (temp > 90.0) ? 90.0 : temp;
+        BenchIn[i].Temperature = (int)temp;
+        BenchIn[i].Threshold   = 50 + (int)((i / 5000u) % 5u);
+        BenchIn[i].Alarm       = (BenchIn[i].Temperature > BenchIn[i].Threshold) ? 1u : 0u;
+        BenchIn[i].Alarms      = BenchIn[i].Alarm;
+    }
+
+    printf("%zu samples\n\n", BenchN);
+    printf("%-8s %12s %12s %12s %14s %14s %10s\n",
+           "mode", "bytes/smp", "encode [ns]", "decode [ns]", "pty [smp/s]", "115200 [smp/s]", "check");
+    for (m = 0u; m < sizeof(BenchModes) / sizeof(BenchModes[0]); m++) {
+        BenchCpu(&BenchModes[m], &enc, &dec);
+        t   = BenchPty(&BenchModes[m], &run, &bytes);
+        per = (double)bytes / (double)BenchN;
+        printf("%-8s %12.1f %12.1f %12.1f %14.0f %14.1f %4zu/%zu%s\n",
+               BenchModes[m].NamePtr, per, enc, dec, (double)BenchN / (t / 1e9),
+               BENCH_BAUD / 10.0 / per, run.Rx.Got - run.Rx.Bad, BenchN,
+               ((run.Rx.Got == BenchN) && (run.Rx.Bad == 0u) && (run.Rx.Rejected == 0u)) ? "" : "  FAIL");
+        if ((run.Rx.Got != BenchN) || (run.Rx.Bad != 0u) || (run.Rx.Rejected != 0u)) {
+            fail = 1;
+        }
+    }
+    printf("\npty: raw mode, no baud rate, host CPU bound. 115200: line limit, 10 bits a byte.\n");
+    free(BenchIn);
+    return (fail ? EXIT_FAILURE : EXIT_SUCCESS);
+}
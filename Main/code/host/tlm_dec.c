@@ -0,0 +1,222 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                     Binary telemetry decoder
+*
+* Description : Reads the UART output of the application built with APP_TLM_BINARY (see app_tlm.h) and
+*               writes one CSV file per record type, plus the text records:
+*
+*                   <prefix>_sample.csv     ms,src,seq,temperature_c,threshold_c,alarm,alarms,period_ms
+*                   <prefix>_button.csv     ms,src,seq,button,threshold_c,latency_us
+*                   <prefix>_counters.csv   ms,src,seq,presses,edges_dropped,log_dropped,samples
+*                   <prefix>_text.txt       text records, and the text printed outside the frames
+*
+*               and a summary on stderr: records per type, rejected frames and sequence gaps, which are
+*               the records the application or the line lost.
+*
+* Build       : gcc -O2 -I . -I host host/tlm_dec.c app_tlm.c app_log.c -o tlm_dec
+*
+* Usage       : tlm_dec [-o prefix] [capture | device | -]
+*
+*               The input can be a file written by the host simulation (SIM_UART) or the serial device
+*               of the board, set to raw mode first (stty -F /dev/ttyUSB1 115200 raw). Default: stdin,
+*               prefix 'tlm'.
+*
+* Note(s)     : 1) The bytes between two zeros that do not decode are text if they are all printable (the
+*                  welcome message, before the first frame), else a rejected frame.
+*********************************************************************************************************
+*/
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+
+#include  "app_tlm.h"
+
+
+#define  DEC_CHUNK_MAX   4096u                                  /* Longest run of non-zero bytes kept                   */
+#define  DEC_SRC_N        256u
+
+
+typedef  struct {
+    FILE           *Out[APP_TLM_TYPE_TEXT + 1u];                /* Indexed by record type                               */
+    unsigned long   Recs[APP_TLM_TYPE_TEXT + 1u];
+    unsigned long   Unknown;
+    unsigned long   Rejected[APP_TLM_ERR_CRC + 1u];
+    unsigned long   TextBytes;                                  /* Outside the frames                                   */
+    unsigned long   Gaps;                                       /* Records missing from the sequence numbers            */
+    unsigned long   Bytes;
+    int             SeqSeen[DEC_SRC_N];
+    CPU_INT16U      SeqNext[DEC_SRC_N];
+} DEC;
+
+
+static  FILE  *DecOpen (const char *prefix, const char *suffix, const char *header)
+{
+    char   path[512];
+    FILE  *f;
+
+
+    snprintf(path, sizeof(path), "%s_%s", prefix, suffix);
+    f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    if (header != NULL) {
+        fprintf(f, "%s\n", header);
+    }
+    return (f);
+}
+
+
+static  void  DecRecord (DEC *p_dec, const APP_TLM_REC *p_rec)
+{
+    const CPU_INT08U  *p = p_rec->Payload;
+    FILE              *f;
+
+
+    if (p_dec->SeqSeen[p_rec->Src]) {
+        p_dec->Gaps += (CPU_INT16U)(p_rec->Seq - p_dec->SeqNext[p_rec->Src]);
+    }
+    p_dec->SeqSeen[p_rec->Src] = 1;
+    p_dec->SeqNext[p_rec->Src] = (CPU_INT16U)(p_rec->Seq + 1u);
+
+    if ((p_rec->Type == 0u) || (p_rec->Type > APP_TLM_TYPE_TEXT)) {
+        p_dec->Unknown++;
+        return;
+    }
+    f = p_dec->Out[p_rec->Type];
+    switch (p_rec->Type) {
+        case APP_TLM_TYPE_SAMPLE:
+             if (p_rec->Len < APP_TLM_SAMPLE_SIZE) {
+                 p_dec->Unknown++;
+                 return;
+             }
+             fprintf(f, "%u,%u,%u,%d,%d,%u,0x%08x,%u\n", (unsigned)p_rec->Ms, p_rec->Src, p_rec->Seq,
+                     (int)(CPU_INT16S)AppTlm_Get16(&p[0]), (int)(CPU_INT16S)AppTlm_Get16(&p[2]), p[4],
+                     (unsigned)AppTlm_Get32(&p[5]), AppTlm_Get16(&p[9]));
+             break;
+
+        case APP_TLM_TYPE_BUTTON:
+             if (p_rec->Len < APP_TLM_BUTTON_SIZE) {
+                 p_dec->Unknown++;
+                 return;
+             }
+             fprintf(f, "%u,%u,%u,%u,%d,%u\n", (unsigned)p_rec->Ms, p_rec->Src, p_rec->Seq,
+                     p[0], (int)(CPU_INT16S)AppTlm_Get16(&p[1]), (unsigned)AppTlm_Get32(&p[3]));
+             break;
+
+        case APP_TLM_TYPE_COUNTERS:
+             if (p_rec->Len < APP_TLM_COUNTERS_SIZE) {
+                 p_dec->Unknown++;
+                 return;
+             }
+             fprintf(f, "%u,%u,%u,%u,%u,%u,%u\n", (unsigned)p_rec->Ms, p_rec->Src, p_rec->Seq,
+                     (unsigned)AppTlm_Get32(&p[0]), (unsigned)AppTlm_Get32(&p[4]),
+                     (unsigned)AppTlm_Get32(&p[8]), (unsigned)AppTlm_Get32(&p[12]));
+             break;
+
+        default:
+             fwrite(p, 1u, p_rec->Len, f);
+             break;
+    }
+    p_dec->Recs[p_rec->Type]++;
+}
+
+
+static  void  DecChunk (DEC *p_dec, const CPU_INT08U *p_chunk, size_t len)
+{
+    APP_TLM_REC  rec;
+    CPU_INT08U   err;
+    size_t       i;
+
+
+    if (len == 0u) {
+        return;
+    }
+    err = AppTlm_Decode(p_chunk, (CPU_INT32U)len, &rec);
+    if (err == APP_TLM_ERR_NONE) {
+        DecRecord(p_dec, &rec);
+        return;
+    }
+    for (i = 0u; i < len; i++) {                                /* Text outside the frames?                             */
+        if (((p_chunk[i] < 0x20u) || (p_chunk[i] > 0x7Eu)) &&
+            (p_chunk[i] != '\r') && (p_chunk[i] != '\n') && (p_chunk[i] != '\t') && (p_chunk[i] != '\f')) {
+            break;
+        }
+    }
+    if (i == len) {
+        fwrite(p_chunk, 1u, len, p_dec->Out[APP_TLM_TYPE_TEXT]);
+        p_dec->TextBytes += len;
+    } else {
+        p_dec->Rejected[err]++;
+    }
+}
+
+
+int  main (int argc, char **argv)
+{
+    static  DEC         dec;
+    static  CPU_INT08U  chunk[DEC_CHUNK_MAX];
+    const char         *prefix = "tlm";
+    const char         *path   = "-";
+    FILE               *in;
+    size_t              len    = 0u;
+    unsigned long       rejected;
+    int                 c;
+    int                 a;
+
+
+    for (a = 1; a < argc; a++) {
+        if ((strcmp(argv[a], "-o") == 0) && (a + 1 < argc)) {
+            prefix = argv[++a];
+        } else if ((argv[a][0] == '-') && (argv[a][1] != '\0')) {
+            fprintf(stderr, "usage: %s [-o prefix] [capture | device | -]\n", argv[0]);
+            return (EXIT_FAILURE);
+        } else {
+            path = argv[a];
+        }
+    }
+    in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (in == NULL) {
+        perror(path);
+        return (EXIT_FAILURE);
+    }
+
+    dec.Out[APP_TLM_TYPE_SAMPLE]   = DecOpen(prefix, "sample.csv",
+                                             "ms,src,seq,temperature_c,threshold_c,alarm,alarms,period_ms");
+    dec.Out[APP_TLM_TYPE_BUTTON]   = DecOpen(prefix, "button.csv", "ms,src,seq,button,threshold_c,latency_us");
+    dec.Out[APP_TLM_TYPE_COUNTERS] = DecOpen(prefix, "counters.csv",
+                                             "ms,src,seq,presses,edges_dropped,log_dropped,samples");
+    dec.Out[APP_TLM_TYPE_TEXT]     = DecOpen(prefix, "text.txt", NULL);
+
+    while ((c = getc(in)) != EOF) {
+        dec.Bytes++;
+        if (c == 0) {
+            DecChunk(&dec, chunk, len);
+            len = 0u;
+        } else if (len < DEC_CHUNK_MAX) {
+            chunk[len++] = (CPU_INT08U)c;
+        }
+    }
+    DecChunk(&dec, chunk, len);                                 /* Whatever came after the last frame                   */
+
+    rejected = dec.Rejected[APP_TLM_ERR_COBS] + dec.Rejected[APP_TLM_ERR_SIZE] + dec.Rejected[APP_TLM_ERR_CRC];
+    fprintf(stderr, "%lu bytes: %lu samples, %lu buttons, %lu counters, %lu text records, %lu unknown\n",
+            dec.Bytes, dec.Recs[APP_TLM_TYPE_SAMPLE], dec.Recs[APP_TLM_TYPE_BUTTON],
+            dec.Recs[APP_TLM_TYPE_COUNTERS], dec.Recs[APP_TLM_TYPE_TEXT], dec.Unknown);
+    fprintf(stderr, "%lu frames rejected (%lu COBS, %lu size, %lu CRC), %lu records lost (sequence gaps), "
+                    "%lu bytes of text outside frames\n",
+            rejected, dec.Rejected[APP_TLM_ERR_COBS], dec.Rejected[APP_TLM_ERR_SIZE], dec.Rejected[APP_TLM_ERR_CRC],
+            dec.Gaps, dec.TextBytes);
+
+    for (a = 1; a <= (int)APP_TLM_TYPE_TEXT; a++) {
+        fclose(dec.Out[a]);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return ((rejected + dec.Gaps > 0u) ? 2 : EXIT_SUCCESS);
+}
@@ -0,0 +1,15 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                   Xilinx ucos_standalone BSP (subset)
+*********************************************************************************************************
+*/
+
+#ifndef  UCOS_BSP_H
+#define  UCOS_BSP_H
+
+void  UCOSStartup (void (*main_task)(void *p_arg));             /* Runs 'main_task' on the calling thread               */
+void  UCOS_Print  (const char *str);                            /* Sends 'str' to the simulated UART                    */
+
+#endif
@@ -0,0 +1,28 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                            Xilinx ucos_standalone interrupt services (subset)
+*
+* Description : Handlers run on the scheduler thread while no task holds the CPU, at the first scheduling
+*               point after the interrupt is raised. See host/sim.c.
+*********************************************************************************************************
+*/
+
+#ifndef  UCOS_INT_H
+#define  UCOS_INT_H
+
+#include  <Source/os.h>
+
+typedef  void  (*UCOS_INT_FNCT_PTR)(void *p_int_arg);
+
+CPU_BOOLEAN  UCOS_IntVectSet (CPU_INT32U          int_id,
+                              CPU_INT08U          int_prio,
+                              CPU_INT08U          int_target_list,
+                              UCOS_INT_FNCT_PTR   int_fnct,
+                              void               *p_int_arg);
+
+CPU_BOOLEAN  UCOS_IntSrcEn   (CPU_INT32U          int_id);
+CPU_BOOLEAN  UCOS_IntSrcDis  (CPU_INT32U          int_id);
+
+#endif
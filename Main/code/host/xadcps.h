@@ -0,0 +1,79 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                       Xilinx XADC PS driver (subset)
+*
+* Description : Every channel returns its scripted trace, encoded as the real converter does (12-bit
+*               result, MSB justified in a 16-bit word). See host/sim.c.
+*********************************************************************************************************
+*/
+
+#ifndef  XADCPS_H
+#define  XADCPS_H
+
+#include  "xil_types.h"
+#include  "xstatus.h"
+#include  "xparameters.h"
+
+#define  XADCPS_CH_TEMP          0x00
+#define  XADCPS_CH_VCCINT        0x01
+#define  XADCPS_CH_VCCAUX        0x02
+#define  XADCPS_CH_VPVN          0x03
+#define  XADCPS_CH_VREFP         0x04
+#define  XADCPS_CH_VREFN         0x05
+#define  XADCPS_CH_VBRAM         0x06
+#define  XADCPS_CH_AUX_MIN       16
+#define  XADCPS_CH_AUX_MAX       31
+
+#define  XADCPS_SEQ_CH_CALIB      0x00000001u                    /* Sequencer channel enable bits                        */
+#define  XADCPS_SEQ_CH_TEMP       0x00000100u
+#define  XADCPS_SEQ_CH_VCCINT     0x00000200u
+#define  XADCPS_SEQ_CH_VCCAUX     0x00000400u
+#define  XADCPS_SEQ_CH_VPVN       0x00000800u
+#define  XADCPS_SEQ_CH_VREFP      0x00001000u
+#define  XADCPS_SEQ_CH_VREFN      0x00002000u
+#define  XADCPS_SEQ_CH_VBRAM      0x00004000u
+#define  XADCPS_SEQ_CH_AUX00      0x00010000u
+
+#define  XADCPS_AVG_0_SAMPLES     0
+#define  XADCPS_AVG_16_SAMPLES    1
+#define  XADCPS_AVG_64_SAMPLES    2
+#define  XADCPS_AVG_256_SAMPLES   3
+
+#define  XADCPS_SEQ_MODE_SAFE            0
+#define  XADCPS_SEQ_MODE_ONEPASS         1
+#define  XADCPS_SEQ_MODE_CONTINPASS      2
+#define  XADCPS_SEQ_MODE_SINGCHAN        3
+
+typedef  struct {
+    u16  DeviceId;
+    u32  BaseAddress;
+} XAdcPs_Config;
+
+typedef  struct {
+    XAdcPs_Config  Config;
+    u32            IsReady;
+    u8             SequencerMode;
+    u32            SeqChEnables;
+    u32            SeqAvgEnables;
+    u8             Average;
+} XAdcPs;
+
+#define  XAdcPs_RawToTemperature(AdcData)                                   \
+    ((((float)(AdcData)/65536.0f)/0.00198421639f ) - 273.15f)
+
+#define  XAdcPs_RawToVoltage(AdcData)                                       \
+    ((((float)(AdcData))* (3.0f))/65536.0f)
+
+XAdcPs_Config  *XAdcPs_LookupConfig     (u16 DeviceId);
+int             XAdcPs_CfgInitialize    (XAdcPs *InstancePtr, XAdcPs_Config *ConfigPtr, u32 EffectiveAddr);
+int             XAdcPs_SelfTest         (XAdcPs *InstancePtr);
+void            XAdcPs_SetSequencerMode (XAdcPs *InstancePtr, u8 SequencerMode);
+u8              XAdcPs_GetSequencerMode (XAdcPs *InstancePtr);
+int             XAdcPs_SetSeqChEnables  (XAdcPs *InstancePtr, u32 ChEnableMask);
+int             XAdcPs_SetSeqAvgEnables (XAdcPs *InstancePtr, u32 AvgEnableChMask);
+void            XAdcPs_SetAvg           (XAdcPs *InstancePtr, u8 Average);
+u16             XAdcPs_GetAdcData       (XAdcPs *InstancePtr, u8 Channel);
+
+#endif
@@ -0,0 +1,43 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                     Xilinx AXI GPIO driver (subset)
+*
+* Description : Channel 1 reads the scripted button state, writes to any channel are recorded with
+*               their virtual time stamp. A change on channel 1 latches its interrupt status bit and,
+*               when enabled, raises the GPIO interrupt. See host/sim.c.
+*********************************************************************************************************
+*/
+
+#ifndef  XGPIO_H
+#define  XGPIO_H
+
+#include  "xil_types.h"
+#include  "xstatus.h"
+#include  "xparameters.h"
+
+#define  XGPIO_IR_CH1_MASK        0x00000001u
+#define  XGPIO_IR_CH2_MASK        0x00000002u
+#define  XGPIO_GIE_GINTR_ENABLE_MASK  0x80000000u
+
+typedef  struct {
+    u32  BaseAddress;
+    u32  IsReady;
+    u32  Direction[2];
+} XGpio;
+
+int   XGpio_Initialize       (XGpio *InstancePtr, u16 DeviceId);
+int   XGpio_SelfTest         (XGpio *InstancePtr);
+void  XGpio_SetDataDirection (XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32   XGpio_DiscreteRead     (XGpio *InstancePtr, unsigned Channel);
+void  XGpio_DiscreteWrite    (XGpio *InstancePtr, unsigned Channel, u32 Data);
+
+void  XGpio_InterruptGlobalEnable  (XGpio *InstancePtr);
+void  XGpio_InterruptGlobalDisable (XGpio *InstancePtr);
+void  XGpio_InterruptEnable        (XGpio *InstancePtr, u32 Mask);
+void  XGpio_InterruptDisable       (XGpio *InstancePtr, u32 Mask);
+void  XGpio_InterruptClear         (XGpio *InstancePtr, u32 Mask);
+u32   XGpio_InterruptGetStatus     (XGpio *InstancePtr);
+
+#endif
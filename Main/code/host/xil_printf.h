@@ -0,0 +1,14 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                 Xilinx standalone BSP console (subset)
+*********************************************************************************************************
+*/
+
+#ifndef  XIL_PRINTF_H
+#define  XIL_PRINTF_H
+
+void  outbyte (char c);                                         /* Sends one byte, of any value, to the simulated UART  */
+
+#endif
@@ -0,0 +1,20 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                        Xilinx basic data types
+*********************************************************************************************************
+*/
+
+#ifndef  XIL_TYPES_H
+#define  XIL_TYPES_H
+
+#include  <stdint.h>
+
+typedef  uint8_t    u8;
+typedef  uint16_t   u16;
+typedef  uint32_t   u32;
+typedef  uint64_t   u64;
+typedef  int32_t    s32;
+
+#endif
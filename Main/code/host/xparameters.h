@@ -0,0 +1,18 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                          Hardware parameters of the simulated block diagram
+*********************************************************************************************************
+*/
+
+#ifndef  XPARAMETERS_H
+#define  XPARAMETERS_H
+
+#define  XPAR_XADCPS_0_DEVICE_ID        0
+#define  XPAR_XADCPS_0_BASEADDR         0xF8007100
+#define  XPAR_AXI_GPIO_0_DEVICE_ID      0
+#define  XPAR_AXI_GPIO_0_BASEADDR       0x41200000
+#define  XPAR_FABRIC_AXI_GPIO_0_IP2INTC_IRPT_INTR   61
+
+#endif
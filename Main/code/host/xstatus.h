@@ -0,0 +1,15 @@
+/*
+*********************************************************************************************************
+*                                       HOST SIMULATION BACKEND
+*
+*                                       Xilinx driver status codes
+*********************************************************************************************************
+*/
+
+#ifndef  XSTATUS_H
+#define  XSTATUS_H
+
+#define  XST_SUCCESS    0L
+#define  XST_FAILURE    1L
+
+#endif
@@ -0,0 +1,296 @@
+/*
+*********************************************************************************************************
+*                                       WAVEFORM CAPTURE FILES
+*
+* Description : See ap_capture.hpp.
+*
+* Note(s)     : The structures are written and mapped as they are, which assumes a little-endian host.
+*********************************************************************************************************
+*/
+
+#include  <cstring>
+#include  <stdexcept>
+
+#include  <fcntl.h>
+#include  <sys/mman.h>
+#include  <sys/stat.h>
+#include  <unistd.h>
+
+#include  "ap_capture.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                              CRC-32
+*********************************************************************************************************
+*/
+
+static  uint32_t  CrcTbl[256];
+
+static  void  CrcInit ()
+{
+    for (uint32_t i = 0u; i < 256u; i++) {
+        uint32_t  c = i;
+
+
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        CrcTbl[i] = c;
+    }
+}
+
+static  uint32_t  CrcAdd (uint32_t crc, const void *p, size_t len)
+{
+    const uint8_t  *b = (const uint8_t *)p;
+
+
+    for (size_t i = 0u; i < len; i++) {
+        crc = CrcTbl[(crc ^ b[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return (crc);
+}
+
+uint32_t  Crc32 (uint32_t crc, const void *p, size_t len)
+{
+    static const bool  init = (CrcInit(), true);
+
+
+    (void)init;
+    return (CrcAdd(crc, p, len));
+}
+
+uint32_t  CapCrc (const CapFrameHeader *h, const uint16_t *samples)
+{
+    CapFrameHeader  tmp = *h;
+    uint32_t        crc;
+
+
+    tmp.Crc = 0u;
+    crc     = Crc32(0xFFFFFFFFu, &tmp, sizeof(tmp));
+    crc     = Crc32(crc, samples, (size_t)h->Samples * 2u);
+    return (crc ^ 0xFFFFFFFFu);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             WRITER
+*********************************************************************************************************
+*/
+
+CaptureWriter::CaptureWriter (const std::string &path, uint64_t start_unix_ns)
+{
+    CapFileHeader  fh;
+    const size_t   frame = sizeof(CapFrameHeader) + kCapSamples * 2u;
+    int            fd    = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat    st;
+
+
+    if ((fd < 0) || (fstat(fd, &st) != 0)) {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    if (st.st_size < (off_t)sizeof(fh)) {                       /* New file                                             */
+        std::memset(&fh, 0, sizeof(fh));
+        std::memcpy(fh.Magic, kCapMagic, sizeof(fh.Magic));
+        fh.Version     = kCapVersion;
+        fh.HeaderSize  = sizeof(CapFileHeader);
+        fh.FrameSize   = (uint32_t)frame;
+        fh.Samples     = kCapSamples;
+        fh.ClkHz       = kClkHz;
+        fh.ConvCycles  = kConvCycles;
+        fh.StartUnixNs = start_unix_ns;
+        if ((ftruncate(fd, 0) != 0) || (pwrite(fd, &fh, sizeof(fh), 0) != (ssize_t)sizeof(fh))) {
+            close(fd);
+            throw std::runtime_error("cannot write " + path);
+        }
+    } else {                                                    /* Append: drop a torn last frame, continue 'Seq'       */
+        CapFrameHeader  last;
+
+
+        if ((pread(fd, &fh, sizeof(fh), 0) != (ssize_t)sizeof(fh)) ||
+            (std::memcmp(fh.Magic, kCapMagic, sizeof(fh.Magic)) != 0) ||
+            (fh.Version != kCapVersion) || (fh.FrameSize != frame) || (fh.HeaderSize != sizeof(fh))) {
+            close(fd);
+            throw std::runtime_error(path + ": not a version 1 capture file");
+        }
+        Frames_ = ((uint64_t)st.st_size - sizeof(fh)) / frame;
+        if (ftruncate(fd, (off_t)(sizeof(fh) + Frames_ * frame)) != 0) {
+            close(fd);
+            throw std::runtime_error("cannot truncate " + path);
+        }
+        if ((Frames_ != 0u) &&
+            (pread(fd, &last, sizeof(last), (off_t)(sizeof(fh) + (Frames_ - 1u) * frame)) == (ssize_t)sizeof(last))) {
+            NextSeq_    = last.Seq + 1u;
+            EdgeOffset_ = last.TriggerEdge + 1u;
+        }
+        if ((start_unix_ns > fh.StartUnixNs) && (fh.StartUnixNs != 0u)) {
+            uint64_t  since = (uint64_t)((double)(start_unix_ns - fh.StartUnixNs) * 1e-9 * fh.ClkHz);
+
+
+            EdgeOffset_ = (since > EdgeOffset_) ? since : EdgeOffset_;
+        }
+    }
+
+    F_ = fdopen(fd, "r+b");
+    if ((F_ == nullptr) || (std::fseek(F_, 0, SEEK_END) != 0)) {
+        close(fd);
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::setvbuf(F_, nullptr, _IOFBF, 64u * frame);
+}
+
+CaptureWriter::~CaptureWriter ()
+{
+    if (F_ != nullptr) {
+        std::fclose(F_);
+    }
+}
+
+void  CaptureWriter::Append (CapFrameHeader h, const uint16_t *samples)
+{
+    h.Sync     = kCapSync;
+    h.Seq      = NextSeq_++;
+    h.Samples  = (uint16_t)kCapSamples;
+    h.Reserved = 0u;
+    h.Crc      = CapCrc(&h, samples);
+    if ((std::fwrite(&h, sizeof(h), 1u, F_) != 1u) ||
+        (std::fwrite(samples, 2u, kCapSamples, F_) != kCapSamples)) {
+        throw std::runtime_error("capture write failed");
+    }
+    Frames_++;
+}
+
+void  CaptureWriter::Flush ()
+{
+    std::fflush(F_);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             READER
+*********************************************************************************************************
+*/
+
+CaptureReader::CaptureReader (const std::string &path)
+    : Path_(path)
+{
+    Map();
+    if ((Len_ < sizeof(CapFileHeader)) ||
+        (std::memcmp(Header().Magic, kCapMagic, sizeof(kCapMagic)) != 0) ||
+        (Header().Version != kCapVersion) || (Header().HeaderSize != sizeof(CapFileHeader)) ||
+        (Header().FrameSize != sizeof(CapFrameHeader) + Header().Samples * 2u)) {
+        throw std::runtime_error(path + ": not a version 1 capture file");
+    }
+    Frames_ = (Len_ - sizeof(CapFileHeader)) / Header().FrameSize;
+}
+
+CaptureReader::~CaptureReader ()
+{
+    if (Base_ != nullptr) {
+        munmap((void *)Base_, Len_);
+    }
+}
+
+void  CaptureReader::Map ()
+{
+    struct stat  st;
+    void        *p;
+    int          fd = open(Path_.c_str(), O_RDONLY);
+
+
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + Path_);
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(CapFileHeader))) {
+        close(fd);
+        throw std::runtime_error(Path_ + ": not a capture file");
+    }
+    p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + Path_);
+    }
+    if (Base_ != nullptr) {
+        munmap((void *)Base_, Len_);
+    }
+    Base_ = (const uint8_t *)p;
+    Len_  = (size_t)st.st_size;
+}
+
+bool  CaptureReader::Refresh ()
+{
+    struct stat  st;
+    uint64_t     before = Frames_;
+
+
+    if ((stat(Path_.c_str(), &st) != 0) || ((size_t)st.st_size <= Len_)) {
+        return (false);
+    }
+    Map();
+    Frames_ = (Len_ - sizeof(CapFileHeader)) / Header().FrameSize;
+    return (Frames_ != before);
+}
+
+CapFrame  CaptureReader::Frame (uint64_t k) const
+{
+    const uint8_t  *p = Base_ + sizeof(CapFileHeader) + k * Header().FrameSize;
+
+
+    return (CapFrame{ (const CapFrameHeader *)p, (const uint16_t *)(p + sizeof(CapFrameHeader)) });
+}
+
+bool  CaptureReader::Valid (uint64_t k) const
+{
+    CapFrame  f = Frame(k);
+
+
+    return ((f.H->Sync == kCapSync) && (f.H->Samples == Header().Samples) && (CapCrc(f.H, f.Samples) == f.H->Crc));
+}
+
+
+/*
+*********************************************************************************************************
+*                                       PIPELINE TO CAPTURE
+*********************************************************************************************************
+*/
+
+void  CaptureObserver::OnWrite (uint64_t edge, uint16_t addr, uint16_t data)
+{
+    (void)data;
+    if (addr == 0u) {                                           /* First word of a sweep: fired 2 edges before          */
+        Fire_      = edge - 2u;
+        PeriodNew_ = false;
+    }
+}
+
+void  CaptureObserver::OnPeriod (uint64_t edge, uint16_t period)
+{
+    (void)edge;
+    Period_    = period;
+    PeriodOk_  = true;
+    PeriodNew_ = true;
+}
+
+void  CaptureObserver::OnSweep (uint64_t edge, const uint16_t *ram)
+{
+    CapFrameHeader  h;
+
+
+    (void)edge;
+    std::memset(&h, 0, sizeof(h));
+    h.TriggerEdge = Fire_ + W_.EdgeOffset();
+    h.Level       = Set_.Level;
+    h.Flags       = (uint8_t)((Set_.Rising ? (unsigned)kCapRising      : 0u) |
+                              (PeriodOk_   ? (unsigned)kCapPeriodValid : 0u) |
+                              (PeriodNew_  ? (unsigned)kCapPeriodNew   : 0u));
+    h.Scale       = (uint8_t)((Set_.VScale & 3u) | ((Set_.HScale & 3u) << 2));
+    h.Period      = Period_;
+    W_.Append(h, ram);
+}
+
+}
@@ -0,0 +1,188 @@
+/*
+*********************************************************************************************************
+*                                       WAVEFORM CAPTURE FILES
+*
+* Description : Append-only file of triggered sweeps, one fixed-size frame per sweep:
+*
+*                   CapFileHeader                       64 bytes, once
+*                   CapFrameHeader + Samples x u16      FrameSize bytes, per sweep, in trigger order
+*
+*               All fields are little-endian. Frames have a fixed size, so frame 'k' starts at
+*               HeaderSize + k * FrameSize and a reader maps the file and uses the frames in place.
+*               A frame that was only partly written (the writer died) is ignored by the reader and
+*               cut off when a writer opens the file again. 'Seq' counts the sweeps of the source, so a
+*               gap in it is a lost frame; the CRC covers the header (with Crc = 0) and the samples.
+*
+*               The samples are the words sync_ram_dualport holds after the sweep, addresses 0 .. 1279,
+*               i.e. the 12-bit codes after the vscale shift, as the VGA reads them.
+*
+*               Only the host tools write and read these files: CaptureObserver over the golden model
+*               ('apmodel run --capture'), and the host simulation of the PS (SIM_FRAMES). The PL of this
+*               design has no port from sync_ram_dualport to the PS and no end of sweep interrupt, so the
+*               target produces no captures, and the frame rates reached on the host say nothing about it.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_CAPTURE_HPP
+#define  AP_CAPTURE_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <cstdio>
+#include  <string>
+
+#include  "ap_model.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                             LAYOUT
+*********************************************************************************************************
+*/
+
+constexpr char      kCapMagic[8]     = { 'A', 'P', 'C', 'A', 'P', '\r', '\n', '\x1A' };
+constexpr uint32_t  kCapVersion      = 1u;
+constexpr uint32_t  kCapSync         = 0x314D5246u;              /* "FRM1"                                               */
+constexpr uint32_t  kCapSamples      = kSweepSamples;
+
+enum : uint8_t {                                                /* CapFrameHeader.Flags                                 */
+    kCapRising       = 0x01u,
+    kCapPeriodValid  = 0x02u,                                   /* 'period' has a value, from this or an earlier sweep  */
+    kCapPeriodNew    = 0x04u                                    /* ... measured during this sweep                       */
+};
+
+struct CapFileHeader {
+    char      Magic[8];
+    uint32_t  Version;
+    uint32_t  HeaderSize;                                       /* sizeof(CapFileHeader)                                */
+    uint32_t  FrameSize;                                        /* sizeof(CapFrameHeader) + Samples * 2                 */
+    uint32_t  Samples;
+    uint32_t  ClkHz;                                            /* Unit of TriggerEdge                                  */
+    uint32_t  ConvCycles;                                       /* Clocks per ADC conversion                            */
+    uint64_t  StartUnixNs;                                      /* Wall clock of edge 0, 0 if unknown                   */
+    uint8_t   Reserved[24];
+};
+
+struct CapFrameHeader {
+    uint32_t  Sync;
+    uint32_t  Seq;
+    uint64_t  TriggerEdge;                                      /* Clock edge at which trigger_controller fired         */
+    uint16_t  Level;                                            /* trigger_value                                        */
+    uint8_t   Flags;
+    uint8_t   Scale;                                            /* vscale | hscale << 2                                 */
+    uint16_t  Period;                                           /* 'period', in decimated samples                       */
+    uint16_t  Samples;
+    uint32_t  Crc;
+    uint32_t  Reserved;
+};
+
+static_assert(sizeof(CapFileHeader)  == 64u, "CapFileHeader layout");
+static_assert(sizeof(CapFrameHeader) == 32u, "CapFrameHeader layout");
+
+uint32_t             CapCrc        (const CapFrameHeader *h, const uint16_t *samples);
+uint32_t             Crc32         (uint32_t crc, const void *p, size_t len);   /* Running, ~0 in and out  */
+
+
+/*
+*********************************************************************************************************
+*                                             WRITER
+*
+* Description : Appends frames to a new or existing capture. Writes are buffered; Flush() makes the
+*               frames written so far visible to readers.
+*
+*               'start_unix_ns' is the wall clock of edge 0 of the source. When appending, EdgeOffset() is
+*               what to add to the source's edges so that TriggerEdge stays relative to the StartUnixNs of
+*               the file, and grows from frame to frame.
+*********************************************************************************************************
+*/
+
+class  CaptureWriter {
+public:
+    explicit             CaptureWriter (const std::string &path, uint64_t start_unix_ns = 0u);
+                        ~CaptureWriter ();
+                         CaptureWriter (const CaptureWriter &) = delete;
+    CaptureWriter       &operator=     (const CaptureWriter &) = delete;
+
+    void                 Append        (CapFrameHeader h, const uint16_t *samples);
+    void                 Flush         ();
+    uint64_t             Frames        () const { return (Frames_); }
+    uint32_t             NextSeq       () const { return (NextSeq_); }
+    uint64_t             EdgeOffset    () const { return (EdgeOffset_); }
+
+private:
+    std::FILE           *F_          = nullptr;
+    uint64_t             Frames_     = 0u;
+    uint32_t             NextSeq_    = 0u;
+    uint64_t             EdgeOffset_ = 0u;
+};
+
+
+/*
+*********************************************************************************************************
+*                                             READER
+*
+* Description : Maps the capture read-only. Frame() points into the mapping; nothing is copied. Refresh()
+*               maps the frames appended since, for a reader that follows a growing file.
+*********************************************************************************************************
+*/
+
+struct CapFrame {
+    const CapFrameHeader  *H;
+    const uint16_t        *Samples;
+};
+
+class  CaptureReader {
+public:
+    explicit             CaptureReader (const std::string &path);
+                        ~CaptureReader ();
+                         CaptureReader (const CaptureReader &) = delete;
+    CaptureReader       &operator=     (const CaptureReader &) = delete;
+
+    bool                 Refresh       ();                      /* true if frames were added                            */
+    const CapFileHeader &Header        () const { return (*(const CapFileHeader *)Base_); }
+    uint64_t             Frames        () const { return (Frames_); }
+    CapFrame             Frame         (uint64_t k) const;
+    bool                 Valid         (uint64_t k) const;      /* Sync word and CRC                                    */
+
+private:
+    void                 Map           ();
+
+    std::string          Path_;
+    const uint8_t       *Base_   = nullptr;
+    size_t               Len_    = 0u;
+    uint64_t             Frames_ = 0u;
+};
+
+
+/*
+*********************************************************************************************************
+*                                       PIPELINE TO CAPTURE
+*
+* Description : Observer of a Pipeline that appends one frame per completed sweep. The settings are the
+*               ones the Pipeline runs with; Set() must be called again when they change.
+*********************************************************************************************************
+*/
+
+class  CaptureObserver : public Observer {
+public:
+                         CaptureObserver (CaptureWriter &w, const Settings &s) : W_(w), Set_(s) {}
+
+    void                 Set             (const Settings &s)  { Set_ = s; }
+    void                 OnWrite         (uint64_t edge, uint16_t addr, uint16_t data) override;
+    void                 OnPeriod        (uint64_t edge, uint16_t period) override;
+    void                 OnSweep         (uint64_t edge, const uint16_t *ram) override;
+
+private:
+    CaptureWriter       &W_;
+    Settings             Set_;
+    uint64_t             Fire_      = 0u;
+    uint16_t             Period_    = 0u;
+    bool                 PeriodOk_  = false;
+    bool                 PeriodNew_ = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+*********************************************************************************************************
+*                                        deep_record MODEL
+*
+* Description : See ap_deep.hpp.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <stdexcept>
+
+#include  "ap_deep.hpp"
+
+
+namespace ap {
+
+uint32_t  DeepConfig::ZoomMax () const
+{
+    uint32_t  z = 0u;
+
+
+    while ((z < kDeepZoomMax) && ((uint64_t)kDeepColumns << (z + 1u)) <= Depth()) {
+        z++;
+    }
+    return (z);
+}
+
+uint32_t  DeepTiles (uint64_t words, uint32_t bits)
+{
+    static const uint32_t  width[6] = {     1u,     2u,    4u,    9u,   18u,   36u };  /* RAMB36E1 aspect ratios */
+    static const uint32_t  depth[6] = { 32768u, 16384u, 8192u, 4096u, 2048u, 1024u };
+    uint32_t               best     = 0u;
+
+
+    for (uint32_t i = 0u; i < 6u; i++) {
+        uint64_t  tiles = ((words + depth[i] - 1u) / depth[i]) * ((bits + width[i] - 1u) / width[i]);
+
+
+        if ((best == 0u) || (tiles < best)) {
+            best = (uint32_t)tiles;
+        }
+    }
+    return (best);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        REDUCE THE VIEW
+*
+* Description : The 'reduce' process: zoom and pan clamped as deep_record does at the start, then the min
+*               and max of each column of 2**zoom samples, shifted right by vscale.
+*********************************************************************************************************
+*/
+
+DeepPicture  DeepReduce (const DeepConfig &c, const std::vector<uint16_t> &rec, const DeepView &v)
+{
+    DeepPicture  p;
+    uint32_t     k;
+    uint32_t     view;
+
+
+    if (rec.size() != c.Depth()) {
+        throw std::runtime_error("deep record: no complete record");
+    }
+    p.Zoom   = std::min(v.Zoom, c.ZoomMax());
+    k        = 1u << p.Zoom;
+    view     = kDeepColumns * k;
+    p.Pan    = std::min(v.Pan, c.Depth() - view);
+    p.Clocks = view + 2u;                                       /* Reads, then the last word and 'rearm'                */
+    p.Max.resize(kDeepColumns);
+    p.Min.resize(kDeepColumns);
+    for (uint32_t col = 0u; col < kDeepColumns; col++) {
+        const uint16_t  *s  = &rec[p.Pan + col * k];
+        uint16_t         lo = s[0];
+        uint16_t         hi = s[0];
+
+
+        for (uint32_t i = 1u; i < k; i++) {
+            lo = std::min(lo, s[i]);
+            hi = std::max(hi, s[i]);
+        }
+        p.Max[col] = (uint16_t)(hi >> (v.VScale & 3u));
+        p.Min[col] = (uint16_t)(lo >> (v.VScale & 3u));
+    }
+    return (p);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             CAPTURE
+*
+* Description : The 'capture' process, event by event. A trigger seen at edge 'e' stores the current ADC
+*               code, that of the last conversion with sample_ready at or before 'e', and the segment ends
+*               at the sample_ready edge of its last sample.
+*
+* Note(s)     : 1) After the last segment: the reduction starts at the first vsync falling edge after it,
+*                  'rearm' comes view + 2 edges later, the state is 'armed' one edge after that, so the
+*                  first trigger taken is at vsync + view + 4.
+*               2) A segment that the end of 'codes' cuts is not stored.
+*********************************************************************************************************
+*/
+
+void  DeepRecorder::OnWrite (uint64_t edge, uint16_t addr, uint16_t data)
+{
+    (void)data;
+    if (addr == 0u) {
+        Trig_.push_back(edge);
+    }
+}
+
+void  DeepRecorder::Replay (const std::vector<uint16_t> &codes, uint32_t zoom, bool hold)
+{
+    std::vector<uint16_t>  rec(Cfg_.Depth(), 0u);
+    std::vector<uint64_t>  seg_edge(Cfg_.Segments(), 0u);
+    uint32_t               seg       = 0u;
+    uint64_t               armed     = 0u;                      /* First edge at which a trigger is taken               */
+    uint32_t               len       = Cfg_.SegLen();
+    uint32_t               view      = kDeepColumns << std::min(zoom, Cfg_.ZoomMax());
+
+
+    Records_ = 0u;
+    Ignored_ = 0u;
+    for (size_t t = 0u; t < Trig_.size(); t++) {
+        uint64_t  e = Trig_[t];
+        uint64_t  n;
+        uint64_t  end;
+
+
+        if ((e < armed) || (e < kReadyEdge)) {
+            Ignored_++;
+            continue;
+        }
+        n = (e - kReadyEdge) / kConvCycles;
+        if (n + len > codes.size()) {
+            break;
+        }
+        for (uint32_t i = 0u; i < len; i++) {
+            rec[(size_t)seg * len + i] = codes[(size_t)(n + i)] & 0xFFFu;
+        }
+        seg_edge[seg] = e;
+        end           = ReadyEdge(n + len - 1u);
+        if (++seg < Cfg_.Segments()) {
+            armed = end + 1u;
+            continue;
+        }
+
+        seg = 0u;
+        Records_++;
+        Rec_     = rec;
+        SegEdge_ = seg_edge;
+        if (hold) {
+            Ignored_ += Trig_.size() - t - 1u;
+            break;
+        }
+
+        uint64_t  f = NextVsyncLow(end + 1u);                   /* Falling edge: the first low edge of a frame          */
+        if (VsyncLow(f - 1u)) {
+            f = ((f + kVsyncLead) / kFrameCycles + 1u) * kFrameCycles - kVsyncLead;
+        }
+        armed = f + view + 4u;
+    }
+}
+
+}
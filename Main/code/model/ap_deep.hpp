@@ -0,0 +1,122 @@
+/*
+*********************************************************************************************************
+*                                        deep_record MODEL
+*
+* Description : Model of deep_record.vhd, the deep capture memory of acquire_and_plot built with
+*               deep_bits > 0:
+*
+*                   capture   every ADC sample, from the one that fired the trigger, into the next of
+*                             2**SegmentBits segments of a record of 2**RecordBits samples
+*                   reduce    at the first vsync falling edge of a complete record, the view (1280
+*                             columns of 2**zoom samples from 'pan') becomes the min and max of each
+*                             column, shifted by vscale; capture re-arms after it unless held
+*
+*               DeepRecorder is the Observer of the Pipeline that supplies the trigger: the trigger of
+*               deep_record is trigger_controller writing address 0. Replay() then runs the capture
+*               state machine over those trigger edges and the codes of the same conversions.
+*
+* Note(s)     : 1) The reduction reads one sample a clock and must end before the first active line,
+*                  41 lines after vsync falls: kDeepZoomMax caps a view at 1280 * 32 samples.
+*               2) DeepTiles() counts the RAMB36 of a memory as Vivado maps it on the 7-series: the
+*                  cheapest of the 32k x 1 ... 1k x 36 aspect ratios.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_DEEP_HPP
+#define  AP_DEEP_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <string>
+#include  <vector>
+
+#include  "ap_model.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                            CONSTANTS
+*********************************************************************************************************
+*/
+
+constexpr uint32_t  kDeepColumns   = 1280u;
+constexpr uint32_t  kDeepZoomMax   =    5u;                     /* 32 samples per column                                */
+constexpr uint32_t  kDeepBlank     = (3u + 38u) * kLineCycles;  /* Clocks from vsync falling to the first active line   */
+constexpr uint32_t  kDeepDispWords = 2048u;                     /* Display memory, 24 bits: max & min                   */
+constexpr uint32_t  kDeepDispBits  =   24u;
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+struct DeepConfig {                                             /* Generics of deep_record                              */
+    uint32_t  RecordBits  = 16u;
+    uint32_t  SegmentBits =  0u;                                /* SegLen() at least kDeepColumns                       */
+
+    uint32_t  Depth    () const { return (1u << RecordBits); }
+    uint32_t  Segments () const { return (1u << SegmentBits); }
+    uint32_t  SegLen   () const { return (1u << (RecordBits - SegmentBits)); }
+    uint32_t  ZoomMax  () const;                                /* zoom_limit: the view fits in the record              */
+};
+
+struct DeepView {                                               /* Inputs of one reduction                              */
+    uint32_t  Zoom   = 0u;                                      /* Clamped to ZoomMax()                                 */
+    uint32_t  Pan    = 0u;                                      /* First sample, clamped to Depth() - view              */
+    uint8_t   VScale = 0u;
+};
+
+struct DeepPicture {                                            /* The display memory after a reduction                 */
+    uint32_t               Zoom   = 0u;                         /* As used, after clamping                              */
+    uint32_t               Pan    = 0u;
+    uint32_t               Clocks = 0u;                         /* From vsync falling to 'rearm'                        */
+    std::vector<uint16_t>  Max;                                 /* data_max of columns 0 .. 1279                        */
+    std::vector<uint16_t>  Min;
+};
+
+uint32_t             DeepTiles     (uint64_t words, uint32_t bits);
+DeepPicture          DeepReduce    (const DeepConfig &c, const std::vector<uint16_t> &rec, const DeepView &v);
+
+
+/*
+*********************************************************************************************************
+*                                             RECORDER
+*
+* Description : Collects the trigger edges of a Pipeline run. Replay(codes, zoom), with the codes of
+*               conversions 0 .. codes.size() - 1 of the same run and the zoom of the reductions (their
+*               length delays the re-arm), then captures as deep_record does: Records() is
+*               the number of complete records, Record() the last one, TriggerEdges() the edge of the
+*               trigger of each of its segments, Ignored() the triggers that came while capturing or
+*               reducing. With 'hold' capture stops after the first record, as with the hold switch on.
+*********************************************************************************************************
+*/
+
+class  DeepRecorder : public Observer {
+public:
+    explicit                      DeepRecorder (const DeepConfig &c) : Cfg_(c) {}
+
+    void                          OnWrite      (uint64_t edge, uint16_t addr, uint16_t data) override;
+    void                          Replay       (const std::vector<uint16_t> &codes, uint32_t zoom, bool hold = false);
+
+    uint64_t                      Records      () const { return (Records_); }
+    uint64_t                      Ignored      () const { return (Ignored_); }
+    uint64_t                      Triggers     () const { return (Trig_.size()); }
+    const std::vector<uint16_t>  &Record       () const { return (Rec_); }
+    const std::vector<uint64_t>  &TriggerEdges () const { return (SegEdge_); }
+
+private:
+    DeepConfig                    Cfg_;
+    std::vector<uint64_t>         Trig_;
+    std::vector<uint16_t>         Rec_;                         /* Last complete record                                 */
+    std::vector<uint64_t>         SegEdge_;
+    uint64_t                      Records_ = 0u;
+    uint64_t                      Ignored_ = 0u;
+};
+
+}
+
+#endif
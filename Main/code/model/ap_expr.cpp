@@ -0,0 +1,305 @@
+/*
+*********************************************************************************************************
+*                                       PLOT EXPRESSIONS
+*
+* Description : See ap_expr.hpp.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <cctype>
+#include  <cmath>
+#include  <cstdlib>
+#include  <stdexcept>
+
+#include  "ap_expr.hpp"
+
+
+namespace ap {
+
+namespace {
+
+constexpr int     kExprStack = 64;                              /* Deepest evaluation stack                             */
+constexpr double  kPi        = 3.14159265358979323846;
+constexpr double  kE         = 2.71828182845904523536;
+constexpr double  kDeg       = 180.0 / kPi;
+
+enum : uint8_t {
+    kOpPushK, kOpPushX,
+    kOpNeg,   kOpAdd,   kOpSub,   kOpMul,   kOpDiv,   kOpPow,   kOpAtan2, kOpMin,   kOpMax,
+    kOpSinD,  kOpCosD,  kOpTanD,  kOpSinR,  kOpCosR,  kOpTanR,  kOpAsin,  kOpAcos,  kOpAtan,
+    kOpDeg,   kOpRad,   kOpSinh,  kOpCosh,  kOpTanh,  kOpExp,   kOpLn,    kOpLog10, kOpLog2,
+    kOpSqrt,  kOpAbs,   kOpFloor, kOpCeil,  kOpRound
+};
+
+const struct {
+    const char  *Name;
+    uint8_t      Op;
+    int          Args;
+} Funcs[] = {
+    { "sin",   kOpSinD,  1 }, { "cos",   kOpCosD,  1 }, { "tan",   kOpTanD,  1 },
+    { "asin",  kOpAsin,  1 }, { "acos",  kOpAcos,  1 }, { "atan",  kOpAtan,  1 }, { "atan2", kOpAtan2, 2 },
+    { "deg",   kOpDeg,   1 }, { "rad",   kOpRad,   1 },
+    { "sinh",  kOpSinh,  1 }, { "cosh",  kOpCosh,  1 }, { "tanh",  kOpTanh,  1 },
+    { "exp",   kOpExp,   1 }, { "ln",    kOpLn,    1 }, { "log10", kOpLog10, 1 }, { "log2",  kOpLog2,  1 },
+    { "sqrt",  kOpSqrt,  1 }, { "abs",   kOpAbs,   1 },
+    { "floor", kOpFloor, 1 }, { "ceil",  kOpCeil,  1 }, { "round", kOpRound, 1 },
+    { "pow",   kOpPow,   2 }, { "min",   kOpMin,   2 }, { "max",   kOpMax,   2 },
+};
+
+}
+
+
+/*
+*********************************************************************************************************
+*                                             COMPILER
+*********************************************************************************************************
+*/
+
+Expr::Expr (const std::string &text) : Text_(text)
+{
+    Add();
+    Skip();
+    if (Pos_ != Text_.size()) {
+        Fail("unexpected character");
+    }
+    if (Max_ > kExprStack) {
+        Fail("nested too deeply");
+    }
+}
+
+void  Expr::Fail (const std::string &what) const
+{
+    throw std::runtime_error("'" + Text_ + "' at " + std::to_string(Pos_) + ": " + what);
+}
+
+void  Expr::Skip ()
+{
+    while ((Pos_ < Text_.size()) && std::isspace((unsigned char)Text_[Pos_])) {
+        Pos_++;
+    }
+}
+
+void  Expr::Emit (uint8_t op, double k)
+{
+    if ((op == kOpSinD) || (op == kOpCosD) || (op == kOpTanD)) {
+        if (!Code_.empty() && (Code_.back().Op == kOpDeg)) {    /* sin(deg(a)) is sin of 'a' radians                    */
+            Code_.pop_back();
+            op = (op == kOpSinD) ? kOpSinR : (op == kOpCosD) ? kOpCosR : kOpTanR;
+        }
+    }
+    if ((op == kOpPushK) || (op == kOpPushX)) {
+        Max_ = std::max(Max_, ++Depth_);
+    } else if ((op >= kOpAdd) && (op <= kOpMax)) {
+        Depth_--;
+    }
+    Code_.push_back({ op, k });
+}
+
+void  Expr::Add ()
+{
+    Mul();
+    for (;;) {
+        Skip();
+        if ((Pos_ < Text_.size()) && ((Text_[Pos_] == '+') || (Text_[Pos_] == '-'))) {
+            char  c = Text_[Pos_++];
+
+
+            Mul();
+            Emit((c == '+') ? kOpAdd : kOpSub);
+        } else {
+            return;
+        }
+    }
+}
+
+void  Expr::Mul ()
+{
+    Unary();
+    for (;;) {
+        Skip();
+        if ((Pos_ < Text_.size()) && ((Text_[Pos_] == '*') || (Text_[Pos_] == '/'))) {
+            char  c = Text_[Pos_++];
+
+
+            Unary();
+            Emit((c == '*') ? kOpMul : kOpDiv);
+        } else {
+            return;
+        }
+    }
+}
+
+void  Expr::Unary ()
+{
+    Skip();
+    if ((Pos_ < Text_.size()) && (Text_[Pos_] == '-')) {
+        Pos_++;
+        Unary();
+        Emit(kOpNeg);
+    } else if ((Pos_ < Text_.size()) && (Text_[Pos_] == '+')) {
+        Pos_++;
+        Unary();
+    } else {
+        Pow();
+    }
+}
+
+void  Expr::Pow ()
+{
+    Primary();
+    Skip();
+    if ((Pos_ < Text_.size()) && (Text_[Pos_] == '^')) {       /* a^-b^c is a^(-(b^c))                                 */
+        Pos_++;
+        Unary();
+        Emit(kOpPow);
+    }
+}
+
+void  Expr::Primary ()
+{
+    Skip();
+    if (Pos_ >= Text_.size()) {
+        Fail("expression expected");
+    }
+    char  c = Text_[Pos_];
+
+
+    if (c == '(') {
+        Pos_++;
+        Add();
+        Skip();
+        if ((Pos_ >= Text_.size()) || (Text_[Pos_] != ')')) {
+            Fail("')' expected");
+        }
+        Pos_++;
+        return;
+    }
+    if (std::isdigit((unsigned char)c) || (c == '.')) {
+        const char  *b = Text_.c_str() + Pos_;
+        char        *e;
+        double       v = std::strtod(b, &e);
+
+
+        if (e == b) {
+            Fail("number expected");
+        }
+        Pos_ += (size_t)(e - b);
+        Emit(kOpPushK, v);
+        return;
+    }
+    if (std::isalpha((unsigned char)c)) {
+        size_t  b = Pos_;
+
+
+        while ((Pos_ < Text_.size()) && std::isalnum((unsigned char)Text_[Pos_])) {
+            Pos_++;
+        }
+        std::string  name = Text_.substr(b, Pos_ - b);
+
+
+        Skip();
+        if ((Pos_ < Text_.size()) && (Text_[Pos_] == '(')) {
+            Call(name);
+        } else if (name == "x") {
+            Emit(kOpPushX);
+        } else if (name == "pi") {
+            Emit(kOpPushK, kPi);
+        } else if (name == "e") {
+            Emit(kOpPushK, kE);
+        } else {
+            Pos_ = b;
+            Fail("unknown name '" + name + "'");
+        }
+        return;
+    }
+    Fail("unexpected character");
+}
+
+void  Expr::Call (const std::string &name)
+{
+    for (const auto &f : Funcs) {
+        if (name != f.Name) {
+            continue;
+        }
+        Pos_++;                                                 /* '('                                                  */
+        for (int a = 0; a < f.Args; a++) {
+            Add();
+            Skip();
+            if ((Pos_ >= Text_.size()) || (Text_[Pos_] != ((a + 1 < f.Args) ? ',' : ')'))) {
+                Fail((a + 1 < f.Args) ? "',' expected" : "')' expected");
+            }
+            Pos_++;
+        }
+        Emit(f.Op);
+        return;
+    }
+    Fail("unknown function '" + name + "'");
+}
+
+
+/*
+*********************************************************************************************************
+*                                            EVALUATION
+*********************************************************************************************************
+*/
+
+double  Expr::Eval (double x) const
+{
+    double  s[kExprStack];
+    int     n = 0;
+
+
+    for (const Ins &i : Code_) {
+        if (i.Op == kOpPushK) {
+            s[n++] = i.K;
+            continue;
+        }
+        if (i.Op == kOpPushX) {
+            s[n++] = x;
+            continue;
+        }
+
+        double  &a = s[n - 1];                                  /* Top; s[n - 2] below it for the binary operators      */
+
+
+        switch (i.Op) {
+            case kOpNeg:   a = -a;                                            break;
+            case kOpAdd:   s[n - 2] += a;                             n--;    break;
+            case kOpSub:   s[n - 2] -= a;                             n--;    break;
+            case kOpMul:   s[n - 2] *= a;                             n--;    break;
+            case kOpDiv:   s[n - 2] /= a;                             n--;    break;
+            case kOpPow:   s[n - 2] = std::pow(s[n - 2], a);          n--;    break;
+            case kOpAtan2: s[n - 2] = std::atan2(s[n - 2], a) * kDeg; n--;    break;
+            case kOpMin:   s[n - 2] = std::fmin(s[n - 2], a);         n--;    break;
+            case kOpMax:   s[n - 2] = std::fmax(s[n - 2], a);         n--;    break;
+            case kOpSinD:  a = std::sin(a / kDeg);                            break;
+            case kOpCosD:  a = std::cos(a / kDeg);                            break;
+            case kOpTanD:  a = std::tan(a / kDeg);                            break;
+            case kOpSinR:  a = std::sin(a);                                   break;
+            case kOpCosR:  a = std::cos(a);                                   break;
+            case kOpTanR:  a = std::tan(a);                                   break;
+            case kOpAsin:  a = std::asin(a) * kDeg;                           break;
+            case kOpAcos:  a = std::acos(a) * kDeg;                           break;
+            case kOpAtan:  a = std::atan(a) * kDeg;                           break;
+            case kOpDeg:   a = a * kDeg;                                      break;
+            case kOpRad:   a = a / kDeg;                                      break;
+            case kOpSinh:  a = std::sinh(a);                                  break;
+            case kOpCosh:  a = std::cosh(a);                                  break;
+            case kOpTanh:  a = std::tanh(a);                                  break;
+            case kOpExp:   a = std::exp(a);                                   break;
+            case kOpLn:    a = std::log(a);                                   break;
+            case kOpLog10: a = std::log10(a);                                 break;
+            case kOpLog2:  a = std::log2(a);                                  break;
+            case kOpSqrt:  a = std::sqrt(a);                                  break;
+            case kOpAbs:   a = std::fabs(a);                                  break;
+            case kOpFloor: a = std::floor(a);                                 break;
+            case kOpCeil:  a = std::ceil(a);                                  break;
+            case kOpRound: a = std::round(a);                                 break;
+            default:                                                          break;
+        }
+    }
+    return (s[0]);
+}
+
+}
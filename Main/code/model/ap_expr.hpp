@@ -0,0 +1,67 @@
+/*
+*********************************************************************************************************
+*                                       PLOT EXPRESSIONS
+*
+* Description : The functions of a pgfplots '\addplot {..}', compiled once to a stack program and
+*               evaluated in double precision for each sample of x:
+*
+*                   operators     + - * / ^ and unary -, '^' binding tightest and to the right
+*                   constants     pi, e, numbers as 1, 0.5, 2e-3
+*                   variable      x
+*                   functions     sin cos tan        argument in degrees, as pgfmath
+*                                 asin acos atan     result in degrees; atan2(y, x) as well
+*                                 deg rad            radians to degrees and back
+*                                 sinh cosh tanh exp ln log10 log2 sqrt abs floor ceil round
+*                                 pow(a, b) min(a, b) max(a, b)
+*
+*               An expression of a document therefore means the same here as under pgfplots:
+*               'abs(sin(deg(x*pi))/(x*pi))' is |sinc(x)|. sin(deg(..)) and its cos and tan are
+*               computed without the round trip through degrees.
+*
+* Note(s)     : 1) Errors throw std::runtime_error with the offset of the offending character.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_EXPR_HPP
+#define  AP_EXPR_HPP
+
+#include  <cstdint>
+#include  <string>
+#include  <vector>
+
+
+namespace ap {
+
+class  Expr {
+public:
+    explicit               Expr   (const std::string &text);
+
+    double                 Eval   (double x) const;
+    const std::string     &Text   () const { return (Text_); }
+
+private:
+    struct Ins {
+        uint8_t            Op;
+        double             K;                                   /* Operand of a push                                    */
+    };
+
+    void                   Add    ();                           /* Recursive descent, one level each                    */
+    void                   Mul    ();
+    void                   Unary  ();
+    void                   Pow    ();
+    void                   Primary();
+    void                   Call   (const std::string &name);
+    void                   Emit   (uint8_t op, double k = 0.0);
+    void                   Skip   ();
+    [[noreturn]] void      Fail   (const std::string &what) const;
+
+    std::string            Text_;
+    size_t                 Pos_   = 0u;                         /* Parser state                                         */
+    int                    Depth_ = 0;
+    int                    Max_   = 0;
+    std::vector<Ins>       Code_;
+};
+
+}
+
+#endif
@@ -0,0 +1,301 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot GOLDEN MODEL
+*
+* Description : See ap_model.hpp.
+*********************************************************************************************************
+*/
+
+#include  <cmath>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <stdexcept>
+#include  "ap_model.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                        trigger_controller
+*********************************************************************************************************
+*/
+
+TriggerController::TriggerController (Init init)
+{
+    if (init == Init::Unknown) {
+        R_.HScaleKnown = false;
+        R_.FscKnown    = false;
+        R_.PeriodKnown = false;
+    }
+}
+
+bool  TriggerController::Fires () const                         /* Trigger condition, on the 9 MSBs                     */
+{
+    uint16_t  last = R_.LastValue >> 3;
+    uint16_t  prev = R_.PrevValue >> 3;
+
+
+    if (Set_.Rising) {
+        return ((last > Set_.Level) && (prev < Set_.Level) && ((R_.LastValue >> 8) > (R_.PrevValue >> 8)));
+    }
+    return ((last < Set_.Level) && (prev > Set_.Level) && ((R_.LastValue >> 8) < (R_.PrevValue >> 8)));
+}
+
+bool  TriggerController::Crosses () const                       /* Second crossing, for 'period'                        */
+{
+    uint16_t  last = R_.LastValue >> 3;
+    uint16_t  prev = R_.PrevValue >> 3;
+
+
+    if (!R_.TriggerFlag || !R_.FscKnown || R_.FlagSecondCross || (R_.CountedAcqs == 0u)) {
+        return (false);
+    }
+    return (Set_.Rising ? ((last > Set_.Level) && (prev <= Set_.Level))
+                        : ((last < Set_.Level) && (prev >= Set_.Level)));
+}
+
+bool  TriggerController::Armed () const
+{
+    return ((R_.CountedAcqs == 0u) && !R_.TriggerFlag && Fires());
+}
+
+bool  TriggerController::Busy () const
+{
+    return (R_.Wee || R_.We || (R_.CountedAcqs == kSweepSamples) || Crosses());
+}
+
+void  TriggerController::Settle ()
+{
+    R_.AddrOut = R_.CountedAcqs;
+    R_.DataOut = Scaled(R_.LastValue);
+    R_.We      = R_.Wee;
+}
+
+void  TriggerController::Edge (uint64_t   e,
+                               bool       vsync_low,
+                               bool       sample_ready,
+                               uint16_t   data1,
+                               uint16_t  *ram,
+                               Observer  *obs)
+{
+    TriggerRegs  n = R_;                                        /* Every assignment reads the values before the edge    */
+
+
+    if (R_.We) {                                                /* sync_ram_dualport write port                         */
+        ram[R_.AddrOut] = R_.DataOut;
+        if (obs != nullptr) {
+            obs->OnWrite(e, R_.AddrOut, R_.DataOut);
+            if (R_.AddrOut == kSweepSamples) {
+                obs->OnSweep(e, ram);
+            }
+        }
+    }
+
+    if ((vsync_low || !Set_.WaitVsync()) && Armed()) {            /* Trigger condition                                    */
+        n.TriggerFlag   = true;
+        n.CountedAcqs   = 0u;
+        n.Wee           = true;
+        n.HScaleCounter = 0u;
+        n.HScaleKnown   = true;
+    }
+
+    if (sample_ready) {                                         /* Acquisition                                          */
+        n.LastValue     = data1;
+        n.PrevValue     = R_.LastValue;
+        n.HScaleCounter = (uint8_t)((R_.HScaleCounter + 1u) & 3u);
+        n.HScaleKnown   = R_.HScaleKnown;                       /* 'U' + 1 stays unknown                                */
+        if (R_.TriggerFlag && R_.HScaleKnown && (R_.HScaleCounter == Set_.HScale)) {
+            n.HScaleCounter = 0u;
+            n.Wee           = true;
+            n.CountedAcqs   = (uint16_t)((R_.CountedAcqs + 1u) & 0x7FFu);
+            if (R_.CountedAcqs == kSweepSamples - 1u) {
+                n.TriggerFlag = false;
+            }
+        }
+    }
+
+    if (Crosses()) {                                            /* Second crossing gives the period                     */
+        n.FlagSecondCross = true;
+        n.FscKnown        = true;
+        n.Period          = R_.CountedAcqs;
+        n.PeriodKnown     = true;
+        if (obs != nullptr) {
+            obs->OnPeriod(e, R_.CountedAcqs);
+        }
+    }
+
+    if (R_.CountedAcqs == kSweepSamples) {
+        n.CountedAcqs     = 0u;
+        n.FlagSecondCross = false;
+        n.FscKnown        = true;
+    }
+
+    if (R_.Wee) {                                               /* 'we' one clock wide, overrides the sets above        */
+        n.Wee = false;
+    }
+
+    n.AddrOut = R_.CountedAcqs;                                 /* 'outputs' process                                    */
+    n.DataOut = Scaled(R_.LastValue);
+    n.We      = R_.Wee;
+
+    R_ = n;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            PIPELINE
+*
+* Note(s)     : 1) Between two sample_ready pulses nothing changes unless the controller is Busy() or
+*                  Armed(). Busy() edges are evaluated one by one (at most three in a row); an Armed()
+*                  controller fires at the next edge, or with WaitVsync at the first vsync-low edge, found
+*                  arithmetically.
+*               2) Settle() stands for the idle edges that are skipped: they only reload the output
+*                  registers with the same values.
+*********************************************************************************************************
+*/
+
+Pipeline::Pipeline (Init init)
+    : Trig_(init)
+{
+}
+
+void  Pipeline::Advance (uint64_t until, Observer *obs)
+{
+    while (E_ < until) {
+        if (Trig_.Busy()) {
+            Trig_.Edge(E_, VsyncLow(E_), false, 0u, Ram_, obs);
+            E_++;
+            continue;
+        }
+        if (Trig_.Armed()) {
+            uint64_t  f = Trig_.Get().WaitVsync() ? NextVsyncLow(E_) : E_;
+
+
+            if (f < until) {
+                Trig_.Settle();
+                Trig_.Edge(f, true, false, 0u, Ram_, obs);
+                E_ = f + 1u;
+                continue;
+            }
+        }
+        Trig_.Settle();
+        E_ = until;
+    }
+}
+
+void  Pipeline::RunUntil (uint64_t edge, Observer *obs)
+{
+    uint64_t  s = ReadyEdge(Conv_);
+
+
+    Advance((edge < s) ? edge : s, obs);
+}
+
+void  Pipeline::Run (Source &src, uint64_t conversions, Observer *obs)
+{
+    uint16_t  codes[4096];
+
+
+    while (conversions > 0u) {
+        size_t  n = (conversions < 4096u) ? (size_t)conversions : 4096u;
+
+
+        src.Fill(Conv_, codes, n);
+        for (size_t i = 0u; i < n; i++) {
+            uint64_t  s = ReadyEdge(Conv_);
+
+
+            Advance(s, obs);
+            Trig_.Edge(s, VsyncLow(s), true, codes[i] & 0xFFFu, Ram_, obs);
+            E_ = s + 1u;
+            Conv_++;
+        }
+        conversions -= n;
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           SAMPLE SOURCES
+*********************************************************************************************************
+*/
+
+void  TbSource::Fill (uint64_t first, uint16_t *codes, size_t count)
+{
+    for (size_t i = 0u; i < count; i++) {
+        codes[i] = (uint16_t)(((first + i) * 1024u) & 0xFFFu);
+    }
+}
+
+SineSource::SineSource (double hz, double amplitude, double mid)
+    : W_(2.0 * M_PI * hz * kConvCycles / kClkHz), Amp_(amplitude), Mid_(mid)
+{
+}
+
+void  SineSource::Fill (uint64_t first, uint16_t *codes, size_t count)
+{
+    for (size_t i = 0u; i < count; i++) {
+        double  v = Mid_ + Amp_ * std::sin(W_ * (double)(first + i));
+
+
+        codes[i] = (v <= 0.0) ? 0u : (v >= 4095.0) ? 4095u : (uint16_t)std::lround(v);
+    }
+}
+
+FileSource::FileSource (const std::string &path)
+{
+    FILE     *f = std::fopen(path.c_str(), "rb");
+    uint8_t   b[2];
+
+
+    if (f == nullptr) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    while (std::fread(b, 1u, 2u, f) == 2u) {
+        Codes_.push_back((uint16_t)((b[0] | (b[1] << 8)) & 0xFFFu));
+    }
+    std::fclose(f);
+    if (Codes_.empty()) {
+        throw std::runtime_error(path + ": no samples");
+    }
+}
+
+void  VectorSource::Fill (uint64_t first, uint16_t *codes, size_t count)
+{
+    size_t  j = (size_t)(first % Codes_.size());
+
+
+    for (size_t i = 0u; i < count; i++) {
+        codes[i] = Codes_[j];
+        if (++j == Codes_.size()) {
+            j = 0u;
+        }
+    }
+}
+
+Source  *MakeSource (const std::string &spec)
+{
+    if (spec == "tb") {
+        return (new TbSource());
+    }
+    if (spec.compare(0u, 5u, "file:") == 0) {
+        return (new FileSource(spec.substr(5u)));
+    }
+    if (spec.compare(0u, 5u, "sine:") == 0) {
+        double  hz  = 0.0;
+        double  amp = 2047.0;
+        double  mid = 2048.0;
+
+
+        if (std::sscanf(spec.c_str() + 5, "%lf:%lf:%lf", &hz, &amp, &mid) < 1) {
+            throw std::runtime_error("bad source " + spec);
+        }
+        return (new SineSource(hz, amp, mid));
+    }
+    throw std::runtime_error("unknown source " + spec);
+}
+
+}
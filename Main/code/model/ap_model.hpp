@@ -0,0 +1,290 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot GOLDEN MODEL
+*
+* Description : Cycle-equivalent C++ model of the acquisition path of acquire_and_plot.vhd:
+*
+*                   adc_driver          one conversion every 101 clocks, 12 bits MSB first at 18 MHz
+*                   trigger_controller  slope/level trigger, hscale decimation, period measurement
+*                   sync_ram_dualport   write port, 2049 words of 12 bits (the write side of frame_buffers)
+*                   vga_control         vsync, which gates the trigger when Settings::WaitVsync() holds
+*
+*               Pipeline only evaluates the clock edges at which a register can change: the edge of
+*               every sample_ready pulse, the two edges that carry the write through 'we' into the RAM,
+*               and the edge at which the trigger fires. The edges it skips are provably no-ops, so the
+*               registers, the RAM and 'period' are the same as the VHDL's at every edge it evaluates.
+*               RtlPipeline (ap_rtl.cpp) is the literal clock-by-clock translation it is checked against.
+*
+* Note(s)     : 1) Edge 0 is the first rising edge of 'clk' with 'resetn' = '1'.
+*               2) 'trigger_up', 'trigger_down', 'trigger_n_p', 'vscale' and 'hscale' go through 2 or 3
+*                  synchronizer flops in the VHDL. The model applies a Settings change at the edge it is
+*                  given, i.e. without that delay.
+*               3) Some registers of trigger_controller have no reset ('hscale_counter',
+*                  'flag_second_cross', 'period'). The FPGA starts them at 0, GHDL at 'U', which changes
+*                  the first sweep. Init selects which one to reproduce.
+*               4) WaitVsync() is the 'wait_vsync' generic of trigger_controller, derived from the generics of
+*                  acquire_and_plot as it does: true for the default build, triple_buffer = false and
+*                  deep_bits = 0, the trigger armed only while vsync = '0'. With triple buffering (or a deep
+*                  record) the trigger re-arms after each sweep;
+*                  the bank bits that frame_buffers adds to the address are not modeled, so Ram() holds the
+*                  last sweep written whatever its bank.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_MODEL_HPP
+#define  AP_MODEL_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <string>
+#include  <utility>
+#include  <vector>
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                            CONSTANTS
+*********************************************************************************************************
+*/
+
+constexpr uint32_t  kClkHz        = 108000000u;
+
+                                                                /* adc_driver, edges counted from edge 0               */
+constexpr uint32_t  kConvCycles   = 101u;                       /* start 1 + t2 2 + readzeros 3*6 + readbits 12*6 + tquiet 8 */
+constexpr uint32_t  kReadyEdge    =  94u;                       /* First edge that sees sample_ready = '1'              */
+constexpr uint32_t  kBitEdge      =  26u;                       /* Edge that samples the MSB of the first conversion    */
+constexpr uint32_t  kBitCycles    =   6u;                       /* One sclk period                                      */
+constexpr uint32_t  kBits         =  12u;
+
+                                                                /* vga_control                                          */
+constexpr uint32_t  kLineCycles   = 112u + 248u + 1280u + 48u;
+constexpr uint32_t  kFrameLines   = 3u + 38u + 1024u + 1u;
+constexpr uint64_t  kFrameCycles  = (uint64_t)kLineCycles * kFrameLines;
+constexpr uint32_t  kVsyncCycles  = 3u * kLineCycles;           /* vsync = '0' for the 3 retrace lines                  */
+constexpr uint32_t  kVsyncLead    = kLineCycles - 2u;           /* First low edge of frame k: k * kFrameCycles - this   */
+
+                                                                /* trigger_controller, sync_ram_dualport                */
+constexpr uint32_t  kSweepSamples = 1280u;
+constexpr uint32_t  kRamWords     = 2049u;                      /* mem_type is (2**addr_width downto 0)                 */
+constexpr uint16_t  kLevelReset   = 256u;                       /* trigger_value after reset                            */
+
+
+/*
+*********************************************************************************************************
+*                                         adc_driver TIMING
+*
+* Description : Edge at which conversion 'n' delivers sample_ready, and edge at which it samples bit 'k'
+*               (0 = MSB) of 'sdata1'. Conversion 'n' starts, with ncs falling, at edge n * kConvCycles.
+*********************************************************************************************************
+*/
+
+inline  uint64_t  ReadyEdge (uint64_t n)
+{
+    return (kReadyEdge + n * kConvCycles);
+}
+
+inline  uint64_t  BitEdge (uint64_t n, uint32_t k)
+{
+    return (kBitEdge + n * kConvCycles + (uint64_t)k * kBitCycles);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         vga_control VSYNC
+*
+* Description : VsyncLow(e) is the value of 'vsync' = '0' seen by trigger_controller at edge 'e', i.e. the
+*               registered output of vga_control. NextVsyncLow(e) is the first edge >= 'e' where it holds.
+*********************************************************************************************************
+*/
+
+inline  bool  VsyncLow (uint64_t e)
+{
+    return ((e >= 1u) && (((e + kVsyncLead) % kFrameCycles) < kVsyncCycles));
+}
+
+inline  uint64_t  NextVsyncLow (uint64_t e)
+{
+    uint64_t  u = e + kVsyncLead;
+
+
+    if ((e >= 1u) && ((u % kFrameCycles) < kVsyncCycles)) {
+        return (e);
+    }
+    if (e == 0u) {
+        return (1u);
+    }
+    return ((u / kFrameCycles + 1u) * kFrameCycles - kVsyncLead);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+enum class Init {
+    Zero,                                                       /* Registers without reset start at 0, as on the FPGA   */
+    Unknown                                                     /* ... start at 'U', as in GHDL                         */
+};
+
+struct Settings {
+    uint16_t  Level  = kLevelReset;                             /* trigger_value, 9 bits                                */
+    bool      Rising = true;                                    /* trigger_slope                                        */
+    uint8_t   VScale = 0u;                                      /* vscale_rr                                            */
+    uint8_t   HScale = 0u;                                      /* hscale_rr: 1 sample out of HScale + 1                */
+    bool      TripleBuffer = false;                             /* Generic triple_buffer of acquire_and_plot            */
+    uint32_t  DeepBits     = 0u;                                /* Generic deep_bits of acquire_and_plot                */
+
+    bool      WaitVsync () const { return (!TripleBuffer && (DeepBits == 0u)); }   /* See note 4                   */
+};
+
+struct Observer {                                               /* Events of interest, all optional                     */
+    virtual        ~Observer  () = default;
+    virtual  void   OnWrite   (uint64_t edge, uint16_t addr, uint16_t data)   { (void)edge; (void)addr; (void)data; }
+    virtual  void   OnPeriod  (uint64_t edge, uint16_t period)                { (void)edge; (void)period; }
+    virtual  void   OnSweep   (uint64_t edge, const uint16_t *ram)            { (void)edge; (void)ram; }
+};
+
+struct TriggerRegs {                                            /* Names follow trigger_controller.vhd                  */
+    uint16_t  LastValue       = 0u;
+    uint16_t  PrevValue       = 0u;
+    uint16_t  CountedAcqs     = 0u;
+    bool      TriggerFlag     = false;
+    bool      Wee             = false;
+    uint8_t   HScaleCounter   = 0u;
+    bool      HScaleKnown     = true;                           /* false while 'hscale_counter' is 'U'/'X'              */
+    bool      FlagSecondCross = false;
+    bool      FscKnown        = true;
+    uint16_t  Period          = 0u;
+    bool      PeriodKnown     = true;
+    uint16_t  AddrOut         = 0u;                             /* Output registers, i.e. the RAM write port            */
+    uint16_t  DataOut         = 0u;
+    bool      We              = false;
+};
+
+
+/*
+*********************************************************************************************************
+*                                        trigger_controller
+*
+* Description : Edge() is one rising edge of the 'main' and 'outputs' processes, plus the write port of
+*               the RAM, which samples 'we', 'addr_out' and 'data_out' at the same edge.
+*********************************************************************************************************
+*/
+
+class  TriggerController {
+public:
+    explicit             TriggerController (Init init = Init::Zero);
+
+    void                 Set               (const Settings &s)  { Set_ = s; }
+    const Settings      &Get               () const             { return (Set_); }
+    const TriggerRegs   &Regs              () const             { return (R_); }
+
+    void                 Edge              (uint64_t         e,
+                                            bool             vsync_low,
+                                            bool             sample_ready,
+                                            uint16_t         data1,
+                                            uint16_t        *ram,
+                                            Observer        *obs);
+
+    bool                 Busy              () const;            /* The next edge changes a register even without input  */
+    bool                 Armed             () const;            /* Fires at the next edge (with vsync = '0')            */
+    void                 Settle            ();                  /* Output registers after idle edges                    */
+
+private:
+    uint16_t             Scaled            (uint16_t v) const   { return ((uint16_t)(v >> Set_.VScale)); }
+    bool                 Fires             () const;
+    bool                 Crosses           () const;
+
+    Settings             Set_;
+    TriggerRegs          R_;
+};
+
+
+/*
+*********************************************************************************************************
+*                                           SAMPLE SOURCES
+*
+* Description : The value the ADC converts at conversion 'n', which starts (ncs falls) at edge
+*               n * kConvCycles. Fill() returns 'count' consecutive 12-bit codes.
+*********************************************************************************************************
+*/
+
+class  Source {
+public:
+    virtual        ~Source () = default;
+    virtual  void   Fill    (uint64_t first, uint16_t *codes, size_t count) = 0;
+};
+
+class  TbSource : public Source {                               /* Stimulus of acquire_and_plot_tb.vhd: +1024 per sample */
+public:
+    void            Fill    (uint64_t first, uint16_t *codes, size_t count) override;
+};
+
+class  SineSource : public Source {
+public:
+                    SineSource (double hz, double amplitude = 2047.0, double mid = 2048.0);
+    void            Fill       (uint64_t first, uint16_t *codes, size_t count) override;
+private:
+    double          W_;                                         /* Radians per conversion                               */
+    double          Amp_;
+    double          Mid_;
+};
+
+class  VectorSource : public Source {                           /* Given codes, replayed in a loop                      */
+public:
+                    VectorSource () = default;
+    explicit        VectorSource (std::vector<uint16_t> codes) : Codes_(std::move(codes)) {}
+    void            Fill         (uint64_t first, uint16_t *codes, size_t count) override;
+    size_t          Size         () const { return (Codes_.size()); }
+protected:
+    std::vector<uint16_t>  Codes_;
+};
+
+class  FileSource : public VectorSource {                       /* Raw little-endian 16-bit codes                       */
+public:
+    explicit        FileSource   (const std::string &path);
+};
+
+Source  *MakeSource (const std::string &spec);                  /* "tb", "sine:<hz>[:<amp>[:<mid>]]", "file:<path>"    */
+
+
+/*
+*********************************************************************************************************
+*                                            PIPELINE
+*
+* Description : Run() converts the next 'conversions' samples of 'src' and stops right after the edge of
+*               the last sample_ready pulse. RunUntil() evaluates the edges before 'edge' that come before
+*               the next sample_ready pulse.
+*********************************************************************************************************
+*/
+
+class  Pipeline {
+public:
+    explicit             Pipeline    (Init init = Init::Zero);
+
+    void                 Set         (const Settings &s)  { Trig_.Set(s); }
+    void                 Run         (Source &src, uint64_t conversions, Observer *obs = nullptr);
+    void                 RunUntil    (uint64_t edge, Observer *obs = nullptr);
+
+    const uint16_t      *Ram         () const { return (Ram_); }
+    const TriggerRegs   &Regs        () const { return (Trig_.Regs()); }
+    uint64_t             Edge        () const { return (E_); }  /* Next edge to evaluate                                */
+    uint64_t             Conversions () const { return (Conv_); }
+
+private:
+    void                 Advance     (uint64_t until, Observer *obs);
+
+    TriggerController    Trig_;
+    uint16_t             Ram_[kRamWords] = {};
+    uint64_t             E_    = 0u;
+    uint64_t             Conv_ = 0u;
+};
+
+}
+
+#endif
@@ -0,0 +1,651 @@
+/*
+*********************************************************************************************************
+*                                       VIVADO REPORT ANALYSIS
+*
+* Description : See ap_report.hpp.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <cctype>
+#include  <cmath>
+#include  <cstdlib>
+#include  <cstring>
+#include  <limits>
+#include  <stdexcept>
+#include  <unordered_map>
+
+#include  <fcntl.h>
+#include  <sys/mman.h>
+#include  <sys/stat.h>
+#include  <unistd.h>
+
+#include  "ap_report.hpp"
+
+
+namespace ap {
+
+namespace {
+
+constexpr double  kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/*
+*********************************************************************************************************
+*                                             LINES
+*
+* Description : Next() returns the lines of the mapping one by one, without the '\r' of a CRLF file.
+*********************************************************************************************************
+*/
+
+struct Cursor {
+    const char  *P;
+    const char  *End;
+    uint64_t     Lines = 0u;
+
+    bool  Next (std::string_view &l)
+    {
+        const char  *nl;
+        size_t       n;
+
+
+        if (P >= End) {
+            return (false);
+        }
+        nl = (const char *)std::memchr(P, '\n', (size_t)(End - P));
+        n  = (size_t)(((nl != nullptr) ? nl : End) - P);
+        if ((n > 0u) && (P[n - 1u] == '\r')) {
+            n--;
+        }
+        l = std::string_view(P, n);
+        P = (nl != nullptr) ? nl + 1 : End;
+        Lines++;
+        return (true);
+    }
+};
+
+bool  Starts (std::string_view l, std::string_view prefix)
+{
+    return ((l.size() >= prefix.size()) && (l.compare(0u, prefix.size(), prefix) == 0));
+}
+
+std::string_view  Trim (std::string_view s)
+{
+    while (!s.empty() && ((s.front() == ' ') || (s.front() == '\t'))) {
+        s.remove_prefix(1u);
+    }
+    while (!s.empty() && ((s.back() == ' ') || (s.back() == '\t'))) {
+        s.remove_suffix(1u);
+    }
+    return (s);
+}
+
+std::string_view  After (std::string_view l, char c)            /* Trimmed text after the first 'c'                     */
+{
+    size_t  i = l.find(c);
+
+
+    return ((i == std::string_view::npos) ? std::string_view() : Trim(l.substr(i + 1u)));
+}
+
+double  Num (std::string_view s)                                /* Leading number of 's': '0.650ns', 'inf'; NaN if none */
+{
+    char    buf[48];
+    char   *end;
+    double  v;
+
+
+    s = Trim(s);
+    if (s.empty()) {
+        return (kNaN);
+    }
+    s = s.substr(0u, sizeof(buf) - 1u);
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    v = std::strtod(buf, &end);
+    return ((end == buf) ? kNaN : v);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          COLUMN TABLES
+*
+* Description : The tables of report_timing_summary: a header line, a line of '---' runs, then rows up to
+*               a blank line. Cells are separated by two spaces or more; each goes to the first run
+*               that ends after its first character (Note 1 of ap_report.hpp).
+*********************************************************************************************************
+*/
+
+typedef  std::vector<std::pair<size_t, size_t>>  Runs;         /* [begin, end) of each '---' run                       */
+
+Runs  DashRuns (std::string_view l)
+{
+    Runs    r;
+    size_t  i = 0u;
+
+
+    while (i < l.size()) {
+        if (l[i] != '-') {
+            i++;
+            continue;
+        }
+        size_t  b = i;
+
+
+        while ((i < l.size()) && (l[i] == '-')) {
+            i++;
+        }
+        r.emplace_back(b, i);
+    }
+    return (r);
+}
+
+void  Cells (std::string_view l, const Runs &runs, std::vector<std::string_view> &out)
+{
+    size_t  i = 0u;
+
+
+    out.assign(runs.size(), std::string_view());
+    while (i < l.size()) {
+        size_t  b;
+        size_t  k = 0u;
+
+
+        if (l[i] == ' ') {
+            i++;
+            continue;
+        }
+        b = i;
+        while ((i < l.size()) && !((l[i] == ' ') && ((i + 1u >= l.size()) || (l[i + 1u] == ' ')))) {
+            i++;
+        }
+        while ((k + 1u < runs.size()) && (runs[k].second <= b)) {
+            k++;
+        }
+        if (!runs.empty() && out[k].empty()) {
+            out[k] = l.substr(b, i - b);
+        }
+    }
+}
+
+void  RowField (TimingRow &r, std::string_view head, std::string_view cell)
+{
+    static const struct {
+        const char  *Head;
+        double TimingRow::*Field;
+    } cols[] = {
+        { "WNS(ns)",                 &TimingRow::Wns       },
+        { "TNS(ns)",                 &TimingRow::Tns       },
+        { "TNS Failing Endpoints",   &TimingRow::TnsFail   },
+        { "TNS Total Endpoints",     &TimingRow::TnsTotal  },
+        { "WHS(ns)",                 &TimingRow::Whs       },
+        { "THS(ns)",                 &TimingRow::Ths       },
+        { "THS Failing Endpoints",   &TimingRow::ThsFail   },
+        { "THS Total Endpoints",     &TimingRow::ThsTotal  },
+        { "WPWS(ns)",                &TimingRow::Wpws      },
+        { "TPWS(ns)",                &TimingRow::Tpws      },
+        { "TPWS Failing Endpoints",  &TimingRow::TpwsFail  },
+        { "TPWS Total Endpoints",    &TimingRow::TpwsTotal },
+    };
+
+
+    if ((head == "Clock") || (head == "From Clock")) {
+        r.Name = cell;
+        return;
+    }
+    if (head == "To Clock") {
+        r.To = cell;
+        return;
+    }
+    for (const auto &c : cols) {
+        if (head == c.Head) {
+            r.*c.Field = Num(cell);
+            return;
+        }
+    }
+}
+
+TimingRow  BlankRow ()
+{
+    TimingRow  r;
+
+
+    r.Wns  = r.Tns  = r.TnsFail  = r.TnsTotal  = kNaN;
+    r.Whs  = r.Ths  = r.ThsFail  = r.ThsTotal  = kNaN;
+    r.Wpws = r.Tpws = r.TpwsFail = r.TpwsTotal = kNaN;
+    return (r);
+}
+
+}
+
+
+/*
+*********************************************************************************************************
+*                                              REPORT
+*********************************************************************************************************
+*/
+
+Report::Report (const std::string &path) : Path_(path), Design_(BlankRow())
+{
+    struct stat  st;
+    void        *p;
+    int          fd = open(path.c_str(), O_RDONLY);
+
+
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        close(fd);
+        throw std::runtime_error(path + ": empty");
+    }
+    Len_ = (size_t)st.st_size;
+    p    = mmap(nullptr, Len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path);
+    }
+    madvise(p, Len_, MADV_SEQUENTIAL);
+    Data_ = (const char *)p;
+
+    std::string_view  cmd;
+    Cursor            c = { Data_, Data_ + Len_ };
+    std::string_view  l;
+
+
+    while (c.Next(l) && !(l.empty() && !Banner_.empty())) {     /* The banner ends at the first blank line              */
+        if (Starts(l, "| ")) {
+            Banner_.push_back(l);
+        }
+    }
+    cmd = Field("Command");
+    try {
+        if (Starts(cmd, "report_timing_summary")) {
+            Kind_ = ReportKind::Timing;
+            ParseTiming();
+        } else if (Starts(cmd, "report_utilization")) {
+            Kind_ = ReportKind::Utilization;
+            ParseUtil();
+        } else {
+            throw std::runtime_error(path + ": neither report_timing_summary nor report_utilization");
+        }
+    } catch (...) {                                             /* No destructor for a half-built object                */
+        munmap((void *)Data_, Len_);
+        throw;
+    }
+}
+
+Report::~Report ()
+{
+    if (Data_ != nullptr) {
+        munmap((void *)Data_, Len_);
+    }
+}
+
+std::string_view  Report::Field (std::string_view name) const
+{
+    for (std::string_view l : Banner_) {
+        size_t  colon = l.find(':');
+
+
+        if ((colon != std::string_view::npos) && (Trim(l.substr(1u, colon - 1u)) == name)) {
+            return (Trim(l.substr(colon + 1u)));
+        }
+    }
+    return (std::string_view());
+}
+
+const UtilRow  *Report::Find (std::string_view site, const UtilTable **table) const
+{
+    for (const UtilTable &t : Tables_) {
+        for (const UtilRow &r : t.Rows) {
+            if (r.Site == site) {
+                if (table != nullptr) {
+                    *table = &t;
+                }
+                return (&r);
+            }
+        }
+    }
+    return (nullptr);
+}
+
+int  UtilTable::Column (std::string_view name) const
+{
+    for (size_t k = 1u; k < Header.size(); k++) {
+        if (Header[k] == name) {
+            return ((int)k - 1);
+        }
+    }
+    return (-1);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      report_timing_summary
+*
+* Description : The lines that matter all start in column 0 or 2; the path details, which are most of a
+*               large report, start with at least three spaces and are skipped on that test alone.
+*********************************************************************************************************
+*/
+
+void  Report::ParseTiming ()
+{
+    enum class  Tbl { None, Design, Clocks, Intra, Inter, Other };
+
+    Cursor                         c = { Data_, Data_ + Len_ };
+    std::string_view               l;
+    Tbl                            tbl   = Tbl::None;
+    int                            phase = 0;                   /* Of tbl: 0 header, 1 dashes, 2 rows                   */
+    std::string_view               head;
+    Runs                           runs;
+    std::vector<std::string_view>  hcells;
+    std::vector<std::string_view>  cells;
+    int                            summary = -1;                /* Lines left of the Timing Details heading             */
+    bool                           details = false;
+    bool                           max     = true;
+    std::string_view               from;
+    std::string_view               to;
+    TimingPath                    *path    = nullptr;
+    std::string_view               pclock;
+    size_t                         pslack  = std::string_view::npos;    /* Columns of the Pulse Width Checks        */
+    size_t                         pcorner = 0u;
+    size_t                         ppin    = 0u;
+
+
+    while (c.Next(l)) {
+        if (summary >= 0) {
+            if (summary-- == 0) {
+                Summary_ = std::string_view(Data_, (size_t)(c.P - Data_));
+            }
+        }
+        if ((l.size() >= 3u) && (l[0] == ' ') && (l[1] == ' ') && (l[2] == ' ')) {
+            if (tbl == Tbl::None) {                             /* Path details                                         */
+                continue;
+            }
+        }
+
+        if (!details) {                                         /* Summary tables                                       */
+            if (Starts(l, "| ") && !Starts(l, "| -")) {
+                std::string_view  t = Trim(l.substr(2u));
+
+
+                tbl   = (t == "Design Timing Summary") ? Tbl::Design :
+                        (t == "Clock Summary")         ? Tbl::Clocks :
+                        (t == "Intra Clock Table")     ? Tbl::Intra  :
+                        (t == "Inter Clock Table")     ? Tbl::Inter  : Tbl::Other;
+                phase = 0;
+                if (t == "Timing Details") {
+                    tbl     = Tbl::None;
+                    details = true;
+                    summary = 2;
+                }
+                continue;
+            }
+            if (l == "All user specified timing constraints are met.") {
+                Met_ = true;
+                continue;
+            }
+            if ((tbl == Tbl::None) || (tbl == Tbl::Other)) {
+                continue;
+            }
+            if (phase == 0) {
+                if (!Trim(l).empty() && (l[0] != '-') && (l[0] != '|')) {
+                    head  = l;
+                    phase = 1;
+                }
+            } else if (phase == 1) {
+                runs  = DashRuns(l);
+                Cells(head, runs, hcells);
+                phase = 2;
+            } else if (Trim(l).empty()) {
+                tbl = Tbl::None;
+            } else if (tbl == Tbl::Clocks) {
+                TimingClock  k;
+
+
+                Cells(l, runs, cells);
+                k.Name     = cells[0];
+                k.Waveform = (cells.size() > 1u) ? cells[1] : std::string_view();
+                k.Period   = (cells.size() > 2u) ? Num(cells[2]) : kNaN;
+                k.Mhz      = (cells.size() > 3u) ? Num(cells[3]) : kNaN;
+                Clocks_.push_back(k);
+            } else {
+                TimingRow  r = BlankRow();
+
+
+                Cells(l, runs, cells);
+                for (size_t k = 0u; k < cells.size(); k++) {
+                    RowField(r, hcells[k], cells[k]);
+                }
+                if (tbl == Tbl::Design) {
+                    Design_ = r;
+                } else {
+                    ((tbl == Tbl::Intra) ? Intra_ : Inter_).push_back(r);
+                }
+            }
+            continue;
+        }
+
+        if (l.empty()) {
+            path   = nullptr;
+            pslack = std::string_view::npos;
+            continue;
+        }
+        if ((pslack != std::string_view::npos) && (pslack < l.size()) && (pcorner < l.size())) {
+            PulseCheck  k;                                      /* A row of the Pulse Width Checks                      */
+
+
+            k.Clock = pclock;
+            k.Check = Trim(l.substr(0u, pcorner));
+            k.Slack = Num(l.substr(pslack, l.find(' ', pslack) - pslack));
+            k.Pin   = (ppin < l.size()) ? Trim(l.substr(ppin)) : std::string_view();
+            Pulses_.push_back(k);
+            continue;
+        }
+        switch (l[0]) {
+            case 'S':
+                 if (Starts(l, "Slack")) {                      /* 'Slack (MET) :   0.650ns  (...)', 'Slack:  inf'      */
+                     TimingPath  p;
+
+
+                     p.Slack       = Num(After(l, ':'));
+                     p.Max         = max;
+                     p.From        = from;
+                     p.To          = to;
+                     p.Requirement = kNaN;
+                     p.Delay       = kNaN;
+                     p.Levels      = 0u;
+                     Paths_.push_back(p);
+                     path = &Paths_.back();
+                 }
+                 break;
+
+            case 'F':
+                 if (Starts(l, "From Clock:")) {
+                     from = After(l, ':');
+                     to   = std::string_view();
+                 }
+                 break;
+
+            case 'M':
+                 if      (l == "Max Delay Paths") { max = true;  }
+                 else if (l == "Min Delay Paths") { max = false; }
+                 break;
+
+            case 'C':
+                 if (Starts(l, "Clock Name:")) {
+                     pclock = After(l, ':');
+                 } else if (Starts(l, "Check Type")) {
+                     pcorner = l.find("Corner");
+                     pslack  = l.find("Slack(ns)");
+                     ppin    = l.rfind(" Pin");
+                     ppin    = (ppin == std::string_view::npos) ? l.size() : ppin + 1u;
+                 }
+                 break;
+
+            case ' ':
+                 if ((path != nullptr) && (l.size() > 2u) && (l[1] == ' ') && (l[2] != ' ') && (l[2] != '-')) {
+                     std::string_view  key = Trim(l.substr(0u, l.find(':')));
+                     std::string_view  v   = After(l, ':');
+
+
+                     if      (key == "Source")          { path->Source      = v; }
+                     else if (key == "Destination")     { path->Destination = v; }
+                     else if (key == "Path Group")      { path->Group       = v; }
+                     else if (key == "Path Type")       { path->Check       = v.substr(0u, v.find(' ')); }
+                     else if (key == "Requirement")     { path->Requirement = Num(v); }
+                     else if (key == "Data Path Delay") { path->Delay       = Num(v); }
+                     else if (key == "Logic Levels")    { path->Levels      = (uint32_t)Num(v); }
+                 } else if (Starts(l, "  To Clock:")) {
+                     to = After(l, ':');
+                 }
+                 break;
+
+            default:
+                 break;
+        }
+    }
+    Lines_ = c.Lines;
+}
+
+
+/*
+*********************************************************************************************************
+*                                        report_utilization
+*
+* Description : A section is a numbered title over a line of dashes; a table is '+---+' border, header
+*               row, border, rows, border. An empty table has its three borders in a row.
+*********************************************************************************************************
+*/
+
+void  Report::ParseUtil ()
+{
+    Cursor            c = { Data_, Data_ + Len_ };
+    std::string_view  l;
+    std::string_view  prev;
+    std::string_view  section;
+    int               borders = 0;                              /* Of the open table                                    */
+
+
+    while (c.Next(l)) {
+        if (Starts(l, "+-")) {
+            if (borders == 0) {
+                Tables_.emplace_back();
+                Tables_.back().Section = section;
+            }
+            borders = (borders == 2) ? 0 : borders + 1;
+        } else if ((borders > 0) && Starts(l, "|")) {
+            std::vector<std::string_view>  cells;
+            size_t                         b = 1u;
+
+
+            for (size_t e = l.find('|', b); e != std::string_view::npos; e = l.find('|', b)) {
+                cells.push_back(l.substr(b, e - b));
+                b = e + 1u;
+            }
+            if (cells.empty()) {
+                continue;
+            }
+            if (borders == 1) {
+                for (std::string_view &h : cells) {
+                    h = Trim(h);
+                }
+                Tables_.back().Header = cells;
+            } else {
+                UtilRow  r;
+                size_t   lead = cells[0].find_first_not_of(' ');
+
+
+                r.Site  = Trim(cells[0]);
+                r.Depth = (lead == std::string_view::npos) ? 0u : (uint32_t)((lead > 0u) ? (lead - 1u) / 2u : 0u);
+                for (size_t k = 1u; k < cells.size(); k++) {
+                    r.Cells.push_back(Trim(cells[k]));
+                }
+                Tables_.back().Rows.push_back(r);
+            }
+        } else if (!l.empty() && (l.find_first_not_of('-') == std::string_view::npos) &&
+                   !prev.empty() && std::isdigit((unsigned char)prev[0])) {
+            section = prev;
+        }
+        prev = l;
+    }
+    Lines_ = c.Lines;
+}
+
+
+/*
+*********************************************************************************************************
+*                                            ANALYSIS
+*********************************************************************************************************
+*/
+
+SlackHistogram  ReportHistogram (const std::vector<TimingPath> &paths, bool max, double bin)
+{
+    SlackHistogram  h = { 0.0, bin, {} };
+    double          lo =  std::numeric_limits<double>::infinity();
+    double          hi = -std::numeric_limits<double>::infinity();
+
+
+    for (const TimingPath &p : paths) {
+        if ((p.Max == max) && std::isfinite(p.Slack)) {
+            lo = std::min(lo, p.Slack);
+            hi = std::max(hi, p.Slack);
+        }
+    }
+    if (!(lo <= hi) || !(bin > 0.0)) {
+        return (h);
+    }
+    h.Lo = std::floor(lo / bin) * bin;
+    h.Count.assign((size_t)std::floor((hi - h.Lo) / bin) + 1u, 0u);
+    for (const TimingPath &p : paths) {
+        if ((p.Max == max) && std::isfinite(p.Slack)) {
+            size_t  k = (size_t)std::floor((p.Slack - h.Lo) / bin);
+
+
+            h.Count[std::min(k, h.Count.size() - 1u)]++;
+        }
+    }
+    return (h);
+}
+
+std::vector<PathDelta>  ReportDiff (const Report &old_rpt, const Report &new_rpt)
+{
+    std::unordered_map<std::string, size_t>  index;             /* Key of a new path to its index                       */
+    std::vector<bool>                        used(new_rpt.Paths().size(), false);
+    std::vector<PathDelta>                   d;
+    std::string                              key;
+
+
+    auto  make = [&key](const TimingPath &p) -> const std::string & {
+        key.assign(p.Max ? "M" : "m");
+        key.append(p.Source.data(), p.Source.size());
+        key.push_back('\n');
+        key.append(p.Destination.data(), p.Destination.size());
+        return (key);
+    };
+
+    for (size_t i = 0u; i < new_rpt.Paths().size(); i++) {
+        index.emplace(make(new_rpt.Paths()[i]), i);             /* The first, worst, of a pin pair listed twice         */
+    }
+    for (const TimingPath &p : old_rpt.Paths()) {
+        auto  it = index.find(make(p));
+
+
+        if ((it != index.end()) && !used[it->second]) {
+            used[it->second] = true;
+            d.push_back({ &p, &new_rpt.Paths()[it->second] });
+        } else {
+            d.push_back({ &p, nullptr });
+        }
+    }
+    for (size_t i = 0u; i < used.size(); i++) {
+        if (!used[i]) {
+            d.push_back({ nullptr, &new_rpt.Paths()[i] });
+        }
+    }
+    return (d);
+}
+
+}
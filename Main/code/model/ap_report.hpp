@@ -0,0 +1,179 @@
+/*
+*********************************************************************************************************
+*                                       VIVADO REPORT ANALYSIS
+*
+* Description : Reads the reports Vivado writes for a build, report_timing_summary (x_timing_report.txt)
+*               and report_utilization (x_utilization.txt), in one pass over the mapped file:
+*
+*                   timing        the Design Timing Summary (WNS, TNS, WHS, THS, WPWS, TPWS and their
+*                                 endpoints), the Clock Summary, the Intra and Inter Clock Tables, every
+*                                 path of the Timing Details with its slack, check, clock pair and group,
+*                                 and the Pulse Width Checks
+*                   utilization   every '+---+' table, under the numbered section it belongs to
+*
+*               The text fields are views into the mapping: they live as long as the Report.
+*
+* Note(s)     : 1) The column tables of report_timing_summary are read by position: a value belongs to
+*                  the column of the '---' run under its header where it starts, so blank cells (a clock
+*                  without hold paths, say) stay blank instead of shifting the row.
+*               2) Slack is +inf for unconstrained paths ("Slack: inf"); a blank summary cell is NaN.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_REPORT_HPP
+#define  AP_REPORT_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <string>
+#include  <string_view>
+#include  <vector>
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+enum class  ReportKind { Timing, Utilization };
+
+struct TimingRow {                                              /* One row of the summary tables, ns                    */
+    std::string_view  Name;                                     /* Clock, or 'from -> to'; empty for the design         */
+    std::string_view  To;                                       /* Inter Clock Table only                               */
+    double            Wns;
+    double            Tns;
+    double            TnsFail;                                  /* Failing and total endpoints                          */
+    double            TnsTotal;
+    double            Whs;
+    double            Ths;
+    double            ThsFail;
+    double            ThsTotal;
+    double            Wpws;
+    double            Tpws;
+    double            TpwsFail;
+    double            TpwsTotal;
+};
+
+struct TimingClock {                                            /* Clock Summary                                        */
+    std::string_view  Name;
+    std::string_view  Waveform;
+    double            Period;
+    double            Mhz;
+};
+
+struct TimingPath {
+    double            Slack;                                    /* +inf when unconstrained                              */
+    bool              Max;                                      /* Max Delay Paths (setup, recovery), else min          */
+    std::string_view  Check;                                    /* Setup, Hold, Recovery, Removal                       */
+    std::string_view  From;                                     /* Clocks of the section; may be empty                  */
+    std::string_view  To;
+    std::string_view  Group;
+    std::string_view  Source;
+    std::string_view  Destination;
+    double            Requirement;                              /* NaN when not given                                   */
+    double            Delay;                                    /* Data Path Delay                                      */
+    uint32_t          Levels;                                   /* Logic Levels                                         */
+};
+
+struct PulseCheck {
+    std::string_view  Clock;
+    std::string_view  Check;                                    /* Min Period, Low Pulse Width, ...                     */
+    std::string_view  Pin;
+    double            Slack;
+};
+
+struct UtilRow {
+    std::string_view               Site;                        /* First cell, without its indent                       */
+    uint32_t                       Depth;                       /* Indent / 2: 1 for 'LUT as Logic' under 'Slice LUTs'  */
+    std::vector<std::string_view>  Cells;                       /* The other cells, trimmed                             */
+};
+
+struct UtilTable {
+    std::string_view               Section;                     /* '3. Memory'                                          */
+    std::vector<std::string_view>  Header;                      /* All cells, the first one included                    */
+    std::vector<UtilRow>           Rows;
+
+    int                            Column (std::string_view name) const;    /* Index into Cells, -1 if absent       */
+};
+
+struct SlackHistogram {
+    double                 Lo;                                  /* Left edge of bin 0                                   */
+    double                 Bin;
+    std::vector<uint64_t>  Count;
+};
+
+
+/*
+*********************************************************************************************************
+*                                              REPORT
+*********************************************************************************************************
+*/
+
+class  Report {
+public:
+    explicit                          Report      (const std::string &path);
+                                     ~Report      ();
+                                      Report      (const Report &) = delete;
+    Report                           &operator=   (const Report &) = delete;
+
+    ReportKind                        Kind        () const { return (Kind_); }
+    const std::string                &Path        () const { return (Path_); }
+    uint64_t                          Bytes       () const { return (Len_); }
+    uint64_t                          Lines       () const { return (Lines_); }
+    std::string_view                  Field       (std::string_view name) const;   /* '| Design : ..' of the banner */
+    std::string_view                  Summary     () const { return (Summary_); }  /* Text up to Timing Details     */
+
+    bool                              Met         () const { return (Met_); }
+    const TimingRow                  &Design      () const { return (Design_); }
+    const std::vector<TimingClock>   &Clocks      () const { return (Clocks_); }
+    const std::vector<TimingRow>     &Intra       () const { return (Intra_); }
+    const std::vector<TimingRow>     &Inter       () const { return (Inter_); }
+    const std::vector<TimingPath>    &Paths       () const { return (Paths_); }
+    const std::vector<PulseCheck>    &Pulses      () const { return (Pulses_); }
+
+    const std::vector<UtilTable>     &Tables      () const { return (Tables_); }
+    const UtilRow                    *Find        (std::string_view site, const UtilTable **table = nullptr) const;
+
+private:
+    void                              ParseTiming ();
+    void                              ParseUtil   ();
+
+    std::string                       Path_;
+    const char                       *Data_  = nullptr;
+    size_t                            Len_   = 0u;
+    uint64_t                          Lines_ = 0u;
+    ReportKind                        Kind_  = ReportKind::Timing;
+    std::vector<std::string_view>     Banner_;                  /* '| Name : value' lines of the banner                 */
+    std::string_view                  Summary_;
+    bool                              Met_   = false;
+    TimingRow                         Design_;
+    std::vector<TimingClock>          Clocks_;
+    std::vector<TimingRow>            Intra_;
+    std::vector<TimingRow>            Inter_;
+    std::vector<TimingPath>           Paths_;
+    std::vector<PulseCheck>           Pulses_;
+    std::vector<UtilTable>            Tables_;
+};
+
+
+/*
+*********************************************************************************************************
+*                                            ANALYSIS
+*********************************************************************************************************
+*/
+
+SlackHistogram  ReportHistogram (const std::vector<TimingPath> &paths, bool max, double bin);
+
+struct PathDelta {                                              /* A path of either build, matched by check and pins    */
+    const TimingPath  *Old;                                     /* nullptr: only in the new build                       */
+    const TimingPath  *New;                                     /* nullptr: only in the old build                       */
+};
+
+std::vector<PathDelta>  ReportDiff (const Report &old_rpt, const Report &new_rpt);
+
+}
+
+#endif
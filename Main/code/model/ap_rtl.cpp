@@ -0,0 +1,194 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot REFERENCE MODEL
+*
+* Description : See ap_rtl.hpp. Each Edge function computes the next value of every register from the
+*               current ones, as a VHDL clocked process does, and the caller commits them together.
+*********************************************************************************************************
+*/
+
+#include  "ap_rtl.hpp"
+
+
+namespace ap {
+
+RtlPipeline::RtlPipeline (Init init)
+    : Trig_(init)
+{
+}
+
+
+/*
+*********************************************************************************************************
+*                                        adc_driver 'main' and 'output'
+*********************************************************************************************************
+*/
+
+void  RtlPipeline::AdcEdge ()
+{
+    AdcRegs  n = Adc_;
+
+
+    switch (Adc_.State) {
+        case kStart:
+             n.State   = kT2;
+             n.Ncs     = false;
+             n.Counter = 0u;
+             break;
+
+        case kT2:
+             n.Counter = (uint8_t)((Adc_.Counter + 1u) & 7u);
+             if (Adc_.Counter == 1u) {
+                 n.State       = kReadZeros;
+                 n.Counter     = 0u;
+                 n.Sclk        = false;
+                 n.CounterSclk = 0u;
+             }
+             break;
+
+        case kReadZeros:
+        case kReadBits:
+             n.CounterSclk = (uint8_t)((Adc_.CounterSclk + 1u) & 7u);
+             if (Adc_.CounterSclk == 2u) {
+                 n.Sclk = true;
+             } else if (Adc_.CounterSclk == 5u) {
+                 n.Sclk        = false;
+                 n.CounterSclk = 0u;
+                 n.CounterBits = (uint8_t)((Adc_.CounterBits + 1u) & 15u);
+                 if (Adc_.State == kReadZeros) {
+                     if (Adc_.CounterBits == 3u - 1u) {
+                         n.CounterBits = 0u;
+                         n.State       = kReadBits;
+                     }
+                 } else {
+                     uint16_t  bit = (uint16_t)(1u << (11u - Adc_.CounterBits));
+
+
+                     n.Dataa = Sdata1_ ? (uint16_t)(Adc_.Dataa | bit) : (uint16_t)(Adc_.Dataa & ~bit);
+                     if (Adc_.CounterBits == 12u - 1u) {
+                         n.CounterBits  = 0u;
+                         n.State        = kTQuiet;
+                         n.SampleReadyy = true;
+                         n.Counter      = 0u;
+                     }
+                 }
+             }
+             break;
+
+        case kTQuiet:
+             n.SampleReadyy = false;
+             n.CounterSclk  = (uint8_t)((Adc_.CounterSclk + 1u) & 7u);
+             if (Adc_.CounterSclk == 2u) {
+                 n.Sclk = true;
+                 n.Ncs  = true;
+             }
+             if (Adc_.CounterSclk == 7u) {
+                 n.State   = kStart;
+                 n.Counter = 0u;
+             }
+             break;
+    }
+
+    if (Adc_.SampleReadyy) {                                    /* 'output' process                                     */
+        n.Data = Adc_.Dataa;
+    }
+    n.SampleReady = Adc_.SampleReadyy;
+
+    Adc_ = n;
+}
+
+
+/*
+*********************************************************************************************************
+*                                vga_control 'hsync_process', 'vsync_process'
+*********************************************************************************************************
+*/
+
+void  RtlPipeline::VgaEdge ()
+{
+    VgaRegs  n      = Vga_;
+    bool     hhsync = (Vga_.HState != kRetrace);
+
+
+    n.HCounter = (uint16_t)((Vga_.HCounter + 1u) & 0x7FFu);
+    switch (Vga_.HState) {
+        case kRetrace:   if (Vga_.HCounter ==  112u - 1u) { n.HState = kBack;      n.HCounter = 0u; }  break;
+        case kBack:      if (Vga_.HCounter ==  248u - 1u) { n.HState = kActPixels; n.HCounter = 0u; }  break;
+        case kActPixels: if (Vga_.HCounter == 1280u - 1u) { n.HState = kFront;     n.HCounter = 0u; }  break;
+        case kFront:     if (Vga_.HCounter ==   48u - 1u) { n.HState = kRetrace;   n.HCounter = 0u; }  break;
+    }
+
+    if (!hhsync && Vga_.HhsyncPrev) {
+        n.VCounter = (uint16_t)((Vga_.VCounter + 1u) & 0x7FFu);
+        switch (Vga_.VState) {
+            case kRetrace:   if (Vga_.VCounter ==    3u - 1u) { n.VState = kBack;      n.VCounter = 0u; }  break;
+            case kBack:      if (Vga_.VCounter ==   38u - 1u) { n.VState = kActPixels; n.VCounter = 0u; }  break;
+            case kActPixels: if (Vga_.VCounter == 1024u - 1u) { n.VState = kFront;     n.VCounter = 0u; }  break;
+            case kFront:     if (Vga_.VCounter ==    1u - 1u) { n.VState = kRetrace;   n.VCounter = 0u; }  break;
+        }
+    }
+
+    n.HhsyncPrev = hhsync;                                      /* 'output_process'                                     */
+    n.Vsync      = (Vga_.VState != kRetrace);
+
+    Vga_ = n;
+}
+
+
+/*
+*********************************************************************************************************
+*                                                RUN
+*
+* Description : Same contract as Pipeline::Run(). The serial ADC latches the next code of 'src' when ncs
+*               falls and, like the testbench, drives three zeros and then the code MSB first, one bit
+*               after each falling edge of sclk.
+*********************************************************************************************************
+*/
+
+void  RtlPipeline::Run (Source &src, uint64_t conversions, Observer *obs)
+{
+    uint64_t  conv = 0u;
+    uint64_t  done = 0u;
+    uint16_t  code;
+
+
+    while (done < conversions) {
+        bool  vsync_low    = !Vga_.Vsync;
+        bool  sample_ready = Adc_.SampleReady;
+        bool  ncs          = Adc_.Ncs;
+        bool  sclk         = Adc_.Sclk;
+
+
+        if (vsync_low != VsyncLow(E_)) {
+            TimingErrors_++;
+        }
+        if (Adc_.State == kReadBits && Adc_.CounterSclk == 5u &&
+            E_ != BitEdge((E_ - kBitEdge) / kConvCycles, Adc_.CounterBits)) {
+            TimingErrors_++;
+        }
+        if (sample_ready && (E_ != ReadyEdge(done))) {
+            TimingErrors_++;
+        }
+
+        Trig_.Edge(E_, vsync_low, sample_ready, Adc_.Data, Ram_, obs);
+        VgaEdge();
+        AdcEdge();
+
+        if (ncs && !Adc_.Ncs) {                                 /* Conversion starts                                    */
+            src.Fill(conv++, &code, 1u);
+            AdcCode_  = code & 0xFFFu;
+            AdcFalls_ = 0u;
+        }
+        if (sclk && !Adc_.Sclk) {                               /* The ADC shifts out the next bit                      */
+            Sdata1_ = (AdcFalls_ >= 3u) && (AdcFalls_ < 3u + kBits) && ((AdcCode_ >> (11u - (AdcFalls_ - 3u))) & 1u);
+            AdcFalls_++;
+        }
+
+        E_++;
+        if (sample_ready) {
+            done++;
+        }
+    }
+}
+
+}
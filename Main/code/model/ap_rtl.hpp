@@ -0,0 +1,75 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot REFERENCE MODEL
+*
+* Description : Clock-by-clock translation of the processes of adc_driver.vhd and vga_control.vhd (sync
+*               part), around the TriggerController of ap_model.hpp, plus the serial ADC of
+*               acquire_and_plot_tb.vhd. Every edge is evaluated, so it is slow; it exists to check
+*               Pipeline, which skips the idle edges, and the timing constants of ap_model.hpp.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_RTL_HPP
+#define  AP_RTL_HPP
+
+#include  "ap_model.hpp"
+
+
+namespace ap {
+
+class  RtlPipeline {
+public:
+    explicit             RtlPipeline  (Init init = Init::Zero);
+
+    void                 Set          (const Settings &s)  { Trig_.Set(s); }
+    void                 Run          (Source &src, uint64_t conversions, Observer *obs = nullptr);
+
+    const uint16_t      *Ram          () const { return (Ram_); }
+    const TriggerRegs   &Regs         () const { return (Trig_.Regs()); }
+    uint64_t             Edge         () const { return (E_); }
+    uint64_t             TimingErrors () const { return (TimingErrors_); }  /* Edges that disagree with ap_model.hpp  */
+
+private:
+    enum  AdcState  { kStart, kT2, kReadZeros, kReadBits, kTQuiet };
+    enum  VgaState  { kRetrace, kBack, kActPixels, kFront };
+
+    struct  AdcRegs {                                           /* adc_driver.vhd                                       */
+        AdcState  State        = kStart;                        /* Initial value, not reset                             */
+        uint8_t   Counter      = 0u;
+        uint8_t   CounterSclk  = 0u;
+        uint8_t   CounterBits  = 0u;
+        bool      Sclk         = true;
+        bool      Ncs          = true;
+        uint16_t  Dataa        = 0u;
+        bool      SampleReadyy = false;
+        uint16_t  Data         = 0u;
+        bool      SampleReady  = false;
+    };
+
+    struct  VgaRegs {                                           /* vga_control.vhd, without the pixel outputs          */
+        VgaState  HState       = kRetrace;
+        uint16_t  HCounter     = 0u;
+        VgaState  VState       = kRetrace;
+        uint16_t  VCounter     = 0u;
+        bool      HhsyncPrev   = true;
+        bool      Vsync        = true;
+    };
+
+    void                 AdcEdge      ();
+    void                 VgaEdge      ();
+
+    TriggerController    Trig_;
+    AdcRegs              Adc_;
+    VgaRegs              Vga_;
+    uint16_t             Ram_[kRamWords] = {};
+    uint64_t             E_ = 0u;
+    uint64_t             TimingErrors_ = 0u;
+
+    bool                 Sdata1_    = false;                    /* Serial ADC of the testbench                          */
+    uint16_t             AdcCode_   = 0u;
+    uint32_t             AdcFalls_  = 0u;
+};
+
+}
+
+#endif
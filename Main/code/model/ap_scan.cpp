@@ -0,0 +1,426 @@
+/*
+*********************************************************************************************************
+*                                      OFFLINE TRIGGER ANALYSIS
+*
+* Description : See ap_scan.hpp.
+*********************************************************************************************************
+*/
+
+#include  <cmath>
+#include  <stdexcept>
+#include  <thread>
+
+#include  <fcntl.h>
+#include  <sys/mman.h>
+#include  <sys/stat.h>
+#include  <unistd.h>
+
+#if  defined(__x86_64__) || defined(__i386__)
+#include  <immintrin.h>
+#define  AP_SCAN_X86
+#endif
+
+#include  "ap_scan.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                       MIRRORED LEVELS
+*
+* Description : Levels of the rising-slope tests, for the codes after 'x & 0xFFF ^ Flip'.
+*********************************************************************************************************
+*/
+
+struct Levels {
+    int16_t   L;
+    int16_t   L12;
+    int16_t   A12;                                              /* May be negative: kScanDown12 then never occurs       */
+    uint16_t  Flip;
+};
+
+static  Levels  Mirror (const ScanLevels &lv)
+{
+    Levels  m;
+
+
+    m.L    = (int16_t)(lv.Rising ? (lv.Level & 0x1FFu) : (511u - (lv.Level & 0x1FFu)));
+    m.L12  = (int16_t)(lv.Rising ? (lv.Level12 & 0xFFFu) : (4095u - (lv.Level12 & 0xFFFu)));
+    m.A12  = (int16_t)(m.L12 - (int16_t)lv.Hyst);
+    m.Flip = lv.Rising ? 0u : 0xFFFu;
+    return (m);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            KERNELS
+*********************************************************************************************************
+*/
+
+static  inline  uint8_t  Kinds (int l, int p, const Levels &m)
+{
+    uint8_t  k = 0u;
+
+
+    if (((l >> 3) > m.L) && ((p >> 3) <= m.L)) {
+        k |= kScanCross;
+        if (((p >> 3) < m.L) && ((l >> 8) > (p >> 8))) {
+            k |= kScanFire;
+        }
+    }
+    if ((l >= m.L12) && (p < m.L12)) {
+        k |= kScanUp12;
+    }
+    if ((l < m.A12) && (p >= m.A12)) {
+        k |= kScanDown12;
+    }
+    return (k);
+}
+
+static  void  ScanScalar (const uint16_t *x, uint64_t begin, uint64_t end, const Levels &m, std::vector<ScanEvent> &out)
+{
+    int  p = (x[begin - 1u] & 0xFFF) ^ m.Flip;
+
+
+    for (uint64_t i = begin; i < end; i++) {
+        int      l = (x[i] & 0xFFF) ^ m.Flip;
+        uint8_t  k = Kinds(l, p, m);
+
+
+        if (k != 0u) {
+            out.push_back({ i, k });
+        }
+        p = l;
+    }
+}
+
+#ifdef  AP_SCAN_X86
+                                                                /* movemask_epi8 gives 2 bits per 16-bit lane           */
+static  inline  void  Emit (uint64_t i, uint32_t any, uint32_t fire, uint32_t cross, uint32_t up, uint32_t down,
+                            std::vector<ScanEvent> &out)
+{
+    while (any != 0u) {
+        uint32_t  b = (uint32_t)__builtin_ctz(any);
+        uint8_t   k = (uint8_t)((((fire  >> b) & 1u) * kScanFire)  | (((cross >> b) & 1u) * kScanCross) |
+                                (((up    >> b) & 1u) * kScanUp12)  | (((down  >> b) & 1u) * kScanDown12));
+
+
+        out.push_back({ i + (b >> 1), k });
+        any &= ~(3u << b);
+    }
+}
+
+static  void  ScanSse2 (const uint16_t *x, uint64_t begin, uint64_t end, const Levels &m, std::vector<ScanEvent> &out)
+{
+    const __m128i  mask = _mm_set1_epi16(0x0FFF);
+    const __m128i  flip = _mm_set1_epi16((short)m.Flip);
+    const __m128i  vl   = _mm_set1_epi16(m.L);
+    const __m128i  vl12 = _mm_set1_epi16(m.L12);
+    const __m128i  va12 = _mm_set1_epi16(m.A12);
+    uint64_t       i    = begin;
+
+
+    for (; i + 8u <= end; i += 8u) {
+        __m128i  l     = _mm_xor_si128(_mm_and_si128(_mm_loadu_si128((const __m128i *)(x + i)),      mask), flip);
+        __m128i  p     = _mm_xor_si128(_mm_and_si128(_mm_loadu_si128((const __m128i *)(x + i - 1u)), mask), flip);
+        __m128i  l9    = _mm_srli_epi16(l, 3);
+        __m128i  p9    = _mm_srli_epi16(p, 3);
+        __m128i  gt    = _mm_cmpgt_epi16(l9, vl);
+        __m128i  cross = _mm_andnot_si128(_mm_cmpgt_epi16(p9, vl), gt);
+        __m128i  fire  = _mm_and_si128(_mm_and_si128(gt, _mm_cmpgt_epi16(vl, p9)),
+                                       _mm_cmpgt_epi16(_mm_srli_epi16(l, 8), _mm_srli_epi16(p, 8)));
+        __m128i  up    = _mm_andnot_si128(_mm_cmpgt_epi16(vl12, l), _mm_cmpgt_epi16(vl12, p));
+        __m128i  down  = _mm_andnot_si128(_mm_cmpgt_epi16(va12, p), _mm_cmpgt_epi16(va12, l));
+        uint32_t any   = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(cross, up), down));
+
+
+        if (any != 0u) {
+            Emit(i, any, (uint32_t)_mm_movemask_epi8(fire), (uint32_t)_mm_movemask_epi8(cross),
+                 (uint32_t)_mm_movemask_epi8(up), (uint32_t)_mm_movemask_epi8(down), out);
+        }
+    }
+    if (i < end) {
+        ScanScalar(x, i, end, m, out);
+    }
+}
+
+__attribute__((target("avx2")))
+static  void  ScanAvx2 (const uint16_t *x, uint64_t begin, uint64_t end, const Levels &m, std::vector<ScanEvent> &out)
+{
+    const __m256i  mask = _mm256_set1_epi16(0x0FFF);
+    const __m256i  flip = _mm256_set1_epi16((short)m.Flip);
+    const __m256i  vl   = _mm256_set1_epi16(m.L);
+    const __m256i  vl12 = _mm256_set1_epi16(m.L12);
+    const __m256i  va12 = _mm256_set1_epi16(m.A12);
+    uint64_t       i    = begin;
+
+
+    for (; i + 16u <= end; i += 16u) {
+        __m256i  l     = _mm256_xor_si256(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(x + i)),      mask), flip);
+        __m256i  p     = _mm256_xor_si256(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(x + i - 1u)), mask), flip);
+        __m256i  l9    = _mm256_srli_epi16(l, 3);
+        __m256i  p9    = _mm256_srli_epi16(p, 3);
+        __m256i  gt    = _mm256_cmpgt_epi16(l9, vl);
+        __m256i  cross = _mm256_andnot_si256(_mm256_cmpgt_epi16(p9, vl), gt);
+        __m256i  up    = _mm256_andnot_si256(_mm256_cmpgt_epi16(vl12, l), _mm256_cmpgt_epi16(vl12, p));
+        __m256i  down  = _mm256_andnot_si256(_mm256_cmpgt_epi16(va12, p), _mm256_cmpgt_epi16(va12, l));
+        uint32_t any   = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(cross, up), down));
+
+
+        if (any != 0u) {                                        /* Rare: the slope guard is only computed here          */
+            __m256i  fire = _mm256_and_si256(_mm256_and_si256(gt, _mm256_cmpgt_epi16(vl, p9)),
+                                             _mm256_cmpgt_epi16(_mm256_srli_epi16(l, 8), _mm256_srli_epi16(p, 8)));
+
+
+            Emit(i, any, (uint32_t)_mm256_movemask_epi8(fire), (uint32_t)_mm256_movemask_epi8(cross),
+                 (uint32_t)_mm256_movemask_epi8(up), (uint32_t)_mm256_movemask_epi8(down), out);
+        }
+    }
+    if (i < end) {
+        ScanSse2(x, i, end, m, out);
+    }
+}
+#endif
+
+ScanIsa  ScanBest ()
+{
+#ifdef  AP_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return (ScanIsa::Avx2);
+    }
+    return (ScanIsa::Sse2);
+#else
+    return (ScanIsa::Scalar);
+#endif
+}
+
+const char  *ScanIsaName (ScanIsa isa)
+{
+    switch (isa) {
+        case ScanIsa::Scalar: return ("scalar");
+        case ScanIsa::Sse2:   return ("sse2");
+        case ScanIsa::Avx2:   return ("avx2");
+        default:              return ("auto");
+    }
+}
+
+void  ScanBlock (ScanIsa isa, const uint16_t *x, uint64_t begin, uint64_t end, const ScanLevels &lv, std::vector<ScanEvent> &out)
+{
+    Levels  m = Mirror(lv);
+
+
+    if (begin < 1u) {
+        begin = 1u;
+    }
+    if (begin >= end) {
+        return;
+    }
+    if (isa == ScanIsa::Auto) {
+        isa = ScanBest();
+    }
+    switch (isa) {
+#ifdef  AP_SCAN_X86
+        case ScanIsa::Avx2: ScanAvx2(x, begin, end, m, out);   break;
+        case ScanIsa::Sse2: ScanSse2(x, begin, end, m, out);   break;
+#endif
+        default:            ScanScalar(x, begin, end, m, out); break;
+    }
+}
+
+void  ScanRange (ScanIsa isa, const uint16_t *x, uint64_t n, const ScanLevels &lv, unsigned threads, std::vector<ScanEvent> &out)
+{
+    std::vector<std::vector<ScanEvent>>  part;
+    std::vector<std::thread>             th;
+    uint64_t                             chunk;
+
+
+    if ((threads <= 1u) || (n < 1024u * 1024u)) {
+        ScanBlock(isa, x, 1u, n, lv, out);
+        return;
+    }
+    part.resize(threads);
+    chunk = ((n + threads - 1u) / threads + 15u) & ~(uint64_t)15u;
+    for (unsigned t = 0u; t < threads; t++) {
+        uint64_t  b = (uint64_t)t * chunk;
+        uint64_t  e = (b + chunk < n) ? (b + chunk) : n;
+
+
+        th.emplace_back([&, t, b, e] { ScanBlock(isa, x, b, e, lv, part[t]); });
+    }
+    for (unsigned t = 0u; t < threads; t++) {
+        th[t].join();
+        out.insert(out.end(), part[t].begin(), part[t].end());
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                             RULES
+*********************************************************************************************************
+*/
+
+const char  *ScanRuleName (ScanRule rule)
+{
+    switch (rule) {
+        case ScanRule::Fpga:    return ("fpga");
+        case ScanRule::NoGuard: return ("noguard");
+        case ScanRule::Fine:    return ("fine");
+        default:                return ("hyst");
+    }
+}
+
+void  ScanTriggers (ScanRule                       rule,
+                    const uint16_t                *x,
+                    uint64_t                       n,
+                    const ScanLevels              &lv,
+                    uint8_t                        hscale,
+                    const std::vector<ScanEvent>  &ev,
+                    std::vector<ScanTrigger>      &out)
+{
+    Levels    m     = Mirror(lv);
+    uint64_t  step  = (uint64_t)hscale + 1u;
+    size_t    c     = 0u;                                       /* Next kScanCross candidate for the period             */
+    bool      armed = (n > 0u) && ((int)((x[0] & 0xFFF) ^ m.Flip) < m.A12);
+
+
+    for (const ScanEvent &e : ev) {
+        bool    hit = false;
+        double  t   = (double)e.Index;
+
+
+        switch (rule) {
+            case ScanRule::Fpga:    hit = (e.Kinds & kScanFire)  != 0u;  break;
+            case ScanRule::NoGuard: hit = (e.Kinds & kScanCross) != 0u;  break;
+            case ScanRule::Fine:    hit = (e.Kinds & kScanUp12)  != 0u;  break;
+            case ScanRule::Hyst:
+                 if ((e.Kinds & kScanDown12) != 0u) {
+                     armed = true;
+                 }
+                 if (armed && ((e.Kinds & kScanUp12) != 0u)) {
+                     hit   = true;
+                     armed = false;
+                 }
+                 break;
+        }
+        if (!hit) {
+            continue;
+        }
+
+        if ((rule == ScanRule::Fine) || (rule == ScanRule::Hyst)) {
+            int  l = (x[e.Index]      & 0xFFF) ^ m.Flip;
+            int  p = (x[e.Index - 1u] & 0xFFF) ^ m.Flip;
+
+
+            t = (double)(e.Index - 1u) + (double)(m.L12 - p) / (double)(l - p);
+        }
+
+                                                                /* counted_acqs reaches 1 after HScale + 1 samples      */
+        while ((c < ev.size()) && ((ev[c].Index < e.Index + step) || !(ev[c].Kinds & kScanCross))) {
+            c++;
+        }
+        int32_t  period = -1;
+        if (c < ev.size()) {
+            uint64_t  k = (ev[c].Index - e.Index) / step;
+
+
+            if (k <= 1279u) {
+                period = (int32_t)k;
+            }
+        }
+        out.push_back({ e.Index, t, period });
+    }
+}
+
+ScanStats  ScanSummary (const std::vector<ScanTrigger> &trig)
+{
+    ScanStats  s;
+    double     sum  = 0.0;
+    double     sum2 = 0.0;
+    double     hw   = 0.0;
+
+
+    s.Triggers = trig.size();
+    for (size_t i = 1u; i < trig.size(); i++) {
+        double  d = trig[i].Time - trig[i - 1u].Time;
+
+
+        if ((s.Intervals == 0u) || (d < s.IntervalMin)) {
+            s.IntervalMin = d;
+        }
+        if ((s.Intervals == 0u) || (d > s.IntervalMax)) {
+            s.IntervalMax = d;
+        }
+        s.Intervals++;
+        sum  += d;
+        sum2 += d * d;
+    }
+    if (s.Intervals != 0u) {
+        s.IntervalAvg = sum / (double)s.Intervals;
+        s.IntervalStd = std::sqrt(std::fmax(0.0, sum2 / (double)s.Intervals - s.IntervalAvg * s.IntervalAvg));
+    }
+
+    for (const ScanTrigger &t : trig) {
+        if (t.HwPeriod < 0) {
+            continue;
+        }
+        if ((s.HwPeriods == 0u) || (t.HwPeriod < s.HwPeriodMin)) {
+            s.HwPeriodMin = t.HwPeriod;
+        }
+        if ((s.HwPeriods == 0u) || (t.HwPeriod > s.HwPeriodMax)) {
+            s.HwPeriodMax = t.HwPeriod;
+        }
+        s.HwPeriods++;
+        hw += t.HwPeriod;
+    }
+    if (s.HwPeriods != 0u) {
+        s.HwPeriodAvg = hw / (double)s.HwPeriods;
+    }
+    return (s);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          MAPPED CAPTURE
+*
+* Note(s)     : The codes are used in place, which assumes a little-endian host.
+*********************************************************************************************************
+*/
+
+MappedCodes::MappedCodes (const std::string &path)
+{
+    struct stat  st;
+    void        *p;
+    int          fd = open(path.c_str(), O_RDONLY);
+
+
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_size < 4)) {
+        close(fd);
+        throw std::runtime_error(path + ": fewer than 2 samples");
+    }
+    Len_ = (size_t)st.st_size;
+    p    = mmap(nullptr, Len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path);
+    }
+    madvise(p, Len_, MADV_SEQUENTIAL);
+    Data_ = (const uint16_t *)p;
+    N_    = Len_ / 2u;
+}
+
+MappedCodes::~MappedCodes ()
+{
+    if (Data_ != nullptr) {
+        munmap((void *)Data_, Len_);
+    }
+}
+
+}
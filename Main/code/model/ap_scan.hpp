@@ -0,0 +1,175 @@
+/*
+*********************************************************************************************************
+*                                      OFFLINE TRIGGER ANALYSIS
+*
+* Description : Finds, in a captured stream of 12-bit codes, every sample pair (x[i-1], x[i]) that meets
+*               one of the trigger_controller.vhd conditions below, then derives trigger points, periods
+*               and jitter from them. 'L' is trigger_value (9 bits) and 'L12' a level on the full 12 bits.
+*
+*                   kScanFire    x[i](11..3) > L  and  x[i-1](11..3) < L  and  x[i](11..8) > x[i-1](11..8)
+*                                                               the trigger condition of the FPGA
+*                   kScanCross   x[i](11..3) > L  and  x[i-1](11..3) <= L
+*                                                               the second-crossing (period) condition
+*                   kScanUp12    x[i] >= L12  and  x[i-1] < L12
+*                   kScanDown12  x[i] <  A12  and  x[i-1] >= A12,  A12 = L12 - hysteresis
+*
+*               The rules are written for the rising slope; a falling slope is the same test on the
+*               mirrored codes 4095 - x, with L mirrored to 511 - L and L12 to 4095 - L12.
+*
+*               ScanBlock() is the vectorized part: it only emits the sparse events, so a capture is
+*               read once at close to memory bandwidth. AVX2 and SSE2 kernels are selected at run time;
+*               all three produce the same events.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_SCAN_HPP
+#define  AP_SCAN_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <string>
+#include  <vector>
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                            EVENTS
+*********************************************************************************************************
+*/
+
+enum : uint8_t {
+    kScanFire   = 0x01u,
+    kScanCross  = 0x02u,
+    kScanUp12   = 0x04u,
+    kScanDown12 = 0x08u
+};
+
+struct ScanEvent {
+    uint64_t  Index;                                            /* i, the pair is (x[i-1], x[i])                        */
+    uint8_t   Kinds;                                            /* kScan... bits                                        */
+};
+
+struct ScanLevels {
+    uint16_t  Level   = 256u;                                   /* trigger_value                                        */
+    uint16_t  Level12 = 256u * 8u;
+    uint16_t  Hyst    = 16u;                                    /* A12 = Level12 - Hyst                                 */
+    bool      Rising  = true;
+};
+
+enum class ScanIsa {
+    Auto,
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+
+/*
+*********************************************************************************************************
+*                                            KERNELS
+*
+* Description : ScanBlock() appends the events of the pairs i = begin .. end - 1, in order, to 'out';
+*               'begin' must be >= 1. Codes are masked to 12 bits first, as the ADC path does.
+*               ScanRange() does the whole capture of 'n' codes, split over 'threads' threads.
+*********************************************************************************************************
+*/
+
+ScanIsa              ScanBest      ();
+const char          *ScanIsaName   (ScanIsa isa);
+void                 ScanBlock     (ScanIsa                  isa,
+                                    const uint16_t          *x,
+                                    uint64_t                 begin,
+                                    uint64_t                 end,
+                                    const ScanLevels        &lv,
+                                    std::vector<ScanEvent>  &out);
+void                 ScanRange     (ScanIsa                  isa,
+                                    const uint16_t          *x,
+                                    uint64_t                 n,
+                                    const ScanLevels        &lv,
+                                    unsigned                 threads,
+                                    std::vector<ScanEvent>  &out);
+
+
+/*
+*********************************************************************************************************
+*                                             RULES
+*
+* Description : A trigger rule turns the events into trigger points:
+*
+*                   Fpga      kScanFire, exactly what trigger_controller fires on
+*                   NoGuard   kScanCross, the same level test without the bits 11..8 slope guard
+*                   Fine      kScanUp12, on all 12 bits, timed by linear interpolation
+*                   Hyst      Fine, re-armed only after kScanDown12 (Schmitt trigger)
+*
+*               Each trigger point carries the period the FPGA would measure from it, i.e. the value of
+*               counted_acqs at the next kScanCross: one count per HScale + 1 samples, between 1 and 1279,
+*               -1 if the sweep ends first.
+*********************************************************************************************************
+*/
+
+enum class ScanRule {
+    Fpga,
+    NoGuard,
+    Fine,
+    Hyst
+};
+
+struct ScanTrigger {
+    uint64_t  Index;
+    double    Time;                                             /* In samples; fractional for Fine and Hyst             */
+    int32_t   HwPeriod;
+};
+
+struct ScanStats {
+    uint64_t  Triggers    = 0u;
+    uint64_t  Intervals   = 0u;                                 /* Trigger to next trigger, in samples                  */
+    double    IntervalMin = 0.0;
+    double    IntervalMax = 0.0;
+    double    IntervalAvg = 0.0;
+    double    IntervalStd = 0.0;                                /* RMS jitter of the trigger period                     */
+    uint64_t  HwPeriods   = 0u;                                 /* Triggers with a measured 'period'                   */
+    int32_t   HwPeriodMin = 0;
+    int32_t   HwPeriodMax = 0;
+    double    HwPeriodAvg = 0.0;
+};
+
+const char          *ScanRuleName  (ScanRule rule);
+void                 ScanTriggers  (ScanRule                       rule,
+                                    const uint16_t                *x,
+                                    uint64_t                       n,
+                                    const ScanLevels              &lv,
+                                    uint8_t                        hscale,
+                                    const std::vector<ScanEvent>  &ev,
+                                    std::vector<ScanTrigger>      &out);
+ScanStats            ScanSummary   (const std::vector<ScanTrigger> &trig);
+
+
+/*
+*********************************************************************************************************
+*                                          MAPPED CAPTURE
+*
+* Description : Read-only mapping of a file of little-endian 16-bit codes.
+*********************************************************************************************************
+*/
+
+class  MappedCodes {
+public:
+    explicit             MappedCodes  (const std::string &path);
+                        ~MappedCodes  ();
+                         MappedCodes  (const MappedCodes &) = delete;
+    MappedCodes         &operator=    (const MappedCodes &) = delete;
+
+    const uint16_t      *Data         () const { return (Data_); }
+    uint64_t             Size         () const { return (N_); }
+
+private:
+    const uint16_t      *Data_ = nullptr;
+    uint64_t             N_    = 0u;
+    size_t               Len_  = 0u;
+};
+
+}
+
+#endif
@@ -0,0 +1,609 @@
+/*
+*********************************************************************************************************
+*                                      vga_control FRAME RENDERER
+*
+* Description : See ap_vga.hpp.
+*
+* Note(s)     : 1) The PNG is 8-bit indexed, compressed with fixed-Huffman deflate blocks built from the
+*                  spans: a run of one color is a literal followed by copies at distance 1, a line equal
+*                  to the one above is a copy at distance 1281 (the filter byte and the pixels). No zlib.
+*********************************************************************************************************
+*/
+
+#include  <cstdio>
+#include  <cstring>
+#include  <stdexcept>
+
+#include  "ap_capture.hpp"
+#include  "ap_vga.hpp"
+
+
+namespace ap {
+
+const uint8_t  kVgaRgb[kVgaColors][3] = {
+    {  0u,  0u,  0u },                                          /* kVgaBlack                                            */
+    {  0u,  0u, 15u },                                          /* kVgaBlue                                             */
+    { 15u, 15u,  0u },                                          /* kVgaYellow                                           */
+    { 15u,  0u,  0u },                                          /* kVgaRed                                              */
+    {  0u, 15u,  0u }                                           /* kVgaGreen                                            */
+};
+
+
+/*
+*********************************************************************************************************
+*                                          PIXEL RULES
+*
+* Description : VgaOffset() is the 'offset' trigger_controller drives for a vscale. VgaPixel() is the
+*               'plot' part of the output_process of vga_control.vhd, condition by condition.
+*********************************************************************************************************
+*/
+
+uint8_t  VgaOffset (uint8_t vscale)
+{
+    static const uint8_t  tbl[4] = { 0x00u, 0x80u, 0xC0u, 0xE0u };
+
+
+    return (tbl[vscale & 3u]);
+}
+
+VgaColor  VgaPixel (const VgaInputs &in, uint32_t h, uint32_t v)
+{
+    uint32_t  data = in.Ram[h] & 0xFFFu;
+    uint32_t  low  = ((in.RamMin != nullptr) ? in.RamMin[h] : in.Ram[h]) & 0xFFFu;
+
+
+    if ((h < 30u) && ((v & 0x1FFu) == (in.TriggerLevel & 0x1FFu)) && ((v & 0x200u) == 0u) && !in.Alarm) {
+        return (kVgaBlue);
+    }
+    if ((((low  >> 3) + in.Offset) <= (v & 0x3FFu)) &&             /* 10 bits: a sum above 511 is off the half, no wrap    */
+        (((data >> 3) + in.Offset) >= (v & 0x3FFu)) && ((v & 0x200u) == 0u) && !in.Alarm) {
+        return (kVgaYellow);
+    }
+    if ((v > 511u + 10u) && (v < 511u + 20u) && (h < (in.Period & 0x7FFu)) && !in.Alarm) {
+        return (kVgaRed);
+    }
+    if ((v > 511u + 30u) && (v < 511u + 61u + 5u) && (h == (in.TTemperature & 0x7FFu))) {
+        return (kVgaBlue);
+    }
+    if ((v > 511u + 30u) && (v < 511u + 61u) && (h < (in.Temperature & 0x7FFu))) {
+        return (in.Alarm ? kVgaRed : kVgaGreen);
+    }
+    return (kVgaBlack);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           RENDERING
+*********************************************************************************************************
+*/
+
+VgaFrame::VgaFrame ()
+{
+    Spans_.reserve(kVgaHeight * 2u + kVgaWidth * 2u);
+    Start_.resize(kVgaHeight + 1u);
+    Cols_.resize(kVgaWidth);
+    RowAt_.resize(kVgaHalf + 2u);
+    Last_.resize(kVgaWidth);
+    LastAt_.resize(kVgaHalf + 2u);
+}
+
+void  VgaFrame::Push (uint32_t x0, uint32_t x1, uint8_t color)  /* To the open line, merged with the last span   */
+{
+    if (x0 >= x1) {
+        return;
+    }
+    if ((Spans_.size() > Open_) && (Spans_.back().Color == color) && (Spans_.back().X1 == x0)) {
+        Spans_.back().X1 = (uint16_t)x1;
+        return;
+    }
+    Spans_.push_back({ (uint16_t)x0, (uint16_t)x1, color });
+}
+
+void  VgaFrame::Bars (uint32_t v, const VgaInputs &in)          /* Lines of the lower half                              */
+{
+    uint32_t  period = ((in.Period      & 0x7FFu) < kVgaWidth) ? (in.Period      & 0x7FFu) : kVgaWidth;
+    uint32_t  temp   = ((in.Temperature & 0x7FFu) < kVgaWidth) ? (in.Temperature & 0x7FFu) : kVgaWidth;
+    uint32_t  mark   = in.TTemperature & 0x7FFu;
+    uint8_t   bar    = in.Alarm ? kVgaRed : kVgaGreen;
+
+
+    if ((v > 511u + 10u) && (v < 511u + 20u) && !in.Alarm) {
+        Push(0u, period, kVgaRed);
+        Push(period, kVgaWidth, kVgaBlack);
+    } else if ((v > 511u + 30u) && (v < 511u + 61u + 5u)) {
+        temp = (v < 511u + 61u) ? temp : 0u;
+        if (mark < kVgaWidth) {                                 /* The marker wins over the bar                         */
+            Push(0u, (temp < mark) ? temp : mark, bar);
+            Push((temp < mark) ? temp : mark, mark, kVgaBlack);
+            Push(mark, mark + 1u, kVgaBlue);
+            Push(mark + 1u, temp, bar);
+            Push((temp > mark + 1u) ? temp : mark + 1u, kVgaWidth, kVgaBlack);
+        } else {
+            Push(0u, temp, bar);
+            Push(temp, kVgaWidth, kVgaBlack);
+        }
+    } else {
+        Push(0u, kVgaWidth, kVgaBlack);
+    }
+}
+
+namespace {
+
+uint16_t  WaveRow (uint16_t code, uint8_t offset)               /* Row of a sample, kVgaHalf when off the upper half    */
+{
+    uint32_t  row = ((code & 0xFFFu) >> 3) + offset;
+
+
+    return ((uint16_t)((row < kVgaHalf) ? row : kVgaHalf));
+}
+
+void  SortRows (const uint16_t *row, std::vector<uint16_t> &cols, std::vector<uint16_t> &at)
+{                                                               /* Counting sort of the columns by row, ascending x     */
+    uint16_t  pos[kVgaHalf + 1u];                               /* Row kVgaHalf is never drawn                          */
+
+
+    std::memset(pos, 0, sizeof(pos));
+    for (uint32_t x = 0u; x < kVgaWidth; x++) {
+        pos[row[x]]++;
+    }
+    at[0] = 0u;
+    for (uint32_t r = 0u; r <= kVgaHalf; r++) {
+        at[r + 1u] = (uint16_t)(at[r] + pos[r]);
+        pos[r]     = at[r];
+    }
+    for (uint32_t x = 0u; x < kVgaWidth; x++) {
+        cols[pos[row[x]]++] = (uint16_t)x;
+    }
+}
+
+uint32_t  NextBit (const uint64_t *set, uint32_t x, bool value)  /* First x' >= x whose bit is 'value', or kVgaWidth    */
+{
+    while (x < kVgaWidth) {
+        uint64_t  w = set[x / 64u] ^ (value ? 0u : ~(uint64_t)0u);
+
+
+        w >>= x % 64u;
+        if (w != 0u) {
+            x += (uint32_t)__builtin_ctzll(w);
+            return ((x < kVgaWidth) ? x : kVgaWidth);
+        }
+        x = (x / 64u + 1u) * 64u;
+    }
+    return (kVgaWidth);
+}
+
+}
+
+void  VgaFrame::Ranges (const VgaInputs &in)                    /* Upper half with RamMin: a row set swept down         */
+{
+    uint16_t  lo[kVgaWidth];
+    uint16_t  hi[kVgaWidth];
+    uint64_t  set[kVgaWidth / 64u];
+    uint32_t  level = in.TriggerLevel & 0x1FFu;
+
+
+    for (uint32_t x = 0u; x < kVgaWidth; x++) {
+        lo[x] = WaveRow(in.RamMin[x], in.Offset);
+        hi[x] = WaveRow(in.Ram[x],    in.Offset);
+    }
+    SortRows(lo, Cols_, RowAt_);
+    SortRows(hi, Last_, LastAt_);
+    std::memset(set, 0, sizeof(set));
+
+    for (uint32_t v = 0u; v < kVgaHalf; v++) {
+        uint32_t  x = 0u;
+
+
+        Open_     = Spans_.size();
+        Start_[v] = (uint32_t)Open_;
+        for (uint32_t k = RowAt_[v]; k < RowAt_[v + 1u]; k++) {
+            uint32_t  c = Cols_[k];
+
+
+            if (lo[c] <= hi[c]) {                               /* Else data_min above data_in: never drawn             */
+                set[c / 64u] |= (uint64_t)1u << (c % 64u);
+            }
+        }
+        if (v == level) {
+            Push(0u, kVgaTrigWidth, kVgaBlue);
+            x = kVgaTrigWidth;
+        }
+        while (x < kVgaWidth) {
+            uint32_t  c = NextBit(set, x, true);
+            uint32_t  e = NextBit(set, c, false);
+
+
+            Push(x, c, kVgaBlack);
+            Push(c, e, kVgaYellow);
+            x = e;
+        }
+        for (uint32_t k = LastAt_[v]; k < LastAt_[v + 1u]; k++) {
+            uint32_t  c = Last_[k];
+
+
+            set[c / 64u] &= ~((uint64_t)1u << (c % 64u));
+        }
+    }
+}
+
+void  VgaFrame::Render (const VgaInputs &in)
+{
+    uint32_t  level = in.TriggerLevel & 0x1FFu;
+
+
+    Spans_.clear();
+    if (!in.Alarm && (in.RamMin != nullptr)) {
+        Ranges(in);
+    } else if (!in.Alarm) {                                     /* The columns sorted by waveform row                   */
+        uint16_t  row[kVgaWidth];
+
+
+        for (uint32_t x = 0u; x < kVgaWidth; x++) {
+            row[x] = WaveRow(in.Ram[x], in.Offset);
+        }
+        SortRows(row, Cols_, RowAt_);
+    }
+
+    for (uint32_t v = ((in.RamMin != nullptr) && !in.Alarm) ? kVgaHalf : 0u; v < kVgaHeight; v++) {
+        Open_     = Spans_.size();
+        Start_[v] = (uint32_t)Open_;
+        if (v >= kVgaHalf) {
+            Bars(v, in);
+        } else if (in.Alarm) {
+            Push(0u, kVgaWidth, kVgaBlack);
+        } else {
+            uint32_t  x = 0u;
+
+
+            if (v == level) {
+                Push(0u, kVgaTrigWidth, kVgaBlue);
+                x = kVgaTrigWidth;
+            }
+            for (uint32_t k = RowAt_[v]; k < RowAt_[v + 1u]; k++) {
+                uint32_t  c = Cols_[k];
+
+
+                if (c >= x) {                                   /* Not under the trigger line                           */
+                    Push(x, c, kVgaBlack);
+                    Push(c, c + 1u, kVgaYellow);
+                    x = c + 1u;
+                }
+            }
+            Push(x, kVgaWidth, kVgaBlack);
+        }
+    }
+    Start_[kVgaHeight] = (uint32_t)Spans_.size();
+}
+
+const VgaSpan  *VgaFrame::Line (uint32_t v, uint32_t *p_n) const
+{
+    *p_n = Start_[v + 1u] - Start_[v];
+    return (&Spans_[Start_[v]]);
+}
+
+void  VgaFrame::Expand (uint8_t *idx) const
+{
+    for (uint32_t v = 0u; v < kVgaHeight; v++) {
+        for (uint32_t k = Start_[v]; k < Start_[v + 1u]; k++) {
+            std::memset(&idx[v * kVgaWidth + Spans_[k].X0], Spans_[k].Color, Spans_[k].X1 - Spans_[k].X0);
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                              PPM
+*********************************************************************************************************
+*/
+
+void  VgaFrame::EncodePpm (std::vector<uint8_t> &out) const
+{
+    char      hdr[32];
+    int       len = std::snprintf(hdr, sizeof(hdr), "P6\n%u %u\n255\n", (unsigned)kVgaWidth, (unsigned)kVgaHeight);
+    uint8_t  *p;
+
+
+    out.resize((size_t)len + (size_t)kVgaWidth * kVgaHeight * 3u);
+    std::memcpy(out.data(), hdr, (size_t)len);
+    p = out.data() + len;
+    for (const VgaSpan &s : Spans_) {
+        uint8_t  r = (uint8_t)(kVgaRgb[s.Color][0] * 17u);
+        uint8_t  g = (uint8_t)(kVgaRgb[s.Color][1] * 17u);
+        uint8_t  b = (uint8_t)(kVgaRgb[s.Color][2] * 17u);
+
+
+        for (uint32_t x = s.X0; x < s.X1; x++) {
+            p[0] = r;
+            p[1] = g;
+            p[2] = b;
+            p   += 3;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                              PNG
+*********************************************************************************************************
+*/
+
+namespace {
+
+class  Deflate {                                                /* One final fixed-Huffman block (RFC 1951, 3.2.6)      */
+public:
+    explicit  Deflate (std::vector<uint8_t> &out) : Out_(out)
+    {
+        Bits(1u, 1u);                                           /* BFINAL                                               */
+        Bits(1u, 2u);                                           /* BTYPE = fixed                                        */
+    }
+
+    void  Run (uint8_t value, uint32_t n)                       /* n bytes of 'value'                                   */
+    {
+        if (n == 0u) {
+            return;
+        }
+        if ((RunN_ > 0u) && (RunV_ == value)) {
+            RunN_ += n;
+        } else {
+            Flush();
+            RunV_ = value;
+            RunN_ = n;
+        }
+        Adler(value, n);
+    }
+
+    void  Copy (uint32_t n, uint32_t dist, const VgaSpan *s, uint32_t spans)   /* n bytes from 'dist' back    */
+    {
+        Flush();
+        Chunks(n, dist);
+        Adler(0u, 1u);                                          /* The bytes copied: filter byte, then the line         */
+        for (uint32_t k = 0u; k < spans; k++) {
+            Adler(s[k].Color, (uint32_t)(s[k].X1 - s[k].X0));
+        }
+    }
+
+    uint32_t  Finish ()                                         /* Returns the Adler-32 of the data                     */
+    {
+        Flush();
+        Code(256u);
+        if (Cnt_ > 0u) {
+            Out_.push_back((uint8_t)Acc_);
+        }
+        return ((B_ << 16) | A_);
+    }
+
+private:
+    void  Bits (uint32_t v, uint32_t n)
+    {
+        Acc_ |= (uint64_t)v << Cnt_;
+        Cnt_ += n;
+        while (Cnt_ >= 8u) {
+            Out_.push_back((uint8_t)Acc_);
+            Acc_ >>= 8;
+            Cnt_  -= 8u;
+        }
+    }
+
+    void  Huff (uint32_t code, uint32_t n)                      /* Huffman codes go out MSB first                       */
+    {
+        uint32_t  r = 0u;
+
+
+        for (uint32_t i = 0u; i < n; i++) {
+            r = (r << 1) | ((code >> i) & 1u);
+        }
+        Bits(r, n);
+    }
+
+    void  Code (uint32_t sym)                                   /* Literal/length alphabet, fixed code                  */
+    {
+        if      (sym < 144u) { Huff(0x30u  + sym,          8u); }
+        else if (sym < 256u) { Huff(0x190u + sym - 144u,   9u); }
+        else if (sym < 280u) { Huff(sym - 256u,            7u); }
+        else                 { Huff(0xC0u  + sym - 280u,   8u); }
+    }
+
+    void  Match (uint32_t len, uint32_t dist)                   /* 3 <= len <= 258                                      */
+    {
+        static const uint16_t  len_base[29]  = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+                                                 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t   len_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4,
+                                                 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t  dst_base[30]  = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                                 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385,
+                                                 24577 };
+        uint32_t               l = 28u;
+        uint32_t               d = 29u;
+
+
+        while (len_base[l] > len) {
+            l--;
+        }
+        while (dst_base[d] > dist) {
+            d--;
+        }
+        Code(257u + l);
+        Bits(len - len_base[l], len_extra[l]);
+        Huff(d, 5u);
+        Bits(dist - dst_base[d], (d < 4u) ? 0u : (d / 2u - 1u));
+    }
+
+    void  Chunks (uint32_t n, uint32_t dist)                    /* Copy of any length >= 3, as matches of 3..258        */
+    {
+        while (n > 0u) {
+            uint32_t  len = (n > 258u) ? 258u : n;
+
+
+            if ((n - len > 0u) && (n - len < 3u)) {
+                len = n - 3u;
+            }
+            Match(len, dist);
+            n -= len;
+        }
+    }
+
+    void  Flush ()                                              /* Pending run: a literal, then copies of it            */
+    {
+        uint32_t  n = RunN_;
+
+
+        if (n == 0u) {
+            return;
+        }
+        Code(RunV_);
+        n--;
+        if (n >= 3u) {
+            Chunks(n, 1u);
+        } else {
+            while (n-- > 0u) {
+                Code(RunV_);
+            }
+        }
+        RunN_ = 0u;
+    }
+
+    void  Adler (uint32_t v, uint32_t n)                        /* n bytes of 'v' at once                               */
+    {
+        B_ = (uint32_t)(((uint64_t)B_ + (uint64_t)n * A_ + (uint64_t)v * n * (n + 1u) / 2u) % 65521u);
+        A_ = (uint32_t)(((uint64_t)A_ + (uint64_t)n * v) % 65521u);
+    }
+
+    std::vector<uint8_t>  &Out_;
+    uint64_t               Acc_  = 0u;
+    uint32_t               Cnt_  = 0u;
+    uint8_t                RunV_ = 0u;
+    uint32_t               RunN_ = 0u;
+    uint32_t               A_    = 1u;
+    uint32_t               B_    = 0u;
+};
+
+void  Be32 (std::vector<uint8_t> &out, uint32_t v)
+{
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >>  8));
+    out.push_back((uint8_t)v);
+}
+
+size_t  ChunkOpen (std::vector<uint8_t> &out, const char *type)
+{
+    size_t  at = out.size();
+
+
+    Be32(out, 0u);
+    out.insert(out.end(), type, type + 4);
+    return (at);
+}
+
+void  ChunkClose (std::vector<uint8_t> &out, size_t at)
+{
+    uint32_t  len = (uint32_t)(out.size() - at - 8u);
+
+
+    out[at]      = (uint8_t)(len >> 24);
+    out[at + 1u] = (uint8_t)(len >> 16);
+    out[at + 2u] = (uint8_t)(len >>  8);
+    out[at + 3u] = (uint8_t)len;
+    Be32(out, Crc32(0xFFFFFFFFu, &out[at + 4u], len + 4u) ^ 0xFFFFFFFFu);
+}
+
+}
+
+void  VgaFrame::EncodePng (std::vector<uint8_t> &out) const
+{
+    static const uint8_t  sig[8] = { 0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n' };
+    size_t                at;
+
+
+    out.assign(sig, sig + 8);
+
+    at = ChunkOpen(out, "IHDR");
+    Be32(out, kVgaWidth);
+    Be32(out, kVgaHeight);
+    out.push_back(8u);                                          /* Bit depth                                            */
+    out.push_back(3u);                                          /* Indexed color                                        */
+    out.push_back(0u);
+    out.push_back(0u);
+    out.push_back(0u);
+    ChunkClose(out, at);
+
+    at = ChunkOpen(out, "PLTE");
+    for (uint32_t c = 0u; c < kVgaColors; c++) {
+        for (uint32_t k = 0u; k < 3u; k++) {
+            out.push_back((uint8_t)(kVgaRgb[c][k] * 17u));
+        }
+    }
+    ChunkClose(out, at);
+
+    at = ChunkOpen(out, "IDAT");
+    out.push_back(0x78u);                                       /* zlib header: deflate, 32K window, no dictionary      */
+    out.push_back(0x01u);
+    {
+        Deflate   z(out);
+        uint32_t  adler;
+
+
+        for (uint32_t v = 0u; v < kVgaHeight; v++) {
+            uint32_t  n    = Start_[v + 1u] - Start_[v];
+            bool      same = (v > 0u) && (n == Start_[v] - Start_[v - 1u]);
+
+
+            for (uint32_t k = 0u; same && (k < n); k++) {
+                const VgaSpan  &a = Spans_[Start_[v] + k];
+                const VgaSpan  &b = Spans_[Start_[v - 1u] + k];
+
+
+                same = (a.X0 == b.X0) && (a.X1 == b.X1) && (a.Color == b.Color);
+            }
+            if (same) {
+                z.Copy(kVgaWidth + 1u, kVgaWidth + 1u, &Spans_[Start_[v]], n);
+            } else {
+                z.Run(0u, 1u);                                  /* Filter: none                                         */
+                for (uint32_t k = Start_[v]; k < Start_[v + 1u]; k++) {
+                    z.Run(Spans_[k].Color, (uint32_t)(Spans_[k].X1 - Spans_[k].X0));
+                }
+            }
+        }
+        adler = z.Finish();
+        Be32(out, adler);
+    }
+    ChunkClose(out, at);
+
+    at = ChunkOpen(out, "IEND");
+    ChunkClose(out, at);
+}
+
+
+/*
+*********************************************************************************************************
+*                                             FILES
+*********************************************************************************************************
+*/
+
+void  VgaFrame::Write (const std::string &path) const
+{
+    std::vector<uint8_t>  buf;
+    bool                  ppm = (path.size() >= 4u) && (path.compare(path.size() - 4u, 4u, ".ppm") == 0);
+    std::FILE            *f;
+
+
+    if (ppm) {
+        EncodePpm(buf);
+    } else {
+        EncodePng(buf);
+    }
+    f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    if (std::fwrite(buf.data(), 1u, buf.size(), f) != buf.size()) {
+        std::fclose(f);
+        throw std::runtime_error("cannot write " + path);
+    }
+    std::fclose(f);
+}
+
+}
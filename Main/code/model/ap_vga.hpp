@@ -0,0 +1,136 @@
+/*
+*********************************************************************************************************
+*                                      vga_control FRAME RENDERER
+*
+* Description : Draws the 1280 x 1024 picture of vga_control.vhd from the RAM and the display inputs,
+*               without the VGA hardware, for frame dumps and pixel-exact checks of the display logic.
+*
+*               The rules of the 'output_process', by priority, for the active pixel (h, v):
+*
+*                   blue    trigger line     h < 30, v < 512, v(8..0) = trigger_level, no alarm
+*                   yellow  waveform         v < 512, (data_min(11..3) + offset) mod 512 <= v and
+*                                            (data_in(11..3) + offset) mod 512 >= v, no alarm
+*                   red     period bar       521 < v < 531, h < period, no alarm
+*                   blue    threshold        541 < v < 577, h = t_temperature
+*                   green   temperature bar  541 < v < 572, h < temperature (red in alarm)
+*                   black   anything else
+*
+*               VgaFrame::Render() does not evaluate them pixel by pixel: it sorts the columns of the
+*               waveform by row once, then builds each scanline as a list of spans of one color. The
+*               writers encode the spans directly: the PNG as runs and row copies of a deflate stream,
+*               the PPM by filling runs. VgaPixel() is the literal, per-pixel form, to check them with.
+*
+* Note(s)     : 1) data_in at active pixel h is mem(h): the address is issued 2 clocks ahead (see the
+*                  comment in vga_control.vhd). The colors are registered, so on the cable the picture
+*                  comes one clock after h_counter; pixel (h, v) here is the one computed at h_counter = h.
+*               2) 'offset' is wired from trigger_controller and only depends on vscale, see VgaOffset().
+*               3) The colors are 0 or 15 on every channel, so a frame has at most 5 colors; the PNG is
+*                  written with a palette.
+*               4) data_min is RamMin, the lowest sample of a column: the range of the sweeps overlaid by
+*                  frame_buffers.vhd, or of the samples reduced by deep_record.vhd. Without it data_min is
+*                  data_in and a column is one row; with it Render() adds each column to a row set at its
+*                  lowest row and takes it out after its highest one. A range that wraps past row 511
+*                  draws nothing, as in vga_control.
+*********************************************************************************************************
+*/
+
+#ifndef  AP_VGA_HPP
+#define  AP_VGA_HPP
+
+#include  <cstddef>
+#include  <cstdint>
+#include  <string>
+#include  <vector>
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                            CONSTANTS
+*********************************************************************************************************
+*/
+
+constexpr uint32_t  kVgaWidth      = 1280u;
+constexpr uint32_t  kVgaHeight     = 1024u;
+constexpr uint32_t  kVgaHalf       =  512u;                     /* v_counter(9) = '0': the waveform half                */
+constexpr uint32_t  kVgaTrigWidth  =   30u;
+
+enum VgaColor : uint8_t {
+    kVgaBlack = 0u,
+    kVgaBlue,
+    kVgaYellow,
+    kVgaRed,
+    kVgaGreen,
+    kVgaColors
+};
+
+extern const uint8_t  kVgaRgb[kVgaColors][3];                   /* red, green, blue of each color, 4 bits each          */
+
+
+/*
+*********************************************************************************************************
+*                                            DATA TYPES
+*********************************************************************************************************
+*/
+
+struct VgaInputs {                                              /* Inputs of vga_control, held for the whole frame      */
+    const uint16_t  *Ram          = nullptr;                    /* mem(0 .. 1279), 12-bit words                         */
+    const uint16_t  *RamMin       = nullptr;                    /* data_min of the same columns, nullptr: = Ram         */
+    uint16_t         TriggerLevel = 0u;                         /* 9 bits                                               */
+    uint8_t          Offset       = 0u;
+    uint16_t         Period       = 0u;                         /* 11 bits, in pixels                                   */
+    uint16_t         Temperature  = 0u;                         /* 11 bits, in pixels                                   */
+    uint16_t         TTemperature = 0u;                         /* 11 bits, in pixels                                   */
+    bool             Alarm        = false;
+};
+
+struct VgaSpan {                                                /* Pixels X0 .. X1 - 1 of a line                        */
+    uint16_t  X0;
+    uint16_t  X1;
+    uint8_t   Color;
+};
+
+uint8_t              VgaOffset   (uint8_t vscale);
+VgaColor             VgaPixel    (const VgaInputs &in, uint32_t h, uint32_t v);
+
+
+/*
+*********************************************************************************************************
+*                                             FRAME
+*
+* Description : Render() replaces the picture. Line(v) gives the spans of line 'v', left to right, adjacent
+*               spans of the same color merged. Expand() writes one color index per pixel, row after row.
+*               The writers throw std::runtime_error when the file cannot be written.
+*********************************************************************************************************
+*/
+
+class  VgaFrame {
+public:
+                         VgaFrame   ();
+
+    void                 Render     (const VgaInputs &in);
+    const VgaSpan       *Line       (uint32_t v, uint32_t *p_n) const;
+    void                 Expand     (uint8_t *idx) const;
+
+    void                 EncodePng  (std::vector<uint8_t> &out) const;
+    void                 EncodePpm  (std::vector<uint8_t> &out) const;
+    void                 Write      (const std::string &path) const;   /* PNG, or PPM if 'path' ends in .ppm            */
+
+private:
+    void                 Push       (uint32_t x0, uint32_t x1, uint8_t color);
+    void                 Bars       (uint32_t v, const VgaInputs &in);
+    void                 Ranges     (const VgaInputs &in);
+
+    std::vector<VgaSpan>   Spans_;
+    std::vector<uint32_t>  Start_;                              /* Spans of line v: Start_[v] .. Start_[v + 1] - 1      */
+    std::vector<uint16_t>  Cols_;                               /* Waveform columns sorted by row                       */
+    std::vector<uint16_t>  RowAt_;                              /* ... first one of each row                            */
+    std::vector<uint16_t>  Last_;                               /* With RamMin: Cols_ by lowest row, these by highest   */
+    std::vector<uint16_t>  LastAt_;
+    size_t                 Open_ = 0u;                          /* First span of the line being built                   */
+};
+
+}
+
+#endif
@@ -0,0 +1,248 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot BENCHMARK SUITE
+*
+* Description : The scope paths of the host tools, with the harness of host/bench.h:
+*
+*                   trigger_pipeline     Pipeline::Run(), one conversion: trigger_controller evaluated
+*                                        event by event (ap_model.hpp)
+*                   trigger_rtl          RtlPipeline::Run(), one conversion: every clock edge of
+*                                        adc_driver, trigger_controller and vga_control (ap_rtl.hpp)
+*                   scan_<isa>           ScanBlock(), one sample: the level and slope tests of the
+*                                        trigger rules, with each kernel the host supports (ap_scan.hpp)
+*                   rule_<rule>          ScanTriggers() over the events of the whole input, 2**20 samples:
+*                                        events to trigger points and periods
+*                   vga_pixel            VgaPixel() over a whole frame, one frame
+*                   vga_render           VgaFrame::Render(), one frame of one sample per column
+*                   vga_render_ranges    the same with data_min: the column ranges of frame_buffers and
+*                                        deep_record
+*                   vga_png / vga_ppm    Render() and the encoder, one frame
+*
+*               The input is the sine:10000 source, 10 kHz full scale: a trigger about every 107 samples.
+*
+* Build       : gcc -O2 -c host/bench.c -o bench.o
+*               g++ -O2 -std=c++17 -pthread -I host -o apbench model/apbench.cpp model/ap_model.cpp model/ap_rtl.cpp \
+*                   model/ap_scan.cpp model/ap_vga.cpp model/ap_capture.cpp bench.o
+*
+* Usage       : apbench [options of bench.h]
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <cstdint>
+#include  <memory>
+#include  <string>
+#include  <vector>
+
+#include  "ap_model.hpp"
+#include  "ap_rtl.hpp"
+#include  "ap_scan.hpp"
+#include  "ap_vga.hpp"
+#include  "bench.h"
+
+using  namespace  ap;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DATA
+*********************************************************************************************************
+*/
+
+namespace {
+
+constexpr uint32_t  kBenchCodes = 1u << 20;                     /* Samples of the scan and rule inputs                  */
+constexpr uint32_t  kBenchBlock = 1u << 14;                     /* Samples per ScanBlock() call                         */
+
+struct  Input {
+    std::vector<uint16_t>   Codes;
+    std::vector<ScanEvent>  Events;                             /* Of all of Codes, for the rules                       */
+    ScanLevels              Levels;
+    ScanIsa                 Isa  = ScanIsa::Scalar;
+    ScanRule                Rule = ScanRule::Fpga;
+    std::vector<uint16_t>   Max;                                /* One display RAM, and its data_min                    */
+    std::vector<uint16_t>   Min;
+    VgaFrame                Frame;
+    std::vector<uint8_t>    Buf;
+};
+
+Input  In;
+
+
+/*
+*********************************************************************************************************
+*                                           BENCHMARKS
+*********************************************************************************************************
+*/
+
+void  BenchPipeline (void *p_arg, unsigned long n)
+{
+    static  std::unique_ptr<Source>  src(MakeSource("sine:10000"));
+    static  Pipeline                 p;
+
+
+    (void)p_arg;
+    p.Run(*src, n);
+    Bench_Sink(p.Regs().Period);
+}
+
+void  BenchRtl (void *p_arg, unsigned long n)
+{
+    static  std::unique_ptr<Source>  src(MakeSource("sine:10000"));
+    static  RtlPipeline              p;
+
+
+    (void)p_arg;
+    p.Run(*src, n);
+    Bench_Sink(p.Regs().Period);
+}
+
+void  BenchScan (void *p_arg, unsigned long n)
+{
+    std::vector<ScanEvent>  out;
+    uint64_t                i = 1u;
+
+
+    (void)p_arg;
+    out.reserve(kBenchBlock);
+    while (n > 0u) {                                            /* Blocks of the input, round and round                 */
+        uint64_t  end = std::min<uint64_t>(i + std::min<uint64_t>(n, kBenchBlock), kBenchCodes);
+
+
+        out.clear();
+        ScanBlock(In.Isa, In.Codes.data(), i, end, In.Levels, out);
+        n -= (unsigned long)(end - i);
+        i  = (end == kBenchCodes) ? 1u : end;
+        Bench_Sink(out.size());
+    }
+}
+
+void  BenchRule (void *p_arg, unsigned long n)
+{
+    std::vector<ScanTrigger>  out;
+
+
+    (void)p_arg;
+    out.reserve(kBenchCodes / 64u);
+    for (unsigned long i = 0u; i < n; i++) {
+        out.clear();
+        ScanTriggers(In.Rule, In.Codes.data(), kBenchCodes, In.Levels, 0u, In.Events, out);
+        Bench_Sink(out.size());
+    }
+}
+
+VgaInputs  BenchVgaInputs (bool ranges)
+{
+    VgaInputs  in;
+
+
+    in.Ram          = In.Max.data();
+    in.RamMin       = ranges ? In.Min.data() : nullptr;
+    in.TriggerLevel = 256u;
+    in.Offset       = VgaOffset(0u);
+    in.Period       = 640u;
+    in.Temperature  = 38u << 4;
+    in.TTemperature = 50u << 4;
+    return (in);
+}
+
+void  BenchVgaPixel (void *p_arg, unsigned long n)
+{
+    VgaInputs  in  = BenchVgaInputs(false);
+    uint64_t   acc = 0u;
+
+
+    (void)p_arg;
+    for (unsigned long i = 0u; i < n; i++) {
+        for (uint32_t v = 0u; v < kVgaHeight; v++) {
+            for (uint32_t h = 0u; h < kVgaWidth; h++) {
+                acc += VgaPixel(in, h, v);
+            }
+        }
+    }
+    Bench_Sink((unsigned long)acc);
+}
+
+void  BenchVgaRender (void *p_arg, unsigned long n)
+{
+    VgaInputs  in = BenchVgaInputs(p_arg != nullptr);
+
+
+    for (unsigned long i = 0u; i < n; i++) {
+        in.TriggerLevel = (uint16_t)(i & 0x1FFu);               /* Not the same picture twice                           */
+        In.Frame.Render(in);
+    }
+}
+
+void  BenchVgaEncode (void *p_arg, unsigned long n)
+{
+    VgaInputs  in  = BenchVgaInputs(false);
+    bool       ppm = (p_arg != nullptr);
+
+
+    for (unsigned long i = 0u; i < n; i++) {
+        in.TriggerLevel = (uint16_t)(i & 0x1FFu);
+        In.Frame.Render(in);
+        if (ppm) {
+            In.Frame.EncodePpm(In.Buf);
+        } else {
+            In.Frame.EncodePng(In.Buf);
+        }
+    }
+    Bench_Sink(In.Buf.size());
+}
+
+}
+
+
+int  main (int argc, char *argv[])
+{
+    static const ScanIsa   isas[]  = { ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2 };
+    static const ScanRule  rules[] = { ScanRule::Fpga, ScanRule::NoGuard, ScanRule::Fine, ScanRule::Hyst };
+    std::vector<std::string>  names;
+    std::unique_ptr<Source>   src(MakeSource("sine:10000"));
+    int                       yes = 1;
+
+
+    Bench_Init(argc, argv, "scope");
+    In.Codes.resize(kBenchCodes);
+    src->Fill(0u, In.Codes.data(), In.Codes.size());
+    ScanRange(ScanIsa::Scalar, In.Codes.data(), kBenchCodes, In.Levels, 1u, In.Events);
+    In.Max.resize(kVgaWidth);
+    In.Min.resize(kVgaWidth);
+    for (uint32_t x = 0u; x < kVgaWidth; x++) {                 /* 8 samples a column, as deep_record at zoom 3         */
+        uint16_t  lo = 0xFFFu;
+        uint16_t  hi = 0u;
+
+
+        for (uint32_t k = 0u; k < 8u; k++) {
+            lo = std::min(lo, In.Codes[x * 8u + k]);
+            hi = std::max(hi, In.Codes[x * 8u + k]);
+        }
+        In.Max[x] = hi;
+        In.Min[x] = lo;
+    }
+
+    names.reserve(16u);                                         /* Bench_Run() keeps the name pointers                  */
+    Bench_Run("trigger_pipeline", BenchPipeline, nullptr);
+    Bench_Run("trigger_rtl",      BenchRtl,      nullptr);
+    for (ScanIsa isa : isas) {
+        if ((isa == ScanIsa::Avx2) && (ScanBest() != ScanIsa::Avx2)) {
+            continue;
+        }
+        In.Isa = isa;
+        names.push_back(std::string("scan_") + ScanIsaName(isa));
+        Bench_Run(names.back().c_str(), BenchScan, nullptr);
+    }
+    for (ScanRule rule : rules) {
+        In.Rule = rule;
+        names.push_back(std::string("rule_") + ScanRuleName(rule));
+        Bench_Run(names.back().c_str(), BenchRule, nullptr);
+    }
+    Bench_Run("vga_pixel",         BenchVgaPixel,  nullptr);
+    Bench_Run("vga_render",        BenchVgaRender, nullptr);
+    Bench_Run("vga_render_ranges", BenchVgaRender, &yes);
+    Bench_Run("vga_png",           BenchVgaEncode, nullptr);
+    Bench_Run("vga_ppm",           BenchVgaEncode, &yes);
+    return (Bench_Done());
+}
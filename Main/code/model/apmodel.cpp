@@ -0,0 +1,978 @@
+/*
+*********************************************************************************************************
+*                                   acquire_and_plot GOLDEN MODEL
+*
+*                                           Command line
+*
+* Description : apmodel run     [options]              Runs the model, reports sweeps, period, speed
+*               apmodel check   [options]              Runs Pipeline and RtlPipeline side by side and
+*                                                      compares every RAM write and every 'period' change,
+*                                                      with the trigger armed at vsync, then re-armed
+*                                                      after each sweep (only that with --triple-buffer)
+*               apmodel compare <file.vcd> [options]   Diffs the model against a GHDL waveform of
+*                                                      acquire_and_plot_tb: the model converts the bits
+*                                                      that 'sdata1' carries in the VCD, then its RAM
+*                                                      writes, final RAM and 'period' are compared
+*               apmodel dump    <capture> [options]    Lists the frames of a capture file (ap_capture.hpp)
+*               apmodel render  <capture> [options]    Draws frames of a capture as vga_control does
+*                                                      (ap_vga.hpp), to PNG or PPM files
+*               apmodel vga     [options]              Checks the span renderer against the per-pixel
+*                                                      rules on random inputs, then measures frames/s
+*               apmodel deep    [options]              Runs acquire_and_plot built with deep_bits > 0
+*                                                      (ap_deep.hpp): records, the reduced view, and the
+*                                                      Block RAM it takes against x_utilization.txt
+*
+* Options     : --samples <n>        Conversions to run (run, check).           Default: 1000000 / 200000
+*               --source <spec>      tb | sine:<hz>[:<amp>[:<mid>]] | file:<raw 16-bit codes>.  Default: tb
+*               --level <0..511>     trigger_value                                 Default: 240
+*               --falling            Falling slope (trigger_n_p pressed once)
+*               --vscale <0..3>      --hscale <0..3>
+*               --triple-buffer      acquire_and_plot built with triple_buffer = true: the trigger re-arms
+*                                    after each sweep. Default: false, armed only during vsync, one sweep
+*                                    per frame, as the hardware is built
+*               --ghdl / --fpga      Registers without reset start at 'U' / 0.     Default: compare --ghdl,
+*                                                                                  otherwise --fpga
+*               --scope <name>       Instance of acquire_and_plot in the VCD.  Default: acquire_and_plot_instance
+*               --ram <file>         Writes the final RAM, one word per line; deep: the display memory,
+*                                    data_max and data_min of a column per line
+*               --sweeps             Prints every completed sweep
+*               --capture <file>     Appends a frame per sweep to a capture file (run)
+*               --frame <k>          Prints the samples of frame k (dump)
+*               --follow             Keeps reading frames as the file grows, until it stops for 2 s (dump)
+*               --frame <k>          Renders frame k only (render)                 Default: all
+*               --out <prefix>       Writes <prefix>NNNNNN.png, or .ppm with --ppm (render)
+*               --temp <C>           --threshold <C>   Temperature and threshold shown, whole degrees
+*                                                      (render, vga)                Default: 25, 50
+*               --alarm              Alarm input set; otherwise set when temp > threshold
+*               --record-bits <n>    --segment-bits <n>   deep_bits, deep_segment_bits (deep). Default: 16, 0
+*               --zoom <0..5>        --pan <sample>       View of the record (deep)   Default: 0, 0
+*               --hold               Hold switch on: the first record is kept (deep)
+*               --out <file>         Writes the reduced view as vga_control draws it (deep)
+*               --util <file>        Vivado utilization report (deep)           Default: x_utilization.txt
+*
+* Build       : g++ -O2 -std=c++17 -o apmodel model/apmodel.cpp model/ap_model.cpp model/ap_rtl.cpp model/vcd.cpp \
+*                                                model/ap_capture.cpp model/ap_vga.cpp model/ap_deep.cpp
+*
+* Example     : ghdl -r --std=08 -fsynopsys acquire_and_plot_tb --stop-time=20ms --vcd=tb.vcd
+*               apmodel compare tb.vcd
+*               (and --triple-buffer for a waveform of acquire_and_plot_tb -gtriple_buffer=true)
+*
+* Note(s)     : 1) The default level is the one acquire_and_plot_tb runs at: it presses trigger_down once, from
+*                  the reset value 256 to 240. The 'tb' source never reaches 256, so nothing would trigger.
+*               2) 'check' fails when the run made no sweep or no RAM write: there is then nothing compared.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <chrono>
+#include  <cmath>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
+#include  <memory>
+#include  <random>
+#include  <stdexcept>
+#include  <string>
+#include  <thread>
+#include  <vector>
+
+#include  "ap_capture.hpp"
+#include  "ap_deep.hpp"
+#include  "ap_model.hpp"
+#include  "ap_rtl.hpp"
+#include  "ap_vga.hpp"
+#include  "vcd.hpp"
+
+using  namespace  ap;
+
+constexpr uint16_t  kLevelDefault = 240u;                       /* trigger_value of acquire_and_plot_tb, see note 1     */
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+struct  Options {
+    std::string  Mode;
+    std::string  File;                                          /* compare: VCD, dump: capture                         */
+    std::string  SourceSpec = "tb";
+    std::string  Scope      = "acquire_and_plot_instance";
+    std::string  RamPath;
+    std::string  Capture;
+    int64_t      Frame      = -1;
+    bool         Follow     = false;
+    uint64_t     Samples    = 0u;
+    Settings     Set;
+    int          InitSel    = -1;                               /* -1: default of the mode                              */
+    bool         Sweeps     = false;
+    std::string  Out;
+    bool         Ppm        = false;
+    int          TempC      = 25;
+    int          ThresholdC = 50;
+    bool         Alarm      = false;
+    DeepConfig   Deep;
+    DeepView     View;
+    bool         Hold       = false;
+    std::string  Util       = "x_utilization.txt";
+};
+
+struct  WriteEv {
+    uint64_t  Edge;
+    uint16_t  Addr;
+    uint16_t  Data;
+};
+
+struct  PeriodEv {                                              /* 'period' takes 'Value' after edge 'Edge'             */
+    uint64_t  Edge;
+    uint16_t  Value;
+};
+
+class  Recorder : public Observer {                             /* Keeps the RAM writes and the visible 'period' changes */
+public:
+    explicit  Recorder (bool print_sweeps = false, bool period_known = true) : Print_(print_sweeps), Known_(period_known) {}
+
+    void  OnWrite  (uint64_t edge, uint16_t addr, uint16_t data) override
+    {
+        Writes.push_back({ edge, addr, data });
+    }
+    void  OnPeriod (uint64_t edge, uint16_t period) override
+    {
+        if (!Known_ || (period != Last_)) {
+            Periods.push_back({ edge, period });
+        }
+        Known_ = true;
+        Last_  = period;
+    }
+    void  OnSweep  (uint64_t edge, const uint16_t *ram) override
+    {
+        (void)ram;
+        Sweeps++;
+        if (Print_) {
+            std::printf("sweep %8llu  edge %12llu  (%.6f s)  period %u\n", (unsigned long long)Sweeps,
+                        (unsigned long long)edge, (double)edge / kClkHz, (unsigned)Last_);
+        }
+    }
+
+    std::vector<WriteEv>   Writes;
+    std::vector<PeriodEv>  Periods;
+    uint64_t               Sweeps = 0u;
+
+private:
+    bool      Print_;
+    bool      Known_;
+    uint16_t  Last_ = 0u;
+};
+
+class  Counter : public Observer {                              /* Cheap observer for the speed runs                    */
+public:
+    void  OnPeriod (uint64_t edge, uint16_t period) override { (void)edge; Period = period; }
+    void  OnSweep  (uint64_t edge, const uint16_t *ram) override { (void)edge; (void)ram; Sweeps++; }
+
+    uint64_t  Sweeps = 0u;
+    uint16_t  Period = 0u;
+};
+
+
+/*
+*********************************************************************************************************
+*                                            HELPERS
+*********************************************************************************************************
+*/
+
+static  void  Usage ()
+{
+    std::fprintf(stderr, "usage: apmodel run|check [options]\n"
+                         "       apmodel compare <file.vcd> [options]\n"
+                         "       apmodel dump <capture> [--frame K] [--follow]\n"
+                         "       apmodel render <capture> [--frame K] [--out PREFIX] [--ppm] [--temp C] [--threshold C] [--alarm]\n"
+                         "       apmodel vga [--samples N] [--ppm]\n"
+                         "       apmodel deep [--record-bits N] [--segment-bits N] [--zoom Z] [--pan P] [--hold] [--ram FILE] [--out FILE] [--util FILE]\n"
+                         "options: --samples N --source tb|sine:HZ[:AMP[:MID]]|file:PATH --level L --falling\n"
+                         "         --vscale V --hscale H --triple-buffer --ghdl|--fpga --scope NAME --ram FILE\n"
+                         "         --sweeps --capture FILE\n");
+    std::exit(2);
+}
+
+static  Options  ParseArgs (int argc, char *argv[])
+{
+    Options  o;
+    int      i = 1;
+
+
+    o.Set.Level = kLevelDefault;
+    if (argc < 2) {
+        Usage();
+    }
+    o.Mode = argv[i++];
+    if ((o.Mode == "compare") || (o.Mode == "dump") || (o.Mode == "render")) {
+        if (i >= argc) {
+            Usage();
+        }
+        o.File = argv[i++];
+    } else if ((o.Mode != "run") && (o.Mode != "check") && (o.Mode != "vga") && (o.Mode != "deep")) {
+        Usage();
+    }
+
+    for (; i < argc; i++) {
+        std::string  a    = argv[i];
+        const char  *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+
+        if      (a == "--falling") { o.Set.Rising = false; continue; }
+        else if (a == "--ghdl")    { o.InitSel    = 1;     continue; }
+        else if (a == "--fpga")    { o.InitSel    = 0;     continue; }
+        else if (a == "--sweeps")  { o.Sweeps     = true;  continue; }
+        else if (a == "--follow")  { o.Follow     = true;  continue; }
+        else if (a == "--ppm")     { o.Ppm        = true;  continue; }
+        else if (a == "--alarm")   { o.Alarm      = true;  continue; }
+        else if (a == "--triple-buffer") { o.Set.TripleBuffer = true; continue; }
+        else if (a == "--hold")    { o.Hold       = true;  continue; }
+        if (next == nullptr) {
+            Usage();
+        }
+        i++;
+        if      (a == "--samples") { o.Samples        = std::strtoull(next, nullptr, 0); }
+        else if (a == "--source")  { o.SourceSpec     = next; }
+        else if (a == "--level")   { o.Set.Level      = (uint16_t)(std::strtoul(next, nullptr, 0) & 0x1FFu); }
+        else if (a == "--vscale")  { o.Set.VScale     = (uint8_t)(std::strtoul(next, nullptr, 0) & 3u); }
+        else if (a == "--hscale")  { o.Set.HScale     = (uint8_t)(std::strtoul(next, nullptr, 0) & 3u); }
+        else if (a == "--scope")   { o.Scope          = next; }
+        else if (a == "--ram")     { o.RamPath        = next; }
+        else if (a == "--capture") { o.Capture        = next; }
+        else if (a == "--frame")   { o.Frame          = std::strtoll(next, nullptr, 0); }
+        else if (a == "--out")     { o.Out            = next; }
+        else if (a == "--temp")    { o.TempC          = (int)std::strtol(next, nullptr, 0); }
+        else if (a == "--threshold") { o.ThresholdC   = (int)std::strtol(next, nullptr, 0); }
+        else if (a == "--record-bits")  { o.Deep.RecordBits  = (uint32_t)std::strtoul(next, nullptr, 0); }
+        else if (a == "--segment-bits") { o.Deep.SegmentBits = (uint32_t)std::strtoul(next, nullptr, 0); }
+        else if (a == "--zoom")    { o.View.Zoom      = (uint32_t)std::strtoul(next, nullptr, 0); }
+        else if (a == "--pan")     { o.View.Pan       = (uint32_t)std::strtoul(next, nullptr, 0); }
+        else if (a == "--util")    { o.Util           = next; }
+        else                       { Usage(); }
+    }
+    return (o);
+}
+
+static  void  DumpRam (const std::string &path, const uint16_t *ram)
+{
+    std::FILE  *f;
+
+
+    if (path.empty()) {
+        return;
+    }
+    f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    for (uint32_t a = 0u; a < kRamWords; a++) {
+        std::fprintf(f, "%u\n", (unsigned)ram[a]);
+    }
+    std::fclose(f);
+}
+
+static  void  DumpDisplay (const std::string &path, const DeepPicture &pic)
+{
+    std::FILE  *f;
+
+
+    if (path.empty()) {
+        return;
+    }
+    f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    for (uint32_t c = 0u; c < kDeepColumns; c++) {
+        std::fprintf(f, "%u %u\n", (unsigned)pic.Max[c], (unsigned)pic.Min[c]);
+    }
+    std::fclose(f);
+}
+
+template <typename T, typename Eq, typename Print>
+static  bool  Diff (const char *what, const std::vector<T> &a, const std::vector<T> &b, Eq eq, Print print)
+{
+    size_t  n = (a.size() < b.size()) ? a.size() : b.size();
+
+
+    for (size_t i = 0u; i < n; i++) {
+        if (!eq(a[i], b[i])) {
+            std::printf("%s: first difference at #%zu\n  expected ", what, i);
+            print(a[i]);
+            std::printf("\n  model    ");
+            print(b[i]);
+            std::printf("\n");
+            return (false);
+        }
+    }
+    if (a.size() != b.size()) {
+        std::printf("%s: %zu expected, %zu from the model\n", what, a.size(), b.size());
+        return (false);
+    }
+    std::printf("%-14s: %zu, all equal\n", what, a.size());
+    return (true);
+}
+
+static  bool  DiffWrites (const std::vector<WriteEv> &a, const std::vector<WriteEv> &b)
+{
+    return (Diff("RAM writes", a, b,
+                 [](const WriteEv &x, const WriteEv &y) { return ((x.Edge == y.Edge) && (x.Addr == y.Addr) && (x.Data == y.Data)); },
+                 [](const WriteEv &x) { std::printf("edge %llu mem(%u) <= %u", (unsigned long long)x.Edge, (unsigned)x.Addr, (unsigned)x.Data); }));
+}
+
+static  bool  DiffPeriods (const std::vector<PeriodEv> &a, const std::vector<PeriodEv> &b)
+{
+    return (Diff("period changes", a, b,
+                 [](const PeriodEv &x, const PeriodEv &y) { return ((x.Edge == y.Edge) && (x.Value == y.Value)); },
+                 [](const PeriodEv &x) { std::printf("edge %llu period <= %u", (unsigned long long)x.Edge, (unsigned)x.Value); }));
+}
+
+static  bool  DiffRam (const uint16_t *expected, const uint16_t *model)
+{
+    uint32_t  bad = 0u;
+
+
+    for (uint32_t a = 0u; a < kRamWords; a++) {
+        if (expected[a] != model[a]) {
+            if (bad < 8u) {
+                std::printf("RAM mem(%u): expected %u, model %u\n", (unsigned)a, (unsigned)expected[a], (unsigned)model[a]);
+            }
+            bad++;
+        }
+    }
+    std::printf("%-14s: %u of %u words differ\n", "final RAM", (unsigned)bad, (unsigned)kRamWords);
+    return (bad == 0u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               MODES
+*********************************************************************************************************
+*/
+
+static  int  ModeRun (const Options &o)
+{
+    std::unique_ptr<Source>  src(MakeSource(o.SourceSpec));
+    Pipeline                 p((o.InitSel == 1) ? Init::Unknown : Init::Zero);
+    Recorder                 rec(true);
+    Counter                  cnt;
+    uint64_t                 n = (o.Samples != 0u) ? o.Samples : 1000000u;
+    Observer                *obs = o.Sweeps ? (Observer *)&rec : (Observer *)&cnt;
+    std::unique_ptr<CaptureWriter>    cap;
+    std::unique_ptr<CaptureObserver>  cap_obs;
+    uint64_t                          cap_first = 0u;
+
+
+    if (!o.Capture.empty()) {
+        uint64_t  now = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+
+
+        cap.reset(new CaptureWriter(o.Capture, now));
+        cap_first = cap->Frames();
+        cap_obs.reset(new CaptureObserver(*cap, o.Set));
+        obs = cap_obs.get();
+    }
+    p.Set(o.Set);
+    auto  t0 = std::chrono::steady_clock::now();
+    p.Run(*src, n, obs);
+    auto  t1 = std::chrono::steady_clock::now();
+    double  s = std::chrono::duration<double>(t1 - t0).count();
+
+    std::printf("conversions    : %llu (%.3f s of hardware time, %llu edges)\n",
+                (unsigned long long)n, (double)p.Edge() / kClkHz, (unsigned long long)p.Edge());
+    uint64_t  sweeps = o.Sweeps ? rec.Sweeps : cnt.Sweeps;
+    if (cap) {
+        cap->Flush();
+        sweeps = cap->Frames() - cap_first;
+        std::printf("sweeps         : %llu, appended to %s, which now has %llu frames\n",
+                    (unsigned long long)sweeps, o.Capture.c_str(), (unsigned long long)cap->Frames());
+    } else {
+        std::printf("sweeps         : %llu\n", (unsigned long long)sweeps);
+    }
+    if (p.Edge() > 0u) {
+        double  hw = (double)p.Edge() / kClkHz;
+
+
+        std::printf("sweep rate     : %.1f sweeps/s, %.2f per frame (%s)\n", (double)sweeps / hw,
+                    (double)sweeps / hw * (double)kFrameCycles / kClkHz,
+                    o.Set.WaitVsync() ? "armed at vsync" : "re-armed after each sweep");
+    }
+    if (p.Regs().PeriodKnown) {
+        std::printf("period         : %u\n", (unsigned)p.Regs().Period);
+    } else {
+        std::printf("period         : U\n");
+    }
+    std::printf("host time      : %.3f s, %.1f Msamples/s (%.0fx real time)\n",
+                s, (double)n / s / 1e6, ((double)p.Edge() / kClkHz) / s);
+    DumpRam(o.RamPath, p.Ram());
+    return (EXIT_SUCCESS);
+}
+
+static  bool  CheckSettings (const Options &o, const Settings &set)
+{
+    Init                     init = (o.InitSel == 1) ? Init::Unknown : Init::Zero;
+    std::unique_ptr<Source>  src_fast(MakeSource(o.SourceSpec));
+    std::unique_ptr<Source>  src_rtl(MakeSource(o.SourceSpec));
+    Pipeline                 fast(init);
+    RtlPipeline              rtl(init);
+    Recorder                 rec_fast(false, init == Init::Zero);
+    Recorder                 rec_rtl(false, init == Init::Zero);
+    uint64_t                 n = (o.Samples != 0u) ? o.Samples : 200000u;
+    bool                     ok;
+
+
+    fast.Set(set);
+    rtl.Set(set);
+    fast.Run(*src_fast, n, &rec_fast);
+    rtl.Run(*src_rtl, n, &rec_rtl);
+
+    std::printf("conversions   : %llu, %llu edges, %llu sweeps\n",
+                (unsigned long long)n, (unsigned long long)rtl.Edge(), (unsigned long long)rec_rtl.Sweeps);
+    std::printf("timing errors : %llu\n", (unsigned long long)rtl.TimingErrors());
+    ok  = (rtl.TimingErrors() == 0u);
+    ok &= (fast.Edge() == rtl.Edge());
+    ok &= DiffWrites(rec_rtl.Writes, rec_fast.Writes);
+    ok &= DiffPeriods(rec_rtl.Periods, rec_fast.Periods);
+    ok &= DiffRam(rtl.Ram(), fast.Ram());
+    if ((rec_rtl.Sweeps == 0u) || rec_rtl.Writes.empty()) {     /* See note 2                                           */
+        std::printf("nothing compared: no sweep or no RAM write, try another --level or more --samples\n");
+        ok = false;
+    }
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return (ok);
+}
+
+static  int  ModeCheck (const Options &o)                       /* Both trigger modes, unless --triple-buffer           */
+{
+    Settings  set = o.Set;
+    bool      ok;
+
+
+    if (o.Set.TripleBuffer) {
+        return (CheckSettings(o, set) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    std::printf("-- armed at vsync (triple_buffer = false, as built)\n");
+    ok  = CheckSettings(o, set);
+    set.TripleBuffer = true;
+    std::printf("-- re-armed after each sweep (triple_buffer = true)\n");
+    ok &= CheckSettings(o, set);
+    std::printf("%s\n", ok ? "PASS, both modes" : "FAIL");
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static  int  ModeCompare (const Options &o)
+{
+    VcdReader              vcd(o.File);
+    const std::string      pre  = o.Scope.empty() ? "" : o.Scope + ".";
+    int                    clk  = vcd.Watch(pre + "clk");
+    int                    rstn = vcd.Watch(pre + "resetn");
+    int                    sd   = vcd.Watch(pre + "sdata1");
+    int                    we   = vcd.Watch(pre + "we");
+    int                    addr = vcd.Watch(pre + "addr_trigger_memory");
+    int                    data = vcd.Watch(pre + "data_trigger_memory");
+    int                    per  = vcd.Watch(pre + "period");
+    std::vector<uint16_t>  codes;
+    std::vector<WriteEv>   writes;
+    std::vector<PeriodEv>  periods;
+    std::vector<uint16_t>  ram(kRamWords, 0u);
+    VcdValue               per_prev;
+    uint64_t               e       = 0u;                        /* Next edge number                                     */
+    bool                   running = false;
+    uint64_t               unknown = 0u;
+
+
+    while (vcd.ReadStep()) {
+        bool  rising = vcd.Changes(clk) && vcd.Next(clk).Known && (vcd.Next(clk).Bits == 1u) &&
+                       vcd.Value(clk).Known && (vcd.Value(clk).Bits == 0u);
+
+
+        if (rising) {
+            if (!running && vcd.Value(rstn).Known && (vcd.Value(rstn).Bits == 1u)) {
+                running  = true;
+                per_prev = vcd.Value(per);
+            }
+            if (running) {
+                uint64_t  off = (e >= kBitEdge) ? (e - kBitEdge) % kConvCycles : kConvCycles;
+                uint64_t  n   = (e >= kBitEdge) ? (e - kBitEdge) / kConvCycles : 0u;
+
+
+                if ((off % kBitCycles == 0u) && (off / kBitCycles < kBits)) {   /* adc_driver samples sdata1   */
+                    uint32_t  k = (uint32_t)(off / kBitCycles);
+
+
+                    if (codes.size() <= n) {
+                        codes.resize(n + 1u, 0u);
+                    }
+                    if (!vcd.Value(sd).Known) {
+                        unknown++;
+                    } else if (vcd.Value(sd).Bits != 0u) {
+                        codes[n] |= (uint16_t)(1u << (11u - k));
+                    }
+                }
+                if (vcd.Value(we).Known && (vcd.Value(we).Bits == 1u)) {
+                    writes.push_back({ e, (uint16_t)vcd.Value(addr).Bits, (uint16_t)vcd.Value(data).Bits });
+                    if (vcd.Value(addr).Bits < kRamWords) {
+                        ram[vcd.Value(addr).Bits] = (uint16_t)vcd.Value(data).Bits;
+                    }
+                }
+                if (vcd.Value(per).Known && (!per_prev.Known || (per_prev.Bits != vcd.Value(per).Bits)) && (e > 0u)) {
+                    periods.push_back({ e - 1u, (uint16_t)vcd.Value(per).Bits });
+                }
+                per_prev = vcd.Value(per);
+                e++;
+            }
+        }
+        vcd.Apply();
+    }
+    if (!running) {
+        std::printf("%s: resetn never goes to '1' on a rising edge of clk\n", o.File.c_str());
+        return (EXIT_FAILURE);
+    }
+
+    uint64_t  convs = 0u;                                       /* Conversions whose sample_ready lies inside the dump  */
+    while ((convs < codes.size()) && (ReadyEdge(convs) < e)) {
+        convs++;
+    }
+    codes.resize((size_t)convs);
+
+    VectorSource  src(codes);
+    Pipeline      p((o.InitSel == 0) ? Init::Zero : Init::Unknown);
+    Recorder      rec(false, o.InitSel == 0);
+
+
+    p.Set(o.Set);
+    if (convs > 0u) {
+        p.Run(src, convs, &rec);
+    }
+    p.RunUntil(e, &rec);
+
+    std::printf("VCD            : %llu edges after reset (%.6f s), %llu conversions, %llu unknown sdata1 bits\n",
+                (unsigned long long)e, (double)e / kClkHz, (unsigned long long)convs, (unsigned long long)unknown);
+    bool  ok = true;
+    ok &= DiffWrites(writes, rec.Writes);
+    ok &= DiffPeriods(periods, rec.Periods);
+    ok &= DiffRam(ram.data(), p.Ram());
+    DumpRam(o.RamPath, p.Ram());
+    std::printf("%s\n", ok ? "MATCH" : "MISMATCH");
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+static  void  PrintFrame (const CaptureReader &r, uint64_t k)
+{
+    CapFrame  f   = r.Frame(k);
+    uint16_t  lo  = 0xFFFFu;
+    uint16_t  hi  = 0u;
+
+
+    for (uint32_t i = 0u; i < f.H->Samples; i++) {
+        lo = (f.Samples[i] < lo) ? f.Samples[i] : lo;
+        hi = (f.Samples[i] > hi) ? f.Samples[i] : hi;
+    }
+    std::printf("%8llu %8u %12.6f %5u %-7s %2u %2u ", (unsigned long long)k, (unsigned)f.H->Seq,
+                (double)f.H->TriggerEdge / r.Header().ClkHz, (unsigned)f.H->Level,
+                (f.H->Flags & kCapRising) ? "rising" : "falling", (unsigned)(f.H->Scale & 3u), (unsigned)(f.H->Scale >> 2));
+    if (f.H->Flags & kCapPeriodValid) {
+        std::printf("%6u%c", (unsigned)f.H->Period, (f.H->Flags & kCapPeriodNew) ? ' ' : '*');
+    } else {
+        std::printf("%6s ", "-");
+    }
+    std::printf(" %5u %5u%s\n", (unsigned)lo, (unsigned)hi, r.Valid(k) ? "" : "  BAD CRC");
+}
+
+static  int  ModeDump (const Options &o)
+{
+    CaptureReader  r(o.File);
+    uint64_t       k    = 0u;
+    uint64_t       gaps = 0u;
+    uint64_t       bad  = 0u;
+    uint32_t       seq  = 0u;
+
+
+    if (o.Frame >= 0) {
+        if ((uint64_t)o.Frame >= r.Frames()) {
+            std::printf("%s: %llu frames\n", o.File.c_str(), (unsigned long long)r.Frames());
+            return (EXIT_FAILURE);
+        }
+        CapFrame  f = r.Frame((uint64_t)o.Frame);
+        for (uint32_t i = 0u; i < f.H->Samples; i++) {
+            std::printf("%u\n", (unsigned)f.Samples[i]);
+        }
+        return (EXIT_SUCCESS);
+    }
+
+    std::printf("%8s %8s %12s %5s %-7s %2s %2s %6s  %5s %5s\n", "frame", "seq", "trigger s", "level", "slope",
+                "vs", "hs", "period", "min", "max");
+    for (int idle = 0; ; ) {
+        for (; k < r.Frames(); k++) {
+            CapFrame  f = r.Frame(k);
+
+
+            if ((k != 0u) && (f.H->Seq != seq + 1u)) {
+                gaps++;
+            }
+            seq  = f.H->Seq;
+            bad += !r.Valid(k);
+            PrintFrame(r, k);
+        }
+        if (!o.Follow || (idle >= 20)) {
+            break;
+        }
+        if (r.Refresh()) {
+            idle = 0;
+        } else {
+            idle++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    std::printf("%llu frames, %llu gaps in seq, %llu bad CRC (* = period from an earlier sweep)\n",
+                (unsigned long long)r.Frames(), (unsigned long long)gaps, (unsigned long long)bad);
+    return (((gaps == 0u) && (bad == 0u)) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+static  VgaInputs  DisplayInputs (const Options &o, const uint16_t *ram)
+{
+    VgaInputs  in;
+
+
+    in.Ram          = ram;
+    in.Temperature  = (uint16_t)((o.TempC      & 0x7F) << 4);  /* As AppState_Pack() drives them                      */
+    in.TTemperature = (uint16_t)((o.ThresholdC & 0x7F) << 4);
+    in.Alarm        = o.Alarm || (o.TempC > o.ThresholdC);
+    return (in);
+}
+
+static  int  ModeRender (const Options &o)
+{
+    CaptureReader         r(o.File);
+    VgaFrame              frame;
+    std::vector<uint8_t>  buf;
+    uint64_t              k0     = (o.Frame >= 0) ? (uint64_t)o.Frame : 0u;
+    uint64_t              k1     = (o.Frame >= 0) ? (uint64_t)o.Frame + 1u : r.Frames();
+    double                t_draw = 0.0;
+    double                t_enc  = 0.0;
+    double                t_file = 0.0;
+    uint64_t              bytes  = 0u;
+    char                  path[4096];
+
+
+    if (k1 > r.Frames()) {
+        std::printf("%s: %llu frames\n", o.File.c_str(), (unsigned long long)r.Frames());
+        return (EXIT_FAILURE);
+    }
+    for (uint64_t k = k0; k < k1; k++) {
+        CapFrame   f  = r.Frame(k);
+        VgaInputs  in = DisplayInputs(o, f.Samples);
+
+
+        in.TriggerLevel = f.H->Level;
+        in.Offset       = VgaOffset(f.H->Scale & 3u);
+        in.Period       = (f.H->Flags & kCapPeriodValid) ? f.H->Period : 0u;
+
+        auto  t0 = std::chrono::steady_clock::now();
+        frame.Render(in);
+        auto  t1 = std::chrono::steady_clock::now();
+        if (o.Ppm) {
+            frame.EncodePpm(buf);
+        } else {
+            frame.EncodePng(buf);
+        }
+        auto  t2 = std::chrono::steady_clock::now();
+        if (!o.Out.empty()) {
+            std::FILE  *fp;
+
+
+            std::snprintf(path, sizeof(path), "%s%06llu.%s", o.Out.c_str(), (unsigned long long)k, o.Ppm ? "ppm" : "png");
+            fp = std::fopen(path, "wb");
+            if ((fp == nullptr) || (std::fwrite(buf.data(), 1u, buf.size(), fp) != buf.size())) {
+                throw std::runtime_error(std::string("cannot write ") + path);
+            }
+            std::fclose(fp);
+        }
+        auto  t3 = std::chrono::steady_clock::now();
+        t_draw += std::chrono::duration<double>(t1 - t0).count();
+        t_enc  += std::chrono::duration<double>(t2 - t1).count();
+        t_file += std::chrono::duration<double>(t3 - t2).count();
+        bytes  += buf.size();
+    }
+
+    uint64_t  n = k1 - k0;
+    if (n == 0u) {
+        std::printf("%s: no frames\n", o.File.c_str());
+        return (EXIT_SUCCESS);
+    }
+    std::printf("frames         : %llu, %s, %.0f bytes each%s%s\n", (unsigned long long)n, o.Ppm ? "PPM" : "PNG",
+                (double)bytes / n, o.Out.empty() ? "" : ", written to ", o.Out.empty() ? "" : (o.Out + "*").c_str());
+    std::printf("render         : %8.1f us/frame\n", t_draw / n * 1e6);
+    std::printf("encode         : %8.1f us/frame\n", t_enc  / n * 1e6);
+    std::printf("write          : %8.1f us/frame\n", t_file / n * 1e6);
+    std::printf("total          : %8.0f frames/s on one core (the VGA shows %.1f)\n",
+                n / (t_draw + t_enc + t_file), (double)kClkHz / (double)kFrameCycles);
+    return (EXIT_SUCCESS);
+}
+
+static  int  ModeVga (const Options &o)                          /* Span renderer against VgaPixel(), then speed        */
+{
+    std::mt19937                        rng(12345u);
+    uint64_t                            n = (o.Samples != 0u) ? o.Samples : 200u;
+    std::vector<std::vector<uint16_t>>  rams;
+    std::vector<std::vector<uint16_t>>  mins;
+    std::vector<VgaInputs>              ins;
+    std::vector<uint8_t>                idx(kVgaWidth * kVgaHeight);
+    std::vector<uint8_t>                buf;
+    VgaFrame                            frame;
+    uint64_t                            bad   = 0u;
+    uint64_t                            bytes = 0u;
+
+
+    rams.resize((size_t)n, std::vector<uint16_t>(kVgaWidth));
+    mins.resize((size_t)n, std::vector<uint16_t>(kVgaWidth));
+    for (uint64_t i = 0u; i < n; i++) {                         /* Sines, noise, flat lines and steps, on varied inputs */
+        std::vector<uint16_t>  &ram  = rams[(size_t)i];
+        VgaInputs               in;
+        uint32_t                kind = (uint32_t)(i % 4u);
+        double                  hz   = 1.0 + (double)(rng() % 400u) / 10.0;
+        double                  amp  = (double)(rng() % 2048u);
+
+
+        for (uint32_t x = 0u; x < kVgaWidth; x++) {
+            double  v = 2048.0;
+
+
+            switch (kind) {
+                case 0u: v += amp * std::sin(6.283185307 * hz * x / kVgaWidth);  break;
+                case 1u: v  = (double)(rng() % 4096u);                              break;
+                case 2u: v  = (double)((i * 37u) % 4096u);                          break;
+                default: v += ((x / 97u) % 2u) ? amp : -amp;                        break;
+            }
+            ram[x] = (uint16_t)((v < 0.0) ? 0.0 : (v > 4095.0) ? 4095.0 : v);
+        }
+        in.Ram          = ram.data();
+        if (i % 3u == 1u) {                                     /* Column ranges, some of them wrapping or inverted     */
+            for (uint32_t x = 0u; x < kVgaWidth; x++) {
+                uint32_t  d = rng() % ((x % 7u == 0u) ? 4096u : 512u);
+
+
+                mins[(size_t)i][x] = (uint16_t)((x % 7u == 0u) ? d : (ram[x] > d) ? ram[x] - d : 0u);
+            }
+            in.RamMin = mins[(size_t)i].data();
+        }
+        in.TriggerLevel = (uint16_t)(rng() & 0x1FFu);
+        in.Offset       = VgaOffset((uint8_t)(rng() & 3u));
+        in.Period       = (uint16_t)(rng() & 0x7FFu);
+        in.Temperature  = (uint16_t)(rng() & 0x7FFu);
+        in.TTemperature = (uint16_t)((i % 8u == 0u) ? in.Temperature : (rng() & 0x7FFu));
+        in.Alarm        = (rng() % 4u) == 0u;
+        ins.push_back(in);
+    }
+    ins[0] = DisplayInputs(o, rams[0].data());                  /* One with the command line values                     */
+
+    for (uint64_t i = 0u; i < n; i++) {
+        uint64_t  diff = 0u;
+
+
+        frame.Render(ins[(size_t)i]);
+        frame.Expand(idx.data());
+        for (uint32_t v = 0u; v < kVgaHeight; v++) {
+            for (uint32_t h = 0u; h < kVgaWidth; h++) {
+                diff += (idx[v * kVgaWidth + h] != VgaPixel(ins[(size_t)i], h, v));
+            }
+        }
+        if ((diff != 0u) && (bad < 4u)) {
+            std::printf("input %llu: %llu pixels differ\n", (unsigned long long)i, (unsigned long long)diff);
+        }
+        bad += (diff != 0u);
+    }
+    std::printf("pixel check    : %llu frames of %ux%u, %llu differ\n", (unsigned long long)n,
+                (unsigned)kVgaWidth, (unsigned)kVgaHeight, (unsigned long long)bad);
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool    ppm = (pass == 1);
+        double  s;
+
+
+        bytes   = 0u;
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint64_t i = 0u; i < n; i++) {
+            frame.Render(ins[(size_t)i]);
+            if (ppm) {
+                frame.EncodePpm(buf);
+            } else {
+                frame.EncodePng(buf);
+            }
+            bytes += buf.size();
+        }
+        s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("render + %s  : %8.1f us/frame, %8.0f frames/s, %.0f bytes each\n", ppm ? "PPM" : "PNG",
+                    s / n * 1e6, n / s, (double)bytes / n);
+    }
+    std::printf("%s\n", (bad == 0u) ? "PASS" : "FAIL");
+    return ((bad == 0u) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+static  bool  BramBudget (const std::string &path, uint32_t *p_used, uint32_t *p_avail)
+{                                                               /* '| Block RAM Tile | used | fixed | available | %'    */
+    std::FILE  *f = std::fopen(path.c_str(), "r");
+    char        line[512];
+    bool        ok = false;
+
+
+    if (f == nullptr) {
+        return (false);
+    }
+    while (!ok && (std::fgets(line, sizeof(line), f) != nullptr)) {
+        unsigned  used;
+        unsigned  fixed;
+        unsigned  avail;
+
+
+        if (std::sscanf(line, "| Block RAM Tile | %u | %u | %u |", &used, &fixed, &avail) == 3) {
+            *p_used  = used;
+            *p_avail = avail;
+            ok       = true;
+        }
+    }
+    std::fclose(f);
+    return (ok);
+}
+
+static  int  ModeDeep (const Options &o)
+{
+    std::unique_ptr<Source>  src(MakeSource(o.SourceSpec));
+    std::unique_ptr<Source>  src_codes(MakeSource(o.SourceSpec));
+    Pipeline                 p(Init::Zero);
+    Settings                 set   = o.Set;
+    DeepConfig               cfg   = o.Deep;
+    DeepRecorder             rec(cfg);
+    uint64_t                 n     = (o.Samples != 0u) ? o.Samples : 1000000u;
+    double                   rate  = (double)kClkHz / kConvCycles;
+    std::vector<uint16_t>    codes;
+    uint32_t                 used  = 0u;
+    uint32_t                 avail = 0u;
+
+
+    if ((cfg.RecordBits < 11u) || (cfg.RecordBits > 22u) || (cfg.SegmentBits >= cfg.RecordBits) ||
+        (cfg.SegLen() < kDeepColumns)) {                        /* The assertion of deep_record.vhd                     */
+        throw std::runtime_error("deep: --record-bits 11 .. 22, segments of 1280 samples or more");
+    }
+    set.DeepBits = cfg.RecordBits;                              /* wait_vsync is off when deep_bits > 0                 */
+    p.Set(set);
+    p.Run(*src, n, &rec);
+    codes.resize((size_t)n);
+    src_codes->Fill(0u, codes.data(), codes.size());
+    rec.Replay(codes, o.View.Zoom, o.Hold);
+
+    std::printf("conversions    : %llu (%.3f s of hardware time)\n", (unsigned long long)n, (double)p.Edge() / kClkHz);
+    std::printf("record         : %u samples in %u segment(s) of %u, %.2f ms at %.3f Msamples/s\n",
+                (unsigned)cfg.Depth(), (unsigned)cfg.Segments(), (unsigned)cfg.SegLen(), cfg.Depth() / rate * 1e3,
+                rate / 1e6);
+    std::printf("triggers       : %llu, %llu complete records, %llu ignored (capturing, reducing or held)\n",
+                (unsigned long long)rec.Triggers(), (unsigned long long)rec.Records(),
+                (unsigned long long)rec.Ignored());
+    if (rec.Records() == 0u) {
+        std::printf("no complete record: more --samples, or a source that crosses the level\n");
+        return (EXIT_FAILURE);
+    }
+
+    DeepPicture  pic  = DeepReduce(cfg, rec.Record(), o.View);
+    uint32_t     k    = 1u << pic.Zoom;
+    uint32_t     wide = 0u;                                     /* Columns drawn over more than one row                 */
+    uint32_t     miss = 0u;                                     /* Worst error of keeping 1 sample out of k             */
+
+
+    for (uint32_t c = 0u; c < kDeepColumns; c++) {
+        uint16_t  one = (uint16_t)(rec.Record()[pic.Pan + c * k] >> (o.View.VScale & 3u));
+        uint32_t  err = std::max((uint32_t)(pic.Max[c] - one), (uint32_t)(one - pic.Min[c]));
+
+
+        wide += ((pic.Max[c] >> 3) != (pic.Min[c] >> 3));
+        miss  = std::max(miss, err);
+    }
+    std::printf("view           : zoom %u (%u samples a column), samples %u .. %u, %.3f ms on screen\n",
+                (unsigned)pic.Zoom, (unsigned)k, (unsigned)pic.Pan, (unsigned)(pic.Pan + kDeepColumns * k - 1u),
+                kDeepColumns * k / rate * 1e3);
+    std::printf("reduction      : %u clocks from vsync falling, %u before the first active line (%s)\n",
+                (unsigned)pic.Clocks, (unsigned)kDeepBlank, (pic.Clocks <= kDeepBlank) ? "fits" : "TEARS");
+    std::printf("peak detect    : %u of %u columns span more than one row; 1 sample of %u would miss up to %u LSB\n",
+                (unsigned)wide, (unsigned)kDeepColumns, (unsigned)k, (unsigned)miss);
+    DumpDisplay(o.RamPath, pic);
+
+    if (!o.Out.empty()) {
+        VgaFrame   frame;
+        VgaInputs  in = DisplayInputs(o, pic.Max.data());
+
+
+        in.RamMin       = pic.Min.data();
+        in.TriggerLevel = set.Level;
+        in.Offset       = VgaOffset(o.View.VScale);
+        in.Period       = p.Regs().PeriodKnown ? p.Regs().Period : 0u;
+        frame.Render(in);
+        frame.Write(o.Out);
+        std::printf("picture        : %s\n", o.Out.c_str());
+    }
+
+    if (!BramBudget(o.Util, &used, &avail)) {                   /* Memory against the implemented design                */
+        std::printf("%s: no Block RAM Tile row, budget not checked\n", o.Util.c_str());
+        return (EXIT_SUCCESS);
+    }
+    uint32_t  cap  = DeepTiles(kSweepSamples + 1u, 12u);        /* The capture memory deep_record replaces: only 0 ..   */
+                                                                /* 1280 are written, Vivado trims the rest             */
+    uint32_t  disp = DeepTiles(kDeepDispWords, kDeepDispBits);
+
+
+    std::printf("Block RAM      : %s: %u of %u tiles, %u of them the capture memory\n", o.Util.c_str(),
+                (unsigned)used, (unsigned)avail, (unsigned)cap);
+    std::printf("  %-11s %8s %9s %7s %8s %6s %7s\n", "record_bits", "samples", "ms", "record", "display", "total",
+                "used");
+    for (uint32_t b = 12u; b <= std::max(18u, cfg.RecordBits); b++) {
+        uint32_t  tiles = DeepTiles(1ull << b, 12u);
+        uint32_t  total = used - std::min(used, cap) + tiles + disp;
+
+
+        if ((b > 18u) && (b != cfg.RecordBits)) {
+            continue;
+        }
+        std::printf("  %-11u %8u %9.2f %7u %8u %6u %6.1f%%%s%s\n", (unsigned)b, (unsigned)(1u << b),
+                    (double)(1u << b) / rate * 1e3, (unsigned)tiles, (unsigned)disp, (unsigned)total,
+                    100.0 * total / avail, (total > avail) ? "  over" : "", (b == cfg.RecordBits) ? "  <" : "");
+    }
+    return (EXIT_SUCCESS);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    Options  o = ParseArgs(argc, argv);
+
+
+    try {
+        if (o.Mode == "run") {
+            return (ModeRun(o));
+        }
+        if (o.Mode == "check") {
+            return (ModeCheck(o));
+        }
+        if (o.Mode == "dump") {
+            return (ModeDump(o));
+        }
+        if (o.Mode == "render") {
+            return (ModeRender(o));
+        }
+        if (o.Mode == "vga") {
+            return (ModeVga(o));
+        }
+        if (o.Mode == "deep") {
+            return (ModeDeep(o));
+        }
+        return (ModeCompare(o));
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "apmodel: %s\n", ex.what());
+        return (EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,373 @@
+/*
+*********************************************************************************************************
+*                                        PLOT DATA GENERATOR
+*
+* Description : plotgen [options] <tex>...
+*
+*               Evaluates the curves of the document outside TeX. A figure declares its data in a comment
+*               block of its .tex file, the columns in the pgfplots expression syntax (ap_expr.hpp):
+*
+*                   % plotgen: plots/smrr.dat
+*                   %   domain     = 0.001*2*pi : 5*2*pi
+*                   %   samples    = 20000
+*                   %   spacing    = log                         lin (default) or log
+*                   %   integrator = abs(sin(deg(x*pi))/(x*pi))
+*                   %   lpf        = abs(1/sqrt((pi/2)^2 + (3.14*x)^2))
+*
+*               and loads the table in place of '\addplot {expression}':
+*
+*                   \addplot [blue, no marks] table [x = x, y = integrator] {plots/smrr.dat};
+*
+*               The .dat file has a '#' line with the block, whitespace removed, then a header row
+*               'x integrator lpf' and one row per sample. A file whose '#' line matches its block is
+*               up to date and left alone, so only a changed expression, domain, sample count or spacing
+*               is evaluated again.
+*
+* Options     : --threads <n>   Default: all CPUs
+*               --digits <n>    Significant digits written.                              Default: 9
+*               --force         Regenerates every file
+*               --check         Writes nothing; exit code 1 if a file is out of date
+*
+* Build       : g++ -O2 -std=c++17 -pthread -o plotgen model/plotgen.cpp model/ap_expr.cpp
+*
+* Note(s)     : 1) Paths are relative to the current directory: run it, as LaTeX, from Main/:
+*                      plotgen chapters/Plots.tex
+*               2) Samples are spread evenly over the domain, or over its logarithm with 'spacing = log'
+*                  (the domain must then be positive). The first and last samples are the domain ends.
+*               3) A failed evaluation (a pole, the log of a negative number) is written as nan or inf,
+*                  which pgfplots drops as an unbounded coordinate.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <cctype>
+#include  <chrono>
+#include  <cmath>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
+#include  <filesystem>
+#include  <fstream>
+#include  <stdexcept>
+#include  <string>
+#include  <thread>
+#include  <vector>
+
+#include  "ap_expr.hpp"
+
+using  namespace  ap;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+struct  Options {
+    std::vector<std::string>  Tex;
+    unsigned                  Threads = 0u;
+    int                       Digits  = 9;
+    bool                      Force   = false;
+    bool                      Check   = false;
+};
+
+struct  Column {
+    std::string               Name;
+    std::string               Text;
+};
+
+struct  Block {                                                 /* One '% plotgen:' comment block                       */
+    std::string               Where;                            /* file:line, for the messages                          */
+    std::string               Out;
+    std::string               Domain;
+    uint64_t                  Samples = 500u;                   /* The pgfplots default for a figure with no 'samples'  */
+    bool                      Log     = false;
+    std::vector<Column>       Cols;
+
+    std::string               Spec () const;
+};
+
+
+/*
+*********************************************************************************************************
+*                                             OPTIONS
+*********************************************************************************************************
+*/
+
+static  void  Usage ()
+{
+    std::fprintf(stderr, "usage: plotgen [--threads N] [--digits N] [--force] [--check] <tex>...\n");
+    std::exit(2);
+}
+
+static  Options  ParseArgs (int argc, char *argv[])
+{
+    Options  o;
+
+
+    for (int i = 1; i < argc; i++) {
+        std::string  a    = argv[i];
+        const char  *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+
+        if      (a == "--force")   { o.Force = true; continue; }
+        else if (a == "--check")   { o.Check = true; continue; }
+        else if ((a.size() < 2u) || (a.compare(0u, 2u, "--") != 0)) {
+            o.Tex.push_back(a);
+            continue;
+        }
+        if (next == nullptr) {
+            Usage();
+        }
+        i++;
+        if      (a == "--threads") { o.Threads = (unsigned)std::strtoul(next, nullptr, 0); }
+        else if (a == "--digits")  { o.Digits  = std::max(1, std::min(17, std::atoi(next))); }
+        else                       { Usage(); }
+    }
+    if (o.Tex.empty()) {
+        Usage();
+    }
+    if (o.Threads == 0u) {
+        o.Threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return (o);
+}
+
+static  std::string  Trim (const std::string &s)
+{
+    size_t  b = s.find_first_not_of(" \t\r");
+    size_t  e = s.find_last_not_of(" \t\r");
+
+
+    return ((b == std::string::npos) ? std::string() : s.substr(b, e - b + 1u));
+}
+
+static  std::string  Squeeze (const std::string &s)             /* Without whitespace                                   */
+{
+    std::string  r;
+
+
+    for (char c : s) {
+        if (!std::isspace((unsigned char)c)) {
+            r += c;
+        }
+    }
+    return (r);
+}
+
+std::string  Block::Spec () const
+{
+    std::string  s = "domain=" + Squeeze(Domain) + ";samples=" + std::to_string(Samples) + (Log ? ";spacing=log" : "");
+
+
+    for (const Column &c : Cols) {
+        s += ";" + c.Name + "=" + Squeeze(c.Text);
+    }
+    return (s);
+}
+
+
+/*
+*********************************************************************************************************
+*                                              BLOCKS
+*
+* Description : A block is the '% plotgen: <file>' line and the '%   key = value' lines that follow it.
+*********************************************************************************************************
+*/
+
+static  bool  KeyValue (const std::string &line, std::string &key, std::string &value)
+{
+    std::string  t = Trim(line);
+    size_t       eq;
+
+
+    if (t.empty() || (t[0] != '%')) {
+        return (false);
+    }
+    t  = Trim(t.substr(1u));
+    eq = t.find('=');
+    if ((eq == std::string::npos) || (eq == 0u)) {
+        return (false);
+    }
+    key   = Trim(t.substr(0u, eq));
+    value = Trim(t.substr(eq + 1u));
+    for (char c : key) {
+        if (!std::isalnum((unsigned char)c) && (c != '_')) {
+            return (false);
+        }
+    }
+    return (!value.empty());
+}
+
+static  std::vector<Block>  ReadBlocks (const std::string &path)
+{
+    std::ifstream       in(path);
+    std::vector<Block>  v;
+    std::string         line;
+    std::string         key;
+    std::string         value;
+    bool                open = false;
+    unsigned            n    = 0u;
+
+
+    if (!in) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    while (std::getline(in, line)) {
+        std::string  t = Trim(line);
+
+
+        n++;
+        if ((t.size() > 1u) && (t[0] == '%') && (Trim(t.substr(1u)).compare(0u, 8u, "plotgen:") == 0)) {
+            v.emplace_back();
+            v.back().Where = path + ":" + std::to_string(n);
+            v.back().Out   = Trim(Trim(t.substr(1u)).substr(8u));
+            open           = true;
+            continue;
+        }
+        if (!open || !KeyValue(line, key, value)) {
+            open = false;
+            continue;
+        }
+        if      (key == "domain")  { v.back().Domain  = value; }
+        else if (key == "samples") { v.back().Samples = std::strtoull(value.c_str(), nullptr, 0); }
+        else if (key == "spacing") { v.back().Log     = (value == "log"); }
+        else                       { v.back().Cols.push_back({ key, value }); }
+    }
+    return (v);
+}
+
+static  bool  UpToDate (const Block &b)
+{
+    std::ifstream  in(b.Out);
+    std::string    first;
+
+
+    return (in && std::getline(in, first) && (first == "# plotgen " + b.Spec()));
+}
+
+
+/*
+*********************************************************************************************************
+*                                            EVALUATION
+*
+* Description : Each thread evaluates and formats a contiguous run of samples into its own text; the
+*               runs are then written in order.
+*********************************************************************************************************
+*/
+
+static  void  Generate (const Block &b, const Options &o)
+{
+    std::vector<Expr>         cols;
+    std::vector<std::string>  text;
+    std::vector<std::thread>  pool;
+    size_t                    colon = b.Domain.find(':');
+    double                    lo;
+    double                    hi;
+    unsigned                  nt;
+
+
+    if ((colon == std::string::npos) || b.Cols.empty() || (b.Samples < 2u) || b.Out.empty()) {
+        throw std::runtime_error(b.Where + ": needs a file, 'domain = a : b', samples >= 2 and a column");
+    }
+    lo = Expr(b.Domain.substr(0u, colon)).Eval(0.0);
+    hi = Expr(b.Domain.substr(colon + 1u)).Eval(0.0);
+    if (b.Log && !((lo > 0.0) && (hi > 0.0))) {
+        throw std::runtime_error(b.Where + ": a log spacing needs a positive domain");
+    }
+    for (const Column &c : b.Cols) {
+        cols.emplace_back(c.Text);
+    }
+
+    nt = (unsigned)std::max<uint64_t>(1u, std::min<uint64_t>(o.Threads, b.Samples / 4096u));
+    text.resize(nt);
+    for (unsigned t = 0u; t < nt; t++) {
+        pool.emplace_back([&, t]() {
+            uint64_t     first = b.Samples * t / nt;
+            uint64_t     last  = b.Samples * (t + 1u) / nt;
+            double       a     = b.Log ? std::log(lo) : lo;
+            double       step  = ((b.Log ? std::log(hi) : hi) - a) / (double)(b.Samples - 1u);
+            char         buf[40];
+            std::string &s     = text[t];
+
+
+            s.reserve((size_t)(last - first) * (size_t)(cols.size() + 1u) * (size_t)(o.Digits + 8));
+            for (uint64_t i = first; i < last; i++) {
+                double  x = (i == 0u)              ? lo :
+                            (i == b.Samples - 1u)  ? hi :
+                            b.Log ? std::exp(a + step * (double)i) : a + step * (double)i;
+
+
+                s.append(buf, (size_t)std::snprintf(buf, sizeof(buf), "%.*g", o.Digits, x));
+                for (const Expr &e : cols) {
+                    s.append(buf, (size_t)std::snprintf(buf, sizeof(buf), " %.*g", o.Digits, e.Eval(x)));
+                }
+                s += '\n';
+            }
+        });
+    }
+    for (std::thread &th : pool) {
+        th.join();
+    }
+
+    std::filesystem::path  out(b.Out);
+    std::string            tmp = b.Out + ".tmp";
+    std::FILE             *f;
+
+
+    if (out.has_parent_path()) {
+        std::filesystem::create_directories(out.parent_path());
+    }
+    f = std::fopen(tmp.c_str(), "w");
+    if (f == nullptr) {
+        throw std::runtime_error("cannot write " + tmp);
+    }
+    std::fprintf(f, "# plotgen %s\nx", b.Spec().c_str());
+    for (const Column &c : b.Cols) {
+        std::fprintf(f, " %s", c.Name.c_str());
+    }
+    std::fprintf(f, "\n");
+    for (const std::string &s : text) {
+        std::fwrite(s.data(), 1u, s.size(), f);
+    }
+    if (std::fclose(f) != 0) {
+        throw std::runtime_error("cannot write " + tmp);
+    }
+    std::filesystem::rename(tmp, out);                          /* A half-written file never looks up to date           */
+}
+
+
+int  main (int argc, char *argv[])
+{
+    Options  o     = ParseArgs(argc, argv);
+    unsigned stale = 0u;
+
+
+    try {
+        for (const std::string &tex : o.Tex) {
+            for (const Block &b : ReadBlocks(tex)) {
+                auto  t0 = std::chrono::steady_clock::now();
+
+
+                if (!o.Force && UpToDate(b)) {
+                    std::printf("%-28s up to date\n", b.Out.c_str());
+                    continue;
+                }
+                stale++;
+                if (o.Check) {
+                    std::printf("%-28s out of date (%s)\n", b.Out.c_str(), b.Where.c_str());
+                    continue;
+                }
+                Generate(b, o);
+                std::printf("%-28s %llu samples x %zu columns in %.1f ms\n", b.Out.c_str(),
+                            (unsigned long long)b.Samples, b.Cols.size(),
+                            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+            }
+        }
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "plotgen: %s\n", ex.what());
+        return (EXIT_FAILURE);
+    }
+    return ((o.Check && (stale > 0u)) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,652 @@
+/*
+*********************************************************************************************************
+*                                       INCREMENTAL DOCUMENT BUILD
+*
+* Description : texbuild [options] [<main.tex>]                                     Default: main.tex
+*
+*               Builds the report in steps meant to redo only what an edit changed:
+*
+*               1) The builds read cache/main-build.tex, a copy of main.tex written by BuildCopy(): the lines
+*                  that cannot go in a format (hyperref, cleveref, \synctex) are moved after a
+*                  '\csname endofdump\endcsname' at the end of the preamble, and the TikZ externalization is
+*                  turned on before '\begin{document}'. main.tex itself is not changed.
+*               2) The preamble, up to that line, is dumped once into a format (cache/preamble.fmt, with
+*                  the mylatexformat package) and loaded by every run instead of being read package by
+*                  package. A changed preamble dumps it again.
+*               3) The externalization is in its 'list and make' mode: each tikzpicture and circuitikz is a
+*                  PDF of its own, cache/main-figure<n>.pdf, and the runs write the list of them
+*                  (main.figlist).
+*               4) The figures missing or out of date are compiled in parallel, one pdflatex per figure.
+*                  A compiled figure is kept under the hash of its code (the .md5 file the externalization
+*                  writes), of the preamble and of the plot data in plots/, so a figure that only moved is
+*                  copied from cache/store/ rather than compiled again.
+*               5) The document is run again until its .aux no longer changes.
+*
+* Options     : --jobs <n>      Figures compiled at once.                         Default: all CPUs
+*               --tex <cmd>     Default: pdflatex
+*               --force         Dumps the format and compiles every figure again
+*               --bench         Times a plain build (pdflatex until the .aux settles, every figure
+*                               inline), then a cold texbuild (cache/ removed) and a second one. The
+*                               PDF of the plain build is kept as plain.pdf
+*
+* Build       : g++ -O2 -std=c++17 -o texbuild model/texbuild.cpp
+*
+* Note(s)     : 1) Run it, as LaTeX, from Main/. A plain 'pdflatex main.tex' builds the document as it
+*                  always did, figures inline; it is also the reference that --bench times.
+*               2) Needs the mylatexformat package (TeX Live: collection-latexextra).
+*               3) The logs of the figures are cache/main-figure<n>.log, the format's cache/preamble.log.
+*               4) The SyncTeX data of a texbuild run points into cache/main-build.tex, where the lines of
+*                  the document body are a few further down than in main.tex. Use a plain run for SyncTeX.
+*               5) Not yet run against a TeX installation, only with a stand-in TeX command: neither that
+*                  its PDF matches a plain build nor that it is faster has been checked. --bench is how to
+*                  find out.
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <cerrno>
+#include  <chrono>
+#include  <cstdint>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
+#include  <filesystem>
+#include  <fstream>
+#include  <sstream>
+#include  <stdexcept>
+#include  <string>
+#include  <thread>
+#include  <vector>
+
+#include  <fcntl.h>
+#include  <spawn.h>
+#include  <sys/wait.h>
+
+extern  char  **environ;
+
+namespace  fs = std::filesystem;
+
+
+/*
+*********************************************************************************************************
+*                                          LOCAL CONSTANTS
+*********************************************************************************************************
+*/
+
+constexpr int          kMaxRuns   = 5;                          /* Runs of the document before giving up on the .aux    */
+constexpr const char  *kCache     = "cache";                    /* The 'prefix' of \tikzexternalize in main.tex         */
+constexpr const char  *kEndOfDump = "\\csname endofdump\\endcsname";
+constexpr const char  *kBeginDoc  = "\\begin{document}";
+constexpr const char  *kExternal  = "\\usetikzlibrary{external}\n"
+                                    "\\tikzexternalize[prefix=cache/, mode=list and make]\n";
+
+static  const char    *const  kLate[] = {                      /* Preamble lines kept out of the format, see BuildCopy */
+    "\\usepackage[colorlinks]{hyperref}",
+    "\\usepackage{hyperref}",
+    "\\hypersetup",
+    "\\usepackage{cleveref}",
+    "\\synctex",
+};
+constexpr const char  *kPlots     = "plots";                    /* Data read by the figures, plotgen.cpp                */
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+struct  Options {
+    std::string   Main  = "main.tex";
+    std::string   Tex   = "pdflatex";
+    unsigned      Jobs  = 0u;
+    bool          Force = false;
+    bool          Bench = false;
+};
+
+struct  Stats {                                                 /* What one build did                                   */
+    bool          Format  = false;
+    unsigned      Runs    = 0u;
+    unsigned      Figures = 0u;
+    unsigned      Built   = 0u;                                 /* Compiled                                             */
+    unsigned      Reused  = 0u;                                 /* Copied from the store                                */
+    double        Secs    = 0.0;
+};
+
+struct  Figure {
+    std::string   Name;                                         /* cache/main-figure<n>, as in the .figlist             */
+    std::string   Key;
+    pid_t         Pid = 0;
+};
+
+
+/*
+*********************************************************************************************************
+*                                              OPTIONS
+*********************************************************************************************************
+*/
+
+static  void  Usage ()
+{
+    std::fprintf(stderr, "usage: texbuild [--jobs N] [--tex CMD] [--force] [--bench] [<main.tex>]\n");
+    std::exit(2);
+}
+
+static  Options  ParseArgs (int argc, char *argv[])
+{
+    Options  o;
+
+
+    for (int i = 1; i < argc; i++) {
+        std::string  a    = argv[i];
+        const char  *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+
+        if      (a == "--force") { o.Force = true; continue; }
+        else if (a == "--bench") { o.Bench = true; continue; }
+        else if ((a.size() < 2u) || (a.compare(0u, 2u, "--") != 0)) {
+            o.Main = a;
+            continue;
+        }
+        if (next == nullptr) {
+            Usage();
+        }
+        i++;
+        if      (a == "--jobs") { o.Jobs = (unsigned)std::strtoul(next, nullptr, 0); }
+        else if (a == "--tex")  { o.Tex  = next; }
+        else                    { Usage(); }
+    }
+    if (o.Jobs == 0u) {
+        o.Jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return (o);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          FILES AND HASHES
+*********************************************************************************************************
+*/
+
+static  bool  ReadFile (const std::string &path, std::string &text)
+{
+    std::ifstream       in(path, std::ios::binary);
+    std::ostringstream  s;
+
+
+    if (!in) {
+        return (false);
+    }
+    s << in.rdbuf();
+    text = s.str();
+    return (true);
+}
+
+static  void  WriteFile (const std::string &path, const std::string &text)
+{
+    std::ofstream  out(path, std::ios::binary | std::ios::trunc);
+
+
+    if (!(out << text)) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+static  uint64_t  Fnv (const std::string &text, uint64_t h = 14695981039346656037ull)
+{
+    for (unsigned char c : text) {                              /* FNV-1a: a cache key, not a guard against tampering   */
+        h = (h ^ c) * 1099511628211ull;
+    }
+    return (h);
+}
+
+static  std::string  Hex (uint64_t h)
+{
+    char  buf[20];
+
+
+    std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
+    return (buf);
+}
+
+static  std::string  FileHash (const std::string &path)         /* Empty when the file does not exist                   */
+{
+    std::string  text;
+
+
+    return (ReadFile(path, text) ? Hex(Fnv(text)) : std::string());
+}
+
+static  uint64_t  DataHash ()                                   /* Every file of plots/, in name order                  */
+{
+    std::vector<std::string>  names;
+    std::error_code           ec;
+    uint64_t                  h = Fnv("");
+
+
+    for (const fs::directory_entry &d : fs::directory_iterator(kPlots, ec)) {
+        if (d.is_regular_file()) {
+            names.push_back(d.path().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    for (const std::string &n : names) {
+        std::string  text;
+
+
+        ReadFile(n, text);
+        h = Fnv(text, Fnv(n, h));
+    }
+    return (h);
+}
+
+static  double  Since (std::chrono::steady_clock::time_point t0)
+{
+    return (std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+}
+
+
+/*
+*********************************************************************************************************
+*                                             BUILD COPY
+*
+* Description : The text of main.tex with the preamble lines of kLate, and the lines that close their
+*               braces (\hypersetup{...}), moved after an added '\csname endofdump\endcsname' at the end of
+*               the preamble. hyperref patches commands at \begin{document} and cleveref after it, which a
+*               format does not keep, and \synctex is not dumped either. kExternal follows.
+*********************************************************************************************************
+*/
+
+static  int  Braces (const std::string &line)                   /* Opened minus closed, comment excluded                */
+{
+    int  depth = 0;
+
+
+    for (size_t i = 0u; i < line.size(); i++) {
+        if (line[i] == '\\') {
+            i++;
+        } else if (line[i] == '%') {
+            break;
+        } else if (line[i] == '{') {
+            depth++;
+        } else if (line[i] == '}') {
+            depth--;
+        }
+    }
+    return (depth);
+}
+
+static  bool  IsLate (const std::string &line)
+{
+    size_t  b = line.find_first_not_of(" \t");
+
+
+    for (const char *p : kLate) {
+        if ((b != std::string::npos) && (line.compare(b, std::strlen(p), p) == 0)) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+static  std::string  BuildCopy (const std::string &text, const std::string &main)
+{
+    size_t              begin = text.find(kBeginDoc);
+    std::istringstream  in(text.substr(0u, (begin == std::string::npos) ? 0u : begin));
+    std::string         dumped;
+    std::string         late;
+    std::string         line;
+    int                 depth = 0;
+
+
+    if ((begin == std::string::npos) || (text.find(kEndOfDump) != std::string::npos)) {
+        throw std::runtime_error(main + ": needs a \\begin{document} and no " + kEndOfDump + " of its own");
+    }
+    while (std::getline(in, line)) {
+        if ((depth > 0) || IsLate(line)) {
+            late  += line + "\n";
+            depth += Braces(line);
+        } else {
+            dumped += line + "\n";
+        }
+    }
+    return (dumped + kEndOfDump + "\n" + late + kExternal + text.substr(begin));
+}
+
+
+/*
+*********************************************************************************************************
+*                                             PROCESSES
+*
+* Description : TeX runs in batch mode with its terminal output discarded; its .log has the messages.
+*********************************************************************************************************
+*/
+
+static  pid_t  Spawn (const std::vector<std::string> &args)
+{
+    std::vector<char *>         argv;
+    posix_spawn_file_actions_t  fa;
+    pid_t                       pid;
+    int                         err;
+
+
+    for (const std::string &a : args) {
+        argv.push_back(const_cast<char *>(a.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_addopen(&fa, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&fa, 1, "/dev/null", O_WRONLY, 0);
+    err = posix_spawnp(&pid, argv[0], &fa, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&fa);
+    if (err != 0) {
+        throw std::runtime_error("cannot run " + args[0]);
+    }
+    return (pid);
+}
+
+static  bool  Wait (pid_t pid)
+{
+    int  status;
+
+
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return (false);
+        }
+    }
+    return (WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+static  void  Run (const std::vector<std::string> &args, const std::string &log)
+{
+    if (!Wait(Spawn(args))) {
+        throw std::runtime_error(args[0] + " failed, see " + log);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                              BUILD
+*********************************************************************************************************
+*/
+
+class  Build {
+public:
+                  Build  (const Options &o);
+
+    Stats         Go     ();
+    Stats         Plain  ();                                    /* The --bench reference                                */
+
+private:
+    bool          Format ();
+    void          Document (bool externalize, const std::string &job);
+    void          Figures ();
+
+    const Options &Opt_;
+    std::string    Job_;                                        /* main, for main.tex                                   */
+    std::string    Src_;                                        /* cache/main-build.tex, what the builds read           */
+    std::string    Copy_;                                       /* Its text                                             */
+    std::string    Fmt_;
+    std::string    Preamble_;                                   /* Hash of the dumped part of main.tex                  */
+    Stats          Stats_;
+};
+
+Build::Build (const Options &o) : Opt_(o)
+{
+    std::string  text;
+
+
+    if (!ReadFile(o.Main, text)) {
+        throw std::runtime_error("cannot read " + o.Main);
+    }
+    Job_      = fs::path(o.Main).stem().string();
+    Src_      = std::string(kCache) + "/" + Job_ + "-build.tex";
+    Copy_     = BuildCopy(text, o.Main);
+    Fmt_      = std::string("./") + kCache + "/preamble";
+    Preamble_ = Hex(Fnv(Opt_.Tex, Fnv(Copy_.substr(0u, Copy_.find(kEndOfDump)))));
+}
+
+bool  Build::Format ()
+{
+    std::string  key  = Fmt_ + ".key";
+    std::string  prev;
+
+
+    if (!Opt_.Force && fs::exists(Fmt_ + ".fmt") && ReadFile(key, prev) && (prev == Preamble_)) {
+        return (false);
+    }
+    fs::remove(key);
+    Run({ Opt_.Tex, "-ini", "-interaction=batchmode", "-halt-on-error", "-jobname=" + Fmt_.substr(2u),
+          "&" + Opt_.Tex, "mylatexformat.ltx", Src_ }, Fmt_.substr(2u) + ".log");
+    WriteFile(key, Preamble_);
+    return (true);
+}
+
+void  Build::Document (bool externalize, const std::string &job)
+{
+    std::vector<std::string>  args = { Opt_.Tex, "-interaction=batchmode", "-halt-on-error", "-jobname=" + job };
+
+
+    if (externalize) {
+        args.push_back("-fmt=" + Fmt_);
+        args.push_back("\\input{" + Src_ + "}");
+    } else {
+        args.push_back(Opt_.Main);
+    }
+    Run(args, job + ".log");
+    Stats_.Runs++;
+}
+
+
+/*
+*********************************************************************************************************
+*                                              FIGURES
+*
+* Description : A figure is up to date when cache/<figure>.key holds its key. Otherwise it is copied
+*               from cache/store/<key>.pdf, or compiled, at most --jobs at a time, and then stored.
+*********************************************************************************************************
+*/
+
+void  Build::Figures ()
+{
+    std::ifstream        list(Job_ + ".figlist");
+    std::vector<Figure>  todo;
+    std::string          line;
+    std::string          data  = Hex(DataHash());
+    fs::path             store = fs::path(kCache) / "store";
+    size_t               next  = 0u;
+    unsigned             busy  = 0u;
+    bool                 ok    = true;
+
+
+    fs::create_directories(store);
+    while (std::getline(list, line)) {
+        Figure       f;
+        std::string  md5 = FileHash(line + ".md5");
+        std::string  prev;
+
+
+        if (line.empty()) {
+            continue;
+        }
+        Stats_.Figures++;
+        f.Name = line;
+        f.Key  = md5.empty() ? std::string() : Hex(Fnv(Preamble_ + md5 + data));
+        if (!Opt_.Force && !f.Key.empty() && fs::exists(f.Name + ".pdf") &&
+            ReadFile(f.Name + ".key", prev) && (prev == f.Key)) {
+            continue;
+        }
+        if (!Opt_.Force && !f.Key.empty() && fs::exists(store / (f.Key + ".pdf"))) {
+            for (const char *ext : { ".pdf", ".dpth" }) {
+                if (fs::exists(store / (f.Key + ext))) {
+                    fs::copy_file(store / (f.Key + ext), f.Name + ext, fs::copy_options::overwrite_existing);
+                }
+            }
+            WriteFile(f.Name + ".key", f.Key);
+            Stats_.Reused++;
+            continue;
+        }
+        fs::remove(f.Name + ".key");
+        todo.push_back(f);
+    }
+
+    while ((next < todo.size()) || (busy > 0u)) {
+        if (ok && (next < todo.size()) && (busy < Opt_.Jobs)) {
+            Figure  &f = todo[next++];
+
+
+            f.Pid = Spawn({ Opt_.Tex, "-fmt=" + Fmt_, "-interaction=batchmode", "-halt-on-error",
+                            "-jobname=" + f.Name,
+                            "\\def\\tikzexternalrealjob{" + Job_ + "}\\input{" + Src_ + "}" });
+            busy++;
+            continue;
+        }
+        if (!ok && (busy == 0u)) {
+            break;
+        }
+
+        int    status;
+        pid_t  pid = waitpid(-1, &status, 0);
+
+
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("lost track of the figure jobs");
+        }
+        busy--;
+        for (Figure &f : todo) {
+            if (f.Pid != pid) {
+                continue;
+            }
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+                std::fprintf(stderr, "texbuild: %s failed, see %s.log\n", f.Name.c_str(), f.Name.c_str());
+                ok = false;
+                break;
+            }
+            Stats_.Built++;
+            if (f.Key.empty()) {                                /* First build: the run has just written the .md5       */
+                std::string  md5 = FileHash(f.Name + ".md5");
+
+
+                f.Key = md5.empty() ? std::string() : Hex(Fnv(Preamble_ + md5 + data));
+            }
+            if (!f.Key.empty()) {
+                for (const char *ext : { ".pdf", ".dpth" }) {
+                    if (fs::exists(f.Name + ext)) {
+                        fs::copy_file(f.Name + ext, store / (f.Key + ext), fs::copy_options::overwrite_existing);
+                    }
+                }
+                WriteFile(f.Name + ".key", f.Key);
+            }
+        }
+    }
+    if (!ok) {
+        throw std::runtime_error("figures failed");
+    }
+}
+
+Stats  Build::Go ()
+{
+    auto         t0  = std::chrono::steady_clock::now();
+    std::string  aux = Job_ + ".aux";
+    std::string  before;
+
+
+    Stats_ = Stats();
+    fs::create_directories(kCache);
+    if (!ReadFile(Src_, before) || (before != Copy_)) {         /* Left alone when unchanged                            */
+        WriteFile(Src_, Copy_);
+    }
+    Stats_.Format = Format();
+    for (;;) {                                                  /* Until neither the .aux nor a figure changes          */
+        unsigned  built;
+
+
+        before = FileHash(aux);
+        Document(true, Job_);
+        built  = Stats_.Built + Stats_.Reused;
+        if (Stats_.Runs == 1u) {
+            Figures();
+        }
+        if ((FileHash(aux) == before) && ((Stats_.Built + Stats_.Reused) == built)) {
+            break;
+        }
+        if (Stats_.Runs >= (unsigned)kMaxRuns) {
+            std::fprintf(stderr, "texbuild: %s still changes after %d runs\n", aux.c_str(), kMaxRuns);
+            break;
+        }
+    }
+    Stats_.Secs = Since(t0);
+    return (Stats_);
+}
+
+Stats  Build::Plain ()
+{
+    auto         t0  = std::chrono::steady_clock::now();
+    std::string  job = std::string(kCache) + "/plain";
+    std::string  before;
+
+
+    Stats_ = Stats();
+    fs::create_directories(kCache);
+    do {
+        before = FileHash(job + ".aux");
+        Document(false, job);
+    } while ((FileHash(job + ".aux") != before) && (Stats_.Runs < (unsigned)kMaxRuns));
+    Stats_.Secs = Since(t0);
+    return (Stats_);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               MAIN
+*********************************************************************************************************
+*/
+
+static  void  Print (const char *what, const Stats &s)
+{
+    std::printf("%-26s %7.2f s   %u runs", what, s.Secs, s.Runs);
+    if (s.Format) {
+        std::printf(", format dumped");
+    }
+    if (s.Figures > 0u) {
+        std::printf(", %u figures: %u compiled, %u from the store", s.Figures, s.Built, s.Reused);
+    }
+    std::printf("\n");
+}
+
+int  main (int argc, char *argv[])
+{
+    Options  o = ParseArgs(argc, argv);
+
+
+    try {
+        Build  b(o);
+
+
+        if (!o.Bench) {
+            Print("texbuild", b.Go());
+            return (EXIT_SUCCESS);
+        }
+        Stats  plain = b.Plain();
+        Print("plain pdflatex", plain);
+        fs::rename(std::string(kCache) + "/plain.pdf", "plain.pdf");  /* Kept to compare with the texbuild PDF    */
+        fs::remove_all(kCache);
+        Stats  cold  = b.Go();
+        Print("texbuild, cold cache", cold);
+        Stats  warm  = b.Go();
+        Print("texbuild, no change", warm);
+        std::printf("%-26s %7.1f x\n", "speedup, no change", plain.Secs / std::max(warm.Secs, 1e-3));
+        std::printf("%-26s plain.pdf against %s.pdf\n", "compare the output", fs::path(o.Main).stem().c_str());
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "texbuild: %s\n", ex.what());
+        return (EXIT_FAILURE);
+    }
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,427 @@
+/*
+*********************************************************************************************************
+*                                      OFFLINE TRIGGER ANALYSIS
+*
+*                                           Command line
+*
+* Description : trigscan scan <capture> [options]    Trigger points, periods and jitter of a capture
+*               trigscan gen  <spec> <samples> <capture> [--noise <lsb>] [--seed <n>]
+*                                                   Writes a capture from an apmodel source spec
+*
+*               A capture is a raw file of little-endian 16-bit codes, one per conversion, of which the
+*               12 LSBs are used (the format of apmodel --source file:).
+*
+* Options     : --level <0..511>      trigger_value                                      Default: 256
+*               --level12 <0..4095>   Level of the fine and hyst rules.  Default: the 12-bit code at which
+*                                     the 9-bit test switches, (level + 1) * 8 rising, level * 8 - 1 falling
+*               --hyst <lsb>          Hysteresis of the hyst rule                        Default: 16
+*               --falling             Falling slope
+*               --hscale <0..3>       Decimation used for the FPGA 'period'               Default: 0
+*               --vscale <0..3>       Only used by --hw
+*               --rules <list>        fpga,noguard,fine,hyst                              Default: all
+*               --isa <name>          auto | scalar | sse2 | avx2                         Default: auto
+*               --threads <n>         Default: all CPUs
+*               --repeat <n>          Scans the capture n times, for the throughput figure
+*               --list                Prints every trigger point as CSV: rule,index,time,hw_period
+*               --verify              Checks that every kernel gives the same events
+*               --hw                  Also runs the golden model over the capture (from conversion 0,
+*                                     vsync included) and checks its sweeps against the fpga rule
+*
+* Build       : g++ -O2 -std=c++17 -pthread -o trigscan model/trigscan.cpp model/ap_scan.cpp model/ap_model.cpp
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <chrono>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
+#include  <memory>
+#include  <random>
+#include  <stdexcept>
+#include  <string>
+#include  <thread>
+#include  <vector>
+
+#include  "ap_model.hpp"
+#include  "ap_scan.hpp"
+
+using  namespace  ap;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+struct  Options {
+    std::string            Capture;
+    ScanLevels             Lv;
+    bool                   Level12Set = false;
+    uint8_t                HScale     = 0u;
+    uint8_t                VScale     = 0u;
+    std::vector<ScanRule>  Rules      = { ScanRule::Fpga, ScanRule::NoGuard, ScanRule::Fine, ScanRule::Hyst };
+    ScanIsa                Isa        = ScanIsa::Auto;
+    unsigned               Threads    = 0u;
+    unsigned               Repeat     = 1u;
+    bool                   List       = false;
+    bool                   Verify     = false;
+    bool                   Hw         = false;
+};
+
+class  MappedSource : public Source {                           /* The capture as an apmodel source                     */
+public:
+    MappedSource (const uint16_t *x, uint64_t n) : X_(x), N_(n) {}
+
+    void  Fill (uint64_t first, uint16_t *codes, size_t count) override
+    {
+        for (size_t i = 0u; i < count; i++) {
+            codes[i] = X_[(first + i) % N_] & 0xFFFu;
+        }
+    }
+
+private:
+    const uint16_t  *X_;
+    uint64_t         N_;
+};
+
+class  SweepLog : public Observer {                             /* Trigger sample and measured period of every sweep    */
+public:
+    void  OnWrite (uint64_t edge, uint16_t addr, uint16_t data) override
+    {
+        (void)data;
+        if (addr == 0u) {                                       /* Fired 2 edges earlier, on the pair held since the    */
+            uint64_t  fire = edge - 2u;                         /* ... last sample_ready                                */
+
+
+            Index.push_back((fire - kReadyEdge - 1u) / kConvCycles);
+            Period.push_back(-1);
+        }
+    }
+    void  OnPeriod (uint64_t edge, uint16_t period) override
+    {
+        (void)edge;
+        if (!Period.empty()) {
+            Period.back() = period;
+        }
+    }
+
+    std::vector<uint64_t>  Index;
+    std::vector<int32_t>   Period;
+};
+
+
+/*
+*********************************************************************************************************
+*                                             OPTIONS
+*********************************************************************************************************
+*/
+
+static  void  Usage ()
+{
+    std::fprintf(stderr, "usage: trigscan scan <capture> [--level L] [--level12 L12] [--hyst H] [--falling]\n"
+                         "                     [--hscale H] [--vscale V] [--rules fpga,noguard,fine,hyst]\n"
+                         "                     [--isa auto|scalar|sse2|avx2] [--threads N] [--repeat N]\n"
+                         "                     [--list] [--verify] [--hw]\n"
+                         "       trigscan gen <tb|sine:HZ[:AMP[:MID]]|file:PATH> <samples> <capture> [--noise LSB] [--seed N]\n");
+    std::exit(2);
+}
+
+static  ScanIsa  ParseIsa (const std::string &s)
+{
+    if (s == "scalar") return (ScanIsa::Scalar);
+    if (s == "sse2")   return (ScanIsa::Sse2);
+    if (s == "avx2")   return (ScanIsa::Avx2);
+    if (s == "auto")   return (ScanIsa::Auto);
+    Usage();
+    return (ScanIsa::Auto);
+}
+
+static  std::vector<ScanRule>  ParseRules (const std::string &s)
+{
+    std::vector<ScanRule>  r;
+    size_t                 b = 0u;
+
+
+    while (b <= s.size()) {
+        size_t       e    = s.find(',', b);
+        std::string  name = s.substr(b, (e == std::string::npos) ? std::string::npos : e - b);
+
+
+        if      (name == "fpga")    r.push_back(ScanRule::Fpga);
+        else if (name == "noguard") r.push_back(ScanRule::NoGuard);
+        else if (name == "fine")    r.push_back(ScanRule::Fine);
+        else if (name == "hyst")    r.push_back(ScanRule::Hyst);
+        else                        Usage();
+        if (e == std::string::npos) {
+            break;
+        }
+        b = e + 1u;
+    }
+    return (r);
+}
+
+static  Options  ParseScan (int argc, char *argv[])
+{
+    Options  o;
+
+
+    if (argc < 3) {
+        Usage();
+    }
+    o.Capture = argv[2];
+    for (int i = 3; i < argc; i++) {
+        std::string  a    = argv[i];
+        const char  *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+
+        if      (a == "--falling") { o.Lv.Rising = false; continue; }
+        else if (a == "--list")    { o.List      = true;  continue; }
+        else if (a == "--verify")  { o.Verify    = true;  continue; }
+        else if (a == "--hw")      { o.Hw        = true;  continue; }
+        if (next == nullptr) {
+            Usage();
+        }
+        i++;
+        if      (a == "--level")   { o.Lv.Level   = (uint16_t)(std::strtoul(next, nullptr, 0) & 0x1FFu); }
+        else if (a == "--level12") { o.Lv.Level12 = (uint16_t)(std::strtoul(next, nullptr, 0) & 0xFFFu); o.Level12Set = true; }
+        else if (a == "--hyst")    { o.Lv.Hyst    = (uint16_t)std::strtoul(next, nullptr, 0); }
+        else if (a == "--hscale")  { o.HScale     = (uint8_t)(std::strtoul(next, nullptr, 0) & 3u); }
+        else if (a == "--vscale")  { o.VScale     = (uint8_t)(std::strtoul(next, nullptr, 0) & 3u); }
+        else if (a == "--rules")   { o.Rules      = ParseRules(next); }
+        else if (a == "--isa")     { o.Isa        = ParseIsa(next); }
+        else if (a == "--threads") { o.Threads    = (unsigned)std::strtoul(next, nullptr, 0); }
+        else if (a == "--repeat")  { o.Repeat     = (unsigned)std::strtoul(next, nullptr, 0); }
+        else                       { Usage(); }
+    }
+    if (!o.Level12Set) {
+        o.Lv.Level12 = o.Lv.Rising ? (uint16_t)((o.Lv.Level + 1u) * 8u) : (uint16_t)((o.Lv.Level == 0u) ? 0u : o.Lv.Level * 8u - 1u);
+        if (o.Lv.Level12 > 4095u) {
+            o.Lv.Level12 = 4095u;
+        }
+    }
+    if (o.Threads == 0u) {
+        o.Threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (o.Repeat == 0u) {
+        o.Repeat = 1u;
+    }
+    return (o);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               GEN
+*********************************************************************************************************
+*/
+
+static  int  ModeGen (int argc, char *argv[])
+{
+    double        noise = 0.0;
+    unsigned      seed  = 1u;
+    uint64_t      n;
+    std::FILE    *f;
+
+
+    if (argc < 5) {
+        Usage();
+    }
+    for (int i = 5; i + 1 < argc; i += 2) {
+        if      (std::strcmp(argv[i], "--noise") == 0) { noise = std::strtod(argv[i + 1], nullptr); }
+        else if (std::strcmp(argv[i], "--seed")  == 0) { seed  = (unsigned)std::strtoul(argv[i + 1], nullptr, 0); }
+        else                                           { Usage(); }
+    }
+
+    std::unique_ptr<Source>           src(MakeSource(argv[2]));
+    std::mt19937                      rng(seed);
+    std::normal_distribution<double>  gauss(0.0, (noise > 0.0) ? noise : 1.0);
+    std::vector<uint16_t>             buf(65536u);
+
+
+    n = std::strtoull(argv[3], nullptr, 0);
+    f = std::fopen(argv[4], "wb");
+    if (f == nullptr) {
+        throw std::runtime_error(std::string("cannot write ") + argv[4]);
+    }
+    for (uint64_t first = 0u; first < n; first += buf.size()) {
+        size_t  cnt = (size_t)std::min<uint64_t>(buf.size(), n - first);
+
+
+        src->Fill(first, buf.data(), cnt);
+        if (noise > 0.0) {
+            for (size_t i = 0u; i < cnt; i++) {
+                long  v = std::lround((double)buf[i] + gauss(rng));
+
+
+                buf[i] = (uint16_t)std::min(4095L, std::max(0L, v));
+            }
+        }
+        std::fwrite(buf.data(), sizeof(uint16_t), cnt, f);        /* Little-endian host                                   */
+    }
+    std::fclose(f);
+    return (EXIT_SUCCESS);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               SCAN
+*********************************************************************************************************
+*/
+
+static  bool  Verify (const MappedCodes &cap, const Options &o, const std::vector<ScanEvent> &ref)
+{
+    ScanIsa  isas[] = { ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2 };
+    bool     ok     = true;
+
+
+    for (ScanIsa isa : isas) {
+        std::vector<ScanEvent>  ev;
+        size_t                  bad = 0u;
+
+
+        if ((isa == ScanIsa::Avx2) && (ScanBest() != ScanIsa::Avx2)) {
+            continue;
+        }
+        if ((isa == ScanIsa::Sse2) && (ScanBest() == ScanIsa::Scalar)) {
+            continue;
+        }
+        ScanBlock(isa, cap.Data(), 1u, cap.Size(), o.Lv, ev);
+        if (ev.size() != ref.size()) {
+            bad = std::max(ev.size(), ref.size());
+        } else {
+            for (size_t i = 0u; i < ev.size(); i++) {
+                bad += (ev[i].Index != ref[i].Index) || (ev[i].Kinds != ref[i].Kinds);
+            }
+        }
+        std::printf("verify %-7s: %zu events, %zu differ\n", ScanIsaName(isa), ev.size(), bad);
+        ok &= (bad == 0u);
+    }
+    return (ok);
+}
+
+static  bool  CheckHw (const MappedCodes &cap, const Options &o, const std::vector<ScanTrigger> &fpga)
+{
+    MappedSource  src(cap.Data(), cap.Size());
+    Pipeline      p(Init::Zero);
+    Settings      s;
+    SweepLog      log;
+    size_t        missing = 0u;
+    size_t        wrong   = 0u;
+
+
+    s.Level  = o.Lv.Level;
+    s.Rising = o.Lv.Rising;
+    s.VScale = o.VScale;
+    s.HScale = o.HScale;
+    s.TripleBuffer = true;                                      /* Re-armed after each sweep: the rules ignore vsync    */
+    p.Set(s);
+    p.Run(src, cap.Size(), &log);
+
+    for (size_t k = 0u; k < log.Index.size(); k++) {
+        auto  it = std::lower_bound(fpga.begin(), fpga.end(), log.Index[k],
+                                    [](const ScanTrigger &t, uint64_t i) { return (t.Index < i); });
+
+
+        if ((it == fpga.end()) || (it->Index != log.Index[k])) {
+            missing++;
+        } else if ((k + 1u < log.Index.size()) && (it->HwPeriod != log.Period[k])) {
+            wrong++;                                            /* The last sweep may be cut by the end of the capture  */
+        }
+    }
+    std::printf("hw             : %zu sweeps in %.3f s, %zu not at an fpga trigger point, %zu with another period\n",
+                log.Index.size(), (double)p.Edge() / kClkHz, missing, wrong);
+    return ((missing == 0u) && (wrong == 0u));
+}
+
+static  int  ModeScan (int argc, char *argv[])
+{
+    Options                 o = ParseScan(argc, argv);
+    MappedCodes             cap(o.Capture);
+    std::vector<ScanEvent>  ev;
+    ScanIsa                 isa   = (o.Isa == ScanIsa::Auto) ? ScanBest() : o.Isa;
+    double                  us    = 1e6 * kConvCycles / kClkHz;    /* One sample                                          */
+    double                  best  = 0.0;
+    bool                    ok    = true;
+
+
+    for (unsigned r = 0u; r < o.Repeat; r++) {
+        ev.clear();
+        auto    t0 = std::chrono::steady_clock::now();
+        ScanRange(isa, cap.Data(), cap.Size(), o.Lv, o.Threads, ev);
+        double  s  = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if ((r == 0u) || (s < best)) {
+            best = s;
+        }
+    }
+
+    std::printf("capture        : %s, %llu samples (%.1f MB, %.3f s at %.4f MS/s)\n", o.Capture.c_str(),
+                (unsigned long long)cap.Size(), cap.Size() * 2.0 / 1e6, cap.Size() * us / 1e6, 1.0 / us);
+    std::printf("levels         : %s, level %u, level12 %u, hyst %u, hscale %u\n", o.Lv.Rising ? "rising" : "falling",
+                (unsigned)o.Lv.Level, (unsigned)o.Lv.Level12, (unsigned)o.Lv.Hyst, (unsigned)o.HScale);
+    std::printf("scan           : %s x %u threads, %.3f ms, %.2f GB/s, %zu events\n", ScanIsaName(isa), o.Threads,
+                best * 1e3, cap.Size() * 2.0 / best / 1e9, ev.size());
+    if (o.Verify) {
+        ok &= Verify(cap, o, ev);
+    }
+
+    std::printf("\n%-8s %10s %12s %12s %12s %10s %10s %10s   %s\n", "rule", "triggers", "period", "freq Hz",
+                "jitter ns", "min", "max", "p-p ns", "hw period min/avg/max");
+    std::vector<ScanTrigger>  fpga;
+    for (ScanRule rule : o.Rules) {
+        std::vector<ScanTrigger>  trig;
+        ScanStats                 st;
+
+
+        ScanTriggers(rule, cap.Data(), cap.Size(), o.Lv, o.HScale, ev, trig);
+        st = ScanSummary(trig);
+        std::printf("%-8s %10llu %12.3f %12.3f %12.1f %10.3f %10.3f %10.1f   ", ScanRuleName(rule),
+                    (unsigned long long)st.Triggers, st.IntervalAvg,
+                    (st.IntervalAvg > 0.0) ? 1e6 / (st.IntervalAvg * us) : 0.0, st.IntervalStd * us * 1e3,
+                    st.IntervalMin, st.IntervalMax, (st.IntervalMax - st.IntervalMin) * us * 1e3);
+        if (st.HwPeriods != 0u) {
+            std::printf("%d/%.2f/%d\n", st.HwPeriodMin, st.HwPeriodAvg, st.HwPeriodMax);
+        } else {
+            std::printf("-\n");
+        }
+        if (o.List) {
+            for (const ScanTrigger &t : trig) {
+                std::printf("%s,%llu,%.4f,%d\n", ScanRuleName(rule), (unsigned long long)t.Index, t.Time, t.HwPeriod);
+            }
+        }
+        if (rule == ScanRule::Fpga) {
+            fpga.swap(trig);
+        }
+    }
+    std::printf("(period, min, max in samples; jitter is the RMS deviation of the trigger-to-trigger time)\n");
+
+    if (o.Hw) {
+        if (fpga.empty()) {
+            ScanTriggers(ScanRule::Fpga, cap.Data(), cap.Size(), o.Lv, o.HScale, ev, fpga);
+        }
+        ok &= CheckHw(cap, o, fpga);
+    }
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    if (argc < 2) {
+        Usage();
+    }
+    try {
+        if (std::strcmp(argv[1], "scan") == 0) {
+            return (ModeScan(argc, argv));
+        }
+        if (std::strcmp(argv[1], "gen") == 0) {
+            return (ModeGen(argc, argv));
+        }
+        Usage();
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "trigscan: %s\n", ex.what());
+    }
+    return (EXIT_FAILURE);
+}
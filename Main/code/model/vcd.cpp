@@ -0,0 +1,243 @@
+/*
+*********************************************************************************************************
+*                                          VCD WAVEFORM READER
+*
+* Description : See vcd.hpp.
+*********************************************************************************************************
+*/
+
+#include  <cstdlib>
+#include  <cstring>
+#include  <stdexcept>
+#include  "vcd.hpp"
+
+
+namespace ap {
+
+/*
+*********************************************************************************************************
+*                                               HEADER
+*********************************************************************************************************
+*/
+
+bool  VcdReader::Token (std::string &tok)
+{
+    int  c;
+
+
+    tok.clear();
+    while (((c = std::fgetc(F_)) != EOF) && ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'))) {
+        ;
+    }
+    while ((c != EOF) && (c != ' ') && (c != '\t') && (c != '\r') && (c != '\n')) {
+        tok.push_back((char)c);
+        c = std::fgetc(F_);
+    }
+    return (!tok.empty());
+}
+
+VcdReader::VcdReader (const std::string &path)
+{
+    std::vector<std::string>  scope;
+    std::string               tok;
+
+
+    F_ = std::fopen(path.c_str(), "r");
+    if (F_ == nullptr) {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    while (Token(tok)) {
+        if (tok == "$scope") {
+            Token(tok);                                         /* Kind                                                 */
+            Token(tok);
+            scope.push_back(tok);
+            Token(tok);
+        } else if (tok == "$upscope") {
+            if (!scope.empty()) {
+                scope.pop_back();
+            }
+            Token(tok);
+        } else if (tok == "$var") {
+            Var          v;
+            std::string  name;
+
+
+            Token(tok);                                         /* Type                                                 */
+            Token(tok);
+            v.Width = (unsigned)std::strtoul(tok.c_str(), nullptr, 10);
+            Token(v.Code);
+            Token(name);
+            while (Token(tok) && (tok != "$end")) {             /* Optional bit range                                   */
+                ;
+            }
+            if (name.find('[') != std::string::npos) {
+                name.erase(name.find('['));
+            }
+            for (const std::string &s : scope) {
+                v.Name += s + ".";
+            }
+            v.Name += name;
+            Vars_.push_back(v);
+        } else if (tok == "$enddefinitions") {
+            Token(tok);
+            break;
+        } else if (tok[0] == '$') {                             /* $date, $version, $timescale, $comment             */
+            while (Token(tok) && (tok != "$end")) {
+                ;
+            }
+        }
+    }
+}
+
+VcdReader::~VcdReader ()
+{
+    std::free(Line_);
+    if (F_ != nullptr) {
+        std::fclose(F_);
+    }
+}
+
+int  VcdReader::Find (const std::string &name) const
+{
+    int  found = -1;
+
+
+    for (size_t i = 0u; i < Vars_.size(); i++) {
+        const std::string  &full = Vars_[i].Name;
+
+
+        if (full == name) {
+            return ((int)i);
+        }
+        if ((full.size() > name.size()) &&
+            (full.compare(full.size() - name.size(), name.size(), name) == 0) &&
+            (full[full.size() - name.size() - 1u] == '.')) {
+            if (found >= 0) {
+                return (-1);                                    /* Ambiguous                                            */
+            }
+            found = (int)i;
+        }
+    }
+    return (found);
+}
+
+int  VcdReader::Watch (const std::string &name)
+{
+    int  v = Find(name);
+    int  w;
+
+
+    if (v < 0) {
+        throw std::runtime_error("signal " + name + " not found (or not unique) in the VCD");
+    }
+    w = (int)Cur_.size();
+    Watched_[Vars_[(size_t)v].Code] = w;
+    Cur_.emplace_back();
+    Next_.emplace_back();
+    Dirty_.push_back(0u);
+    return (w);
+}
+
+
+/*
+*********************************************************************************************************
+*                                            VALUE CHANGES
+*********************************************************************************************************
+*/
+
+void  VcdReader::Change (const char *code, const char *val, size_t len)
+{
+    auto      it = Watched_.find(code);
+    VcdValue  v;
+
+
+    if (it == Watched_.end()) {
+        return;
+    }
+    v.Known = true;
+    for (size_t i = 0u; i < len; i++) {
+        v.Bits <<= 1;
+        if (val[i] == '1') {
+            v.Bits |= 1u;
+        } else if (val[i] != '0') {
+            v.Known = false;
+        }
+    }
+    Next_[(size_t)it->second] = v;
+    if (!Dirty_[(size_t)it->second]) {
+        Dirty_[(size_t)it->second] = 1u;
+        DirtyList_.push_back(it->second);
+    }
+}
+
+bool  VcdReader::ReadStep ()
+{
+    ssize_t  n;
+
+
+    if (!HaveNext_) {                                           /* Up to the first time stamp                           */
+        while ((n = getline(&Line_, &LineCap_, F_)) > 0) {
+            if (Line_[0] == '#') {
+                NextTime_ = std::strtoull(Line_ + 1, nullptr, 10);
+                HaveNext_ = true;
+                break;
+            }
+        }
+        if (!HaveNext_) {
+            return (false);
+        }
+    }
+
+    Time_     = NextTime_;
+    HaveNext_ = false;
+    while ((n = getline(&Line_, &LineCap_, F_)) > 0) {
+        char  *p = Line_;
+
+
+        while ((n > 0) && ((p[n - 1] == '\n') || (p[n - 1] == '\r') || (p[n - 1] == ' '))) {
+            p[--n] = '\0';
+        }
+        if (n == 0) {
+            continue;
+        }
+        switch (p[0]) {
+            case '#':
+                 NextTime_ = std::strtoull(p + 1, nullptr, 10);
+                 HaveNext_ = true;
+                 return (true);
+
+            case '$':                                           /* $dumpvars, $end, ...                                 */
+            case 'r':
+            case 'R':
+                 break;
+
+            case 'b':
+            case 'B': {
+                 char  *sp = std::strchr(p, ' ');
+
+
+                 if (sp != nullptr) {
+                     Change(sp + 1, p + 1, (size_t)(sp - p - 1));
+                 }
+                 break;
+            }
+
+            default:                                            /* Scalar: value character, then the code            */
+                 Change(p + 1, p, 1u);
+                 break;
+        }
+    }
+    return (true);
+}
+
+void  VcdReader::Apply ()
+{
+    for (int w : DirtyList_) {
+        Cur_[(size_t)w]   = Next_[(size_t)w];
+        Dirty_[(size_t)w] = 0u;
+    }
+    DirtyList_.clear();
+}
+
+}
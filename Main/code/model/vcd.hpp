@@ -0,0 +1,78 @@
+/*
+*********************************************************************************************************
+*                                          VCD WAVEFORM READER
+*
+* Description : Streaming reader of Value Change Dump files, as written by 'ghdl -r ... --vcd=<file>'.
+*               Only the signals passed to Watch() are decoded; the file is read once, one time step at
+*               a time, so its size does not matter.
+*
+*               ReadStep() loads the changes of the next time step without applying them: Value() still
+*               returns the values before the step, which are the ones a flip-flop samples on a clock
+*               edge of that step, and Next() the values after it. Apply() commits them.
+*
+* Note(s)     : Values other than 0 and 1 ('U', 'X', 'Z', ...) in any bit make the value unknown.
+*********************************************************************************************************
+*/
+
+#ifndef  VCD_HPP
+#define  VCD_HPP
+
+#include  <cstdint>
+#include  <cstdio>
+#include  <string>
+#include  <unordered_map>
+#include  <vector>
+
+
+namespace ap {
+
+struct VcdValue {
+    uint64_t  Bits  = 0u;
+    bool      Known = false;
+};
+
+class  VcdReader {
+public:
+    explicit             VcdReader (const std::string &path);
+                        ~VcdReader ();
+                         VcdReader (const VcdReader &) = delete;
+    VcdReader           &operator= (const VcdReader &) = delete;
+
+    int                  Find      (const std::string &name) const; /* Full dotted name, or a unique suffix; -1 if none */
+    int                  Watch     (const std::string &name);       /* Same, and decodes the signal; throws if absent   */
+
+    bool                 ReadStep  ();                              /* false at the end of the file                    */
+    void                 Apply     ();
+    uint64_t             Time      () const { return (Time_); }
+
+    const VcdValue      &Value     (int w) const { return (Cur_[w]); }
+    const VcdValue      &Next      (int w) const { return (Dirty_[w] ? Next_[w] : Cur_[w]); }
+    bool                 Changes   (int w) const { return (Dirty_[w] != 0u); }
+
+private:
+    struct  Var {
+        std::string  Name;
+        std::string  Code;
+        unsigned     Width;
+    };
+
+    bool                 Token     (std::string &tok);
+    void                 Change    (const char *code, const char *val, size_t len);
+
+    std::FILE                               *F_ = nullptr;
+    std::vector<Var>                         Vars_;
+    std::unordered_map<std::string, int>     Watched_;          /* Identifier code -> watch index                      */
+    std::vector<VcdValue>                    Cur_;
+    std::vector<VcdValue>                    Next_;
+    std::vector<uint8_t>                     Dirty_;
+    std::vector<int>                         DirtyList_;
+    uint64_t                                 Time_     = 0u;
+    uint64_t                                 NextTime_ = 0u;
+    bool                                     HaveNext_ = false;
+    char                                    *Line_     = nullptr;
+    size_t                                   LineCap_  = 0u;
+};
+
+}
+
+#endif
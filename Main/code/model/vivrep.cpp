@@ -0,0 +1,745 @@
+/*
+*********************************************************************************************************
+*                                       VIVADO REPORT ANALYSIS
+*
+*                                           Command line
+*
+* Description : vivrep show <report>... [--paths <n>] [--hist <ns>]
+*                                                   Summary, clocks, clock pairs and worst paths of a
+*                                                   timing report; resource table of a utilization report
+*               vivrep diff <old> <new> [--paths <n>] Build-to-build changes of two reports of one kind
+*               vivrep tex  <report>... [--paths <n>] [--out <file>]
+*                                                   LaTeX tables, in the style of chapters/Lab.tex
+*               vivrep cut  <timing> [<out>]        The summary part of a timing report, up to Timing
+*                                                   Details: what x_timing_report-cut.txt holds
+*
+*               The kind of a report is read from its banner (report_timing_summary or report_utilization).
+*
+* Options     : --paths <n>   Worst setup and hold paths listed.                          Default: 5
+*               --hist <ns>   Slack histograms of the setup and hold paths, bins of that width
+*               --out <file>  Default: standard output
+*
+* Exit codes  : 0, or 1 when a timing report given to show or diff (the new one) does not meet timing.
+*
+* Build       : g++ -O2 -std=c++17 -o vivrep model/vivrep.cpp model/ap_report.cpp
+*
+* Note(s)     : 1) Regenerate the tables of the report with, from Main/code:
+*                      vivrep tex x_timing_report.txt x_utilization.txt --out ../chapters/vivado.tex
+*********************************************************************************************************
+*/
+
+#include  <algorithm>
+#include  <chrono>
+#include  <cmath>
+#include  <cstdio>
+#include  <cstdlib>
+#include  <cstring>
+#include  <memory>
+#include  <stdexcept>
+#include  <string>
+#include  <vector>
+
+#include  "ap_report.hpp"
+
+using  namespace  ap;
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL TYPES
+*********************************************************************************************************
+*/
+
+struct  Options {
+    std::vector<std::string>  Files;
+    unsigned                  Paths = 5u;
+    double                    Hist  = 0.0;
+    std::string               Out;
+};
+
+struct  Loaded {                                                /* A report and the time it took to read                */
+    std::unique_ptr<Report>   Rpt;
+    double                    Ms;
+};
+
+typedef  std::string_view  SV;
+
+
+/*
+*********************************************************************************************************
+*                                             OPTIONS
+*********************************************************************************************************
+*/
+
+static  void  Usage ()
+{
+    std::fprintf(stderr, "usage: vivrep show <report>... [--paths N] [--hist NS]\n"
+                         "       vivrep diff <old report> <new report> [--paths N]\n"
+                         "       vivrep tex  <report>... [--paths N] [--out FILE]\n"
+                         "       vivrep cut  <timing report> [OUT]\n");
+    std::exit(2);
+}
+
+static  Options  ParseArgs (int argc, char *argv[])
+{
+    Options  o;
+
+
+    for (int i = 2; i < argc; i++) {
+        std::string  a    = argv[i];
+        const char  *next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+
+        if ((a.size() < 2u) || (a.compare(0u, 2u, "--") != 0)) {
+            o.Files.push_back(a);
+            continue;
+        }
+        if (next == nullptr) {
+            Usage();
+        }
+        i++;
+        if      (a == "--paths") { o.Paths = (unsigned)std::strtoul(next, nullptr, 0); }
+        else if (a == "--hist")  { o.Hist  = std::strtod(next, nullptr); }
+        else if (a == "--out")   { o.Out   = next; }
+        else                     { Usage(); }
+    }
+    if (o.Files.empty()) {
+        Usage();
+    }
+    return (o);
+}
+
+static  Loaded  Load (const std::string &path)
+{
+    auto    t0 = std::chrono::steady_clock::now();
+    Loaded  r;
+
+
+    r.Rpt.reset(new Report(path));
+    r.Ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return (r);
+}
+
+static  std::FILE  *OpenOut (const std::string &path)
+{
+    std::FILE  *f;
+
+
+    if (path.empty()) {
+        return (stdout);
+    }
+    f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    return (f);
+}
+
+static  std::string  Str (SV s)
+{
+    return (std::string(s.data(), s.size()));
+}
+
+static  std::string  Ns (double v)                              /* '0.650', '-' if blank, 'inf'                         */
+{
+    char  buf[32];
+
+
+    if (std::isnan(v)) {
+        return ("-");
+    }
+    std::snprintf(buf, sizeof(buf), "%.3f", v);
+    return (buf);
+}
+
+static  std::string  Count (double v)                           /* Endpoints: '4519', '-' if blank                      */
+{
+    char  buf[32];
+
+
+    if (std::isnan(v)) {
+        return ("-");
+    }
+    std::snprintf(buf, sizeof(buf), "%.0f", v);
+    return (buf);
+}
+
+static  bool  TimingMet (const Report &r)
+{
+    const TimingRow  &d = r.Design();
+
+
+    return (!(d.Wns < 0.0) && !(d.Whs < 0.0) && !(d.Wpws < 0.0));
+}
+
+static  std::vector<const TimingPath *>  Worst (const Report &r, bool max, unsigned n)
+{
+    std::vector<const TimingPath *>  v;
+
+
+    for (const TimingPath &p : r.Paths()) {
+        if ((p.Max == max) && std::isfinite(p.Slack)) {
+            v.push_back(&p);
+        }
+    }
+    std::stable_sort(v.begin(), v.end(), [](const TimingPath *a, const TimingPath *b) { return (a->Slack < b->Slack); });
+    if (v.size() > n) {
+        v.resize(n);
+    }
+    return (v);
+}
+
+static  bool  ResourceTable (const UtilTable &t)                /* Site Type | Used | Fixed | Available | Util%         */
+{
+    return ((t.Column("Used") >= 0) && (t.Column("Available") >= 0) && (t.Column("Util%") >= 0));
+}
+
+
+/*
+*********************************************************************************************************
+*                                               SHOW
+*********************************************************************************************************
+*/
+
+static  void  ShowHistogram (const Report &r, bool max, double bin)
+{
+    SlackHistogram  h    = ReportHistogram(r.Paths(), max, bin);
+    uint64_t        most = 1u;
+
+
+    std::printf("\n%s slack, %.3f ns bins\n", max ? "setup" : "hold", bin);
+    for (uint64_t n : h.Count) {
+        most = std::max(most, n);
+    }
+    for (size_t k = 0u; k < h.Count.size(); k++) {
+        int  bar = (int)((h.Count[k] * 50u + most - 1u) / most);
+
+
+        std::printf("  %8.3f .. %8.3f  %8llu  %.*s\n", h.Lo + (double)k * bin, h.Lo + (double)(k + 1u) * bin,
+                    (unsigned long long)h.Count[k], bar, "##################################################");
+    }
+}
+
+static  void  ShowTiming (const Report &r, const Options &o)
+{
+    const TimingRow  &d = r.Design();
+    struct Pair {
+        SV        Group;
+        SV        From;
+        SV        To;
+        bool      Max;
+        uint64_t  Paths;
+        double    Worst;
+    };
+    std::vector<Pair>  pairs;
+
+
+    std::printf("%s   WNS %s  TNS %s  (%s of %s endpoints)\n", TimingMet(r) ? "met" : "NOT MET",
+                Ns(d.Wns).c_str(), Ns(d.Tns).c_str(), Count(d.TnsFail).c_str(), Count(d.TnsTotal).c_str());
+    std::printf("        WHS %s  THS %s  (%s of %s endpoints)\n",
+                Ns(d.Whs).c_str(), Ns(d.Ths).c_str(), Count(d.ThsFail).c_str(), Count(d.ThsTotal).c_str());
+    std::printf("        WPWS %s TPWS %s (%s of %s endpoints)\n",
+                Ns(d.Wpws).c_str(), Ns(d.Tpws).c_str(), Count(d.TpwsFail).c_str(), Count(d.TpwsTotal).c_str());
+
+    std::printf("\n%-24s %12s %10s %10s %10s %10s\n", "clock", "period(ns)", "MHz", "WNS", "WHS", "WPWS");
+    for (const TimingClock &k : r.Clocks()) {
+        const TimingRow  *row = nullptr;
+
+
+        for (const TimingRow &i : r.Intra()) {
+            if (i.Name == k.Name) {
+                row = &i;
+            }
+        }
+        std::printf("%-24s %12s %10s %10s %10s %10s\n", Str(k.Name).c_str(), Ns(k.Period).c_str(), Ns(k.Mhz).c_str(),
+                    Ns(row ? row->Wns : NAN).c_str(), Ns(row ? row->Whs : NAN).c_str(), Ns(row ? row->Wpws : NAN).c_str());
+    }
+    for (const TimingRow &i : r.Inter()) {
+        std::printf("%-24s %12s %10s %10s %10s\n", (Str(i.Name) + " -> " + Str(i.To)).c_str(), "", "",
+                    Ns(i.Wns).c_str(), Ns(i.Whs).c_str());
+    }
+
+    for (const TimingPath &p : r.Paths()) {                     /* Clock domains and groups of the listed paths         */
+        auto  it = std::find_if(pairs.begin(), pairs.end(), [&p](const Pair &q) {
+                                    return ((q.Group == p.Group) && (q.From == p.From) && (q.To == p.To) &&
+                                            (q.Max == p.Max)); });
+
+
+        if (it == pairs.end()) {
+            pairs.push_back({ p.Group, p.From, p.To, p.Max, 0u, INFINITY });
+            it = pairs.end() - 1;
+        }
+        it->Paths++;
+        it->Worst = std::min(it->Worst, p.Slack);
+    }
+    std::printf("\n%-14s %-40s %5s %8s %10s\n", "group", "from -> to", "check", "paths", "worst");
+    for (const Pair &q : pairs) {
+        std::string  name = (q.From.empty() ? std::string("(none)") : Str(q.From)) + " -> " +
+                            (q.To.empty()   ? std::string("(none)") : Str(q.To));
+
+
+        std::printf("%-14s %-40s %5s %8llu %10s\n", Str(q.Group).c_str(), name.c_str(), q.Max ? "max" : "min",
+                    (unsigned long long)q.Paths,
+                    Ns(q.Worst).c_str());
+    }
+
+    for (int max = 1; max >= 0; max--) {
+        std::vector<const TimingPath *>  w = Worst(r, max != 0, o.Paths);
+
+
+        if (w.empty()) {
+            continue;
+        }
+        std::printf("\nworst %s paths\n", max ? "setup" : "hold");
+        for (const TimingPath *p : w) {
+            std::printf("  %8s  %2u levels  %8s ns  %s\n            -> %s\n", Ns(p->Slack).c_str(), p->Levels,
+                        Ns(p->Delay).c_str(), Str(p->Source).c_str(), Str(p->Destination).c_str());
+        }
+    }
+    if (o.Hist > 0.0) {
+        ShowHistogram(r, true,  o.Hist);
+        ShowHistogram(r, false, o.Hist);
+    }
+}
+
+static  void  ShowUtil (const Report &r)
+{
+    std::printf("%-36s %10s %10s %8s\n", "resource", "used", "available", "util%");
+    for (const UtilTable &t : r.Tables()) {
+        int  used  = t.Column("Used");
+        int  avail = t.Column("Available");
+        int  util  = t.Column("Util%");
+
+
+        if (!ResourceTable(t)) {
+            continue;
+        }
+        std::printf("%s\n", Str(t.Section).c_str());
+        for (const UtilRow &row : t.Rows) {
+            if ((row.Depth > 1u) || ((size_t)util >= row.Cells.size())) {
+                continue;
+            }
+            std::printf("  %*s%-*s %10s %10s %8s\n", (int)row.Depth * 2, "", 34 - (int)row.Depth * 2,
+                        Str(row.Site).c_str(), Str(row.Cells[used]).c_str(), Str(row.Cells[avail]).c_str(),
+                        Str(row.Cells[util]).c_str());
+        }
+    }
+}
+
+static  int  ModeShow (const Options &o)
+{
+    bool  ok = true;
+
+
+    for (const std::string &f : o.Files) {
+        Loaded         l = Load(f);
+        const Report  &r = *l.Rpt;
+
+
+        std::printf("%s: %s of %s (%s), %s\n", f.c_str(), (r.Kind() == ReportKind::Timing) ? "timing" : "utilization",
+                    Str(r.Field("Design")).c_str(), Str(r.Field("Device")).c_str(), Str(r.Field("Date")).c_str());
+        std::printf("%llu lines, %.1f MB in %.1f ms (%.0f MB/s)\n\n", (unsigned long long)r.Lines(),
+                    (double)r.Bytes() / 1e6, l.Ms, (double)r.Bytes() / 1e3 / std::max(l.Ms, 1e-3));
+        if (r.Kind() == ReportKind::Timing) {
+            std::printf("%zu paths, %zu pulse width checks\n", r.Paths().size(), r.Pulses().size());
+            ShowTiming(r, o);
+            ok &= TimingMet(r);
+        } else {
+            ShowUtil(r);
+        }
+        std::printf("\n");
+    }
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               DIFF
+*********************************************************************************************************
+*/
+
+static  void  DiffValue (const char *name, double a, double b, bool count = false)
+{
+    std::string  sa = count ? Count(a) : Ns(a);
+    std::string  sb = count ? Count(b) : Ns(b);
+
+
+    std::printf("  %-24s %10s -> %-10s", name, sa.c_str(), sb.c_str());
+    if (std::isfinite(a) && std::isfinite(b) && (a != b)) {
+        std::printf(count ? " %+.0f" : " %+.3f", b - a);
+    }
+    std::printf("\n");
+}
+
+static  void  DiffTiming (const Report &a, const Report &b, const Options &o)
+{
+    std::vector<PathDelta>  d = ReportDiff(a, b);
+    std::vector<PathDelta>  both;
+    size_t                  gone  = 0u;
+    size_t                  added = 0u;
+
+
+    std::printf("design\n");
+    DiffValue("WNS",                   a.Design().Wns,      b.Design().Wns);
+    DiffValue("TNS",                   a.Design().Tns,      b.Design().Tns);
+    DiffValue("TNS failing endpoints", a.Design().TnsFail,  b.Design().TnsFail,  true);
+    DiffValue("TNS total endpoints",   a.Design().TnsTotal, b.Design().TnsTotal, true);
+    DiffValue("WHS",                   a.Design().Whs,      b.Design().Whs);
+    DiffValue("THS",                   a.Design().Ths,      b.Design().Ths);
+    DiffValue("THS failing endpoints", a.Design().ThsFail,  b.Design().ThsFail,  true);
+    DiffValue("WPWS",                  a.Design().Wpws,     b.Design().Wpws);
+
+    for (const TimingRow &rb : b.Intra()) {
+        const TimingRow  *ra = nullptr;
+
+
+        for (const TimingRow &i : a.Intra()) {
+            if (i.Name == rb.Name) {
+                ra = &i;
+            }
+        }
+        std::printf("clock %s%s\n", Str(rb.Name).c_str(), (ra == nullptr) ? " (new)" : "");
+        DiffValue("WNS", ra ? ra->Wns : NAN, rb.Wns);
+        DiffValue("WHS", ra ? ra->Whs : NAN, rb.Whs);
+    }
+
+    for (const PathDelta &p : d) {
+        if ((p.Old != nullptr) && (p.New != nullptr)) {
+            both.push_back(p);
+        }
+        gone  += (p.New == nullptr);
+        added += (p.Old == nullptr);
+    }
+    std::stable_sort(both.begin(), both.end(), [](const PathDelta &x, const PathDelta &y) {
+                         return ((x.New->Slack - x.Old->Slack) < (y.New->Slack - y.Old->Slack)); });
+    std::printf("\npaths: %zu in both, %zu only in the old build, %zu only in the new one\n", both.size(), gone, added);
+    for (size_t k = 0u; (k < both.size()) && (k < o.Paths); k++) {
+        const PathDelta  &p = both[k];
+
+
+        if (!std::isfinite(p.Old->Slack) || !std::isfinite(p.New->Slack)) {
+            continue;
+        }
+        std::printf("  %s %8s -> %8s  %+7.3f  %s\n            -> %s\n", p.New->Max ? "max" : "min",
+                    Ns(p.Old->Slack).c_str(), Ns(p.New->Slack).c_str(), p.New->Slack - p.Old->Slack,
+                    Str(p.New->Source).c_str(), Str(p.New->Destination).c_str());
+    }
+    for (const PathDelta &p : d) {
+        if ((p.Old == nullptr) && std::isfinite(p.New->Slack)) {
+            std::printf("  %s      new -> %8s           %s\n            -> %s\n", p.New->Max ? "max" : "min",
+                        Ns(p.New->Slack).c_str(), Str(p.New->Source).c_str(), Str(p.New->Destination).c_str());
+        }
+    }
+}
+
+static  std::vector<std::pair<std::string, double>>  UsedCells (const Report &r)
+{
+    std::vector<std::pair<std::string, double>>  v;             /* 'section / site / .. / site', Used                   */
+
+
+    for (const UtilTable &t : r.Tables()) {
+        std::vector<std::string>  chain;
+        int                       used = t.Column("Used");
+
+
+        if (used < 0) {
+            continue;
+        }
+        for (const UtilRow &row : t.Rows) {
+            chain.resize(std::min<size_t>(row.Depth, chain.size()));
+            chain.push_back(Str(row.Site));
+            if ((size_t)used < row.Cells.size()) {
+                std::string  key = Str(t.Section);
+
+
+                for (const std::string &c : chain) {
+                    key += " / " + c;
+                }
+                v.emplace_back(key, std::strtod(Str(row.Cells[used]).c_str(), nullptr));
+            }
+        }
+    }
+    return (v);
+}
+
+static  void  DiffUtil (const Report &a, const Report &b)
+{
+    std::vector<std::pair<std::string, double>>  ua = UsedCells(a);
+    std::vector<std::pair<std::string, double>>  ub = UsedCells(b);
+    size_t                                       same = 0u;
+
+
+    std::printf("%-64s %8s %8s %8s\n", "resource", "old", "new", "change");
+    for (const auto &nb : ub) {
+        auto    it = std::find_if(ua.begin(), ua.end(), [&nb](const std::pair<std::string, double> &x) {
+                                      return (x.first == nb.first); });
+        double  va = (it != ua.end()) ? it->second : 0.0;
+
+
+        if (va != nb.second) {
+            std::printf("%-64s %8.0f %8.0f %+8.0f\n", nb.first.c_str(), va, nb.second, nb.second - va);
+        } else {
+            same++;
+        }
+    }
+    for (const auto &na : ua) {
+        if (std::none_of(ub.begin(), ub.end(), [&na](const std::pair<std::string, double> &x) {
+                             return (x.first == na.first); })) {
+            std::printf("%-64s %8.0f %8s\n", na.first.c_str(), na.second, "-");
+        }
+    }
+    std::printf("%zu unchanged\n", same);
+}
+
+static  int  ModeDiff (const Options &o)
+{
+    if (o.Files.size() != 2u) {
+        Usage();
+    }
+
+    Loaded  a = Load(o.Files[0]);
+    Loaded  b = Load(o.Files[1]);
+
+
+    if (a.Rpt->Kind() != b.Rpt->Kind()) {
+        throw std::runtime_error("cannot compare a timing report with a utilization report");
+    }
+    std::printf("%s (%s)\n-> %s (%s)\n\n", o.Files[0].c_str(), Str(a.Rpt->Field("Date")).c_str(),
+                o.Files[1].c_str(), Str(b.Rpt->Field("Date")).c_str());
+    if (a.Rpt->Kind() == ReportKind::Timing) {
+        DiffTiming(*a.Rpt, *b.Rpt, o);
+        return (TimingMet(*b.Rpt) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    DiffUtil(*a.Rpt, *b.Rpt);
+    return (EXIT_SUCCESS);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               TEX
+*
+* Description : Tables as the hand-written ones of chapters/Lab.tex: table[H], \centering, |l|r| columns
+*               and \hline rules, the header closed by a double rule.
+*********************************************************************************************************
+*/
+
+static  std::string  Tex (SV s)                                 /* Escapes the LaTeX specials of a netlist name         */
+{
+    std::string  r;
+
+
+    for (char ch : s) {
+        switch (ch) {
+            case '_': case '&': case '%': case '$': case '#': case '{': case '}':
+                 r += '\\';
+                 r += ch;
+                 break;
+
+            case '~':  r += "\\textasciitilde{}";   break;
+            case '^':  r += "\\textasciicircum{}";  break;
+            case '\\': r += "\\textbackslash{}";    break;
+            default:   r += ch;                     break;
+        }
+    }
+    return (r);
+}
+
+static  std::string  Leaf (SV pin)                              /* Last two levels of a hierarchical pin name           */
+{
+    size_t  k = pin.rfind('/');
+
+
+    if ((k != SV::npos) && (k > 0u)) {
+        k = pin.rfind('/', k - 1u);
+    }
+    return (Tex((k == SV::npos) ? pin : pin.substr(k + 1u)));
+}
+
+static  std::string  TexNs (double v)
+{
+    return (std::isnan(v) ? std::string("-") : "$" + Ns(v) + "$");
+}
+
+static  void  TexTiming (std::FILE *f, const Report &r, const Options &o)
+{
+    const TimingRow  &d      = r.Design();
+    std::string       design = Tex(r.Field("Design"));
+
+
+    std::fprintf(f, "\\begin{table}[H] \\centering\n"
+                    "   \\begin{tabular}{ |l|r|r|r|r| } \\hline\n"
+                    "       Check & Worst slack (ns) & Total (ns) & Failing endpoints & Endpoints \\\\ \\hline \\hline\n");
+    std::fprintf(f, "       Setup & %s & %s & %s & %s \\\\ \\hline\n", TexNs(d.Wns).c_str(), TexNs(d.Tns).c_str(),
+                 Count(d.TnsFail).c_str(), Count(d.TnsTotal).c_str());
+    std::fprintf(f, "       Hold & %s & %s & %s & %s \\\\ \\hline\n", TexNs(d.Whs).c_str(), TexNs(d.Ths).c_str(),
+                 Count(d.ThsFail).c_str(), Count(d.ThsTotal).c_str());
+    std::fprintf(f, "       Pulse width & %s & %s & %s & %s \\\\ \\hline\n", TexNs(d.Wpws).c_str(), TexNs(d.Tpws).c_str(),
+                 Count(d.TpwsFail).c_str(), Count(d.TpwsTotal).c_str());
+    std::fprintf(f, "   \\end{tabular}\n"
+                    "   \\caption{Timing summary of %s (%s)}\n"
+                    "   \\label{tab:vivado-timing}\n"
+                    "\\end{table}\n\n", design.c_str(), TimingMet(r) ? "all constraints met" : "constraints not met");
+
+    std::fprintf(f, "\\begin{table}[H] \\centering\n"
+                    "   \\begin{tabular}{ |l|r|r|r|r| } \\hline\n"
+                    "       Clock & Period (ns) & Frequency (MHz) & WNS (ns) & WHS (ns) \\\\ \\hline \\hline\n");
+    for (const TimingClock &k : r.Clocks()) {
+        const TimingRow  *row = nullptr;
+
+
+        for (const TimingRow &i : r.Intra()) {
+            if (i.Name == k.Name) {
+                row = &i;
+            }
+        }
+        std::fprintf(f, "       %s & %s & %s & %s & %s \\\\ \\hline\n", Tex(k.Name).c_str(), TexNs(k.Period).c_str(),
+                     TexNs(k.Mhz).c_str(), TexNs(row ? row->Wns : NAN).c_str(), TexNs(row ? row->Whs : NAN).c_str());
+    }
+    std::fprintf(f, "   \\end{tabular}\n"
+                    "   \\caption{Clocks}\n"
+                    "   \\label{tab:vivado-clocks}\n"
+                    "\\end{table}\n\n");
+
+    for (int max = 1; max >= 0; max--) {
+        std::vector<const TimingPath *>  w = Worst(r, max != 0, o.Paths);
+
+
+        if (w.empty()) {
+            continue;
+        }
+        std::fprintf(f, "\\begin{table}[H] \\centering\n"
+                        "   \\begin{tabular}{ |r|r|r|l|l| } \\hline\n"
+                        "       Slack (ns) & Levels & Delay (ns) & Source & Destination \\\\ \\hline \\hline\n");
+        for (const TimingPath *p : w) {
+            std::fprintf(f, "       %s & %u & %s & %s & %s \\\\ \\hline\n", TexNs(p->Slack).c_str(), p->Levels,
+                         TexNs(p->Delay).c_str(), Leaf(p->Source).c_str(), Leaf(p->Destination).c_str());
+        }
+        std::fprintf(f, "   \\end{tabular}\n"
+                        "   \\caption{Worst %s paths}\n"
+                        "   \\label{tab:vivado-%s}\n"
+                        "\\end{table}\n\n", max ? "setup" : "hold", max ? "setup" : "hold");
+    }
+}
+
+static  void  TexUtil (std::FILE *f, const Report &r)
+{
+    std::vector<SV>  done;                                      /* Slice Logic Distribution repeats some sites          */
+
+
+    std::fprintf(f, "\\begin{table}[H] \\centering\n"
+                    "   \\begin{tabular}{ |l|r|r|r| } \\hline\n"
+                    "       Resource & Used & Available & Util\\%% \\\\ \\hline \\hline\n");
+    for (const UtilTable &t : r.Tables()) {
+        int  used  = t.Column("Used");
+        int  avail = t.Column("Available");
+        int  util  = t.Column("Util%");
+
+
+        if (!ResourceTable(t)) {
+            continue;
+        }
+        for (const UtilRow &row : t.Rows) {                     /* Top-level sites that are used                        */
+            if ((row.Depth != 0u) || ((size_t)util >= row.Cells.size()) || (row.Cells[used] == "0") ||
+                row.Cells[avail].empty() || (std::find(done.begin(), done.end(), row.Site) != done.end())) {
+                continue;
+            }
+            done.push_back(row.Site);
+            std::fprintf(f, "       %s & %s & %s & $%s$ \\\\ \\hline\n", Tex(row.Site).c_str(), Tex(row.Cells[used]).c_str(),
+                         Tex(row.Cells[avail]).c_str(), Tex(row.Cells[util]).c_str());
+        }
+    }
+    std::fprintf(f, "   \\end{tabular}\n"
+                    "   \\caption{Resources of %s on the %s}\n"
+                    "   \\label{tab:vivado-utilization}\n"
+                    "\\end{table}\n\n", Tex(r.Field("Design")).c_str(), Tex(r.Field("Device")).c_str());
+}
+
+static  int  ModeTex (const Options &o)
+{
+    std::vector<Loaded>  rpts;
+    std::FILE           *f;
+
+
+    for (const std::string &path : o.Files) {                   /* All read before the output is opened                 */
+        rpts.push_back(Load(path));
+    }
+    f = OpenOut(o.Out);
+    std::fprintf(f, "%% Generated by vivrep tex from");
+    for (const std::string &path : o.Files) {
+        std::fprintf(f, " %s", path.c_str());
+    }
+    std::fprintf(f, "\n\n");
+    for (const Loaded &l : rpts) {
+        if (l.Rpt->Kind() == ReportKind::Timing) {
+            TexTiming(f, *l.Rpt, o);
+        } else {
+            TexUtil(f, *l.Rpt);
+        }
+    }
+    if (f != stdout) {
+        std::fclose(f);
+    }
+    return (EXIT_SUCCESS);
+}
+
+
+/*
+*********************************************************************************************************
+*                                               CUT
+*********************************************************************************************************
+*/
+
+static  int  ModeCut (int argc, char *argv[])
+{
+    std::FILE  *f;
+
+
+    if ((argc < 3) || (argc > 4)) {
+        Usage();
+    }
+
+    Report  r(argv[2]);
+
+
+    if (r.Kind() != ReportKind::Timing) {
+        throw std::runtime_error(std::string(argv[2]) + ": not a timing report");
+    }
+    f = OpenOut((argc == 4) ? argv[3] : "");
+    std::fwrite(r.Summary().data(), 1u, r.Summary().size(), f);
+    if (f != stdout) {
+        std::fclose(f);
+    }
+    return (EXIT_SUCCESS);
+}
+
+
+int  main (int argc, char *argv[])
+{
+    if (argc < 3) {
+        Usage();
+    }
+    try {
+        if (std::strcmp(argv[1], "cut") == 0) {
+            return (ModeCut(argc, argv));
+        }
+
+        Options  o = ParseArgs(argc, argv);
+
+
+        if (std::strcmp(argv[1], "show") == 0) {
+            return (ModeShow(o));
+        }
+        if (std::strcmp(argv[1], "diff") == 0) {
+            return (ModeDiff(o));
+        }
+        if (std::strcmp(argv[1], "tex") == 0) {
+            return (ModeTex(o));
+        }
+        Usage();
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "vivrep: %s\n", ex.what());
+    }
+    return (EXIT_FAILURE);
+}
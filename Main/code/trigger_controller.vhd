@@ -10,12 +10,18 @@ use ieee.numeric_std.all;
 -- Hardware controller for the trigger controller
 -- Clock frequency required: 108 MHz
 -- Resetn: active low
+-- wait_vsync: the trigger is only armed while vsync='0', so one sweep is taken per frame. Set it to
+-- false when the memory has a bank per sweep (frame_buffers.vhd): the trigger re-arms as soon as the
+-- last sample is stored.
 --
 ------------------------------------------
 ------------------------------------------
 
 
 entity trigger_controller is
+generic(
+    wait_vsync: boolean := true -- arm the trigger only during vsync
+);
 port(
 	clk:  	in std_logic; -- 108 MHz clock signal
     resetn: in std_logic; -- active low
@@ -71,7 +77,7 @@ begin
         else
         
             -- trigger condition
-            if ((vsync='0' and counted_acqs=0 and trigger_flag='0')) then
+            if (((vsync='0' or not wait_vsync) and counted_acqs=0 and trigger_flag='0')) then
                 if ((trigger_slope='1' and last_value(11 downto 3)>trigger_value(8 downto 0) and prev_value(11 downto 3)<trigger_value(8 downto 0) and last_value(11 downto 8)>prev_value(11 downto 8)) or
                     (trigger_slope='0' and last_value(11 downto 3)<trigger_value(8 downto 0) and prev_value(11 downto 3)>trigger_value(8 downto 0) and last_value(11 downto 8)<prev_value(11 downto 8))) then -- trigger fires
                     trigger_flag <= '1'; -- flag that determines that a total of 1280 samples need to be acquired
@@ -10,7 +10,9 @@ use ieee.numeric_std.all;
 -- vga_control.vhd
 -- Generates the necessary signals to display data on screen
 -- For each column pixel, it reads its value at the memory. 
--- If the 9 MSB coindice with the current row, a yellow pixel is plotted.
+-- If the current row lies between the 9 MSB of data_min and data_in, plus offset, a yellow pixel is plotted.
+-- They are the same sample unless sweeps are overlaid (persistence in frame_buffers.vhd).
+-- The sums are taken in 10 bits: a sample that offset moves past row 511 is not drawn, rather than wrapping.
 -- Trigger level is also plotted in a 30 wide pixel blue line.
 -- Clock frequency required: 108 MHz
 -- Resetn: active low
@@ -24,6 +26,7 @@ port(
 	clk:  	in std_logic; -- 108 MHz
 	resetn: in std_logic; -- active low
 	data_in: in std_logic_vector(11 downto 0); -- input data from the memory
+	data_min: in std_logic_vector(11 downto 0); -- lowest of the overlaid sweeps, = data_in without persistence
 	trigger_level: in std_logic_vector(8 downto 0); -- trigger level to display
 	--
     t_temperature: in std_logic_vector(10 downto 0); -- threshold temperature, in pixels
@@ -157,7 +160,7 @@ begin
                          red <= "0000";
                          green <= "0000";
                          blue <= "1111";
-			     elsif ( (data_in(11 downto 3)+offset = v_counter(8 downto 0)) and v_counter(9)='0' and alarm='0') then -- compare 9 MSB, plot the waveform in yellow
+			     elsif ( (('0' & data_min(11 downto 3))+offset <= v_counter(9 downto 0)) and (('0' & data_in(11 downto 3))+offset >= v_counter(9 downto 0)) and v_counter(9)='0' and alarm='0') then -- compare 9 MSB plus offset in 10 bits, no wrap, plot the waveform in yellow
 			         -- waveform is shifted to have it centered in the upper half of the screen
 			         red <= "1111";
 			         green <= "1111";